@@ -15,6 +15,20 @@
 #include "web_server_handler.h"
 #include "temperature_log_handler.h"
 #include "tft_integration.h"
+#include "program_codec.h"
+#include "api_cache.h"
+#include "schedule_batch.h"
+#include "boot_sequence.h"
+#include "time_service.h"
+#include "metrics.h"
+#include "mqtt_telemetry.h"
+#include "trace_ring.h"
+#include "profiler.h"
+#include "furnace_model.h"
+#include "furnace_control.h"
+#include "furnace_sim.h"
+#include "control_benchmark.h"
+#include "energy_meter.h"
 
 Preferences preferences;
 
@@ -83,6 +97,8 @@ extern int maxTempPoints;
 // Temperature variables
 float* targetTemp = NULL;
 float** programTemps = NULL;
+bool programLoaded[MAX_PROGRAMS] = {false};   // Temperatures read from flash (see PROGRAM STORAGE)
+String manifestNames[MAX_PROGRAMS];           // Names as last written to the program manifest
 unsigned long lastSmoothingUpdate = 0;
 
 // Logging configuration
@@ -93,9 +109,10 @@ unsigned long lastLogTime = 0;
 
 // Timing variables
 unsigned long lastTempCheck = 0;
+unsigned long lastTickMicros = 0;
+TraceEvent traceTick;  // Filled in over one control tick, see trace_ring.h
+float controlTargetTemp = 0.0;  // Target of the last control tick
 unsigned long lastDisplayUpdate = 0;
-unsigned long lastTimeSync = 0;
-unsigned long lastWifiCheck = 0;
 unsigned long lastDnsCheck = 0;
 unsigned long lastManualTimeUpdate = 0;
 
@@ -140,9 +157,7 @@ void saveWifiConfig();
 bool deleteRecursive(const String& path);
 void generateRandomPassword();
 void createDefaultConfig();
-void connectToWifi();
 void setupCaptivePortal();
-void checkWifiConnection();
 void syncTime();
 int getCurrentHour();
 int getCurrentMinute();
@@ -151,9 +166,17 @@ String getCurrentTime();
 String getFullTimestamp();
 void readTemperature();
 void controlFurnace();
+float getControlTargetTemperature();
+void setRelay(bool on);
+void traceControlTick(bool relayWasOn);
 void logTemperature();
 void loadProgramsFromSPIFFS();
+bool loadProgramsFromBinary();
+bool loadProgramManifest();
+uint8_t* encodeAllPrograms(size_t& length);
 void saveAllPrograms();
+void saveProgramToSPIFFS(int programIndex);
+void ensureProgramLoaded(int programIndex);
 void loadProgram(int programIndex);
 void saveProgram(int programIndex, String programName);
 void setupWebServer();
@@ -161,9 +184,6 @@ void initializeTemperatureArrays();
 float getSmoothedTargetTemperature();
 void checkTempLogCleanup();
 void checkLogFiles();
-// Add PID function prototypes
-void resetPID();
-float calculatePIDOutput(float setpoint, float input, unsigned long currentTime);
 void processPendingThemeSave();
 
 void checkTempLogCleanup() {
@@ -175,7 +195,7 @@ void checkTempLogCleanup() {
     if (SPIFFS.exists(TEMP_LOG_FILE)) {
       File newFile = SPIFFS.open(TEMP_LOG_FILE, FILE_WRITE);
       if (newFile) {
-        newFile.println("Timestamp,Temperature,Target,FurnaceStatus");
+        newFile.println(TEMP_LOG_HEADER);
         newFile.close();
       }
     }
@@ -183,6 +203,10 @@ void checkTempLogCleanup() {
 }
 
 void initializeTemperatureArrays() {
+  // Taken before the old arrays are freed: the web task can get here from
+  // /api/updateResolution while a load or save holds pointers into them
+  ProgramStoreLock lock;
+
   if (targetTemp != NULL) {
     free(targetTemp);
     targetTemp = NULL;
@@ -200,6 +224,12 @@ void initializeTemperatureArrays() {
   }
   
   maxTempPoints = 24 * tempResolution;
+  bumpAllApiGenerations();
+
+  // Fresh arrays hold no program data - reload from flash on next use
+  for (int i = 0; i < MAX_PROGRAMS; i++) {
+    programLoaded[i] = false;
+  }
   
   targetTemp = (float*)malloc(maxTempPoints * sizeof(float));
   if (targetTemp == NULL) {
@@ -230,35 +260,18 @@ void initializeTemperatureArrays() {
   }
 }
 
-void listSPIFFSFiles(const char* dirname = "/", uint8_t levels = 2) {
-  File root = SPIFFS.open(dirname);
-  if (!root) {
-    return;
-  }
-  if (!root.isDirectory()) {
-    root.close();
-    return;
-  }
-  File file = root.openNextFile();
-  int fileCount = 0;
-  while (file) {
-    if (file.isDirectory()) {
-      if (levels) {
-        listSPIFFSFiles(file.path(), levels - 1);
-      }
-    }
-    file = root.openNextFile();
-    fileCount++;
-  }
-  root.close();
+// ====================================================================
+// BOOT STAGES
+// ====================================================================
+// Critical stages run from setup() in this order; deferred ones follow
+// from loop() once the relay is under control (boot_sequence.h)
+
+static void bootRelay() {
+  pinMode(RELAY_PIN, OUTPUT);
+  digitalWrite(RELAY_PIN, LOW);
 }
 
-void setup() {
-  Serial.begin(115200);
-  Serial.println("Furnace Controller Starting...");
-  
-  while (!Serial);
-  
+static void bootStorage() {
   bool spiffsMounted = SPIFFS.begin(true);
   
   if (!spiffsMounted) {
@@ -267,80 +280,21 @@ void setup() {
       Serial.println("SPIFFS formatted successfully");
       spiffsMounted = SPIFFS.begin(true);
     }
-    
-    if (!spiffsMounted) {
-      Serial.println("ERROR: SPIFFS initialization failed!");
-      return;
-    }
   }
   
-  Serial.println("SPIFFS initialized successfully");
-  
-  size_t totalBytes = SPIFFS.totalBytes();
-  size_t usedBytes = SPIFFS.usedBytes();
-  
-  if (!SPIFFS.exists(TEMP_LOG_FILE)) {
-    File file = SPIFFS.open(TEMP_LOG_FILE, FILE_WRITE);
-    if (file) {
-      file.println("Timestamp,Temperature,Target,FurnaceStatus");
-      file.close();
-    }
-  }
-  
-  listSPIFFSFiles();
-  
-  if (SPIFFS.exists(TEMP_LOG_FILE)) {
-  } else {
-  }
-
-  pinMode(RELAY_PIN, OUTPUT);
-  digitalWrite(RELAY_PIN, LOW);
+  Serial.println(spiffsMounted ? "SPIFFS initialized successfully" : "ERROR: SPIFFS initialization failed!");
+}
 
+static void bootSettings() {
   loadAppSettings();
   loadWifiConfig();
-  
   initializeTemperatureArrays();
+}
 
-  if (!SPIFFS.exists(TEMP_LOG_FILE)) {
-    File file = SPIFFS.open(TEMP_LOG_FILE, FILE_WRITE);
-    if (!file) {
-      size_t total = SPIFFS.totalBytes();
-      size_t used = SPIFFS.usedBytes();
-      
-      File testFile = SPIFFS.open("/test_file.txt", FILE_WRITE);
-      if (testFile) {
-        testFile.println("Test file created successfully");
-        testFile.close();
-        
-        SPIFFS.remove("/test_file.txt");
-        
-        file = SPIFFS.open(TEMP_LOG_FILE, FILE_WRITE);
-        if (file) {
-        }
-      }
-    }
-    
-    if (file) {
-      size_t bytesWritten = file.println("Timestamp,Temperature,Target,FurnaceStatus");
-      file.close();
-      
-      if (SPIFFS.exists(TEMP_LOG_FILE)) {
-        File verifyFile = SPIFFS.open(TEMP_LOG_FILE, FILE_READ);
-        if (verifyFile) {
-          verifyFile.close();
-        }
-      }
-    }
-  } else {
-    File file = SPIFFS.open(TEMP_LOG_FILE, FILE_READ);
-    if (file) {
-      if (file.size() > 0) {
-        String firstLine = file.readStringUntil('\n');
-      }
-      file.close();
-    }
-  }
-
+static void bootThermocouple() {
+#ifdef SIMULATED_FURNACE
+  Serial.println("Simulated furnace in place of the thermocouple; relay pin held low");
+#else
   if (!thermocouple.begin()) {
     Serial.println("ERROR: Thermocouple initialization failed!");
     thermocoupleError = true;
@@ -356,48 +310,59 @@ void setup() {
       Serial.println("°C");
     }
   }
+#endif
+}
 
+static void bootProgram() {
+  loadProgramsFromSPIFFS();
+  if (programNames[0].length() > 0) {
+    loadProgram(0);
+  }
+  
+  // Reset PID controller on startup
+  resetPID();
+}
+
+static void bootWifi() {
 #ifdef HARDCODED_WIFI_TEST
   connectToHardcodedWiFi();
-  wifiConnected = (WiFi.status() == WL_CONNECTED);
-#else
-  WiFi.setHostname("furnace");
-  connectToWifi();
 #endif
+  // Connects in the background; onWifiConnected() runs once it has an IP
+  WiFi.setHostname("furnace");
+  beginWifi();
+}
 
-  if (!wifiConnected) {
-    Serial.println("WiFi connection failed, starting Access Point mode");
-    startAccessPoint();
-    setupCaptivePortal();
-  } else {
-    Serial.print("WiFi connected! IP address: ");
-    Serial.println(WiFi.localIP());
-    Serial.print("Hostname: ");
-    Serial.println(WiFi.getHostname());
-    
-    if (!MDNS.begin("furnace")) {
-      Serial.println("mDNS responder failed to start");
-    } else {
-      Serial.println("mDNS responder started");
-    }
-    configTime(GMT_OFFSET_SEC, DAYLIGHT_OFFSET_SEC, NTP_SERVER);
-    syncTime();
-    loadProgramsFromSPIFFS();
-    if (programNames[0].length() > 0) {
-      loadProgram(0);
-    }
-  }
-
+static void bootWebServer() {
+  // Portal pages answer only on the access point, so they are registered
+  // once and stay harmless while the station is connected
+  setupCaptivePortal();
   setupWebServer();
+}
+
+static void bootLogFiles() {
   checkLogFiles();
+}
+
+static BootStage bootStages[] = {
+  { "relay",        bootRelay,        false },
+  { "storage",      bootStorage,      false },
+  { "settings",     bootSettings,     false },
+  { "energy",       beginEnergyMeter, false },
+  { "thermocouple", bootThermocouple, false },
+  { "program",      bootProgram,      false },
+  { "wifi",         bootWifi,         true },
+  { "webserver",    bootWebServer,    true },
+  { "mqtt",         beginMqtt,        true },
+  { "display",      initializeTFT,    true },
+  { "logfiles",     bootLogFiles,     true },
+};
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("Furnace Controller Starting...");
+
+  runBootStages(bootStages, sizeof(bootStages) / sizeof(bootStages[0]));
   
-  // Reset PID controller on startup
-  resetPID();
-  
-  // Initialize TFT display
-  initializeTFT();
-  
-  Serial.println("Furnace Controller setup complete!");
   Serial.println("System ready for operation.");
   if (pidEnabled) {
     Serial.println("PID Control: ENABLED");
@@ -413,49 +378,103 @@ void setup() {
   } else {
     Serial.println("PID Control: DISABLED");
   }
-  delay(2000);
 }
 
 void loop() {
+  PROFILE_SCOPE("loop");
   unsigned long currentMillis = millis();
  
-  checkTempLogCleanup();
+  {
+    PROFILE_SCOPE("loop.logCleanup");
+    checkTempLogCleanup();
+  }
 
-  if (!ap_active && currentMillis - lastWifiCheck >= 30000) {
-    lastWifiCheck = currentMillis;
-    checkWifiConnection();
+  {
+    PROFILE_SCOPE("loop.wifi");
+    updateWifi();
   }
   
   // Handle DNS requests for captive portal - process more frequently for better responsiveness
   if (ap_active) {
+    PROFILE_SCOPE("loop.dns");
     handleDNS();
   }
 
-  if (wifiConnected && currentMillis - lastTimeSync >= 3600000) {
-    lastTimeSync = currentMillis;
-    if (!useManualTime) {
-      syncTime();
-    }
+  // NTP syncs arrive in the background (time_service.h)
+  updateTimeService();
+
+  // Batch schedule edits from the web UI land between control ticks
+  {
+    PROFILE_SCOPE("loop.scheduleBatch");
+    applyPendingScheduleBatch();
   }
 
   if (currentMillis - lastTempCheck >= 500) {
+    PROFILE_SCOPE("loop.controlTick");
     lastTempCheck = currentMillis;
-    readTemperature();
-    if (!thermocoupleError && systemEnabled) {
+
+    // Tick lateness against the 500 ms period (metrics.h)
+    unsigned long tickMicros = micros();
+    unsigned long tickPeriod = lastTickMicros != 0 ? tickMicros - lastTickMicros : 0;
+    if (lastTickMicros != 0) {
+      observeMetric(METRIC_CONTROL_JITTER, tickPeriod > 500000UL ? tickPeriod - 500000UL : 0);
+    }
+    lastTickMicros = tickMicros;
+    countMetric(METRIC_CONTROL_TICKS);
+
+    bool relayWasOn = furnaceStatus;
+    traceTick = TraceEvent();
+    traceTick.millis = currentMillis;
+    traceTick.tickMs = (uint16_t)min(tickPeriod / 1000UL, 65535UL);
+
+    unsigned long controlStarted = micros();
+    {
+      PROFILE_SCOPE("loop.readTemperature");
+      readTemperature();
+    }
+    bool controlling = !thermocoupleError && systemEnabled;
+    if (controlling) {
       controlFurnace();
     } else {
-      furnaceStatus = false;
-      digitalWrite(RELAY_PIN, LOW);
+      setRelay(false);
     }
+    recordControlBenchmark(controlTargetTemp, controlling, relayWasOn, micros() - controlStarted);
+    recordRelayChange(furnaceStatus);
+    traceControlTick(relayWasOn);
+    updateApiStatusGeneration();
     
     if (currentMillis - lastLogTime >= (loggingFrequencySeconds * 1000)) {
       lastLogTime = currentMillis;
       if (!thermocoupleError) {
+        PROFILE_SCOPE("loop.logTemperature");
         logTemperature();
       }
     }
   }
 
+  // Network, web server and display come up one stage per pass, after
+  // the control tick
+  if (!isBootComplete()) {
+    PROFILE_SCOPE("loop.bootStage");
+    runDeferredBootStage();
+  }
+
+  // Firing boundaries and NVS checkpoints of the energy counters
+  updateEnergyMeter();
+
+  // Simulated firings against the current control settings, while the
+  // system is disabled (control_benchmark.h)
+  {
+    PROFILE_SCOPE("loop.benchmark");
+    updateControlBenchmark();
+  }
+
+  // Telemetry sampling, publishing and MQTT commands (mqtt_telemetry.h)
+  {
+    PROFILE_SCOPE("loop.mqtt");
+    updateMqtt();
+  }
+
   if (useManualTime && currentMillis - lastManualTimeUpdate >= 1000) {
     lastManualTimeUpdate = currentMillis;
     
@@ -492,10 +511,16 @@ void loop() {
   }
   
   // Process any pending theme save operations (non-blocking)
-  processPendingThemeSave();
+  {
+    PROFILE_SCOPE("loop.themeSave");
+    processPendingThemeSave();
+  }
   
   // Update TFT display
-  updateTFT();
+  {
+    PROFILE_SCOPE("loop.tft");
+    updateTFT();
+  }
 }
 
 void createDefaultAppSettings() {
@@ -607,29 +632,21 @@ void saveAppSettings() {
   preferences.end();
 }
 
-void syncTime() {
-  if (!wifiConnected) {
-    timeIsSynchronized = false;
-    return;
+void onWifiConnected() {
+  static bool mdnsStarted = false;
+  if (!mdnsStarted) {
+    mdnsStarted = MDNS.begin("furnace");
+    Serial.println(mdnsStarted ? "mDNS responder started" : "mDNS responder failed to start");
   }
 
-  configTime(GMT_OFFSET_SEC, DAYLIGHT_OFFSET_SEC, NTP_SERVER);
-  
-  int retry = 0;
-  const int maxRetries = 5;
-  struct tm timeinfo;
-  
-  while (retry < maxRetries && !getLocalTime(&timeinfo)) {
-    delay(1000);
-    retry++;
-  }
-
-  if (retry >= maxRetries) {
-    timeIsSynchronized = false;
-    return;
-  }
+  beginTimeService();
+  startMqtt();
+}
 
-  timeIsSynchronized = true;
+// Start an NTP sync in the background; timeIsSynchronized is set once the
+// first answer arrives
+void syncTime() {
+  requestTimeSync();
 }
 
 struct tm getAdjustedTime() {
@@ -761,90 +778,71 @@ float getSmoothedTargetTemperature() {
   return smoothedTemp;
 }
 
-void controlFurnace() {
-  float currentTargetTemp;
+// Target the program asks for right now
+float getControlTargetTemperature() {
   if (temperatureSmoothingEnabled) {
-    currentTargetTemp = getSmoothedTargetTemperature();
-  } else {
-    int currentIndex = getCurrentTempIndex();
-    currentIndex = max(0, min(currentIndex, maxTempPoints - 1));
-    currentTargetTemp = targetTemp[currentIndex];
+    return getSmoothedTargetTemperature();
   }
+  int currentIndex = getCurrentTempIndex();
+  currentIndex = max(0, min(currentIndex, maxTempPoints - 1));
+  return targetTemp[currentIndex];
+}
 
-  // Check if we're within the PID setpoint window
-  float tempError = abs(currentTargetTemp - currentTemp);
-  bool withinSetpointWindow = tempError <= pidSetpointWindow;
+// The only place the heater is switched, and where its energy is metered
+// (energy_meter.h). Simulated builds keep the pin low, so a bench
+// controller still wired to a kiln never fires it blind; a benchmark
+// firing (control_benchmark.h) touches neither pin nor meter.
+void setRelay(bool on) {
+  furnaceStatus = on;
+  if (isBenchmarkDrivingControl()) return;
+  noteRelayEdge(on);
+#ifndef SIMULATED_FURNACE
+  digitalWrite(RELAY_PIN, on ? HIGH : LOW);
+#endif
+}
 
-  if (pidEnabled && withinSetpointWindow) {
-    // Use PID control when within setpoint window
-    unsigned long now = millis();
-    float pidOutput = calculatePIDOutput(currentTargetTemp, currentTemp, now);
-    
-    // Convert PID output (0-100) to PWM duty cycle
-    float duty = pidOutput / 100.0;
-    duty = constrain(duty, 0.0f, 1.0f);
-    
-    pwmOnTimeMs = (unsigned long)(pwmPeriodMs * duty);
-    
-    if (now - pwmCycleStart >= pwmPeriodMs) {
-      pwmCycleStart = now;
-    }
-    
-    if ((now - pwmCycleStart) < pwmOnTimeMs) {
-      if (!pwmRelayState) {
-        digitalWrite(RELAY_PIN, HIGH);
-        pwmRelayState = true;
-        furnaceStatus = true;
-      }
-    } else {
-      if (pwmRelayState) {
-        digitalWrite(RELAY_PIN, LOW);
-        pwmRelayState = false;
-        furnaceStatus = false;
-      }
-    }
-  } else if (pwmEnabled) {
-    // Use PWM control when outside setpoint window or PID disabled
-    float error = currentTargetTemp - currentTemp;
-    float maxErr = 10.0f;
-    float minErr = -10.0f;
-    float clampedError = constrain(error, minErr, maxErr);
-    float duty = (clampedError + maxErr) / (2 * maxErr);
-    duty = constrain(duty, 0.0f, 1.0f);
-    pwmOnTimeMs = (unsigned long)(pwmPeriodMs * duty);
-    
-    unsigned long now = millis();
-    if (now - pwmCycleStart >= pwmPeriodMs) {
-      pwmCycleStart = now;
-    }
-    
-    if ((now - pwmCycleStart) < pwmOnTimeMs) {
-      if (!pwmRelayState) {
-        digitalWrite(RELAY_PIN, HIGH);
-        pwmRelayState = true;
-        furnaceStatus = true;
-      }
-    } else {
-      if (pwmRelayState) {
-        digitalWrite(RELAY_PIN, LOW);
-        pwmRelayState = false;
-        furnaceStatus = false;
-      }
-    }
+// Drop the relay when the system is switched off. The PWM window restarts
+// on the next enable instead of resuming an on-phase.
+void stopHeating() {
+  setRelay(false);
+  pwmRelayState = false;
+}
+
+void controlFurnace() {
+  controlTargetTemp = getControlTargetTemperature();
+  ControlMode mode = driveFurnace(controlTargetTemp, millis());
+
+  traceTick.setpoint = traceTenths(controlTargetTemp);
+  if (mode == CONTROL_MODE_PID) {
+    traceTick.flags |= TRACE_FLAG_MODE_PID;
+  } else if (mode == CONTROL_MODE_PWM) {
+    traceTick.flags |= TRACE_FLAG_MODE_PWM;
+  }
+  setMetricGauge(METRIC_PID_P, pidTerms.proportional);
+  setMetricGauge(METRIC_PID_I, pidTerms.integral);
+  setMetricGauge(METRIC_PID_D, pidTerms.derivative);
+  setMetricGauge(METRIC_PID_OUTPUT, pidTerms.output);
+}
+
+// Complete this tick's trace event from the control outcome and record it
+void traceControlTick(bool relayWasOn) {
+  traceTick.temp = thermocoupleError ? TRACE_NO_VALUE : traceTenths(currentTemp);
+  traceTick.p = traceTenths(getMetricGauge(METRIC_PID_P));
+  traceTick.i = traceTenths(getMetricGauge(METRIC_PID_I));
+  traceTick.d = traceTenths(getMetricGauge(METRIC_PID_D));
+
+  if (traceTick.flags & (TRACE_FLAG_MODE_PID | TRACE_FLAG_MODE_PWM)) {
+    traceTick.duty = (uint8_t)min(100UL, pwmOnTimeMs * 100UL / max(pwmPeriodMs, 1UL));
   } else {
-    // Simple On/Off control
-    if (currentTemp < currentTargetTemp) {
-      if (!furnaceStatus) {
-        furnaceStatus = true;
-        digitalWrite(RELAY_PIN, HIGH);
-      }
-    } else if (currentTemp > currentTargetTemp) {
-      if (furnaceStatus) {
-        furnaceStatus = false;
-        digitalWrite(RELAY_PIN, LOW);
-      }
-    }
+    traceTick.duty = furnaceStatus ? 100 : 0;
   }
+
+  if (furnaceStatus) traceTick.flags |= TRACE_FLAG_RELAY_ON;
+  if (furnaceStatus != relayWasOn) traceTick.flags |= TRACE_FLAG_RELAY_EDGE;
+  if (systemEnabled) traceTick.flags |= TRACE_FLAG_ENABLED;
+  if (thermocoupleError) traceTick.flags |= TRACE_FLAG_SENSOR_ERROR;
+
+  recordTrace(traceTick);
 }
 
 void readTemperature() {
@@ -858,8 +856,14 @@ void readTemperature() {
   currentTemp = offset + amplitude * sin(phase);
   failedTempReadings = 0;
   thermocoupleError = false;
+  traceTick.rawTemp = traceTenths(currentTemp);
+#else
+  unsigned long readStarted = micros();
+#ifdef SIMULATED_FURNACE
+  double tempC = readSimulatedThermocouple();
 #else
   double tempC = thermocouple.readCelsius();
+#endif
 
   // Check for various error conditions
   bool hasError = false;
@@ -881,7 +885,11 @@ void readTemperature() {
   }
   
   // Use MAX31855 built-in error detection
+#ifdef SIMULATED_FURNACE
+  uint8_t fault = 0;
+#else
   uint8_t fault = thermocouple.readError();
+#endif
   if (fault != 0) {
     hasError = true;
     // Log specific fault type for debugging
@@ -895,8 +903,13 @@ void readTemperature() {
       Serial.println("Thermocouple fault: Short to VCC");
     }
   }
+  observeMetric(METRIC_THERMOCOUPLE_READ, micros() - readStarted);
+  countMetric(METRIC_THERMOCOUPLE_READS);
+  traceTick.rawTemp = traceTenths(tempC);
   
   if (hasError) {
+    countMetric(METRIC_THERMOCOUPLE_FAULTS);
+    traceTick.flags |= TRACE_FLAG_READ_FAULT;
     failedTempReadings++;
 
     if (failedTempReadings >= MAX_FAILED_READINGS) {
@@ -911,6 +924,12 @@ void readTemperature() {
 #endif
 }
 
+static void countLogWrite(size_t bytes, unsigned long startedMicros) {
+  observeMetric(METRIC_LOG_WRITE, micros() - startedMicros);
+  countMetric(METRIC_LOG_WRITES);
+  countMetric(METRIC_LOG_BYTES, bytes);
+}
+
 void logTemperature() {
   if (thermocoupleError) {
     return;
@@ -920,7 +939,9 @@ void logTemperature() {
   String timestamp = getFullTimestamp();
   String logLine = timestamp + "," + String(currentTemp, 1) + "," + 
                    String(targetTemp[currentIndex], 1) + "," +
-                   (furnaceStatus ? "ON" : "OFF") + "\n";
+                   (furnaceStatus ? "ON" : "OFF") + "," +
+                   String(energyKWh(getEnergySnapshot().firing) * 1000.0f, 0) + "\n";
+  unsigned long writeStarted = micros();
   
   if (SPIFFS.exists(TEMP_LOG_FILE)) {
     File checkFile = SPIFFS.open(TEMP_LOG_FILE, FILE_READ);
@@ -931,11 +952,13 @@ void logTemperature() {
       
       File newFile = SPIFFS.open(TEMP_LOG_FILE, FILE_WRITE);
       if (newFile) {
-        newFile.println("Timestamp,Temperature,Target,FurnaceStatus");
+        newFile.println(TEMP_LOG_HEADER);
         newFile.print(logLine);
         newFile.close();
+        countLogWrite(logLine.length(), writeStarted);
         return;
       } else {
+        countMetric(METRIC_LOG_ERRORS);
         return;
       }
     } else if (checkFile) {
@@ -947,18 +970,21 @@ void logTemperature() {
   if (!file) {
     file = SPIFFS.open(TEMP_LOG_FILE, FILE_WRITE);
     if (file) {
-      file.println("Timestamp,Temperature,Target,FurnaceStatus");
+      file.println(TEMP_LOG_HEADER);
     } else {
+      countMetric(METRIC_LOG_ERRORS);
       return;
     }
   }
   
   file.print(logLine);
   file.close();
+  countLogWrite(logLine.length(), writeStarted);
 }
 
 void saveProgram(int programIndex, String programName) {
   if (programIndex < 0 || programIndex >= MAX_PROGRAMS) return;
+  ProgramStoreLock lock;
 
   String previousProgramName = programNames[programIndex];
   bool isNewProgram = (previousProgramName.length() == 0);
@@ -980,7 +1006,7 @@ void saveProgram(int programIndex, String programName) {
     }
   } else {
     for (int i = 0; i < maxTempPoints; i++) {
-      programTemps[programIndex][i] = targetTemp[i];
+      programTemps[programIndex][i] = quantizeProgramTemp(targetTemp[i]);
     }
   }
   
@@ -988,59 +1014,341 @@ void saveProgram(int programIndex, String programName) {
     programTemps[programIndex][maxTempPoints - 1] = 0.0;
   }
 
-  saveAllPrograms();
+  saveProgramToSPIFFS(programIndex);
+}
+
+// ====================================================================
+// PROGRAM STORAGE
+// ====================================================================
+// Each program lives in its own program_codec.h blob (/prog/<slot>.bin) and
+// the names of all slots in a manifest (/prog/index.bin), so saving one
+// program rewrites one small file. Files are written to <name>.tmp and
+// renamed over the old one; a write cut short by a power loss leaves either
+// the old file or a complete .tmp that is picked up on the next boot.
+// Only the names are read at boot - program temperatures are loaded the
+// first time they are needed (ensureProgramLoaded). Recovery runs only at
+// boot, so a .tmp still being written is never taken for an interrupted
+// one. Loading and saving hold programStoreMutex.
+
+static SemaphoreHandle_t programStoreMutex = NULL;
+
+// Created by the first caller, which is setup() loading the programs
+void lockProgramStore() {
+  if (programStoreMutex == NULL) programStoreMutex = xSemaphoreCreateRecursiveMutex();
+  xSemaphoreTakeRecursive(programStoreMutex, portMAX_DELAY);
+}
+
+void unlockProgramStore() {
+  xSemaphoreGiveRecursive(programStoreMutex);
+}
+
+String programFilePath(int programIndex) {
+  return String(PROGRAM_DIR "/") + String(programIndex) + ".bin";
+}
+
+// Read a whole file and check that it is a valid program blob.
+// Returns a malloc'd buffer the caller frees, or NULL.
+uint8_t* readProgramBlob(const String& path, size_t& length) {
+  length = 0;
+  File file = SPIFFS.open(path, FILE_READ);
+  if (!file || file.isDirectory()) return NULL;
+
+  size_t size = file.size();
+  uint8_t* blob = (uint8_t*)malloc(size > 0 ? size : 1);
+  if (blob == NULL) {
+    file.close();
+    return NULL;
+  }
+  size_t readLength = file.read(blob, size);
+  file.close();
+
+  ProgramBlobReader reader(blob, readLength);
+  if (readLength != size || !reader.isValid()) {
+    free(blob);
+    return NULL;
+  }
+  length = readLength;
+  return blob;
+}
+
+// Finish a write-rename that was interrupted: a complete .tmp wins over the
+// old file, an incomplete one is discarded
+void recoverProgramFile(const String& path) {
+  String tmpPath = path + ".tmp";
+  if (!SPIFFS.exists(tmpPath)) return;
+
+  size_t length;
+  uint8_t* blob = readProgramBlob(tmpPath, length);
+  if (blob != NULL) {
+    free(blob);
+    if (SPIFFS.exists(path)) SPIFFS.remove(path);
+    SPIFFS.rename(tmpPath, path);
+    Serial.println("Programs: Recovered " + path + " from interrupted save");
+  } else {
+    SPIFFS.remove(tmpPath);
+    Serial.println("Programs: Discarded incomplete " + tmpPath);
+  }
+}
+
+bool writeProgramFileAtomic(const String& path, const uint8_t* data, size_t length) {
+  String tmpPath = path + ".tmp";
+  File file = SPIFFS.open(tmpPath, FILE_WRITE);
+  if (!file) return false;
+  size_t written = file.write(data, length);
+  file.close();
+  if (written != length) {
+    SPIFFS.remove(tmpPath);
+    return false;
+  }
+
+  // SPIFFS rename does not replace an existing file
+  if (SPIFFS.exists(path)) SPIFFS.remove(path);
+  return SPIFFS.rename(tmpPath, path);
+}
+
+void saveProgramManifest() {
+  ProgramStoreLock lock;
+  size_t capacity = PROGRAM_CODEC_HEADER_SIZE + PROGRAM_CODEC_CRC_SIZE + MAX_PROGRAMS * PROGRAM_CODEC_RECORD_MAX_SIZE(0);
+  uint8_t* buffer = (uint8_t*)malloc(capacity);
+  if (buffer == NULL) {
+    Serial.println("ERROR: Failed to allocate program manifest buffer");
+    return;
+  }
+
+  ProgramBlobWriter writer(buffer, capacity);
+  for (int i = 0; i < MAX_PROGRAMS; i++) {
+    if (programNames[i].length() > 0) {
+      writer.add(i, programNames[i].c_str(), NULL, 0);
+    }
+  }
+  size_t length = writer.finish();
+  if (length > 0 && writeProgramFileAtomic(PROGRAM_MANIFEST_FILE, buffer, length)) {
+    for (int i = 0; i < MAX_PROGRAMS; i++) manifestNames[i] = programNames[i];
+  } else {
+    Serial.println("ERROR: Failed to write " PROGRAM_MANIFEST_FILE);
+  }
+  free(buffer);
+}
+
+// Persist one program slot (an empty name deletes it)
+void saveProgramToSPIFFS(int programIndex) {
+  if (programIndex < 0 || programIndex >= MAX_PROGRAMS) return;
+  ProgramStoreLock lock;
+  String path = programFilePath(programIndex);
+
+  if (programNames[programIndex].length() == 0) {
+    if (SPIFFS.exists(path)) SPIFFS.remove(path);
+  } else {
+    size_t capacity = PROGRAM_CODEC_HEADER_SIZE + PROGRAM_CODEC_CRC_SIZE + PROGRAM_CODEC_RECORD_MAX_SIZE(maxTempPoints);
+    uint8_t* buffer = (uint8_t*)malloc(capacity);
+    if (buffer == NULL) {
+      Serial.println("ERROR: Failed to allocate program encode buffer");
+      return;
+    }
+    ProgramBlobWriter writer(buffer, capacity);
+    writer.add(programIndex, programNames[programIndex].c_str(), programTemps[programIndex], maxTempPoints);
+    size_t length = writer.finish();
+    if (length == 0 || !writeProgramFileAtomic(path, buffer, length)) {
+      Serial.println("ERROR: Failed to save " + path);
+    }
+    free(buffer);
+  }
+  programLoaded[programIndex] = true;
+  bumpApiGeneration(API_RESOURCE_PROGRAMS);
+
+  if (manifestNames[programIndex] != programNames[programIndex]) {
+    saveProgramManifest();
+  }
 }
 
 void saveAllPrograms() {
-  DynamicJsonDocument doc(8192);
-  JsonArray programs = doc.createNestedArray("programs");
+  ProgramStoreLock lock;
+  for (int i = 0; i < MAX_PROGRAMS; i++) {
+    // Programs never loaded are unchanged on flash
+    if (programLoaded[i] || programNames[i].length() == 0) {
+      saveProgramToSPIFFS(i);
+    }
+  }
+  saveProgramManifest();
+}
+
+// Load a program's temperatures from flash the first time they are needed.
+// A missing or corrupt file only affects this program, which reads as empty.
+// The flag is set only once the temperatures are in place, so a caller
+// that sees it set never reads a half-loaded program.
+void ensureProgramLoaded(int programIndex) {
+  if (programIndex < 0 || programIndex >= MAX_PROGRAMS) return;
+  ProgramStoreLock lock;
+  if (programLoaded[programIndex]) return;
+  if (programTemps == NULL || programTemps[programIndex] == NULL) return;
 
+  for (int i = 0; i < maxTempPoints; i++) {
+    programTemps[programIndex][i] = 0.0;
+  }
+  if (programNames[programIndex].length() > 0) {
+    String path = programFilePath(programIndex);
+    size_t length;
+    uint8_t* blob = readProgramBlob(path, length);
+    ProgramRecord record;
+    ProgramBlobReader reader(blob, length);
+    if (blob == NULL || !reader.next(record, programTemps[programIndex], maxTempPoints)) {
+      Serial.println("ERROR: " + path + " is missing or corrupt, program '" + programNames[programIndex] + "' is empty");
+    }
+    free(blob);
+  }
+  programLoaded[programIndex] = true;
+}
+
+// Encode every non-empty program slot into a binary blob (program_codec.h).
+// Returns a malloc'd buffer the caller frees, or NULL.
+uint8_t* encodeAllPrograms(size_t& length) {
+  length = 0;
+  size_t capacity = PROGRAM_CODEC_HEADER_SIZE + PROGRAM_CODEC_CRC_SIZE +
+                    MAX_PROGRAMS * PROGRAM_CODEC_RECORD_MAX_SIZE(maxTempPoints);
+  uint8_t* buffer = (uint8_t*)malloc(capacity);
+  if (buffer == NULL) {
+    Serial.println("ERROR: Failed to allocate program encode buffer");
+    return NULL;
+  }
+
+  ProgramStoreLock lock;
+  ProgramBlobWriter writer(buffer, capacity);
   for (int i = 0; i < MAX_PROGRAMS; i++) {
     if (programNames[i].length() > 0) {
-      JsonObject program = programs.createNestedObject();
-      program["name"] = programNames[i];
-      program["index"] = i;
-      JsonArray temps = program.createNestedArray("temps");
-      for (int j = 0; j < maxTempPoints; j++) {
-        temps.add(programTemps[i][j]);
+      ensureProgramLoaded(i);
+      writer.add(i, programNames[i].c_str(), programTemps[i], maxTempPoints);
+    }
+  }
+
+  length = writer.finish();
+  if (length == 0) {
+    free(buffer);
+    return NULL;
+  }
+  return buffer;
+}
+
+// Read program names from the manifest. Slots holding a program file that
+// the manifest doesn't list (save interrupted before the manifest update,
+// or the manifest itself lost) are picked up from the file itself. Runs at
+// boot, so this is where interrupted writes are finished.
+// Returns false if there is no per-program store yet.
+bool loadProgramManifest() {
+  recoverProgramFile(PROGRAM_MANIFEST_FILE);
+  size_t length;
+  uint8_t* blob = readProgramBlob(PROGRAM_MANIFEST_FILE, length);
+  bool haveManifest = (blob != NULL);
+
+  ProgramBlobReader reader(blob, length);
+  ProgramRecord record;
+  while (reader.next(record, NULL, 0)) {
+    if (record.index < MAX_PROGRAMS) {
+      programNames[record.index] = record.name;
+    }
+  }
+  free(blob);
+
+  bool manifestChanged = false;
+  for (int i = 0; i < MAX_PROGRAMS; i++) {
+    manifestNames[i] = programNames[i];
+    String path = programFilePath(i);
+    recoverProgramFile(path);
+    if (programNames[i].length() == 0 && SPIFFS.exists(path)) {
+      uint8_t* orphan = readProgramBlob(path, length);
+      ProgramBlobReader orphanReader(orphan, length);
+      if (orphan != NULL && orphanReader.next(record, NULL, 0)) {
+        programNames[i] = record.name;
+        manifestChanged = true;
+        Serial.println("Programs: Restored '" + programNames[i] + "' missing from manifest");
       }
+      free(orphan);
     }
   }
+  if (!haveManifest && !manifestChanged) {
+    return false;
+  }
+  if (manifestChanged) {
+    saveProgramManifest();
+  }
+  return true;
+}
 
-  File file = SPIFFS.open("/programs.json", FILE_WRITE);
-  if (file) {
-    serializeJson(doc, file);
-    file.close();
+// Load every program from the single-file store of the previous firmware
+bool loadProgramsFromBinary() {
+  size_t length;
+  uint8_t* blob = readProgramBlob(PROGRAMS_BIN_FILE, length);
+  if (blob == NULL) {
+    Serial.println("ERROR: " PROGRAMS_BIN_FILE " is corrupt");
+    return false;
   }
+
+  ProgramBlobReader reader(blob, length);
+  ProgramRecord record;
+  float* scratch = (float*)malloc(maxTempPoints * sizeof(float));
+  while (scratch != NULL && reader.next(record, scratch, maxTempPoints)) {
+    if (record.index < MAX_PROGRAMS) {
+      programNames[record.index] = record.name;
+      memcpy(programTemps[record.index], scratch, maxTempPoints * sizeof(float));
+    }
+  }
+  free(scratch);
+  free(blob);
+  return true;
 }
 
 void loadProgram(int programIndex) {
   if (programIndex < 0 || programIndex >= MAX_PROGRAMS) return;
   if (programNames[programIndex].length() == 0) return;
 
+  {
+    ProgramStoreLock lock;
+    ensureProgramLoaded(programIndex);
+    for (int i = 0; i < maxTempPoints; i++) targetTemp[i] = programTemps[programIndex][i];
+  }
   activeProgram = programIndex;
-  for (int i = 0; i < maxTempPoints; i++) targetTemp[i] = programTemps[programIndex][i];
+  bumpApiGeneration(API_RESOURCE_STATUS);
   
   // Force TFT UI refresh when program is loaded
   onTFTProgramChange(programIndex);
 }
 
 void loadProgramsFromSPIFFS() {
-  if (SPIFFS.exists("/programs.json")) {
-    File file = SPIFFS.open("/programs.json", FILE_READ);
+  ProgramStoreLock lock;
+  for (int i = 0; i < MAX_PROGRAMS; i++) {
+    programNames[i] = "";
+    manifestNames[i] = "";
+    programLoaded[i] = false;
+  }
+
+  if (loadProgramManifest()) {
+    return;
+  }
+
+  // Everything below migrates an older store: all programs are loaded into
+  // memory and written out as per-program files
+  for (int i = 0; i < MAX_PROGRAMS; i++) {
+    programLoaded[i] = true;
+    for (int j = 0; j < maxTempPoints; j++) {
+      programTemps[i][j] = 0.0;
+    }
+  }
+
+  if (SPIFFS.exists(PROGRAMS_BIN_FILE) && loadProgramsFromBinary()) {
+    saveAllPrograms();
+    SPIFFS.remove(PROGRAMS_BIN_FILE);
+    Serial.println("Programs migrated from " PROGRAMS_BIN_FILE " to " PROGRAM_DIR);
+    return;
+  }
+
+  if (SPIFFS.exists(PROGRAMS_FILE)) {
+    // Legacy JSON store - loaded once and rewritten in the binary format
+    File file = SPIFFS.open(PROGRAMS_FILE, FILE_READ);
     if (file) {
       DynamicJsonDocument doc(8192);
       DeserializationError error = deserializeJson(doc, file);
       file.close();
 
       if (!error) {
-        for (int i = 0; i < MAX_PROGRAMS; i++) {
-          programNames[i] = "";
-          for (int j = 0; j < maxTempPoints; j++) {
-            programTemps[i][j] = 0.0;
-          }
-        }
-        
         JsonArray programs = doc["programs"].as<JsonArray>();
         for (JsonObject program : programs) {
           int index = program["index"];
@@ -1050,7 +1358,7 @@ void loadProgramsFromSPIFFS() {
             
             int numPoints = min((int)temps.size(), maxTempPoints);
             for (int i = 0; i < numPoints; i++) {
-              programTemps[index][i] = temps[i].as<float>();
+              programTemps[index][i] = quantizeProgramTemp(temps[i].as<float>());
             }
             
             for (int i = numPoints; i < maxTempPoints; i++) {
@@ -1058,6 +1366,8 @@ void loadProgramsFromSPIFFS() {
             }
           }
         }
+        saveAllPrograms();
+        Serial.println("Programs migrated from " PROGRAMS_FILE " to " PROGRAM_DIR);
       }
     }
   } else {
@@ -1122,55 +1432,11 @@ bool deleteRecursive(const String& path) {
   }
 }
 
-float calculatePIDOutput(float setpoint, float input, unsigned long currentTime) {
-  if (!pidEnabled) return 0.0;
-  
-  // Check if enough time has passed since last calculation
-  if (currentTime - pidLastTime < (unsigned long)(pidSampleTime * 1000)) {
-    return 0.0; // Return previous output if not time for new calculation
-  }
-  
-  float error = setpoint - input;
-  float deltaTime = (currentTime - pidLastTime) / 1000.0; // Convert to seconds
-  
-  // Proportional term
-  float proportional = pidKp * error;
-  
-  // Integral term
-  pidIntegral += pidKi * error * deltaTime;
-  
-  // Derivative term
-  float derivative = pidKd * (error - pidLastError) / deltaTime;
-  
-  // Calculate output
-  float output = proportional + pidIntegral + derivative;
-  
-  // Clamp output to min/max range
-  output = constrain(output, pidOutputMin, pidOutputMax);
-  
-  // Anti-windup: if output is saturated, don't accumulate integral
-  if (output >= pidOutputMax || output <= pidOutputMin) {
-    pidIntegral -= pidKi * error * deltaTime;
-  }
-  
-  // Update for next iteration
-  pidLastError = error;
-  pidLastTime = currentTime;
-  
-  return output;
-}
-
-void resetPID() {
-  pidIntegral = 0.0;
-  pidLastError = 0.0;
-  pidLastTime = 0;
-}
-
 void checkLogFiles() {
   if (!SPIFFS.exists(TEMP_LOG_FILE)) {
     File tempLog = SPIFFS.open(TEMP_LOG_FILE, FILE_WRITE);
     if (tempLog) {
-      tempLog.println("Timestamp,Temperature,Target,FurnaceStatus");
+      tempLog.println(TEMP_LOG_HEADER);
       tempLog.close();
     }
   }
@@ -1231,6 +1497,7 @@ void processPendingThemeSave() {
   if (configFile) {
     serializeJson(configDoc, configFile);
     configFile.close();
+    bumpApiGeneration(API_RESOURCE_THEME);
     Serial.println("Theme settings saved successfully");
   } else {
     Serial.println("Error: Failed to save theme settings");
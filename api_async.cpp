@@ -0,0 +1,154 @@
+#include "api_router.h"
+#include "json_arena.h"
+#include <ESPAsyncWebServer.h>
+
+// =================================================================
+//                  ESPASYNCWEBSERVER ADAPTERS
+// =================================================================
+// The API layer works on ApiRequest (api_request.h). On the controller a
+// request is a wrapper around the server's AsyncWebServerRequest, made on
+// the stack for each callback; the wrapper's id() is the server's request,
+// so arenas and body buffers follow the request across callbacks.
+
+static_assert(API_METHOD_GET == HTTP_GET && API_METHOD_POST == HTTP_POST &&
+              API_METHOD_DELETE == HTTP_DELETE && API_METHOD_PUT == HTTP_PUT &&
+              API_METHOD_PATCH == HTTP_PATCH && API_METHOD_HEAD == HTTP_HEAD &&
+              API_METHOD_OPTIONS == HTTP_OPTIONS && API_METHOD_ANY == HTTP_ANY,
+              "ApiMethod bits must match WebRequestMethod");
+
+#define ASYNC_API_MAX_HEADERS 4
+
+class AsyncApiRequest : public ApiRequest {
+public:
+    explicit AsyncApiRequest(AsyncWebServerRequest *request) : request(request), headerCount(0) {}
+
+    AsyncWebServerRequest* getRequest() const { return request; }
+
+    const void* id() const override { return request; }
+    const String& url() const override { return request->url(); }
+    ApiMethod method() const override { return request->method(); }
+
+    void addHeader(const char* name, const String& value) override {
+        if (headerCount < ASYNC_API_MAX_HEADERS) {
+            headerNames[headerCount] = name;
+            headerValues[headerCount] = value;
+            headerCount++;
+        }
+    }
+
+    void send(int code, const char* contentType, const String& body) override {
+        sendResponse(request->beginResponse(code, contentType, body));
+    }
+
+    void sendNoCopy(int code, const char* contentType, const uint8_t* body, size_t length) override {
+        sendResponse(request->beginResponse_P(code, contentType, body, length));
+    }
+
+    void onDisconnect(std::function<void()> fn) override { request->onDisconnect(fn); }
+
+    void* getTempObject() const override { return request->_tempObject; }
+    void setTempObject(void* block) override { request->_tempObject = block; }
+
+private:
+    AsyncWebServerRequest* request;
+    const char* headerNames[ASYNC_API_MAX_HEADERS];
+    String headerValues[ASYNC_API_MAX_HEADERS];
+    int headerCount;
+
+    void sendResponse(AsyncWebServerResponse *response) {
+        for (int i = 0; i < headerCount; i++) {
+            response->addHeader(headerNames[i], headerValues[i]);
+        }
+        headerCount = 0;
+        request->send(response);
+    }
+};
+
+// Handlers registered through the adapters below only ever see requests
+// dispatched from begin(), so the ApiRequest is always an AsyncApiRequest
+static AsyncWebServerRequest* asyncRequest(ApiRequest& request) {
+  return static_cast<AsyncApiRequest&>(request).getRequest();
+}
+
+// ====================================================================
+// ROUTER
+// ====================================================================
+
+bool ApiRouter::on(const char* path, ApiMethod method, ArRequestHandlerFunction onRequest,
+                   ArUploadHandlerFunction onUpload, ArBodyHandlerFunction onBody) {
+  ApiRequestHandler requestHandler = nullptr;
+  ApiUploadHandler uploadHandler = nullptr;
+  ApiBodyHandler bodyHandler = nullptr;
+  if (onRequest) {
+    requestHandler = [onRequest](ApiRequest& request) { onRequest(asyncRequest(request)); };
+  }
+  if (onUpload) {
+    uploadHandler = [onUpload](ApiRequest& request, const String& filename, size_t index, uint8_t *data, size_t len, bool final) {
+      onUpload(asyncRequest(request), filename, index, data, len, final);
+    };
+  }
+  if (onBody) {
+    bodyHandler = [onBody](ApiRequest& request, uint8_t *data, size_t len, size_t index, size_t total) {
+      onBody(asyncRequest(request), data, len, index, total);
+    };
+  }
+  return on(path, method, requestHandler, uploadHandler, bodyHandler);
+}
+
+void ApiRouter::begin(AsyncWebServer& server) {
+  // "/api" matches the path itself and everything below "/api/"
+  server.on("/api", HTTP_ANY,
+    [this](AsyncWebServerRequest *request) {
+      AsyncApiRequest apiRequest(request);
+      handleRequest(apiRequest);
+    },
+    [this](AsyncWebServerRequest *request, const String& filename, size_t index, uint8_t *data, size_t len, bool final) {
+      AsyncApiRequest apiRequest(request);
+      handleUpload(apiRequest, filename, index, data, len, final);
+    },
+    [this](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+      AsyncApiRequest apiRequest(request);
+      handleBody(apiRequest, data, len, index, total);
+    });
+
+  Serial.print("API: Dispatch table ready with ");
+  Serial.print(routeCount);
+  Serial.println(" routes");
+}
+
+// ====================================================================
+// JSON ARENAS AND BODIES
+// ====================================================================
+
+JsonArena* jsonArenaFor(AsyncWebServerRequest *request) {
+  AsyncApiRequest apiRequest(request);
+  return jsonArenaFor(apiRequest);
+}
+
+AsyncWebServerResponse* beginJsonResponse(AsyncWebServerRequest *request, int code, const JsonDocument& doc) {
+  AsyncApiRequest apiRequest(request);
+  size_t length;
+  const char* buffer = serializeJsonToArena(apiRequest, doc, length);
+  if (buffer) {
+    return request->beginResponse_P(code, "application/json", (const uint8_t*)buffer, length);
+  }
+
+  // No arena room: the response owns a heap copy as before
+  String json;
+  serializeJson(doc, json);
+  return request->beginResponse(code, "application/json", json);
+}
+
+void sendJson(AsyncWebServerRequest *request, int code, const JsonDocument& doc) {
+  request->send(beginJsonResponse(request, code, doc));
+}
+
+ArBodyHandlerFunction collectBody(size_t maxSize, ArBodyHandlerFunction handler) {
+  ApiBodyHandler collected = collectBody(maxSize, [handler](ApiRequest& request, uint8_t *data, size_t len, size_t index, size_t total) {
+    handler(asyncRequest(request), data, len, index, total);
+  });
+  return [collected](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+    AsyncApiRequest apiRequest(request);
+    collected(apiRequest, data, len, index, total);
+  };
+}
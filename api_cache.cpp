@@ -0,0 +1,157 @@
+#include "api_cache.h"
+#include "json_arena.h"
+#include <ESPAsyncWebServer.h>
+#include <WiFi.h>
+#include <atomic>
+
+extern float currentTemp;
+extern bool furnaceStatus;
+extern bool systemEnabled;
+extern bool thermocoupleError;
+extern int activeProgram;
+extern bool timeIsSynchronized;
+extern float getSmoothedTargetTemperature();
+extern int getCurrentTempIndex();
+
+#define API_STATUS_MAX_AGE_MS 60000       // Refresh the clock and uptime at least this often
+
+struct CachedBody {
+  String etag;
+  char* body;
+  size_t length;
+  size_t capacity;
+};
+
+// Bumped from the async_tcp task and from loop()
+static std::atomic<uint32_t> generations[API_RESOURCE_COUNT];
+static CachedBody cachedBodies[API_RESOURCE_COUNT];
+static std::atomic<bool> generationsSeeded(false);
+
+// loop() only
+static uint32_t lastStatusSignature = 0;
+static uint32_t lastStatusBumpMillis = 0;
+
+static const char* const resourcePrefixes[API_RESOURCE_COUNT] = { "st", "pg", "th" };
+
+// Start from a random generation so ETags from before a reboot never match.
+// Added rather than stored, so a bump racing the seed is kept.
+static void seedGenerations() {
+  if (generationsSeeded.load(std::memory_order_acquire)) return;
+  if (generationsSeeded.exchange(true)) return;
+  for (int i = 0; i < API_RESOURCE_COUNT; i++) {
+    generations[i].fetch_add(esp_random());
+  }
+}
+
+void bumpApiGeneration(ApiResource resource) {
+  seedGenerations();
+  generations[resource].fetch_add(1);
+}
+
+void bumpAllApiGenerations() {
+  for (int i = 0; i < API_RESOURCE_COUNT; i++) {
+    bumpApiGeneration((ApiResource)i);
+  }
+}
+
+// The published values, at the resolution the pages show them
+static uint32_t hashStatusField(uint32_t hash, int32_t value) {
+  return (hash ^ (uint32_t)value) * 16777619u;
+}
+
+void updateApiStatusGeneration() {
+  uint32_t now = millis();
+  uint32_t signature = 2166136261u;
+  signature = hashStatusField(signature, lroundf(currentTemp * 10));
+  signature = hashStatusField(signature, lroundf(getSmoothedTargetTemperature() * 10));
+  signature = hashStatusField(signature, getCurrentTempIndex());
+  signature = hashStatusField(signature, activeProgram);
+  signature = hashStatusField(signature, (furnaceStatus ? 1 : 0) | (systemEnabled ? 2 : 0) |
+                                         (thermocoupleError ? 4 : 0) | (timeIsSynchronized ? 8 : 0) |
+                                         (WiFi.status() == WL_CONNECTED ? 16 : 0));
+
+  if (signature != lastStatusSignature || now - lastStatusBumpMillis >= API_STATUS_MAX_AGE_MS) {
+    lastStatusSignature = signature;
+    lastStatusBumpMillis = now;
+    bumpApiGeneration(API_RESOURCE_STATUS);
+  }
+}
+
+String apiResourceEtag(ApiResource resource, const char* variant) {
+  seedGenerations();
+  char etag[48];
+  snprintf(etag, sizeof(etag), "\"%s-%08x%s%s\"", resourcePrefixes[resource],
+           (unsigned)generations[resource].load(), variant ? "-" : "", variant ? variant : "");
+  return String(etag);
+}
+
+static void addCacheHeaders(AsyncWebServerResponse *response, const String& etag) {
+  response->addHeader("ETag", etag);
+  response->addHeader("Cache-Control", "no-cache");
+}
+
+bool sendIfNotModified(AsyncWebServerRequest *request, const String& etag) {
+  if (!request->hasHeader("If-None-Match")) return false;
+  const String& ifNoneMatch = request->getHeader("If-None-Match")->value();
+  if (ifNoneMatch.indexOf(etag) < 0 && ifNoneMatch != "*") return false;
+
+  AsyncWebServerResponse *response = request->beginResponse(304);
+  addCacheHeaders(response, etag);
+  request->send(response);
+  return true;
+}
+
+// The cached body can be replaced while a response is still being sent,
+// so each response gets its own copy in the request's arena
+static AsyncWebServerResponse* beginCopiedResponse(AsyncWebServerRequest *request, const char* body, size_t length) {
+  JsonArena* arena = jsonArenaFor(request);
+  char* copy = (char*)arena->allocate(length);
+  if (copy && arena->owns(copy)) {
+    memcpy(copy, body, length);
+    return request->beginResponse_P(200, "application/json", (const uint8_t*)copy, length);
+  }
+  arena->deallocate(copy);
+
+  String json;
+  json.reserve(length);
+  json.concat(body, length);
+  return request->beginResponse(200, "application/json", json);
+}
+
+bool serveFromApiCache(AsyncWebServerRequest *request, ApiResource resource, const String& etag) {
+  if (sendIfNotModified(request, etag)) return true;
+
+  CachedBody& cached = cachedBodies[resource];
+  if (!cached.body || cached.etag != etag) return false;
+
+  AsyncWebServerResponse *response = beginCopiedResponse(request, cached.body, cached.length);
+  addCacheHeaders(response, etag);
+  request->send(response);
+  return true;
+}
+
+void sendAndCacheJson(AsyncWebServerRequest *request, ApiResource resource, const String& etag, const JsonDocument& doc) {
+  CachedBody& cached = cachedBodies[resource];
+  size_t length = measureJson(doc);
+
+  // Keep the largest buffer seen so a resource settles on one allocation
+  if (length + 1 > cached.capacity) {
+    char* grown = (char*)realloc(cached.body, length + 1);
+    if (!grown) {
+      AsyncWebServerResponse *response = beginJsonResponse(request, 200, doc);
+      addCacheHeaders(response, etag);
+      request->send(response);
+      return;
+    }
+    cached.body = grown;
+    cached.capacity = length + 1;
+  }
+
+  serializeJson(doc, cached.body, length + 1);
+  cached.length = length;
+  cached.etag = etag;
+
+  AsyncWebServerResponse *response = beginCopiedResponse(request, cached.body, cached.length);
+  addCacheHeaders(response, etag);
+  request->send(response);
+}
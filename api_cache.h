@@ -0,0 +1,51 @@
+#ifndef API_CACHE_H
+#define API_CACHE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+class AsyncWebServerRequest;
+
+// =================================================================
+//                  CONDITIONAL GET FOR POLLED RESOURCES
+// =================================================================
+// The pages and the service worker refetch /api/status, /api/programs and
+// /api/theme far more often than they change. Each resource has a
+// generation counter that is bumped whenever its data is mutated; the
+// ETag is derived from it, so a matching If-None-Match is answered with
+// 304 before any SPIFFS access or JSON is built, and the last 200 body is
+// kept in RAM and resent until the generation moves on.
+//
+// /api/status is not mutated through a setter: its generation is bumped
+// by updateApiStatusGeneration() when the temperatures or state it
+// publishes change, and at least once a minute so its clock and uptime
+// stay close. Polls in between are answered with 304.
+
+enum ApiResource {
+    API_RESOURCE_STATUS,
+    API_RESOURCE_PROGRAMS,
+    API_RESOURCE_THEME,
+    API_RESOURCE_COUNT
+};
+
+// Mark a resource changed. Safe to call from any task.
+void bumpApiGeneration(ApiResource resource);
+void bumpAllApiGenerations();
+
+// Bump the status generation if what /api/status reports has changed
+// (call after each control tick)
+void updateApiStatusGeneration();
+
+// Quoted ETag for the resource as it is now. The variant tells apart
+// representations of the same resource (e.g. "bin" for binary programs).
+String apiResourceEtag(ApiResource resource, const char* variant = nullptr);
+
+// Answer with 304 when If-None-Match matches, or with the cached body when
+// it was built for this ETag. Returns true when the request was answered.
+bool serveFromApiCache(AsyncWebServerRequest *request, ApiResource resource, const String& etag);
+bool sendIfNotModified(AsyncWebServerRequest *request, const String& etag);
+
+// Send a freshly built 200 response and keep its body for later requests
+void sendAndCacheJson(AsyncWebServerRequest *request, ApiResource resource, const String& etag, const JsonDocument& doc);
+
+#endif // API_CACHE_H
@@ -0,0 +1,62 @@
+#ifndef API_REQUEST_H
+#define API_REQUEST_H
+
+#include <Arduino.h>
+#include <functional>
+
+// =================================================================
+//                  API REQUEST INTERFACE
+// =================================================================
+// What the API layer (api_router.h, json_arena.h) needs from an HTTP
+// request, so the router, the JSON arenas and body collection build
+// without ESPAsyncWebServer. On the controller api_async.cpp wraps the
+// server's requests; tools/api_host.cpp serves the same code from a plain
+// socket on a PC.
+
+// Request method bits. The values are ESPAsyncWebServer's, so HTTP_GET
+// and friends can be passed wherever an ApiMethod is taken.
+typedef uint8_t ApiMethod;
+
+#define API_METHOD_GET      0b00000001
+#define API_METHOD_POST     0b00000010
+#define API_METHOD_DELETE   0b00000100
+#define API_METHOD_PUT      0b00001000
+#define API_METHOD_PATCH    0b00010000
+#define API_METHOD_HEAD     0b00100000
+#define API_METHOD_OPTIONS  0b01000000
+#define API_METHOD_ANY      0b01111111
+
+class ApiRequest {
+public:
+    virtual ~ApiRequest() {}
+
+    // The same for every ApiRequest wrapping one HTTP request, so a
+    // request finds its arena again from a wrapper made later
+    virtual const void* id() const = 0;
+
+    virtual const String& url() const = 0;
+    virtual ApiMethod method() const = 0;
+
+    // Header for the response sent next
+    virtual void addHeader(const char* name, const String& value) = 0;
+
+    // Answer the request. send() copies the body; sendNoCopy() sends it
+    // from where it is, which must stay valid until the request is done
+    // with (memory from the request's arena)
+    virtual void send(int code, const char* contentType, const String& body) = 0;
+    virtual void sendNoCopy(int code, const char* contentType, const uint8_t* body, size_t length) = 0;
+
+    // Called once when the request is done with, answered or dropped.
+    // There is one callback per request and the JSON arena takes it.
+    virtual void onDisconnect(std::function<void()> fn) = 0;
+
+    // A malloc'd block freed with the request
+    virtual void* getTempObject() const = 0;
+    virtual void setTempObject(void* block) = 0;
+};
+
+typedef std::function<void(ApiRequest& request)> ApiRequestHandler;
+typedef std::function<void(ApiRequest& request, const String& filename, size_t index, uint8_t *data, size_t len, bool final)> ApiUploadHandler;
+typedef std::function<void(ApiRequest& request, uint8_t *data, size_t len, size_t index, size_t total)> ApiBodyHandler;
+
+#endif // API_REQUEST_H
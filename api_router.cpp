@@ -0,0 +1,202 @@
+#include "api_router.h"
+#include "json_arena.h"
+#include "api_cache.h"
+
+ApiRouter apiRouter;
+
+ApiRouter::ApiRouter() : routeCount(0), activeRoute(nullptr) {}
+
+// First index whose path is not less than the given one
+int ApiRouter::lowerBound(const char* path) const {
+  int low = 0;
+  int high = routeCount;
+  while (low < high) {
+    int mid = (low + high) / 2;
+    if (strcmp(routes[mid].path, path) < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+bool ApiRouter::on(const char* path, ApiMethod method, ApiRequestHandler onRequest,
+                   ApiUploadHandler onUpload, ApiBodyHandler onBody) {
+  if (strncmp(path, "/api/", 5) != 0) {
+    Serial.print("API: Route outside /api/ rejected: ");
+    Serial.println(path);
+    return false;
+  }
+
+  int pos = lowerBound(path);
+  for (int i = pos; i < routeCount && strcmp(routes[i].path, path) == 0; i++) {
+    if (routes[i].method & method) {
+      Serial.print("API: Duplicate route rejected: ");
+      Serial.print(methodName(method));
+      Serial.print(" ");
+      Serial.println(path);
+      return false;
+    }
+  }
+
+  if (routeCount >= MAX_API_ROUTES) {
+    Serial.print("API: Route table full (MAX_API_ROUTES), rejected: ");
+    Serial.println(path);
+    return false;
+  }
+
+  // Insert after any other methods of the same path to keep the table sorted
+  while (pos < routeCount && strcmp(routes[pos].path, path) == 0) pos++;
+  for (int i = routeCount; i > pos; i--) {
+    routes[i] = routes[i - 1];
+  }
+  routes[pos].path = path;
+  routes[pos].method = method;
+  routes[pos].onRequest = onRequest;
+  routes[pos].onUpload = onUpload;
+  routes[pos].onBody = onBody;
+  routes[pos].jsonCapacity = jsonArenaCapacityFor(path);
+  routes[pos].requests = 0;
+  routes[pos].arenaAllocs = 0;
+  routes[pos].heapAllocs = 0;
+  routes[pos].arenaPeak = 0;
+  routes[pos].handlerMicros = 0;
+  routes[pos].maxHandlerMicros = 0;
+  memset(routes[pos].latencyBuckets, 0, sizeof(routes[pos].latencyBuckets));
+  routeCount++;
+  return true;
+}
+
+const ApiRoute* ApiRouter::find(const String& path, ApiMethod method) const {
+  const char* p = path.c_str();
+  for (int i = lowerBound(p); i < routeCount && strcmp(routes[i].path, p) == 0; i++) {
+    if (routes[i].method & method) {
+      return &routes[i];
+    }
+  }
+  return nullptr;
+}
+
+ApiRoute* ApiRouter::findRoute(const String& path, ApiMethod method) {
+  return const_cast<ApiRoute*>(find(path, method));
+}
+
+void ApiRouter::recordTiming(ApiRoute* route, uint32_t elapsed) {
+  route->handlerMicros += elapsed;
+  if (elapsed > route->maxHandlerMicros) route->maxHandlerMicros = elapsed;
+
+  int bucket = 0;
+  while (bucket < API_LATENCY_BUCKETS - 1 && elapsed >= ((uint32_t)API_LATENCY_BUCKET_MICROS << bucket)) {
+    bucket++;
+  }
+  route->latencyBuckets[bucket]++;
+}
+
+uint32_t ApiRouter::getCallCount(const ApiRoute& route) {
+  uint32_t calls = 0;
+  for (int i = 0; i < API_LATENCY_BUCKETS; i++) calls += route.latencyBuckets[i];
+  return calls;
+}
+
+uint32_t ApiRouter::latencyPercentile(const ApiRoute& route, int percent) {
+  uint32_t calls = getCallCount(route);
+  if (calls == 0) return 0;
+
+  uint32_t wanted = (calls * percent + 99) / 100;
+  uint32_t seen = 0;
+  for (int i = 0; i < API_LATENCY_BUCKETS - 1; i++) {
+    seen += route.latencyBuckets[i];
+    if (seen >= wanted) return (uint32_t)API_LATENCY_BUCKET_MICROS << i;
+  }
+  return route.maxHandlerMicros;
+}
+
+void ApiRouter::handleRequest(ApiRequest& request) {
+  ApiRoute* route = findRoute(request.url(), request.method());
+  if (route) {
+    route->requests++;
+    activeRoute = route;
+    unsigned long start = micros();
+    if (route->onRequest) route->onRequest(request);
+    recordTiming(route, micros() - start);
+    activeRoute = nullptr;
+
+    // Any write through the API may change what /api/status reports
+    if (request.method() != API_METHOD_GET && request.method() != API_METHOD_HEAD) {
+      bumpApiGeneration(API_RESOURCE_STATUS);
+    }
+    return;
+  }
+
+  ArenaJsonDocument doc(request);
+  doc["error"] = "Not Found";
+  doc["path"] = request.url();
+  doc["method"] = methodName(request.method());
+  sendJson(request, 404, doc);
+}
+
+void ApiRouter::handleUpload(ApiRequest& request, const String& filename, size_t index, uint8_t *data, size_t len, bool final) {
+  ApiRoute* route = findRoute(request.url(), request.method());
+  if (route && route->onUpload) {
+    activeRoute = route;
+    unsigned long start = micros();
+    route->onUpload(request, filename, index, data, len, final);
+    recordTiming(route, micros() - start);
+    activeRoute = nullptr;
+  }
+}
+
+void ApiRouter::handleBody(ApiRequest& request, uint8_t *data, size_t len, size_t index, size_t total) {
+  ApiRoute* route = findRoute(request.url(), request.method());
+  if (route && route->onBody) {
+    activeRoute = route;
+    unsigned long start = micros();
+    route->onBody(request, data, len, index, total);
+    recordTiming(route, micros() - start);
+    activeRoute = nullptr;
+  }
+}
+
+const char* ApiRouter::methodName(ApiMethod method) {
+  switch (method) {
+    case API_METHOD_GET: return "GET";
+    case API_METHOD_POST: return "POST";
+    case API_METHOD_DELETE: return "DELETE";
+    case API_METHOD_PUT: return "PUT";
+    case API_METHOD_PATCH: return "PATCH";
+    case API_METHOD_HEAD: return "HEAD";
+    case API_METHOD_OPTIONS: return "OPTIONS";
+    default: return "ANY";
+  }
+}
+
+// ====================================================================
+// DEBUG ENDPOINT
+// ====================================================================
+
+void handleApiRoutesRequest(ApiRequest& request) {
+  ArenaJsonDocument doc(request);
+  doc["status"] = "success";
+  doc["count"] = apiRouter.getRouteCount();
+  JsonArray endpoints = doc.createNestedArray("endpoints");
+  for (int i = 0; i < apiRouter.getRouteCount(); i++) {
+    const ApiRoute& route = apiRouter.getRoute(i);
+    JsonObject endpoint = endpoints.createNestedObject();
+    endpoint["method"] = ApiRouter::methodName(route.method);
+    endpoint["path"] = route.path;
+    endpoint["requests"] = route.requests;
+
+    // Time inside the handler only; network time is measured by tools/api_loadgen.py
+    uint32_t calls = ApiRouter::getCallCount(route);
+    if (calls > 0) {
+      endpoint["calls"] = calls;
+      endpoint["avgMicros"] = (uint32_t)(route.handlerMicros / calls);
+      endpoint["p50Micros"] = ApiRouter::latencyPercentile(route, 50);
+      endpoint["p99Micros"] = ApiRouter::latencyPercentile(route, 99);
+      endpoint["maxMicros"] = route.maxHandlerMicros;
+    }
+  }
+
+  sendJson(request, 200, doc);
+}
@@ -0,0 +1,101 @@
+#ifndef API_ROUTER_H
+#define API_ROUTER_H
+
+#include <Arduino.h>
+#include "api_request.h"
+
+// Only the AsyncWebServer adapters below name these (api_async.cpp)
+class AsyncWebServer;
+class AsyncWebServerRequest;
+
+// Maximum number of /api/ routes in the dispatch table
+#define MAX_API_ROUTES 80
+
+// Handler time histogram: bucket i counts callbacks shorter than
+// API_LATENCY_BUCKET_MICROS << i, the last bucket everything slower
+#define API_LATENCY_BUCKETS 8
+#define API_LATENCY_BUCKET_MICROS 250
+
+struct ApiRoute {
+    const char* path;                      // Exact path, e.g. "/api/status"
+    ApiMethod method;                      // HTTP_GET, HTTP_POST, ...
+    ApiRequestHandler onRequest;
+    ApiUploadHandler onUpload;
+    ApiBodyHandler onBody;
+
+    // JSON arena sizing and usage (json_arena.h)
+    size_t jsonCapacity;                   // Arena bytes from the capacity table
+    uint32_t requests;                     // Requests dispatched to the route
+    uint32_t arenaAllocs;                  // Allocations served from an arena
+    uint32_t heapAllocs;                   // Allocations that fell back to the heap
+    size_t arenaPeak;                      // Most arena bytes one request used
+
+    // Time spent in the route's callbacks (request, upload and body chunks)
+    uint64_t handlerMicros;
+    uint32_t maxHandlerMicros;
+    uint32_t latencyBuckets[API_LATENCY_BUCKETS];
+};
+
+// Dispatch table for all /api/ endpoints.
+//
+// ESPAsyncWebServer tries every registered handler in order for each request,
+// so with one server.on() per endpoint a static file request had to fail 60+
+// matchers first. The router registers a single "/api" handler instead and
+// looks routes up with a binary search over a table kept sorted by path.
+// Duplicate path+method registrations are rejected when they are added.
+//
+// The table and the dispatch work on ApiRequest (api_request.h) and build
+// without the web server; begin() and the on() taking AsyncWebServer
+// handlers are the controller's adapters, defined in api_async.cpp.
+class ApiRouter {
+public:
+    ApiRouter();
+
+    // Same arguments as AsyncWebServer::on(). Call before begin().
+    bool on(const char* path, ApiMethod method, ApiRequestHandler onRequest,
+            ApiUploadHandler onUpload = nullptr, ApiBodyHandler onBody = nullptr);
+    bool on(const char* path, ApiMethod method, std::function<void(AsyncWebServerRequest*)> onRequest,
+            std::function<void(AsyncWebServerRequest*, const String&, size_t, uint8_t*, size_t, bool)> onUpload = nullptr,
+            std::function<void(AsyncWebServerRequest*, uint8_t*, size_t, size_t, size_t)> onBody = nullptr);
+
+    // Attach the single /api handler to the server
+    void begin(AsyncWebServer& server);
+
+    // Dispatch a request (or one upload or body chunk of it) on the table.
+    // Unknown routes get a JSON 404 from handleRequest().
+    void handleRequest(ApiRequest& request);
+    void handleUpload(ApiRequest& request, const String& filename, size_t index, uint8_t *data, size_t len, bool final);
+    void handleBody(ApiRequest& request, uint8_t *data, size_t len, size_t index, size_t total);
+
+    const ApiRoute* find(const String& path, ApiMethod method) const;
+
+    int getRouteCount() const { return routeCount; }
+    const ApiRoute& getRoute(int index) const { return routes[index]; }
+
+    // Route whose handler is running, nullptr outside a dispatch
+    ApiRoute* getActiveRoute() const { return activeRoute; }
+
+    static const char* methodName(ApiMethod method);
+
+    // Handler callbacks timed for a route, and the time below which the
+    // given percentage of them finished (bucket upper bound, or the
+    // slowest callback for the open-ended last bucket)
+    static uint32_t getCallCount(const ApiRoute& route);
+    static uint32_t latencyPercentile(const ApiRoute& route, int percent);
+
+private:
+    ApiRoute routes[MAX_API_ROUTES];
+    int routeCount;
+    ApiRoute* activeRoute;
+
+    int lowerBound(const char* path) const;
+    ApiRoute* findRoute(const String& path, ApiMethod method);
+    void recordTiming(ApiRoute* route, uint32_t elapsed);
+};
+
+extern ApiRouter apiRouter;
+
+// GET /api/debug/routes: the dispatch table with per-route handler timing
+void handleApiRoutesRequest(ApiRequest& request);
+
+#endif // API_ROUTER_H
@@ -0,0 +1,164 @@
+#include "benchmark_engine.h"
+#include <math.h>
+#include <string.h>
+
+extern float currentTemp;
+extern bool furnaceStatus;
+extern unsigned long pwmCycleStart;
+extern unsigned long pwmOnTimeMs;
+extern bool pwmRelayState;
+extern float pidIntegral;
+extern float pidLastError;
+extern unsigned long pidLastTime;
+
+// ====================================================================
+// PROFILES
+// ====================================================================
+
+static const BenchmarkSegment bisqueSegments[] = {
+  { 100, 600, 0 },                // Slow through water smoking and quartz
+  { 150, 950, 15 },
+};
+
+static const BenchmarkSegment glazeSegments[] = {
+  { 150, 1000, 0 },
+  { 50, 1220, 10 },               // Near the model's top power: tests lag on a ramp
+};
+
+static const BenchmarkSegment slowCoolSegments[] = {
+  { 0, 1000, 30 },                // Starts hot with the controller cold
+  { 60, 700, 10 },                // Slower than the kiln cools on its own
+};
+
+static const BenchmarkSegment stepSegments[] = {
+  { 0, 500, 30 },
+  { 0, 550, 60 },
+  { 0, 520, 60 },
+};
+
+const BenchmarkProfile benchmarkProfiles[BENCHMARK_PROFILE_COUNT] = {
+  { "bisque", 20, bisqueSegments, sizeof(bisqueSegments) / sizeof(bisqueSegments[0]) },
+  { "glaze", 20, glazeSegments, sizeof(glazeSegments) / sizeof(glazeSegments[0]) },
+  { "slowCool", 1000, slowCoolSegments, sizeof(slowCoolSegments) / sizeof(slowCoolSegments[0]) },
+  { "step", 500, stepSegments, sizeof(stepSegments) / sizeof(stepSegments[0]) },
+};
+
+int findBenchmarkProfile(const char* name) {
+  for (int i = 0; i < BENCHMARK_PROFILE_COUNT; i++) {
+    if (strcmp(benchmarkProfiles[i].name, name) == 0) return i;
+  }
+  return -1;
+}
+
+// ====================================================================
+// CONTROL STATE
+// ====================================================================
+
+void saveControlState(ControlState& state) {
+  state.currentTemp = currentTemp;
+  state.furnaceStatus = furnaceStatus;
+  state.pwmCycleStart = pwmCycleStart;
+  state.pwmOnTimeMs = pwmOnTimeMs;
+  state.pwmRelayState = pwmRelayState;
+  state.pidIntegral = pidIntegral;
+  state.pidLastError = pidLastError;
+  state.pidLastTime = pidLastTime;
+  state.pidTerms = pidTerms;
+}
+
+void loadControlState(const ControlState& state) {
+  currentTemp = state.currentTemp;
+  furnaceStatus = state.furnaceStatus;
+  pwmCycleStart = state.pwmCycleStart;
+  pwmOnTimeMs = state.pwmOnTimeMs;
+  pwmRelayState = state.pwmRelayState;
+  pidIntegral = state.pidIntegral;
+  pidLastError = state.pidLastError;
+  pidLastTime = state.pidLastTime;
+  pidTerms = state.pidTerms;
+}
+
+// ====================================================================
+// RUNNING
+// ====================================================================
+
+void beginBenchmarkRun(BenchmarkRun& run, int index, const FurnaceModelParams& params, uint32_t seed) {
+  const BenchmarkProfile& profile = benchmarkProfiles[index];
+  run = BenchmarkRun();
+  run.profile = index;
+  resetFurnaceModel(run.model, params, profile.startC, seed);
+  run.control.currentTemp = profile.startC;
+  run.segmentStartC = profile.startC;
+}
+
+// Close the settling figures of the hold that just ended
+static void finishHold(BenchmarkRun& run, BenchmarkResult& result, unsigned long holdEndMs) {
+  if (run.lastOutsideMs + BENCHMARK_TICK_MS >= holdEndMs && run.lastOutsideMs != run.holdStartMs) {
+    result.unsettledHolds++;
+    return;
+  }
+  float settled = (run.lastOutsideMs - run.holdStartMs) / 1000.0f;
+  if (settled > result.settlingSeconds) result.settlingSeconds = settled;
+}
+
+// Target at run.now, moving through the segments as they end. Returns
+// false once the profile is over.
+static bool advanceProfile(BenchmarkRun& run, BenchmarkResult& result, float& target) {
+  const BenchmarkProfile& profile = benchmarkProfiles[run.profile];
+  while (run.segment < profile.segmentCount) {
+    const BenchmarkSegment& segment = profile.segments[run.segment];
+    unsigned long rampMs = 0;
+    if (segment.ratePerHour > 0) {
+      rampMs = (unsigned long)(fabsf(segment.targetC - run.segmentStartC) / segment.ratePerHour * 3600000.0f);
+    }
+    unsigned long endMs = rampMs + (unsigned long)(segment.holdMinutes * 60000.0f);
+    unsigned long elapsed = run.now - run.segmentStartMs;
+
+    if (elapsed < rampMs) {
+      target = run.segmentStartC + (segment.targetC - run.segmentStartC) * ((float)elapsed / rampMs);
+      return true;
+    }
+    if (elapsed < endMs) {
+      if (!run.holding) {
+        run.holding = true;
+        run.holdStartMs = run.now;
+        run.lastOutsideMs = run.now;
+      }
+      target = segment.targetC;
+      return true;
+    }
+
+    if (run.holding) finishHold(run, result, run.segmentStartMs + endMs);
+    run.holding = false;
+    run.segmentStartC = segment.targetC;
+    run.segmentStartMs += endMs;
+    run.segment++;
+  }
+  return false;
+}
+
+// In the order loop() runs them: the kiln heats for the tick with the
+// relay as control left it, the thermocouple is read, and control switches
+// the relay for the next tick
+bool runBenchmarkTick(BenchmarkRun& run, BenchmarkResult& result) {
+  const float tickSeconds = BENCHMARK_TICK_MS / 1000.0f;
+  stepFurnaceModel(run.model, furnaceStatus, tickSeconds);
+  run.now += BENCHMARK_TICK_MS;
+  currentTemp = readFurnaceModel(run.model);
+
+  float target;
+  if (!advanceProfile(run, result, target)) return false;
+
+  bool relayWasOn = furnaceStatus;
+  uint32_t started = benchmarkMicros();
+  driveFurnace(target, run.now);
+  result.controlMicros += benchmarkMicros() - started;
+  result.ticks++;
+
+  // Judged on the chamber, not on the delayed and noisy reading
+  addControlSample(result.quality, target, run.model.tempC, furnaceStatus, relayWasOn, tickSeconds);
+  if (run.holding && fabsf(run.model.tempC - target) > BENCHMARK_SETTLE_BAND) {
+    run.lastOutsideMs = run.now;
+  }
+  return true;
+}
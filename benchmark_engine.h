@@ -0,0 +1,93 @@
+#ifndef BENCHMARK_ENGINE_H
+#define BENCHMARK_ENGINE_H
+
+#include <stdint.h>
+#include "furnace_model.h"
+#include "furnace_control.h"
+
+// =================================================================
+//                  CONTROL BENCHMARK ENGINE
+// =================================================================
+// Standard firing profiles, run through driveFurnace() against the thermal
+// model on a virtual clock, one BENCHMARK_TICK_MS control tick at a time.
+// The controller runs it in slices from loop() (control_benchmark.h); the
+// host runner (tools/host_benchmark.cpp) runs it flat out.
+//
+// No Arduino dependencies so it builds on the host. benchmarkMicros() is
+// provided by the build, for timing the control code.
+
+#define BENCHMARK_TICK_MS 500             // Same period as the control tick in loop()
+#define BENCHMARK_SETTLE_BAND 5.0f        // Settled: within this many C of a hold's target
+#define BENCHMARK_PROFILE_COUNT 4
+
+// One step of a firing profile: ramp at ratePerHour (0 jumps straight
+// there) to targetC, then hold it
+struct BenchmarkSegment {
+    float ratePerHour;
+    float targetC;
+    float holdMinutes;
+};
+
+struct BenchmarkProfile {
+    const char* name;
+    float startC;                // Kiln and target at the start
+    const BenchmarkSegment* segments;
+    uint8_t segmentCount;
+};
+
+extern const BenchmarkProfile benchmarkProfiles[BENCHMARK_PROFILE_COUNT];
+
+// Index in benchmarkProfiles, -1 if there is none of that name
+int findBenchmarkProfile(const char* name);
+
+// Everything driveFurnace() reads or leaves behind between ticks
+struct ControlState {
+    float currentTemp;
+    bool furnaceStatus;
+    unsigned long pwmCycleStart;
+    unsigned long pwmOnTimeMs;
+    bool pwmRelayState;
+    float pidIntegral;
+    float pidLastError;
+    unsigned long pidLastTime;
+    PidTerms pidTerms;
+};
+
+// Copy the control globals out of and back into a ControlState
+void saveControlState(ControlState& state);
+void loadControlState(const ControlState& state);
+
+struct BenchmarkResult {
+    ControlQuality quality;
+    float settlingSeconds;       // Slowest hold to settle
+    uint8_t unsettledHolds;      // Holds that ended outside the band
+    uint32_t ticks;
+    uint32_t controlMicros;      // CPU time in driveFurnace()
+    uint32_t wallMillis;
+};
+
+// A firing in progress
+struct BenchmarkRun {
+    uint8_t profile;
+    FurnaceModel model;
+    ControlState control;        // Control globals between ticks
+    unsigned long now;           // Virtual millis()
+    uint8_t segment;
+    float segmentStartC;
+    unsigned long segmentStartMs;
+    bool holding;
+    unsigned long holdStartMs;
+    unsigned long lastOutsideMs; // Last tick of the hold outside the band
+};
+
+// Start profile index on a fresh model and a cold controller
+void beginBenchmarkRun(BenchmarkRun& run, int index, const FurnaceModelParams& params, uint32_t seed);
+
+// One control tick. The control globals must hold run.control (see
+// loadControlState). Returns false once the profile is over.
+bool runBenchmarkTick(BenchmarkRun& run, BenchmarkResult& result);
+
+// Microsecond clock for timing driveFurnace()
+uint32_t benchmarkMicros();
+
+#endif
@@ -0,0 +1,76 @@
+#include "boot_sequence.h"
+#include "api_cache.h"
+
+static BootStage* bootStages = nullptr;
+static int bootStageCount = 0;
+static int nextDeferredStage = 0;
+static uint32_t controlReadyAt = 0;
+static uint32_t bootCompleteAt = 0;
+
+static void runStage(BootStage& stage) {
+  stage.startedAt = millis();
+  uint32_t started = micros();
+  stage.run();
+  stage.durationMicros = micros() - started;
+  stage.done = true;
+  bumpApiGeneration(API_RESOURCE_STATUS);
+
+  Serial.print("Boot: ");
+  Serial.print(stage.name);
+  Serial.print(" took ");
+  Serial.print(stage.durationMicros / 1000.0, 1);
+  Serial.println(" ms");
+}
+
+void runBootStages(BootStage* stages, int count) {
+  bootStages = stages;
+  bootStageCount = count;
+
+  for (int i = 0; i < count; i++) {
+    if (!stages[i].deferred) {
+      runStage(stages[i]);
+    }
+  }
+
+  controlReadyAt = millis();
+  Serial.print("Boot: Control live at ");
+  Serial.print(controlReadyAt);
+  Serial.println(" ms");
+}
+
+void runDeferredBootStage() {
+  if (bootCompleteAt != 0 || bootStages == nullptr) return;
+
+  while (nextDeferredStage < bootStageCount && !bootStages[nextDeferredStage].deferred) {
+    nextDeferredStage++;
+  }
+  if (nextDeferredStage < bootStageCount) {
+    runStage(bootStages[nextDeferredStage++]);
+    return;
+  }
+
+  bootCompleteAt = millis();
+  Serial.print("Boot: Complete at ");
+  Serial.print(bootCompleteAt);
+  Serial.println(" ms");
+}
+
+bool isBootComplete() {
+  return bootCompleteAt != 0;
+}
+
+uint32_t getControlReadyMillis() {
+  return controlReadyAt;
+}
+
+uint32_t getBootCompleteMillis() {
+  return bootCompleteAt;
+}
+
+int getBootStageCount() {
+  return bootStageCount;
+}
+
+const BootStage& getBootStage(int index) {
+  return bootStages[index];
+}
@@ -0,0 +1,41 @@
+#ifndef BOOT_SEQUENCE_H
+#define BOOT_SEQUENCE_H
+
+#include <Arduino.h>
+
+// =================================================================
+//                  STAGED BOOT
+// =================================================================
+// setup() only runs the stages the relay depends on - relay pin, storage,
+// settings, thermocouple and the active program - so closed-loop control
+// starts well under a second after reset. Everything else (Wi-Fi, web
+// server, display, log file checks) is deferred: loop() runs one deferred
+// stage per pass, after the control tick, so no stage ever delays the
+// relay by more than its own duration.
+//
+// Each stage's start time and duration are kept for /api/status.
+
+typedef void (*BootStageFunction)();
+
+struct BootStage {
+    const char* name;
+    BootStageFunction run;
+    bool deferred;                    // Run from loop() once control is live
+    uint32_t startedAt;               // millis() when the stage started
+    uint32_t durationMicros;
+    bool done;
+};
+
+// Run every non-deferred stage in order (call once from setup)
+void runBootStages(BootStage* stages, int count);
+
+// Run the next deferred stage, if any (call every loop)
+void runDeferredBootStage();
+
+bool isBootComplete();
+uint32_t getControlReadyMillis();     // millis() when the last critical stage finished
+uint32_t getBootCompleteMillis();     // millis() when the last deferred stage finished, else 0
+int getBootStageCount();
+const BootStage& getBootStage(int index);
+
+#endif // BOOT_SEQUENCE_H
@@ -21,9 +21,18 @@
 // Uncomment to enable fake temperature readings for testing without a thermocouple.
 // #define FAKE_TEMPERATURE_MODE
 
+// Uncomment to run against a simulated kiln (furnace_sim.h): the thermocouple
+// is replaced by a thermal model heated by the relay, and the relay pin is
+// never driven.
+// #define SIMULATED_FURNACE
+
 // Uncomment to use hardcoded WiFi credentials for faster testing.
 // #define HARDCODED_WIFI_TEST
 
+// Scoped timers around loop() stages and TFT drawing (profiler.h).
+// Comment out to compile them out entirely.
+#define PROFILE_ENABLED
+
 // =================================================================
 //                          PIN DEFINITIONS
 // =================================================================
@@ -38,6 +47,27 @@
 #define AP_SSID "Furnace_Control"
 #define DNS_PORT 53
 #define NTP_SERVER "pool.ntp.org"
+
+// Station reconnects (wifi_manager.cpp)
+#define WIFI_CONNECT_TIMEOUT_MS 15000    // One attempt, from begin() to an IP address
+#define WIFI_BACKOFF_MIN_MS 1000         // Doubles per failed attempt...
+#define WIFI_BACKOFF_MAX_MS 120000       // ...up to this, with random jitter
+#define WIFI_AP_FALLBACK_FAILURES 3      // Failed reconnects before the setup access point opens
+
+// MQTT telemetry (mqtt_telemetry.cpp)
+#define MQTT_DEFAULT_TOPIC "furnace"
+#define MQTT_DEFAULT_SAMPLE_SECONDS 10
+#define MQTT_DEFAULT_BATCH 6             // Samples per telemetry message
+#define MQTT_MAX_BATCH 30
+#define MQTT_RING_SAMPLES 360            // Queued in RAM, one hour at the default rate
+#define MQTT_SPILL_CHUNK 60              // Samples moved to flash at a time once the ring is full
+#define MQTT_SPILL_MAX_BYTES 65536       // Cap on the spill file; past it queued samples are dropped
+#define MQTT_ENQUEUE_RETRY_MS 15000      // Retry a batch the client's outbox had no room for
+
+// Energy metering (energy_meter.cpp)
+#define ENERGY_DEFAULT_ELEMENT_WATTS 3000 // Set to the kiln's rating in /api/energy
+#define ENERGY_CHECKPOINT_MS 900000      // Counters saved to NVS at most this often while heating...
+#define ENERGY_CHECKPOINT_MIN_WH 10      // ...and only once this much is unsaved
 const long GMT_OFFSET_SEC = 0;
 const int DAYLIGHT_OFFSET_SEC = 3600;
 
@@ -49,13 +79,24 @@ const int DAYLIGHT_OFFSET_SEC = 3600;
 #define TEMP_READINGS_PER_HOUR 4  // Number of target temperature readings per hour (4 = every 15 minutes)
 const int SMOOTHING_UPDATE_INTERVAL = 30000; // 30 seconds
 
+// Accepted target temperatures for schedule edits: the MAX31855 K-type range
+#define SCHEDULE_TEMP_MIN -200.0
+#define SCHEDULE_TEMP_MAX 1350.0
+
 // =================================================================
 //                          FILE SYSTEM PATHS
 // =================================================================
 #define TEMP_LOG_FILE "/temp_log.csv"
+// FiringWh: energy of the current firing (energy_meter.h); older logs lack it
+#define TEMP_LOG_HEADER "Timestamp,Temperature,Target,FurnaceStatus,FiringWh"
 
 #define THEME_CONFIG_FILE "/theme.json"
 #define PROGRAMS_FILE "/programs.json"
+#define PROGRAMS_BIN_FILE "/programs.bin"  // Single-file binary store, migrated to PROGRAM_DIR
+#define PROGRAM_DIR "/prog"                // One program_codec.h file per program slot
+#define PROGRAM_MANIFEST_FILE "/prog/index.bin"
+#define STATIC_ASSET_MANIFEST "/.assets.json"  // Written by tools/build_assets.py
+#define MQTT_SPILL_FILE "/mqtt_spill.bin"          // Telemetry queued while the broker is away
 
 // =================================================================
 //                      FORWARD DECLARATIONS
@@ -126,6 +167,25 @@ extern int activeProgram;
 void loadProgram(int programIndex);
 void saveProgram(int programIndex, String programName);
 void saveAllPrograms();
+void saveProgramToSPIFFS(int programIndex);
+void ensureProgramLoaded(int programIndex);
+
+// Program slots are read and written from both loop() and the web server
+// task. Hold the lock while loading, saving or reading a program's
+// temperatures as a whole; it is recursive, so the storage functions above
+// can be called with it held.
+void lockProgramStore();
+void unlockProgramStore();
+
+class ProgramStoreLock {
+public:
+    ProgramStoreLock() { lockProgramStore(); }
+    ~ProgramStoreLock() { unlockProgramStore(); }
+};
+
+// Relay (the only way to switch it; see setRelay() in the sketch)
+void setRelay(bool on);
+void stopHeating();
 
 // Temperature resolution settings
 extern int tempResolution;
@@ -0,0 +1,320 @@
+#include "control_benchmark.h"
+
+extern bool systemEnabled;
+extern bool pwmEnabled;
+extern unsigned long pwmPeriodMs;
+extern bool pidEnabled;
+extern float pidKp;
+extern float pidKi;
+extern float pidKd;
+extern float pidSampleTime;
+extern float pidSetpointWindow;
+
+// ====================================================================
+// STATE
+// ====================================================================
+
+enum BenchmarkState {
+  BENCHMARK_IDLE,
+  BENCHMARK_RUNNING,
+  BENCHMARK_DONE,
+  BENCHMARK_ABORTED
+};
+
+// Settings the suite ran with, for the report
+struct BenchmarkSettings {
+    bool pidEnabled;
+    float pidKp;
+    float pidKi;
+    float pidKd;
+    float pidSampleTime;
+    float pidSetpointWindow;
+    bool pwmEnabled;
+    unsigned long pwmPeriodMs;
+};
+
+static portMUX_TYPE benchmarkMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Shared with the web server, under benchmarkMux
+static BenchmarkState benchmarkState = BENCHMARK_IDLE;
+static bool startPending = false;
+static uint8_t pendingProfiles = 0;
+static FurnaceModelParams pendingParams;
+static uint32_t pendingSeed = 1;
+static uint8_t runProfiles = 0;          // Bit per benchmarkProfiles entry
+static FurnaceModelParams runParams;
+static uint32_t runSeed = 1;
+static BenchmarkSettings runSettings;
+static BenchmarkResult results[BENCHMARK_PROFILE_COUNT];
+static uint8_t resultCount = 0;
+static int8_t currentProfile = -1;
+static unsigned long currentSimMillis = 0;
+
+// The firing in progress. Only loop() touches it.
+static BenchmarkRun run;
+static unsigned long runStartedMillis = 0;
+static bool drivingControl = false;
+
+bool isBenchmarkDrivingControl() {
+  return drivingControl;
+}
+
+uint32_t benchmarkMicros() {
+  return micros();
+}
+
+// ====================================================================
+// STARTING
+// ====================================================================
+
+int stageControlBenchmark(JsonDocument& doc, String& error) {
+  if (systemEnabled) {
+    error = "Disable the system before benchmarking";
+    return 409;
+  }
+
+  uint8_t profiles = 0;
+  if (doc.containsKey("profiles")) {
+    for (JsonVariant name : doc["profiles"].as<JsonArray>()) {
+      const char* text = name.as<const char*>();
+      int index = text ? findBenchmarkProfile(text) : -1;
+      if (index < 0) {
+        error = String("Unknown profile ") + (text ? text : "");
+        return 400;
+      }
+      profiles |= 1 << index;
+    }
+  } else {
+    profiles = (1 << BENCHMARK_PROFILE_COUNT) - 1;
+  }
+  if (profiles == 0) {
+    error = "No profiles";
+    return 400;
+  }
+
+  FurnaceModelParams params = FURNACE_MODEL_DEFAULTS;
+  JsonObject model = doc["model"];
+  if (model) {
+    params.heaterWatts = model["heaterWatts"] | params.heaterWatts;
+    params.heatCapacity = model["heatCapacity"] | params.heatCapacity;
+    params.lossWattsPerKelvin = model["lossWattsPerKelvin"] | params.lossWattsPerKelvin;
+    params.ambientC = model["ambientC"] | params.ambientC;
+    params.deadTimeSeconds = model["deadTimeSeconds"] | params.deadTimeSeconds;
+    params.noiseC = model["noiseC"] | params.noiseC;
+  }
+  if (params.heaterWatts <= 0 || params.heatCapacity <= 0 || params.lossWattsPerKelvin < 0 ||
+      params.noiseC < 0 || params.deadTimeSeconds < 0 || params.deadTimeSeconds > FURNACE_MODEL_DELAY_SLOTS - 1) {
+    error = "Model parameter out of range";
+    return 400;
+  }
+
+  uint32_t seed = doc["seed"] | 1;
+  bool busy;
+  portENTER_CRITICAL(&benchmarkMux);
+  busy = startPending || benchmarkState == BENCHMARK_RUNNING;
+  if (!busy) {
+    startPending = true;
+    pendingProfiles = profiles;
+    pendingParams = params;
+    pendingSeed = seed;
+  }
+  portEXIT_CRITICAL(&benchmarkMux);
+
+  if (busy) {
+    error = "A benchmark is already running";
+    return 409;
+  }
+  return 200;
+}
+
+static void beginProfile(int index) {
+  beginBenchmarkRun(run, index, runParams, runSeed);
+  runStartedMillis = millis();
+
+  portENTER_CRITICAL(&benchmarkMux);
+  currentProfile = index;
+  currentSimMillis = 0;
+  results[resultCount] = BenchmarkResult();
+  portEXIT_CRITICAL(&benchmarkMux);
+}
+
+// Next profile after the current one, or -1 when the suite is done
+static int nextProfile(int after) {
+  for (int i = after + 1; i < BENCHMARK_PROFILE_COUNT; i++) {
+    if (runProfiles & (1 << i)) return i;
+  }
+  return -1;
+}
+
+// ====================================================================
+// RUNNING
+// ====================================================================
+
+static void finishSuite(BenchmarkState state) {
+  portENTER_CRITICAL(&benchmarkMux);
+  benchmarkState = state;
+  currentProfile = -1;
+  portEXIT_CRITICAL(&benchmarkMux);
+  Serial.println(state == BENCHMARK_DONE ? "Control benchmark finished" : "Control benchmark abandoned: system enabled");
+}
+
+void updateControlBenchmark() {
+  if (startPending) {
+    portENTER_CRITICAL(&benchmarkMux);
+    startPending = false;
+    runProfiles = pendingProfiles;
+    runParams = pendingParams;
+    runSeed = pendingSeed;
+    runSettings = { pidEnabled, pidKp, pidKi, pidKd, pidSampleTime, pidSetpointWindow, pwmEnabled, pwmPeriodMs };
+    resultCount = 0;
+    benchmarkState = BENCHMARK_RUNNING;
+    portEXIT_CRITICAL(&benchmarkMux);
+
+    Serial.println("Control benchmark started");
+    beginProfile(nextProfile(-1));
+  }
+  if (benchmarkState != BENCHMARK_RUNNING) return;
+
+  if (systemEnabled) {
+    finishSuite(BENCHMARK_ABORTED);
+    return;
+  }
+
+  // Swap the simulated firing into the control globals for the slice
+  ControlState live;
+  saveControlState(live);
+  loadControlState(run.control);
+  drivingControl = true;
+
+  BenchmarkResult result = results[resultCount];
+  bool finished = false;
+  unsigned long sliceStarted = micros();
+  while (micros() - sliceStarted < BENCHMARK_SLICE_MICROS) {
+    if (!runBenchmarkTick(run, result)) {
+      finished = true;
+      break;
+    }
+  }
+
+  drivingControl = false;
+  saveControlState(run.control);
+  loadControlState(live);
+
+  result.wallMillis = millis() - runStartedMillis;
+  portENTER_CRITICAL(&benchmarkMux);
+  results[resultCount] = result;
+  currentSimMillis = run.now;
+  if (finished) resultCount++;
+  portEXIT_CRITICAL(&benchmarkMux);
+
+  if (finished) {
+    int next = nextProfile(run.profile);
+    if (next < 0) {
+      finishSuite(BENCHMARK_DONE);
+    } else {
+      beginProfile(next);
+    }
+  }
+}
+
+// ====================================================================
+// REPORT
+// ====================================================================
+
+static const char* stateName(BenchmarkState state) {
+  switch (state) {
+    case BENCHMARK_RUNNING: return "running";
+    case BENCHMARK_DONE: return "done";
+    case BENCHMARK_ABORTED: return "aborted";
+    default: return "idle";
+  }
+}
+
+void writeControlBenchmarkReport(JsonDocument& doc) {
+  BenchmarkResult copied[BENCHMARK_PROFILE_COUNT];
+  uint8_t profileOrder[BENCHMARK_PROFILE_COUNT];
+  BenchmarkState state;
+  uint8_t count;
+  int current;
+  unsigned long simMillis;
+  uint8_t profiles;
+  FurnaceModelParams params;
+  uint32_t seed;
+  BenchmarkSettings settingsUsed;
+
+  portENTER_CRITICAL(&benchmarkMux);
+  state = benchmarkState;
+  count = resultCount;
+  memcpy(copied, results, sizeof(copied));
+  current = currentProfile;
+  simMillis = currentSimMillis;
+  profiles = runProfiles;
+  params = runParams;
+  seed = runSeed;
+  settingsUsed = runSettings;
+  bool pending = startPending;
+  portEXIT_CRITICAL(&benchmarkMux);
+
+  // Staged but not yet picked up by loop()
+  if (pending) {
+    doc["state"] = "starting";
+    return;
+  }
+
+  doc["state"] = stateName(state);
+  if (state == BENCHMARK_IDLE) return;
+
+  if (state == BENCHMARK_RUNNING && current >= 0) {
+    JsonObject progress = doc.createNestedObject("progress");
+    progress["profile"] = benchmarkProfiles[current].name;
+    progress["simulatedSeconds"] = simMillis / 1000;
+  }
+
+  doc["tickMs"] = BENCHMARK_TICK_MS;
+  doc["settleBand"] = BENCHMARK_SETTLE_BAND;
+  doc["seed"] = seed;
+
+  JsonObject settings = doc.createNestedObject("settings");
+  settings["pidEnabled"] = settingsUsed.pidEnabled;
+  settings["pidKp"] = settingsUsed.pidKp;
+  settings["pidKi"] = settingsUsed.pidKi;
+  settings["pidKd"] = settingsUsed.pidKd;
+  settings["pidSampleTime"] = settingsUsed.pidSampleTime;
+  settings["pidSetpointWindow"] = settingsUsed.pidSetpointWindow;
+  settings["pwmEnabled"] = settingsUsed.pwmEnabled;
+  settings["pwmPeriodMs"] = settingsUsed.pwmPeriodMs;
+
+  JsonObject model = doc.createNestedObject("model");
+  model["heaterWatts"] = params.heaterWatts;
+  model["heatCapacity"] = params.heatCapacity;
+  model["lossWattsPerKelvin"] = params.lossWattsPerKelvin;
+  model["ambientC"] = params.ambientC;
+  model["deadTimeSeconds"] = params.deadTimeSeconds;
+  model["noiseC"] = params.noiseC;
+
+  // Finished profiles run in benchmarkProfiles order
+  int filled = 0;
+  for (int i = 0; i < BENCHMARK_PROFILE_COUNT && filled < count; i++) {
+    if (profiles & (1 << i)) profileOrder[filled++] = i;
+  }
+
+  JsonArray runs = doc.createNestedArray("runs");
+  for (int i = 0; i < count; i++) {
+    const BenchmarkResult& result = copied[i];
+    const ControlQuality& quality = result.quality;
+    JsonObject entry = runs.createNestedObject();
+    entry["profile"] = benchmarkProfiles[profileOrder[i]].name;
+    entry["seconds"] = quality.seconds;
+    entry["iae"] = quality.absErrorSeconds;
+    entry["meanAbsError"] = quality.seconds > 0 ? quality.absErrorSeconds / quality.seconds : 0;
+    entry["maxOvershoot"] = quality.maxOvershoot;
+    entry["maxUndershoot"] = quality.maxUndershoot;
+    entry["settlingSeconds"] = result.settlingSeconds;
+    entry["unsettledHolds"] = result.unsettledHolds;
+    entry["relayCycles"] = quality.relayCycles;
+    entry["heaterOnSeconds"] = quality.heaterOnSeconds;
+    entry["energyKWh"] = quality.heaterOnSeconds * params.heaterWatts / 3600000.0;
+    entry["controlUsPerTick"] = result.ticks > 0 ? (float)result.controlMicros / result.ticks : 0;
+    entry["wallMs"] = result.wallMillis;
+  }
+}
@@ -0,0 +1,52 @@
+#ifndef CONTROL_BENCHMARK_H
+#define CONTROL_BENCHMARK_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "benchmark_engine.h"
+
+// =================================================================
+//                  CONTROL BENCHMARK
+// =================================================================
+// Drives the real control code - driveFurnace(), its PWM mapping and
+// calculatePIDOutput() - against the thermal model in furnace_model.h
+// through standard firing profiles (benchmark_engine.h), on a virtual
+// clock. A ten-hour glaze firing takes a few seconds. The controller's
+// current PWM and PID settings are used, so a control change is judged by
+// running the suite before and after it and comparing the reports
+// (tools/benchmark_compare.py). tools/host_benchmark.cpp runs the same
+// suite on a PC and writes the same report.
+//
+// POST /api/debug/benchmark starts a run; every field is optional, so {}
+// runs the whole suite on the default kiln:
+//
+//   {
+//     "profiles": ["bisque", "step"],       default: all of them
+//     "model": { "deadTimeSeconds": 40 },   overrides FURNACE_MODEL_DEFAULTS
+//     "seed": 7                             sensor noise sequence
+//   }
+//
+// GET /api/debug/benchmark returns the state (idle, starting, running,
+// done or aborted), progress while running and the report so far.
+//
+// The suite only runs while the system is disabled, and is abandoned if
+// it is enabled. It runs from loop() in slices of BENCHMARK_SLICE_MICROS;
+// during a slice the control globals hold the simulated firing's state,
+// and setRelay() leaves the relay pin alone.
+
+#define BENCHMARK_SLICE_MICROS 15000
+
+// Validate a start request and stage it for loop(). Returns the HTTP
+// status; error says why when it is not 200.
+int stageControlBenchmark(JsonDocument& doc, String& error);
+
+// Start a staged suite and run the next slice of it. Called from loop().
+void updateControlBenchmark();
+
+// True while a slice has the control globals
+bool isBenchmarkDrivingControl();
+
+// Progress or the finished report
+void writeControlBenchmarkReport(JsonDocument& doc);
+
+#endif
@@ -216,23 +216,41 @@ async function syncTemperatureUpdates() {
     try {
         // Get pending updates from IndexedDB
         const pendingUpdates = await getPendingUpdates();
+        if (pendingUpdates.length === 0) {
+            return;
+        }
         
+        // Replay the whole queue as one batch edit, oldest first so later
+        // edits win; only the last temperature per point is sent
+        pendingUpdates.sort((a, b) => a.timestamp - b.timestamp);
+        const latest = new Map();
         for (const update of pendingUpdates) {
-            try {
-                const response = await fetch('/api/updateTemp', {
-                    method: 'POST',
-                    headers: { 'Content-Type': 'application/json' },
-                    body: JSON.stringify(update)
-                });
-                
-                if (response.ok) {
-                    // Remove from pending updates
-                    await removePendingUpdate(update.id);
+            if (update.data && Array.isArray(update.data.points)) {
+                for (const [index, temp] of update.data.points) {
+                    latest.set(index, temp);
                 }
-            } catch (error) {
-                console.error('Failed to sync temperature update:', error);
+            } else if (update.data) {
+                latest.set(update.data.index, update.data.temp);
             }
         }
+        const points = Array.from(latest);
+        
+        const response = await fetch('/api/schedule', {
+            method: 'PATCH',
+            headers: { 'Content-Type': 'application/json' },
+            body: JSON.stringify({ points: points })
+        });
+        
+        // A rejected batch (e.g. resolution changed, or too large even after
+        // merging) is dropped rather than retried forever
+        if (response.ok || response.status === 400 || response.status === 409 || response.status === 413) {
+            for (const update of pendingUpdates) {
+                await removePendingUpdate(update.id);
+            }
+        }
+        if (!response.ok) {
+            console.error('Temperature update batch rejected:', response.status);
+        }
     } catch (error) {
         console.error('Error syncing temperature updates:', error);
     }
@@ -0,0 +1,269 @@
+#include "energy_meter.h"
+#include <Preferences.h>
+#include <time.h>
+
+extern bool systemEnabled;
+extern int activeProgram;
+extern bool timeIsSynchronized;
+
+// Saved as one blob; bump the version when the layout changes
+struct EnergyTotals {
+    uint16_t version;
+    EnergyCounter firing;
+    EnergyCounter lifetime;
+    EnergyCounter programs[MAX_PROGRAMS];
+    uint32_t firings;
+    int8_t firingProgram;
+    uint32_t firingStartUnix;
+    bool firingOpen;                  // Started and not yet ended, across reboots
+};
+
+// Layout before firingOpen; its firing is taken as ended
+struct EnergyTotalsV1 {
+    uint16_t version;
+    EnergyCounter firing;
+    EnergyCounter lifetime;
+    EnergyCounter programs[MAX_PROGRAMS];
+    uint32_t firings;
+    int8_t firingProgram;
+    uint32_t firingStartUnix;
+};
+
+#define ENERGY_TOTALS_VERSION 2
+
+static portMUX_TYPE energyMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Under energyMux: the web server reads and resets them
+static EnergyTotals totals = {};
+static EnergySettings settings = { ENERGY_DEFAULT_ELEMENT_WATTS, 0 };
+static bool relayOn = false;
+static uint32_t relayOnSince = 0;
+static uint64_t unsavedWattMillis = 0;
+static bool checkpointRequested = false;
+
+// loop() only
+static bool firingActive = false;             // loop()'s view of totals.firingOpen
+static uint32_t lastCheckpointMillis = 0;
+
+// ====================================================================
+// COUNTING
+// ====================================================================
+
+static void addEnergy(EnergyCounter& counter, uint32_t onMillis, uint64_t wattMillis) {
+  counter.onMillis += onMillis;
+  counter.wattMillis += wattMillis;
+}
+
+// Charge relay time up to now and restart the open interval. Caller
+// holds energyMux.
+static void accrueLocked(uint32_t now) {
+  if (!relayOn) return;
+  uint32_t onMillis = now - relayOnSince;
+  uint64_t wattMillis = (uint64_t)((double)onMillis * settings.elementWatts);
+  addEnergy(totals.firing, onMillis, wattMillis);
+  addEnergy(totals.lifetime, onMillis, wattMillis);
+  if (activeProgram >= 0 && activeProgram < MAX_PROGRAMS) {
+    addEnergy(totals.programs[activeProgram], onMillis, wattMillis);
+  }
+  unsavedWattMillis += wattMillis;
+  relayOnSince = now;
+}
+
+// A firing starts with the first heat after the system is enabled, not
+// with the enable flag itself: it defaults to on at boot, and enabling
+// without ever heating is not a firing
+static void startFiringLocked(uint32_t startUnix) {
+  totals.firing = EnergyCounter();
+  totals.firings++;
+  totals.firingProgram = activeProgram;
+  totals.firingStartUnix = startUnix;
+  totals.firingOpen = true;
+  // Saved at once, so a reboot resumes this firing instead of counting another
+  checkpointRequested = true;
+}
+
+void noteRelayEdge(bool on) {
+  uint32_t now = millis();
+  uint32_t startUnix = timeIsSynchronized ? (uint32_t)time(nullptr) : 0;
+  portENTER_CRITICAL(&energyMux);
+  if (on != relayOn) {
+    accrueLocked(now);
+    if (on && systemEnabled && !totals.firingOpen) startFiringLocked(startUnix);
+    relayOn = on;
+    relayOnSince = now;
+  }
+  portEXIT_CRITICAL(&energyMux);
+}
+
+// ====================================================================
+// STORAGE
+// ====================================================================
+
+static void loadEnergySettings() {
+  Preferences prefs;
+  prefs.begin("energy", true);
+  settings.elementWatts = prefs.getFloat("watts", ENERGY_DEFAULT_ELEMENT_WATTS);
+  settings.costPerKWh = prefs.getFloat("cost", 0);
+  EnergyTotals stored;
+  EnergyTotalsV1 storedV1;
+  size_t length = prefs.getBytesLength("totals");
+  bool found = length == sizeof(stored) && prefs.getBytes("totals", &stored, sizeof(stored)) == sizeof(stored) &&
+               stored.version == ENERGY_TOTALS_VERSION;
+  bool foundV1 = !found && length == sizeof(storedV1) &&
+                 prefs.getBytes("totals", &storedV1, sizeof(storedV1)) == sizeof(storedV1) && storedV1.version == 1;
+  prefs.end();
+
+  if (found) {
+    totals = stored;
+  } else {
+    totals.version = ENERGY_TOTALS_VERSION;
+    totals.firingProgram = -1;
+    if (foundV1) {
+      totals.firing = storedV1.firing;
+      totals.lifetime = storedV1.lifetime;
+      memcpy(totals.programs, storedV1.programs, sizeof(totals.programs));
+      totals.firings = storedV1.firings;
+      totals.firingProgram = storedV1.firingProgram;
+      totals.firingStartUnix = storedV1.firingStartUnix;
+    }
+  }
+}
+
+static void checkpointEnergy() {
+  EnergyTotals copy;
+  portENTER_CRITICAL(&energyMux);
+  accrueLocked(millis());
+  copy = totals;
+  unsavedWattMillis = 0;
+  checkpointRequested = false;
+  portEXIT_CRITICAL(&energyMux);
+
+  Preferences prefs;
+  prefs.begin("energy", false);
+  prefs.putBytes("totals", &copy, sizeof(copy));
+  prefs.end();
+  lastCheckpointMillis = millis();
+}
+
+void beginEnergyMeter() {
+  loadEnergySettings();
+  // A firing interrupted by a reboot carries on if the system is still
+  // enabled, and is ended by loop() if not
+  firingActive = totals.firingOpen;
+  lastCheckpointMillis = millis();
+
+  Serial.print("Energy: ");
+  Serial.print(energyKWh(totals.lifetime), 2);
+  Serial.print(" kWh lifetime, ");
+  Serial.print(settings.elementWatts, 0);
+  Serial.println(" W elements");
+}
+
+// ====================================================================
+// FIRINGS AND CHECKPOINTS
+// ====================================================================
+
+void updateEnergyMeter() {
+  if (!firingActive) {
+    // Started by noteRelayEdge()
+    portENTER_CRITICAL(&energyMux);
+    firingActive = totals.firingOpen;
+    portEXIT_CRITICAL(&energyMux);
+    if (firingActive) Serial.println("Energy: firing started");
+  } else if (!systemEnabled) {
+    firingActive = false;
+    portENTER_CRITICAL(&energyMux);
+    totals.firingOpen = false;
+    portEXIT_CRITICAL(&energyMux);
+    checkpointEnergy();
+    Serial.print("Energy: firing ended, ");
+    Serial.print(energyKWh(getEnergySnapshot().firing), 2);
+    Serial.println(" kWh");
+    return;
+  }
+
+  uint32_t now = millis();
+  bool due = checkpointRequested;
+  if (!due && now - lastCheckpointMillis >= ENERGY_CHECKPOINT_MS) {
+    portENTER_CRITICAL(&energyMux);
+    accrueLocked(now);
+    due = unsavedWattMillis >= (uint64_t)ENERGY_CHECKPOINT_MIN_WH * 3600000ULL;
+    portEXIT_CRITICAL(&energyMux);
+  }
+  if (due) checkpointEnergy();
+}
+
+// ====================================================================
+// READING AND SETTINGS
+// ====================================================================
+
+EnergySnapshot getEnergySnapshot() {
+  EnergySnapshot snapshot;
+  uint32_t now = millis();
+  portENTER_CRITICAL(&energyMux);
+  accrueLocked(now);
+  snapshot.firing = totals.firing;
+  snapshot.lifetime = totals.lifetime;
+  memcpy(snapshot.programs, totals.programs, sizeof(snapshot.programs));
+  snapshot.firings = totals.firings;
+  snapshot.firingProgram = totals.firingProgram;
+  snapshot.firingStartUnix = totals.firingStartUnix;
+  snapshot.relayOn = relayOn;
+  portEXIT_CRITICAL(&energyMux);
+  snapshot.firingActive = firingActive;
+  snapshot.checkpointAgeMillis = now - lastCheckpointMillis;
+  return snapshot;
+}
+
+const EnergySettings& getEnergySettings() {
+  return settings;
+}
+
+bool saveEnergySettings(const EnergySettings& updated, String& error) {
+  if (!(updated.elementWatts >= 100 && updated.elementWatts <= 30000)) {
+    error = "Element power must be 100-30000 W";
+    return false;
+  }
+  if (!(updated.costPerKWh >= 0 && updated.costPerKWh <= 100)) {
+    error = "Cost per kWh must be 0-100";
+    return false;
+  }
+
+  Preferences prefs;
+  prefs.begin("energy", false);
+  prefs.putFloat("watts", updated.elementWatts);
+  prefs.putFloat("cost", updated.costPerKWh);
+  prefs.end();
+
+  // Heat used so far is charged at the old power
+  portENTER_CRITICAL(&energyMux);
+  accrueLocked(millis());
+  settings = updated;
+  portEXIT_CRITICAL(&energyMux);
+  return true;
+}
+
+bool resetEnergyCounters(const String& which) {
+  portENTER_CRITICAL(&energyMux);
+  accrueLocked(millis());
+  bool known = true;
+  if (which == "firing") {
+    totals.firing = EnergyCounter();
+  } else if (which == "programs") {
+    memset(totals.programs, 0, sizeof(totals.programs));
+  } else if (which == "lifetime") {
+    uint16_t version = totals.version;
+    int8_t firingProgram = totals.firingProgram;
+    bool firingOpen = totals.firingOpen;
+    totals = EnergyTotals();
+    totals.version = version;
+    totals.firingProgram = firingProgram;
+    totals.firingOpen = firingOpen;
+  } else {
+    known = false;
+  }
+  // Saved by loop(), not the web server task
+  if (known) checkpointRequested = true;
+  portEXIT_CRITICAL(&energyMux);
+  return known;
+}
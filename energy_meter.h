@@ -0,0 +1,71 @@
+#ifndef ENERGY_METER_H
+#define ENERGY_METER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// =================================================================
+//                  ENERGY METERING
+// =================================================================
+// Relay on-time is integrated at every switch - setRelay() reports each
+// edge with its millis() - and turned into energy with the configured
+// element power. Three sets of counters are kept:
+//
+//   firing     from the first heat after the system is enabled until
+//              it is disabled; kept until the next firing starts
+//   programs   per program slot, charged to the program active while
+//              the heat was used
+//   lifetime   since the counters were last reset
+//
+// Counters survive reboots in NVS (Preferences "energy"). Flash wear is
+// bounded by saving at most every ENERGY_CHECKPOINT_MS while heating and
+// only once ENERGY_CHECKPOINT_MIN_WH is unsaved, plus once when a firing
+// ends: about a hundred writes over a long firing day. A power cut loses
+// at most ENERGY_CHECKPOINT_MS of heating.
+
+struct EnergyCounter {
+    uint64_t onMillis;                // Relay on-time
+    uint64_t wattMillis;              // Energy in W*ms, at the power set at the time
+};
+
+struct EnergySettings {
+    float elementWatts;
+    float costPerKWh;                 // 0 leaves costs out
+};
+
+// Copy of the counters, open relay interval included
+struct EnergySnapshot {
+    EnergyCounter firing;
+    EnergyCounter lifetime;
+    EnergyCounter programs[MAX_PROGRAMS];
+    uint32_t firings;                 // Firings started since the last lifetime reset
+    int8_t firingProgram;             // Program active when the firing started, -1 before the first
+    uint32_t firingStartUnix;         // 0 when the clock was not set
+    bool firingActive;
+    bool relayOn;
+    uint32_t checkpointAgeMillis;     // Since the counters were last saved
+};
+
+// Load settings and counters (boot stage, before control starts)
+void beginEnergyMeter();
+
+// Called by setRelay() on every switch
+void noteRelayEdge(bool on);
+
+// Track firings and checkpoint the counters (call every loop)
+void updateEnergyMeter();
+
+EnergySnapshot getEnergySnapshot();
+const EnergySettings& getEnergySettings();
+
+// Validate and store new settings; energy already counted is unchanged
+bool saveEnergySettings(const EnergySettings& settings, String& error);
+
+// Zero "firing", "programs" or "lifetime" (which also zeroes the others)
+bool resetEnergyCounters(const String& which);
+
+inline float energyKWh(const EnergyCounter& counter) {
+    return counter.wattMillis / 3.6e9f;
+}
+
+#endif // ENERGY_METER_H
@@ -0,0 +1,62 @@
+#include "file_range.h"
+#include <string.h>
+
+// Decimal digits at text, up to a non-digit. Returns false when there are
+// none or the value does not fit.
+static bool parseOffset(const char*& text, size_t& value) {
+  if (*text < '0' || *text > '9') return false;
+  value = 0;
+  while (*text >= '0' && *text <= '9') {
+    size_t next = value * 10 + (*text - '0');
+    if (next / 10 != value) return false;
+    value = next;
+    text++;
+  }
+  return true;
+}
+
+static const char* skipSpaces(const char* text) {
+  while (*text == ' ' || *text == '\t') text++;
+  return text;
+}
+
+FileRangeResult parseFileRange(const char* header, size_t size, size_t& start, size_t& end) {
+  if (strncmp(header, "bytes=", 6) != 0 || strchr(header, ',')) return FILE_RANGE_FULL;
+  const char* spec = skipSpaces(header + 6);
+
+  if (*spec == '-') {
+    // Suffix range: the last N bytes
+    spec++;
+    size_t suffix;
+    if (!parseOffset(spec, suffix) || *skipSpaces(spec) != '\0') return FILE_RANGE_FULL;
+    if (suffix == 0 || size == 0) return FILE_RANGE_UNSATISFIABLE;
+    start = suffix >= size ? 0 : size - suffix;
+    end = size;
+    return FILE_RANGE_PARTIAL;
+  }
+
+  size_t from;
+  if (!parseOffset(spec, from) || *spec != '-') return FILE_RANGE_FULL;
+  spec = skipSpaces(spec + 1);
+
+  size_t to = 0;
+  bool open = *spec == '\0';
+  if (!open && (!parseOffset(spec, to) || *skipSpaces(spec) != '\0' || to < from)) return FILE_RANGE_FULL;
+  if (from >= size) return FILE_RANGE_UNSATISFIABLE;
+
+  start = from;
+  end = open || to >= size - 1 ? size : to + 1;
+  return FILE_RANGE_PARTIAL;
+}
+
+size_t fileChunkLength(size_t position, size_t end, size_t maxLen) {
+  if (position >= end) return 0;
+  size_t length = end - position < maxLen ? end - position : maxLen;
+
+  // Stop short of the next alignment boundary so later reads are aligned
+  if (length > FILE_READ_ALIGN) {
+    size_t alignedEnd = (position + length) & ~(size_t)(FILE_READ_ALIGN - 1);
+    if (alignedEnd > position) length = alignedEnd - position;
+  }
+  return length;
+}
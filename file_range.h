@@ -0,0 +1,32 @@
+#ifndef FILE_RANGE_H
+#define FILE_RANGE_H
+
+#include <stddef.h>
+
+// =================================================================
+//                  BYTE RANGES AND READ CHUNKS
+// =================================================================
+// The arithmetic behind resumable downloads (file_transfer.h): which part
+// of a file a Range header asks for, and how much of it to read for each
+// chunk of the response. No Arduino dependencies so it builds on the host
+// (tools/file_range_test.cpp).
+
+#define FILE_READ_ALIGN 512
+
+enum FileRangeResult {
+    FILE_RANGE_FULL,                  // No usable range: send the whole file
+    FILE_RANGE_PARTIAL,               // Send [start, end) with 206
+    FILE_RANGE_UNSATISFIABLE          // Answer 416
+};
+
+// Parse a Range header against the file size. Only a single "bytes="
+// range is honoured; several ranges, other units and malformed headers
+// get the whole file. start and end are set for FILE_RANGE_PARTIAL.
+FileRangeResult parseFileRange(const char* header, size_t size, size_t& start, size_t& end);
+
+// Bytes to read for the chunk at position: up to maxLen and end, cut back
+// to the next FILE_READ_ALIGN boundary when more than one alignment unit
+// is wanted, so after the first chunk every read covers whole flash pages
+size_t fileChunkLength(size_t position, size_t end, size_t maxLen);
+
+#endif // FILE_RANGE_H
@@ -0,0 +1,71 @@
+#include "file_transfer.h"
+#include <memory>
+
+// Open file shared by the response filler; closed with the response
+struct FileSendState {
+  File file;
+  size_t end;        // One past the last byte to send
+};
+
+static String fileEtag(File& file) {
+  char etag[32];
+  snprintf(etag, sizeof(etag), "\"f-%x-%lx\"", (unsigned)file.size(), (unsigned long)file.getLastWrite());
+  return String(etag);
+}
+
+void sendFileWithRanges(AsyncWebServerRequest *request, const String& path, const String& contentType,
+                        const char* downloadName) {
+  std::shared_ptr<FileSendState> state = std::make_shared<FileSendState>();
+  state->file = SPIFFS.open(path, "r");
+  if (!state->file || state->file.isDirectory()) {
+    request->send(404, "text/plain", "File not found");
+    return;
+  }
+
+  size_t size = state->file.size();
+  String etag = fileEtag(state->file);
+  size_t start = 0;
+  state->end = size;
+  bool partial = false;
+
+  if (request->hasHeader("Range")) {
+    // If-Range: resume only when the client still has this version
+    bool sameVersion = !request->hasHeader("If-Range") || request->getHeader("If-Range")->value() == etag;
+    FileRangeResult range = sameVersion ? parseFileRange(request->getHeader("Range")->value().c_str(), size, start, state->end)
+                                        : FILE_RANGE_FULL;
+    if (range == FILE_RANGE_UNSATISFIABLE) {
+      AsyncWebServerResponse *response = request->beginResponse(416, "text/plain", "Range not satisfiable");
+      response->addHeader("Content-Range", "bytes */" + String(size));
+      request->send(response);
+      return;
+    }
+    partial = range == FILE_RANGE_PARTIAL;
+  }
+
+  if (start > 0 && !state->file.seek(start)) {
+    request->send(500, "text/plain", "Seek failed");
+    return;
+  }
+
+  AsyncWebServerResponse *response = request->beginResponse(contentType, state->end - start,
+    [state, start](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+      size_t position = start + index;
+      size_t read = state->file.read(buffer, fileChunkLength(position, state->end, maxLen));
+      if (position + read >= state->end) {
+        state->file.close();
+      }
+      return read;
+    });
+
+  if (partial) {
+    response->setCode(206);
+    response->addHeader("Content-Range", "bytes " + String(start) + "-" + String(state->end - 1) + "/" + String(size));
+  }
+  response->addHeader("Accept-Ranges", "bytes");
+  response->addHeader("ETag", etag);
+  response->addHeader("Cache-Control", "no-cache");
+  if (downloadName) {
+    response->addHeader("Content-Disposition", "attachment; filename=" + String(downloadName));
+  }
+  request->send(response);
+}
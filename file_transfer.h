@@ -0,0 +1,29 @@
+#ifndef FILE_TRANSFER_H
+#define FILE_TRANSFER_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <SPIFFS.h>
+#include "file_range.h"
+
+// =================================================================
+//                  RESUMABLE FILE DOWNLOADS
+// =================================================================
+// Log and file-manager downloads are served from an open SPIFFS file with
+// HTTP Range support: a single "bytes=" range is answered with 206 Partial
+// Content, so a browser that drops a long download resumes where it
+// stopped instead of starting over. Each file gets an ETag from its size
+// and modification time; an If-Range that no longer matches (the log grew
+// or was cleared) gets the whole file again.
+//
+// Reads follow the TCP send window but end on FILE_READ_ALIGN boundaries,
+// so after the first chunk every SPIFFS read covers whole flash pages.
+// The range and chunk arithmetic is in file_range.h.
+
+// Send a SPIFFS file, honouring Range and If-Range. With a download name
+// the response carries Content-Disposition: attachment. Answers 404 when
+// the file cannot be opened.
+void sendFileWithRanges(AsyncWebServerRequest *request, const String& path, const String& contentType,
+                        const char* downloadName = nullptr);
+
+#endif // FILE_TRANSFER_H
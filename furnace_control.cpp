@@ -0,0 +1,133 @@
+#include "furnace_control.h"
+#include <math.h>
+
+extern float currentTemp;
+extern bool furnaceStatus;
+extern bool pwmEnabled;
+extern unsigned long pwmCycleStart;
+extern unsigned long pwmPeriodMs;
+extern unsigned long pwmOnTimeMs;
+extern bool pwmRelayState;
+extern bool pidEnabled;
+extern float pidKp;
+extern float pidKi;
+extern float pidKd;
+extern float pidSampleTime;
+extern int pidOutputMin;
+extern int pidOutputMax;
+extern float pidSetpointWindow;
+extern float pidIntegral;
+extern float pidLastError;
+extern unsigned long pidLastTime;
+
+PidTerms pidTerms = {};
+
+static float clampFloat(float value, float low, float high) {
+  return value < low ? low : (value > high ? high : value);
+}
+
+// Run the relay on for duty of each pwmPeriodMs window
+static void drivePwmWindow(float duty, unsigned long now) {
+  pwmOnTimeMs = (unsigned long)(pwmPeriodMs * duty);
+
+  if (now - pwmCycleStart >= pwmPeriodMs) {
+    pwmCycleStart = now;
+  }
+
+  if ((now - pwmCycleStart) < pwmOnTimeMs) {
+    if (!pwmRelayState) {
+      setRelay(true);
+      pwmRelayState = true;
+    }
+  } else {
+    if (pwmRelayState) {
+      setRelay(false);
+      pwmRelayState = false;
+    }
+  }
+}
+
+ControlMode driveFurnace(float currentTargetTemp, unsigned long now) {
+  // Check if we're within the PID setpoint window
+  float tempError = fabsf(currentTargetTemp - currentTemp);
+  bool withinSetpointWindow = tempError <= pidSetpointWindow;
+
+  if (pidEnabled && withinSetpointWindow) {
+    // Use PID control when within setpoint window
+    float pidOutput = calculatePIDOutput(currentTargetTemp, currentTemp, now);
+
+    // Convert PID output (0-100) to PWM duty cycle
+    drivePwmWindow(clampFloat(pidOutput / 100.0f, 0.0f, 1.0f), now);
+    return CONTROL_MODE_PID;
+  }
+
+  if (pwmEnabled) {
+    // Use PWM control when outside setpoint window or PID disabled
+    float error = currentTargetTemp - currentTemp;
+    float maxErr = 10.0f;
+    float clampedError = clampFloat(error, -maxErr, maxErr);
+    drivePwmWindow(clampFloat((clampedError + maxErr) / (2 * maxErr), 0.0f, 1.0f), now);
+    return CONTROL_MODE_PWM;
+  }
+
+  // Simple On/Off control
+  if (currentTemp < currentTargetTemp) {
+    if (!furnaceStatus) {
+      setRelay(true);
+    }
+  } else if (currentTemp > currentTargetTemp) {
+    if (furnaceStatus) {
+      setRelay(false);
+    }
+  }
+  return CONTROL_MODE_ON_OFF;
+}
+
+float calculatePIDOutput(float setpoint, float input, unsigned long currentTime) {
+  if (!pidEnabled) return 0.0;
+
+  // Check if enough time has passed since last calculation
+  if (currentTime - pidLastTime < (unsigned long)(pidSampleTime * 1000)) {
+    return 0.0; // Return previous output if not time for new calculation
+  }
+
+  float error = setpoint - input;
+  float deltaTime = (currentTime - pidLastTime) / 1000.0; // Convert to seconds
+
+  // Proportional term
+  float proportional = pidKp * error;
+
+  // Integral term
+  pidIntegral += pidKi * error * deltaTime;
+
+  // Derivative term
+  float derivative = pidKd * (error - pidLastError) / deltaTime;
+
+  // Calculate output
+  float output = proportional + pidIntegral + derivative;
+
+  // Clamp output to min/max range
+  output = clampFloat(output, pidOutputMin, pidOutputMax);
+
+  // Anti-windup: if output is saturated, don't accumulate integral
+  if (output >= pidOutputMax || output <= pidOutputMin) {
+    pidIntegral -= pidKi * error * deltaTime;
+  }
+
+  // Update for next iteration
+  pidLastError = error;
+  pidLastTime = currentTime;
+
+  pidTerms.proportional = proportional;
+  pidTerms.integral = pidIntegral;
+  pidTerms.derivative = derivative;
+  pidTerms.output = output;
+
+  return output;
+}
+
+void resetPID() {
+  pidIntegral = 0.0;
+  pidLastError = 0.0;
+  pidLastTime = 0;
+}
@@ -0,0 +1,44 @@
+#ifndef FURNACE_CONTROL_H
+#define FURNACE_CONTROL_H
+
+#include <stdint.h>
+
+// =================================================================
+//                  FURNACE CONTROL LAW
+// =================================================================
+// Switches the relay towards a target: PID inside pidSetpointWindow,
+// proportional PWM outside it (or with PID off), plain on/off with both
+// off. The settings and state are the sketch's globals (pidKp, pwmPeriodMs,
+// pwmCycleStart, ...). Time comes in as an argument, so the same code runs
+// on millis() in loop() and on the control benchmark's virtual clock.
+//
+// No Arduino dependencies so it builds on the host (tools/host_benchmark.cpp).
+// setRelay() is provided by the build: the sketch on the controller.
+
+enum ControlMode {
+    CONTROL_MODE_ON_OFF,
+    CONTROL_MODE_PWM,
+    CONTROL_MODE_PID
+};
+
+// Terms of the last PID calculation, percent of output
+struct PidTerms {
+    float proportional;
+    float integral;
+    float derivative;
+    float output;
+};
+
+extern PidTerms pidTerms;
+
+// Switch the relay towards currentTargetTemp; now is the millisecond clock
+// the PWM window and PID timing run on. Returns the mode that decided.
+ControlMode driveFurnace(float currentTargetTemp, unsigned long now);
+
+float calculatePIDOutput(float setpoint, float input, unsigned long currentTime);
+void resetPID();
+
+// The only way control switches the heater
+void setRelay(bool on);
+
+#endif
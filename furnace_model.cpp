@@ -0,0 +1,98 @@
+#include "furnace_model.h"
+#include <math.h>
+
+// ====================================================================
+// THERMAL MODEL
+// ====================================================================
+
+void resetFurnaceModel(FurnaceModel& model, const FurnaceModelParams& params, float startC, uint32_t seed) {
+  model.params = params;
+  model.params.deadTimeSeconds = fminf(fmaxf(params.deadTimeSeconds, 0.0f), (float)(FURNACE_MODEL_DELAY_SLOTS - 1));
+  model.tempC = startC;
+  for (int i = 0; i < FURNACE_MODEL_DELAY_SLOTS; i++) {
+    model.history[i] = startC;
+  }
+  model.historyHead = 0;
+  model.secondFraction = 0;
+  model.noiseState = seed != 0 ? seed : 1;
+}
+
+// Exact solution of C dT/dt = P - k (T - ambient) over the step, so the
+// model stays stable however coarse the step is
+static void integrateFurnaceModel(FurnaceModel& model, float power, float seconds) {
+  const FurnaceModelParams& p = model.params;
+  if (p.lossWattsPerKelvin <= 0) {
+    model.tempC += power * seconds / p.heatCapacity;
+    return;
+  }
+  float settleC = p.ambientC + power / p.lossWattsPerKelvin;
+  model.tempC = settleC + (model.tempC - settleC) * expf(-p.lossWattsPerKelvin * seconds / p.heatCapacity);
+}
+
+// Steps are cut at whole seconds so the dead-time history gets one entry
+// per second however the model is driven
+void stepFurnaceModel(FurnaceModel& model, bool heaterOn, float seconds) {
+  if (seconds <= 0 || model.params.heatCapacity <= 0) return;
+
+  float power = heaterOn ? model.params.heaterWatts : 0.0f;
+  while (seconds > 0) {
+    float step = fminf(seconds, 1.0f - model.secondFraction);
+    integrateFurnaceModel(model, power, step);
+    seconds -= step;
+    model.secondFraction += step;
+    if (model.secondFraction >= 1.0f - 1e-4f) {
+      model.secondFraction = 0;
+      model.historyHead = (model.historyHead + 1) % FURNACE_MODEL_DELAY_SLOTS;
+      model.history[model.historyHead] = model.tempC;
+    }
+  }
+}
+
+// xorshift32; the model's own generator keeps benchmark runs repeatable
+static float nextNoiseUniform(FurnaceModel& model) {
+  uint32_t x = model.noiseState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  model.noiseState = x;
+  return (x >> 8) / 16777216.0f;
+}
+
+float readFurnaceModel(FurnaceModel& model) {
+  const FurnaceModelParams& p = model.params;
+
+  // Chamber temperature deadTime ago, interpolated between whole seconds
+  float delay = p.deadTimeSeconds - model.secondFraction;
+  float seen;
+  if (delay <= 0) {
+    seen = model.tempC;
+  } else {
+    int whole = (int)delay;
+    float part = delay - whole;
+    int newer = (model.historyHead + FURNACE_MODEL_DELAY_SLOTS - whole) % FURNACE_MODEL_DELAY_SLOTS;
+    int older = (newer + FURNACE_MODEL_DELAY_SLOTS - 1) % FURNACE_MODEL_DELAY_SLOTS;
+    seen = model.history[newer] + (model.history[older] - model.history[newer]) * part;
+  }
+
+  // Sum of three uniforms: near-normal with the requested deviation
+  if (p.noiseC > 0) {
+    float sum = nextNoiseUniform(model) + nextNoiseUniform(model) + nextNoiseUniform(model);
+    seen += (sum - 1.5f) * 2.0f * p.noiseC;
+  }
+  return roundf(seen * 4.0f) / 4.0f;
+}
+
+// ====================================================================
+// CONTROL FIGURES
+// ====================================================================
+
+void addControlSample(ControlQuality& quality, float target, float temp, bool relayOn, bool relayWasOn, float seconds) {
+  float error = temp - target;
+  quality.samples++;
+  quality.seconds += seconds;
+  quality.absErrorSeconds += fabsf(error) * seconds;
+  if (error > quality.maxOvershoot) quality.maxOvershoot = error;
+  if (-error > quality.maxUndershoot) quality.maxUndershoot = -error;
+  if (relayOn && !relayWasOn) quality.relayCycles++;
+  if (relayOn) quality.heaterOnSeconds += seconds;
+}
@@ -0,0 +1,61 @@
+#ifndef FURNACE_MODEL_H
+#define FURNACE_MODEL_H
+
+#include <stdint.h>
+
+// =================================================================
+//                  FURNACE THERMAL MODEL
+// =================================================================
+// A lumped thermal model of the kiln and running figures for how closely
+// control follows its target. Used by the simulated build (furnace_sim.h)
+// and the control benchmark (benchmark_engine.h). No Arduino dependencies
+// so it builds on the host.
+
+// Lumped model: one heat capacity, heated by the elements while the relay
+// is on and losing heat to the room through the walls. The thermocouple
+// sees the chamber deadTime late (heat soaking through to the junction),
+// with noise, at the MAX31855's 0.25 C resolution.
+struct FurnaceModelParams {
+    float heaterWatts;           // Element power
+    float heatCapacity;          // J/K of the chamber, load and inner brick
+    float lossWattsPerKelvin;    // Wall loss per degree above ambient
+    float ambientC;
+    float deadTimeSeconds;       // Up to FURNACE_MODEL_DELAY_SLOTS - 1
+    float noiseC;                // Standard deviation of the reading
+};
+
+// A small 230 V test kiln: 3 kW, about 360 C/h at full power from cold and
+// 50 C/h at 1200 C, ~1400 C ceiling, a 3.8 hour cooling time constant
+#define FURNACE_MODEL_DEFAULTS { 3000.0f, 30000.0f, 2.17f, 20.0f, 20.0f, 0.5f }
+
+#define FURNACE_MODEL_DELAY_SLOTS 64     // Chamber history, one slot per second
+
+struct FurnaceModel {
+    FurnaceModelParams params;
+    float tempC;                 // Chamber temperature now
+    float history[FURNACE_MODEL_DELAY_SLOTS];
+    uint8_t historyHead;         // Slot of the latest whole second
+    float secondFraction;        // Time since that slot was written
+    uint32_t noiseState;         // Seeded in reset, so runs repeat exactly
+};
+
+void resetFurnaceModel(FurnaceModel& model, const FurnaceModelParams& params, float startC, uint32_t seed = 1);
+void stepFurnaceModel(FurnaceModel& model, bool heaterOn, float seconds);
+// What the thermocouple reads now
+float readFurnaceModel(FurnaceModel& model);
+
+// How closely one run followed its target. Errors are only counted
+// while the controller is running a program.
+struct ControlQuality {
+    uint32_t samples;
+    double seconds;              // Time covered by the samples
+    double absErrorSeconds;      // Integrated |target - temp|, C*s (IAE)
+    float maxOvershoot;          // Largest temp - target, C
+    float maxUndershoot;         // Largest target - temp, C
+    uint32_t relayCycles;        // Off-to-on switches (relay wear)
+    double heaterOnSeconds;
+};
+
+void addControlSample(ControlQuality& quality, float target, float temp, bool relayOn, bool relayWasOn, float seconds);
+
+#endif
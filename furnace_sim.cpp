@@ -0,0 +1,127 @@
+#include "furnace_sim.h"
+#include "json_arena.h"
+
+extern float currentTemp;
+extern bool furnaceStatus;
+
+// ====================================================================
+// CONTROL FIGURES
+// ====================================================================
+
+static ControlBenchmark controlBenchmark;
+static uint32_t lastSampleMillis = 0;
+
+void resetControlBenchmark() {
+  controlBenchmark = ControlBenchmark();
+  controlBenchmark.loopStackLowWater = UINT32_MAX;
+  controlBenchmark.minFreeHeap = UINT32_MAX;
+  lastSampleMillis = 0;
+}
+
+void recordControlBenchmark(float target, bool controlling, bool relayWasOn, uint32_t tickMicros) {
+  static bool started = false;
+  if (!started) {
+    resetControlBenchmark();
+    started = true;
+  }
+
+  uint32_t now = millis();
+  if (controlling && lastSampleMillis != 0) {
+    addControlSample(controlBenchmark.quality, target, currentTemp, furnaceStatus, relayWasOn,
+                     (now - lastSampleMillis) / 1000.0f);
+  }
+  lastSampleMillis = controlling ? now : 0;
+
+  controlBenchmark.ticks++;
+  controlBenchmark.tickMicros += tickMicros;
+  if (tickMicros > controlBenchmark.maxTickMicros) controlBenchmark.maxTickMicros = tickMicros;
+
+  // Runs on the loop task; ESP-IDF reports the mark in bytes
+  uint32_t stackFree = uxTaskGetStackHighWaterMark(NULL);
+  if (stackFree < controlBenchmark.loopStackLowWater) controlBenchmark.loopStackLowWater = stackFree;
+  uint32_t heapFree = ESP.getFreeHeap();
+  if (heapFree < controlBenchmark.minFreeHeap) controlBenchmark.minFreeHeap = heapFree;
+}
+
+const ControlBenchmark& getControlBenchmark() {
+  return controlBenchmark;
+}
+
+// ====================================================================
+// SIMULATED THERMOCOUPLE
+// ====================================================================
+
+#ifdef SIMULATED_FURNACE
+static FurnaceModel simulatedFurnace;
+static uint32_t lastModelMillis = 0;
+
+float readSimulatedThermocouple() {
+  uint32_t now = millis();
+  if (lastModelMillis != 0) {
+    // The relay state since the last read is the one control left it in
+    stepFurnaceModel(simulatedFurnace, furnaceStatus, (now - lastModelMillis) / 1000.0f);
+  } else {
+    const FurnaceModelParams params = FURNACE_MODEL_DEFAULTS;
+    resetFurnaceModel(simulatedFurnace, params, params.ambientC, now);
+  }
+  lastModelMillis = now;
+  return readFurnaceModel(simulatedFurnace);
+}
+
+const FurnaceModel& getSimulatedFurnace() {
+  return simulatedFurnace;
+}
+#endif
+
+// ====================================================================
+// API
+// ====================================================================
+
+void handleControlBenchmarkRequest(AsyncWebServerRequest *request) {
+  const ControlBenchmark& bench = getControlBenchmark();
+  const ControlQuality& quality = bench.quality;
+  ArenaJsonDocument doc(request);
+
+  JsonObject control = doc.createNestedObject("control");
+  control["seconds"] = quality.seconds;
+  control["iae"] = quality.absErrorSeconds;
+  control["meanAbsError"] = quality.seconds > 0 ? quality.absErrorSeconds / quality.seconds : 0;
+  control["maxOvershoot"] = quality.maxOvershoot;
+  control["maxUndershoot"] = quality.maxUndershoot;
+  control["relayCycles"] = quality.relayCycles;
+  control["heaterOnSeconds"] = quality.heaterOnSeconds;
+
+  JsonObject cpu = doc.createNestedObject("tick");
+  cpu["count"] = bench.ticks;
+  cpu["avgUs"] = bench.ticks > 0 ? (uint32_t)(bench.tickMicros / bench.ticks) : 0;
+  cpu["maxUs"] = bench.maxTickMicros;
+
+  JsonObject memory = doc.createNestedObject("memory");
+  memory["heapFree"] = ESP.getFreeHeap();
+  memory["heapMinFree"] = bench.ticks > 0 ? bench.minFreeHeap : ESP.getFreeHeap();
+  memory["heapMinFreeSinceBoot"] = ESP.getMinFreeHeap();
+  memory["heapLargestBlock"] = ESP.getMaxAllocHeap();
+  memory["loopStackFree"] = bench.ticks > 0 ? bench.loopStackLowWater : 0;
+
+#ifdef SIMULATED_FURNACE
+  const FurnaceModel& model = getSimulatedFurnace();
+  JsonObject sim = doc.createNestedObject("simulated");
+  sim["tempC"] = model.tempC;
+  sim["heaterWatts"] = model.params.heaterWatts;
+  sim["heatCapacity"] = model.params.heatCapacity;
+  sim["lossWattsPerKelvin"] = model.params.lossWattsPerKelvin;
+  sim["ambientC"] = model.params.ambientC;
+  sim["deadTimeSeconds"] = model.params.deadTimeSeconds;
+  sim["noiseC"] = model.params.noiseC;
+#else
+  doc["simulated"] = false;
+#endif
+
+  AsyncWebServerResponse *response = beginJsonResponse(request, 200, doc);
+  response->addHeader("Cache-Control", "no-store");
+  request->send(response);
+
+  if (request->hasParam("reset")) {
+    resetControlBenchmark();
+  }
+}
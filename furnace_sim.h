@@ -0,0 +1,48 @@
+#ifndef FURNACE_SIM_H
+#define FURNACE_SIM_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include "config.h"
+#include "furnace_model.h"
+
+// =================================================================
+//                  SIMULATED FURNACE AND CONTROL FIGURES
+// =================================================================
+// Running figures for how well the live control loop tracks its target,
+// and the simulated thermocouple, both on the model in furnace_model.h.
+//
+// With SIMULATED_FURNACE (config.h) readTemperature() reads the model
+// instead of the MAX31855, and the relay drives the model's heater instead
+// of the pin, so the whole firmware - schedule, PID, PWM, logging, web UI,
+// TFT - runs on a bare ESP32 with nothing wired to it.
+//
+// The control figures are kept in every build. GET /api/debug/control
+// returns them with CPU time per control tick and memory low-water marks;
+// ?reset=1 starts a new measurement after reading.
+
+// Control figures of the live loop since boot or the last reset
+struct ControlBenchmark {
+    ControlQuality quality;
+    uint32_t ticks;
+    uint64_t tickMicros;         // CPU time in readTemperature() + control
+    uint32_t maxTickMicros;
+    uint32_t loopStackLowWater;  // Bytes of loop task stack never touched
+    uint32_t minFreeHeap;        // Since the last reset, unlike ESP.getMinFreeHeap()
+};
+
+// Called from the control tick in loop(); tickMicros is the time spent
+// reading the thermocouple and switching the relay
+void recordControlBenchmark(float target, bool controlling, bool relayWasOn, uint32_t tickMicros);
+const ControlBenchmark& getControlBenchmark();
+void resetControlBenchmark();
+
+#ifdef SIMULATED_FURNACE
+// The thermocouple reading; also advances the model to now
+float readSimulatedThermocouple();
+const FurnaceModel& getSimulatedFurnace();
+#endif
+
+void handleControlBenchmarkRequest(AsyncWebServerRequest *request);
+
+#endif
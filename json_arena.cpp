@@ -0,0 +1,342 @@
+#include "json_arena.h"
+#include "api_router.h"
+#include "metrics.h"
+
+// Every block carries its size so reallocate() can copy it
+struct ArenaBlockHeader {
+  uint32_t size;
+  uint32_t reserved;     // Keeps blocks 8 byte aligned
+};
+
+#define ARENA_ALIGN(n) (((n) + 7) & ~(size_t)7)
+#define ARENA_NO_BLOCK ((size_t)-1)
+
+#define JSON_ARENA_TOTAL_SIZE (JSON_ARENA_SMALL_SIZE * JSON_ARENA_SMALL_COUNT + \
+                               JSON_ARENA_MEDIUM_SIZE * JSON_ARENA_MEDIUM_COUNT + \
+                               JSON_ARENA_LARGE_SIZE * JSON_ARENA_LARGE_COUNT)
+
+alignas(8) static uint8_t arenaMemory[JSON_ARENA_TOTAL_SIZE];
+static JsonArena arenas[JSON_ARENA_COUNT];   // Sorted by capacity, smallest first
+static JsonArena fallbackArena;              // Heap only, shared by overflow requests
+static bool arenasReady = false;
+static JsonArenaStats arenaStats = {};
+
+// Arena bytes per route: the JSON document plus the serialized response.
+// Routes not listed get JSON_ARENA_DEFAULT_CAPACITY. Raise an entry when
+// /api/debug/heap shows heap allocations for the route.
+static const struct {
+  const char* path;
+  size_t capacity;
+} jsonCapacityTable[] = {
+  { "/api/debug/benchmark", JSON_ARENA_LARGE_SIZE },
+  { "/api/debug/heap",     JSON_ARENA_LARGE_SIZE },
+  { "/api/debug/profile",  JSON_ARENA_LARGE_SIZE },
+  { "/api/debug/routes",   JSON_ARENA_LARGE_SIZE },
+  { "/api/list",           JSON_ARENA_LARGE_SIZE },
+  { "/api/loadProgram",    JSON_ARENA_MEDIUM_SIZE },
+  { "/api/programs",       JSON_ARENA_LARGE_SIZE },
+  { "/api/saveProgram",    JSON_ARENA_LARGE_SIZE },
+  { "/api/scan",           JSON_ARENA_MEDIUM_SIZE },
+  { "/api/schedule",       JSON_ARENA_MEDIUM_SIZE },
+  { "/api/settings/load",  JSON_ARENA_SMALL_SIZE },
+  { "/api/status",         JSON_ARENA_MEDIUM_SIZE },
+  { "/api/theme",          JSON_ARENA_MEDIUM_SIZE },
+};
+
+size_t jsonArenaCapacityFor(const char* path) {
+  for (size_t i = 0; i < sizeof(jsonCapacityTable) / sizeof(jsonCapacityTable[0]); i++) {
+    if (strcmp(jsonCapacityTable[i].path, path) == 0) {
+      return jsonCapacityTable[i].capacity;
+    }
+  }
+  return JSON_ARENA_DEFAULT_CAPACITY;
+}
+
+static void initJsonArenas() {
+  uint8_t* next = arenaMemory;
+  int slot = 0;
+  for (int i = 0; i < JSON_ARENA_SMALL_COUNT; i++, slot++) {
+    arenas[slot].memory = next;
+    arenas[slot].capacity = JSON_ARENA_SMALL_SIZE;
+    next += JSON_ARENA_SMALL_SIZE;
+  }
+  for (int i = 0; i < JSON_ARENA_MEDIUM_COUNT; i++, slot++) {
+    arenas[slot].memory = next;
+    arenas[slot].capacity = JSON_ARENA_MEDIUM_SIZE;
+    next += JSON_ARENA_MEDIUM_SIZE;
+  }
+  for (int i = 0; i < JSON_ARENA_LARGE_COUNT; i++, slot++) {
+    arenas[slot].memory = next;
+    arenas[slot].capacity = JSON_ARENA_LARGE_SIZE;
+    next += JSON_ARENA_LARGE_SIZE;
+  }
+  arenasReady = true;
+}
+
+// ====================================================================
+// ALLOCATOR
+// ====================================================================
+
+JsonArena::JsonArena()
+  : memory(nullptr), capacity(0), top(0), last(ARENA_NO_BLOCK), peak(0), body(nullptr), owner(nullptr), route(nullptr) {}
+
+bool JsonArena::owns(const void* pointer) const {
+  const uint8_t* p = (const uint8_t*)pointer;
+  return memory && p >= memory && p < memory + capacity;
+}
+
+void* JsonArena::allocate(size_t size) {
+  observeMetric(METRIC_JSON_ALLOC, size);
+  size_t needed = sizeof(ArenaBlockHeader) + ARENA_ALIGN(size);
+  if (memory && needed <= capacity - top) {
+    ArenaBlockHeader* header = (ArenaBlockHeader*)(memory + top);
+    header->size = size;
+    last = top;
+    top += needed;
+    if (top > peak) peak = top;
+    arenaStats.arenaAllocs++;
+    if (route) route->arenaAllocs++;
+    return header + 1;
+  }
+
+  // Arena full (or this is the fallback): behave like the default allocator
+  arenaStats.heapAllocs++;
+  if (route) route->heapAllocs++;
+  return malloc(size);
+}
+
+void JsonArena::deallocate(void* pointer) {
+  if (!pointer) return;
+  if (!owns(pointer)) {
+    free(pointer);
+    return;
+  }
+
+  // Only the newest block can be given back; the rest goes with the arena
+  ArenaBlockHeader* header = (ArenaBlockHeader*)pointer - 1;
+  if ((uint8_t*)header == memory + last) {
+    top = last;
+    last = ARENA_NO_BLOCK;
+  }
+}
+
+void* JsonArena::reallocate(void* pointer, size_t newSize) {
+  if (!pointer) return allocate(newSize);
+  if (!owns(pointer)) {
+    arenaStats.heapAllocs++;
+    if (route) route->heapAllocs++;
+    return realloc(pointer, newSize);
+  }
+
+  ArenaBlockHeader* header = (ArenaBlockHeader*)pointer - 1;
+  size_t offset = (uint8_t*)header - memory;
+
+  // The newest block grows or shrinks in place (string builders, pool lists)
+  if (offset == last && ARENA_ALIGN(newSize) <= capacity - offset - sizeof(ArenaBlockHeader)) {
+    header->size = newSize;
+    top = offset + sizeof(ArenaBlockHeader) + ARENA_ALIGN(newSize);
+    if (top > peak) peak = top;
+    return pointer;
+  }
+
+  size_t oldSize = header->size;
+  void* moved = allocate(newSize);
+  if (moved) {
+    memcpy(moved, pointer, min(oldSize, newSize));
+  }
+  return moved;
+}
+
+void JsonArena::begin(const void* request, ApiRoute* route) {
+  owner = request;
+  this->route = route;
+  top = 0;
+  last = ARENA_NO_BLOCK;
+  body = nullptr;
+}
+
+void JsonArena::release() {
+  if (route && top > route->arenaPeak) {
+    route->arenaPeak = top;
+  }
+  owner = nullptr;
+  route = nullptr;
+  top = 0;
+  last = ARENA_NO_BLOCK;
+  body = nullptr;
+}
+
+// ====================================================================
+// REQUEST BINDING
+// ====================================================================
+
+JsonArena* jsonArenaFor(ApiRequest& request) {
+  if (!arenasReady) initJsonArenas();
+
+  const void* id = request.id();
+  for (int i = 0; i < JSON_ARENA_COUNT; i++) {
+    if (arenas[i].owner == id) return &arenas[i];
+  }
+
+  ApiRoute* route = apiRouter.getActiveRoute();
+  size_t wanted = route ? route->jsonCapacity : JSON_ARENA_DEFAULT_CAPACITY;
+
+  // Smallest free arena that fits, otherwise the largest free one
+  JsonArena* chosen = nullptr;
+  for (int i = 0; i < JSON_ARENA_COUNT; i++) {
+    if (arenas[i].isBusy()) continue;
+    chosen = &arenas[i];
+    if (arenas[i].capacity >= wanted) break;
+  }
+
+  if (!chosen) {
+    arenaStats.fallbackRequests++;
+    fallbackArena.route = route;
+    return &fallbackArena;
+  }
+
+  arenaStats.pooledRequests++;
+  chosen->begin(id, route);
+  request.onDisconnect([chosen]() { chosen->release(); });
+  return chosen;
+}
+
+const char* serializeJsonToArena(ApiRequest& request, const JsonDocument& doc, size_t& length) {
+  JsonArena* arena = jsonArenaFor(request);
+  length = measureJson(doc);
+
+  char* buffer = (char*)arena->allocate(length + 1);
+  if (buffer && arena->owns(buffer)) {
+    serializeJson(doc, buffer, length + 1);
+    return buffer;
+  }
+  arena->deallocate(buffer);
+  return nullptr;
+}
+
+void sendJson(ApiRequest& request, int code, const JsonDocument& doc) {
+  size_t length;
+  const char* buffer = serializeJsonToArena(request, doc, length);
+  if (buffer) {
+    request.sendNoCopy(code, "application/json", (const uint8_t*)buffer, length);
+    return;
+  }
+
+  // No arena room: the response owns a heap copy as before
+  String json;
+  serializeJson(doc, json);
+  request.send(code, "application/json", json);
+}
+
+// ====================================================================
+// REQUEST BODIES
+// ====================================================================
+
+ApiBodyHandler collectBody(size_t maxSize, ApiBodyHandler handler) {
+  return [maxSize, handler](ApiRequest& request, uint8_t *data, size_t len, size_t index, size_t total) {
+    if (total > maxSize) {
+      if (index == 0) {
+        Serial.print("API: Body of ");
+        Serial.print(total);
+        Serial.print(" bytes rejected for ");
+        Serial.println(request.url());
+        request.send(413, "application/json", "{\"success\":false,\"error\":\"Request body too large\"}");
+      }
+      return;
+    }
+
+    if (index == 0 && len == total) {
+      handler(request, data, len, 0, total);
+      return;
+    }
+
+    JsonArena* arena = jsonArenaFor(request);
+    uint8_t* body = nullptr;
+    if (index == 0) {
+      void* buffer = arena->allocate(total);
+      if (buffer && arena->owns(buffer)) {
+        body = (uint8_t*)buffer;
+        arena->body = body;
+      } else {
+        arena->deallocate(buffer);
+        body = (uint8_t*)malloc(total);
+        request.setTempObject(body);  // Freed by the server with the request
+      }
+      if (!body) {
+        request.send(503, "application/json", "{\"success\":false,\"error\":\"Out of memory\"}");
+        return;
+      }
+    } else {
+      body = arena->isPooled() && arena->body ? arena->body : (uint8_t*)request.getTempObject();
+      if (!body) return;  // First chunk could not be buffered and was answered
+    }
+
+    if (index + len > total) return;
+    memcpy(body + index, data, len);
+    if (index + len == total) {
+      handler(request, body, total, 0, total);
+    }
+  };
+}
+
+int getJsonArenaCount() {
+  if (!arenasReady) initJsonArenas();
+  return JSON_ARENA_COUNT;
+}
+
+const JsonArena& getJsonArena(int index) {
+  return arenas[index];
+}
+
+const JsonArenaStats& getJsonArenaStats() {
+  return arenaStats;
+}
+
+// ====================================================================
+// DEBUG ENDPOINT
+// ====================================================================
+
+void handleApiHeapRequest(ApiRequest& request) {
+  ArenaJsonDocument doc(request);
+  uint32_t freeHeap = ESP.getFreeHeap();
+  uint32_t largestBlock = ESP.getMaxAllocHeap();
+  doc["uptime"] = millis() / 1000;
+  doc["heapSize"] = ESP.getHeapSize();
+  doc["freeHeap"] = freeHeap;
+  doc["minFreeHeap"] = ESP.getMinFreeHeap();
+  doc["largestFreeBlock"] = largestBlock;
+  doc["fragmentationPercent"] = freeHeap > 0 ? 100 - (largestBlock * 100) / freeHeap : 0;
+
+  const JsonArenaStats& stats = getJsonArenaStats();
+  JsonObject arena = doc.createNestedObject("arena");
+  arena["pooledRequests"] = stats.pooledRequests;
+  arena["fallbackRequests"] = stats.fallbackRequests;
+  arena["arenaAllocs"] = stats.arenaAllocs;
+  arena["heapAllocs"] = stats.heapAllocs;
+  JsonArray slots = arena.createNestedArray("slots");
+  for (int i = 0; i < getJsonArenaCount(); i++) {
+    const JsonArena& slot = getJsonArena(i);
+    JsonObject entry = slots.createNestedObject();
+    entry["capacity"] = slot.capacity;
+    entry["busy"] = slot.isBusy();
+    entry["peak"] = slot.peak;
+  }
+
+  // Only routes that have been used, to keep the response inside its arena
+  JsonArray routes = doc.createNestedArray("routes");
+  for (int i = 0; i < apiRouter.getRouteCount(); i++) {
+    const ApiRoute& route = apiRouter.getRoute(i);
+    if (route.requests == 0) continue;
+    JsonObject entry = routes.createNestedObject();
+    entry["method"] = ApiRouter::methodName(route.method);
+    entry["path"] = route.path;
+    entry["requests"] = route.requests;
+    entry["capacity"] = route.jsonCapacity;
+    entry["arenaAllocs"] = route.arenaAllocs;
+    entry["heapAllocs"] = route.heapAllocs;
+    entry["arenaPeak"] = route.arenaPeak;
+  }
+
+  request.addHeader("Cache-Control", "no-store");
+  sendJson(request, 200, doc);
+}
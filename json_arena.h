@@ -0,0 +1,123 @@
+#ifndef JSON_ARENA_H
+#define JSON_ARENA_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "api_request.h"
+
+// Only the AsyncWebServer adapters below name these (api_async.cpp)
+class AsyncWebServerRequest;
+class AsyncWebServerResponse;
+
+// =================================================================
+//                  REQUEST JSON ARENAS
+// =================================================================
+// Every API request used to build its JSON document and response String
+// from malloc with sizes between a few bytes and several KB. With a few
+// browsers polling at once those blocks were freed out of order and the
+// largest free heap block (ESP.getMaxAllocHeap) shrank over days of uptime.
+//
+// Requests now draw their JSON documents and response buffers from a bump
+// arena: a fixed block set aside at boot and never freed. The arena is
+// picked from the route's entry in the capacity table (json_arena.cpp),
+// reset in one shot when the request disconnects, and anything that does
+// not fit - or a request arriving while every arena is busy - falls back
+// to the heap and is counted so /api/debug/heap shows when the table
+// needs retuning.
+
+// Arena size classes, all carved from one static block
+#define JSON_ARENA_SMALL_SIZE 1536
+#define JSON_ARENA_SMALL_COUNT 3
+#define JSON_ARENA_MEDIUM_SIZE 6144
+#define JSON_ARENA_MEDIUM_COUNT 2
+#define JSON_ARENA_LARGE_SIZE 12288
+#define JSON_ARENA_LARGE_COUNT 1
+#define JSON_ARENA_COUNT (JSON_ARENA_SMALL_COUNT + JSON_ARENA_MEDIUM_COUNT + JSON_ARENA_LARGE_COUNT)
+
+// Capacity assumed for routes missing from the capacity table
+#define JSON_ARENA_DEFAULT_CAPACITY JSON_ARENA_SMALL_SIZE
+
+// Request body caps for collectBody(). Larger bodies get 413 on their
+// first chunk, before anything is buffered.
+#define REQUEST_BODY_MAX 2048
+#define REQUEST_BODY_MAX_THEME 4096
+#define REQUEST_BODY_MAX_SCHEDULE 8192     // A full day at the finest resolution as JSON
+
+struct ApiRoute;
+
+class JsonArena : public ArduinoJson::Allocator {
+public:
+    JsonArena();
+
+    void* allocate(size_t size) override;
+    void deallocate(void* pointer) override;
+    void* reallocate(void* pointer, size_t newSize) override;
+
+    // Hand the arena to a request (ApiRequest::id()); attributes
+    // allocations to the route
+    void begin(const void* request, ApiRoute* route);
+    void release();
+
+    bool owns(const void* pointer) const;
+    bool isPooled() const { return memory != nullptr; }
+    bool isBusy() const { return owner != nullptr; }
+
+    uint8_t* memory;                  // nullptr for the heap fallback
+    size_t capacity;
+    size_t top;                       // Bytes used by the current request
+    size_t last;                      // Offset of the newest block, for in-place growth
+    size_t peak;                      // Most bytes one request has used
+    uint8_t* body;                    // Request body being collected, see collectBody()
+    const void* owner;                // ApiRequest::id() of the request using it
+    ApiRoute* route;
+};
+
+// Totals since boot, reported by /api/debug/heap
+struct JsonArenaStats {
+    uint32_t pooledRequests;          // Requests served from an arena
+    uint32_t fallbackRequests;        // Requests that found every arena busy
+    uint32_t arenaAllocs;             // Allocations served from an arena
+    uint32_t heapAllocs;              // Allocations that went to the heap
+};
+
+// Arena bytes a route should get, from the capacity table
+size_t jsonArenaCapacityFor(const char* path);
+
+// The request's arena, claimed on first use. The arena is released from
+// the request's onDisconnect callback, so handlers must not set their own.
+JsonArena* jsonArenaFor(ApiRequest& request);
+JsonArena* jsonArenaFor(AsyncWebServerRequest *request);
+
+// A JSON document whose memory comes from the request's arena
+class ArenaJsonDocument : public JsonDocument {
+public:
+    explicit ArenaJsonDocument(ApiRequest& request)
+        : JsonDocument(jsonArenaFor(request)) {}
+    explicit ArenaJsonDocument(AsyncWebServerRequest *request)
+        : JsonDocument(jsonArenaFor(request)) {}
+};
+
+// Serialize a document into the request's arena and send it without
+// copying it into a String (the arena outlives the response).
+// serializeJsonToArena() returns nullptr when the arena has no room.
+const char* serializeJsonToArena(ApiRequest& request, const JsonDocument& doc, size_t& length);
+void sendJson(ApiRequest& request, int code, const JsonDocument& doc);
+AsyncWebServerResponse* beginJsonResponse(AsyncWebServerRequest *request, int code, const JsonDocument& doc);
+void sendJson(AsyncWebServerRequest *request, int code, const JsonDocument& doc);
+
+// Wrap a body handler so it runs once with the complete body (index 0,
+// len == total). Bodies arriving in one packet are passed through as is;
+// split bodies are collected in the request's arena, or a heap buffer the
+// server frees with the request when the arena is too small.
+ApiBodyHandler collectBody(size_t maxSize, ApiBodyHandler handler);
+std::function<void(AsyncWebServerRequest*, uint8_t*, size_t, size_t, size_t)> collectBody(
+    size_t maxSize, std::function<void(AsyncWebServerRequest*, uint8_t*, size_t, size_t, size_t)> handler);
+
+int getJsonArenaCount();
+const JsonArena& getJsonArena(int index);
+const JsonArenaStats& getJsonArenaStats();
+
+// GET /api/debug/heap: heap fragmentation and arena usage per route
+void handleApiHeapRequest(ApiRequest& request);
+
+#endif // JSON_ARENA_H
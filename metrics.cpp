@@ -0,0 +1,247 @@
+#include "metrics.h"
+#include "api_router.h"
+#include "json_arena.h"
+#include <ESPAsyncWebServer.h>
+#include "wifi_manager.h"
+#include "energy_meter.h"
+
+extern float currentTemp;
+extern bool furnaceStatus;
+extern bool systemEnabled;
+extern bool thermocoupleError;
+
+std::atomic<uint32_t> metricCounters[METRIC_COUNTER_COUNT];
+std::atomic<float> metricGauges[METRIC_GAUGE_COUNT];
+
+// Bucket bases: 128 us control jitter, 16 us thermocouple reads, 256 us
+// log writes, 1 ms TFT frames and screen switches, 16 byte JSON allocations
+MetricHistogramSlots metricHistograms[METRIC_HISTOGRAM_COUNT] = {
+  { 7 }, { 4 }, { 8 }, { 10 }, { 10 }, { 4 }
+};
+
+struct MetricInfo {
+    const char* name;
+    const char* help;
+};
+
+static const MetricInfo counterInfo[METRIC_COUNTER_COUNT] = {
+  { "furnace_control_ticks_total", "Control loop ticks" },
+  { "furnace_thermocouple_reads_total", "Thermocouple reads" },
+  { "furnace_thermocouple_faults_total", "Thermocouple reads rejected as faulty" },
+  { "furnace_relay_toggles_total", "Relay switches on or off" },
+  { nullptr, nullptr },               // Served as furnace_relay_on_seconds_total
+  { "furnace_log_writes_total", "Temperature log lines written" },
+  { "furnace_log_bytes_total", "Temperature log bytes written" },
+  { "furnace_log_errors_total", "Temperature log writes that failed" },
+};
+
+static const MetricInfo gaugeInfo[METRIC_GAUGE_COUNT] = {
+  { "furnace_pid_proportional", "PID proportional term at the last calculation" },
+  { "furnace_pid_integral", "PID integral term at the last calculation" },
+  { "furnace_pid_derivative", "PID derivative term at the last calculation" },
+  { "furnace_pid_output", "PID output in percent at the last calculation" },
+};
+
+// Histograms in microseconds are served in seconds
+static const struct {
+  MetricInfo info;
+  bool micros;
+} histogramInfo[METRIC_HISTOGRAM_COUNT] = {
+  { { "furnace_control_tick_lateness_seconds", "How far control ticks started past their period" }, true },
+  { { "furnace_thermocouple_read_seconds", "Thermocouple read time" }, true },
+  { { "furnace_log_write_seconds", "Temperature log write time" }, true },
+  { { "furnace_tft_frame_seconds", "TFT UI update time per frame" }, true },
+  { { "furnace_tft_screen_switch_seconds", "TFT screen switch time, cached or redrawn" }, true },
+  { { "furnace_json_alloc_bytes", "JSON arena allocation sizes" }, false },
+};
+
+static uint32_t relayOnSince = 0;
+static bool relayOn = false;
+
+void recordRelayChange(bool on) {
+  if (on == relayOn) return;
+  uint32_t now = millis();
+  if (on) {
+    relayOnSince = now;
+  } else {
+    countMetric(METRIC_RELAY_ON_MILLIS, now - relayOnSince);
+  }
+  relayOn = on;
+  countMetric(METRIC_RELAY_TOGGLES);
+}
+
+uint32_t getRelayOnMillis() {
+  uint32_t total = metricCounters[METRIC_RELAY_ON_MILLIS].load(std::memory_order_relaxed);
+  if (relayOn) total += millis() - relayOnSince;
+  return total;
+}
+
+// ====================================================================
+// TEXT EXPOSITION
+// ====================================================================
+
+static void printHeader(Print& out, const char* name, const char* help, const char* type) {
+  out.print("# HELP ");
+  out.print(name);
+  out.print(' ');
+  out.println(help);
+  out.print("# TYPE ");
+  out.print(name);
+  out.print(' ');
+  out.println(type);
+}
+
+static void printSample(Print& out, const char* name, double value, int digits = 0) {
+  out.print(name);
+  out.print(' ');
+  out.println(value, digits);
+}
+
+static void printSample(Print& out, const char* name, const char* suffix, const char* labels, double value, int digits = 0) {
+  out.print(name);
+  out.print(suffix);
+  if (labels) {
+    out.print('{');
+    out.print(labels);
+    out.print('}');
+  }
+  out.print(' ');
+  out.println(value, digits);
+}
+
+// Cumulative buckets in Prometheus form; bucket i ends below bound << i
+static void printHistogram(Print& out, const char* name, const char* labels, const uint32_t* buckets, int bucketCount,
+                           uint32_t bound, uint64_t sum, uint32_t count, double scale) {
+  uint64_t cumulative = 0;
+  for (int i = 0; i < bucketCount; i++) {
+    cumulative += buckets[i];
+    out.print(name);
+    out.print("_bucket{");
+    if (labels) {
+      out.print(labels);
+      out.print(',');
+    }
+    out.print("le=\"");
+    if (i == bucketCount - 1) {
+      out.print("+Inf");
+    } else {
+      out.print(((double)bound * (1UL << i)) * scale, scale < 1 ? 6 : 0);
+    }
+    out.print("\"} ");
+    out.println((double)cumulative, 0);
+  }
+  printSample(out, name, "_sum", labels, sum * scale, scale < 1 ? 6 : 0);
+  printSample(out, name, "_count", labels, count);
+}
+
+static void printMetrics(Print& out) {
+  for (int i = 0; i < METRIC_COUNTER_COUNT; i++) {
+    if (!counterInfo[i].name) continue;
+    printHeader(out, counterInfo[i].name, counterInfo[i].help, "counter");
+    printSample(out, counterInfo[i].name, metricCounters[i].load(std::memory_order_relaxed));
+  }
+  printHeader(out, "furnace_relay_on_seconds_total", "Time the relay has been on", "counter");
+  printSample(out, "furnace_relay_on_seconds_total", getRelayOnMillis() / 1000.0, 3);
+
+  // Metered at relay edges (energy_meter.h); survives reboots
+  EnergySnapshot energy = getEnergySnapshot();
+  printHeader(out, "furnace_energy_kwh_total", "Element energy since the counters were reset", "counter");
+  printSample(out, "furnace_energy_kwh_total", energyKWh(energy.lifetime), 4);
+  printHeader(out, "furnace_firing_energy_kwh", "Element energy of the current or last firing", "gauge");
+  printSample(out, "furnace_firing_energy_kwh", energyKWh(energy.firing), 4);
+  printHeader(out, "furnace_program_energy_kwh_total", "Element energy per program slot", "counter");
+  for (int i = 0; i < MAX_PROGRAMS; i++) {
+    if (energy.programs[i].onMillis == 0) continue;
+    char labels[16];
+    snprintf(labels, sizeof(labels), "program=\"%d\"", i);
+    printSample(out, "furnace_program_energy_kwh_total", "", labels, energyKWh(energy.programs[i]), 4);
+  }
+  printHeader(out, "furnace_firings_total", "Firings started since the counters were reset", "counter");
+  printSample(out, "furnace_firings_total", energy.firings);
+  printHeader(out, "furnace_element_watts", "Configured element power", "gauge");
+  printSample(out, "furnace_element_watts", getEnergySettings().elementWatts);
+
+  for (int i = 0; i < METRIC_GAUGE_COUNT; i++) {
+    printHeader(out, gaugeInfo[i].name, gaugeInfo[i].help, "gauge");
+    printSample(out, gaugeInfo[i].name, metricGauges[i].load(std::memory_order_relaxed), 3);
+  }
+
+  printHeader(out, "furnace_temperature_celsius", "Thermocouple temperature", "gauge");
+  printSample(out, "furnace_temperature_celsius", currentTemp, 2);
+  printHeader(out, "furnace_relay_on", "Relay state", "gauge");
+  printSample(out, "furnace_relay_on", furnaceStatus ? 1 : 0);
+  printHeader(out, "furnace_system_enabled", "Heating program enabled", "gauge");
+  printSample(out, "furnace_system_enabled", systemEnabled ? 1 : 0);
+  printHeader(out, "furnace_thermocouple_error", "Thermocouple in error state", "gauge");
+  printSample(out, "furnace_thermocouple_error", thermocoupleError ? 1 : 0);
+
+  for (int i = 0; i < METRIC_HISTOGRAM_COUNT; i++) {
+    MetricHistogramSlots& slots = metricHistograms[i];
+    uint32_t buckets[METRIC_HISTOGRAM_BUCKETS];
+    for (int b = 0; b < METRIC_HISTOGRAM_BUCKETS; b++) {
+      buckets[b] = slots.buckets[b].load(std::memory_order_relaxed);
+    }
+    printHeader(out, histogramInfo[i].info.name, histogramInfo[i].info.help, "histogram");
+    printHistogram(out, histogramInfo[i].info.name, nullptr, buckets, METRIC_HISTOGRAM_BUCKETS,
+                   1UL << slots.baseShift, slots.sum.load(std::memory_order_relaxed),
+                   slots.count.load(std::memory_order_relaxed), histogramInfo[i].micros ? 1e-6 : 1);
+  }
+
+  // Per-route API figures kept by the dispatch table
+  printHeader(out, "furnace_http_request_duration_seconds", "API handler time per route", "histogram");
+  for (int i = 0; i < apiRouter.getRouteCount(); i++) {
+    const ApiRoute& route = apiRouter.getRoute(i);
+    uint32_t calls = ApiRouter::getCallCount(route);
+    if (calls == 0) continue;
+    char labels[96];
+    snprintf(labels, sizeof(labels), "path=\"%s\",method=\"%s\"", route.path, ApiRouter::methodName(route.method));
+    printHistogram(out, "furnace_http_request_duration_seconds", labels, route.latencyBuckets, API_LATENCY_BUCKETS,
+                   API_LATENCY_BUCKET_MICROS, route.handlerMicros, calls, 1e-6);
+  }
+  printHeader(out, "furnace_http_requests_total", "API requests per route", "counter");
+  for (int i = 0; i < apiRouter.getRouteCount(); i++) {
+    const ApiRoute& route = apiRouter.getRoute(i);
+    if (route.requests == 0) continue;
+    char labels[96];
+    snprintf(labels, sizeof(labels), "path=\"%s\",method=\"%s\"", route.path, ApiRouter::methodName(route.method));
+    printSample(out, "furnace_http_requests_total", "", labels, route.requests);
+  }
+
+  const JsonArenaStats& arena = getJsonArenaStats();
+  printHeader(out, "furnace_json_allocations_total", "JSON document allocations by source", "counter");
+  printSample(out, "furnace_json_allocations_total", "", "source=\"arena\"", arena.arenaAllocs);
+  printSample(out, "furnace_json_allocations_total", "", "source=\"heap\"", arena.heapAllocs);
+  printHeader(out, "furnace_json_arena_busy_total", "Requests that found every JSON arena busy", "counter");
+  printSample(out, "furnace_json_arena_busy_total", arena.fallbackRequests);
+
+  printHeader(out, "furnace_heap_free_bytes", "Free heap", "gauge");
+  printSample(out, "furnace_heap_free_bytes", ESP.getFreeHeap());
+  printHeader(out, "furnace_heap_largest_block_bytes", "Largest allocatable heap block", "gauge");
+  printSample(out, "furnace_heap_largest_block_bytes", ESP.getMaxAllocHeap());
+  printHeader(out, "furnace_heap_min_free_bytes", "Lowest free heap since boot", "gauge");
+  printSample(out, "furnace_heap_min_free_bytes", ESP.getMinFreeHeap());
+
+  const WifiMetrics& wifi = getWifiMetrics();
+  printHeader(out, "furnace_wifi_connected", "Station connected", "gauge");
+  printSample(out, "furnace_wifi_connected", wifiConnected ? 1 : 0);
+  printHeader(out, "furnace_wifi_rssi_dbm", "Station signal strength", "gauge");
+  printSample(out, "furnace_wifi_rssi_dbm", wifiConnected ? WiFi.RSSI() : 0);
+  printHeader(out, "furnace_wifi_connect_attempts_total", "Station connection attempts", "counter");
+  printSample(out, "furnace_wifi_connect_attempts_total", wifi.attempts);
+  printHeader(out, "furnace_wifi_connect_failures_total", "Station connection attempts that failed", "counter");
+  printSample(out, "furnace_wifi_connect_failures_total", wifi.failures);
+  printHeader(out, "furnace_wifi_disconnects_total", "Station links lost", "counter");
+  printSample(out, "furnace_wifi_disconnects_total", wifi.disconnects);
+  printHeader(out, "furnace_wifi_last_outage_seconds", "Link lost to address regained, last reconnect", "gauge");
+  printSample(out, "furnace_wifi_last_outage_seconds", wifi.lastOutageMillis / 1000.0, 3);
+
+  printHeader(out, "furnace_uptime_seconds", "Time since boot", "counter");
+  printSample(out, "furnace_uptime_seconds", millis() / 1000.0, 3);
+}
+
+void handleMetricsRequest(AsyncWebServerRequest *request) {
+  AsyncResponseStream *response = request->beginResponseStream("text/plain; version=0.0.4");
+  response->addHeader("Cache-Control", "no-cache");
+  printMetrics(*response);
+  request->send(response);
+}
@@ -0,0 +1,99 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include <atomic>
+
+class AsyncWebServerRequest;
+
+// =================================================================
+//                  METRICS REGISTRY
+// =================================================================
+// Fixed slots of counters, gauges and histograms, served by /metrics in
+// the Prometheus text format. Every update is one relaxed atomic
+// operation on a static slot - no locks, no allocation - so updates can
+// sit on the control path.
+//
+// Histogram buckets double from a power-of-two base: bucket 0 counts
+// values below the base, bucket i values below base << i, the last one
+// everything larger. Values are recorded in the histogram's unit
+// (microseconds or bytes) and converted to seconds when scraped. Sums are
+// 32-bit and wrap, which Prometheus treats like a counter reset.
+
+#define METRIC_HISTOGRAM_BUCKETS 12
+
+enum MetricCounter {
+    METRIC_CONTROL_TICKS,
+    METRIC_THERMOCOUPLE_READS,
+    METRIC_THERMOCOUPLE_FAULTS,       // Readings rejected as faulty
+    METRIC_RELAY_TOGGLES,
+    METRIC_RELAY_ON_MILLIS,           // Completed on periods only, see getRelayOnMillis()
+    METRIC_LOG_WRITES,
+    METRIC_LOG_BYTES,
+    METRIC_LOG_ERRORS,
+    METRIC_COUNTER_COUNT
+};
+
+enum MetricGauge {
+    METRIC_PID_P,
+    METRIC_PID_I,
+    METRIC_PID_D,
+    METRIC_PID_OUTPUT,
+    METRIC_GAUGE_COUNT
+};
+
+enum MetricHistogram {
+    METRIC_CONTROL_JITTER,            // How far a tick started past its 500 ms period, us
+    METRIC_THERMOCOUPLE_READ,         // us
+    METRIC_LOG_WRITE,                 // us
+    METRIC_TFT_FRAME,                 // us
+    METRIC_TFT_SWITCH,                // Screen switch to new content on the panel, us
+    METRIC_JSON_ALLOC,                // bytes
+    METRIC_HISTOGRAM_COUNT
+};
+
+struct MetricHistogramSlots {
+    constexpr MetricHistogramSlots(uint8_t baseShift)
+        : baseShift(baseShift), buckets{}, count(0), sum(0) {}
+
+    uint8_t baseShift;                // Bucket 0 holds values below 1 << baseShift
+    std::atomic<uint32_t> buckets[METRIC_HISTOGRAM_BUCKETS];
+    std::atomic<uint32_t> count;
+    std::atomic<uint64_t> sum;        // 32 bits of microseconds wrap in about 71 minutes
+};
+
+extern std::atomic<uint32_t> metricCounters[METRIC_COUNTER_COUNT];
+extern std::atomic<float> metricGauges[METRIC_GAUGE_COUNT];
+extern MetricHistogramSlots metricHistograms[METRIC_HISTOGRAM_COUNT];
+
+inline void countMetric(MetricCounter counter, uint32_t amount = 1) {
+    metricCounters[counter].fetch_add(amount, std::memory_order_relaxed);
+}
+
+inline void setMetricGauge(MetricGauge gauge, float value) {
+    metricGauges[gauge].store(value, std::memory_order_relaxed);
+}
+
+inline float getMetricGauge(MetricGauge gauge) {
+    return metricGauges[gauge].load(std::memory_order_relaxed);
+}
+
+inline void observeMetric(MetricHistogram histogram, uint32_t value) {
+    MetricHistogramSlots& slots = metricHistograms[histogram];
+    uint32_t scaled = value >> slots.baseShift;
+    int bucket = scaled ? 32 - __builtin_clz(scaled) : 0;
+    if (bucket >= METRIC_HISTOGRAM_BUCKETS) bucket = METRIC_HISTOGRAM_BUCKETS - 1;
+    slots.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    slots.count.fetch_add(1, std::memory_order_relaxed);
+    slots.sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+// Relay transitions, for toggles and on-time (call from the control loop)
+void recordRelayChange(bool on);
+// Relay on-time since boot including the current on period
+uint32_t getRelayOnMillis();
+
+// GET /metrics
+void handleMetricsRequest(AsyncWebServerRequest *request);
+
+#endif // METRICS_H
@@ -0,0 +1,546 @@
+#include "mqtt_telemetry.h"
+#include "config.h"
+#include "metrics.h"
+#include "json_arena.h"
+#include "schedule_batch.h"
+#include "web_server_handler.h"
+#include <ArduinoJson.h>
+#include <Preferences.h>
+#include <SPIFFS.h>
+#include <WiFi.h>
+#include <mqtt_client.h>
+
+extern bool thermocoupleError;
+extern bool timeIsSynchronized;
+
+struct TelemetrySample {
+  uint32_t time;                      // Unix time, 0 before the clock is set
+  int16_t temp;                       // Tenths of a degree, or TELEMETRY_NO_READING
+  int16_t target;                     // Tenths of a degree, or TELEMETRY_NO_READING
+  uint8_t duty;                       // Relay on-time over the sample period, percent
+  uint8_t flags;                      // TELEMETRY_FLAG_*
+} __attribute__((packed));
+
+#define SAMPLE_SIZE sizeof(TelemetrySample)
+#define TELEMETRY_NO_READING INT16_MIN   // Sent as null
+
+static MqttSettings settings;
+static bool started = false;
+static esp_mqtt_client_handle_t client = nullptr;
+static volatile bool restartRequested = false;
+static String deviceId;
+static String telemetryTopic;
+static String statusTopic;
+static String resultTopic;
+static String commandPrefix;          // "<topic>/cmd/"
+
+// Queue, oldest first: the in-flight batch, the spill file, then the ring
+static TelemetrySample ring[MQTT_RING_SAMPLES];
+static int ringHead = 0;
+static int ringCount = 0;
+static uint32_t spillSize = 0;        // Whole samples in the spill file, bytes
+static uint32_t spillReadOffset = 0;  // Bytes already moved into a batch
+
+// The batch waiting for its PUBACK
+static TelemetrySample inFlight[MQTT_MAX_BATCH];
+static int inFlightCount = 0;
+static int inFlightMsgId = -1;        // -1: not in the outbox, -2: the outbox refused it
+static uint32_t inFlightSeq = 0;
+static uint32_t inFlightSentAt = 0;
+static uint8_t inFlightAttempts = 0;
+static uint32_t nextSeq = 1;
+
+static uint32_t lastSampleMillis = 0;
+static uint32_t lastRelayOnMillis = 0;
+static bool wasConnected = false;
+static MqttStats stats;
+
+// Written by the MQTT task, consumed by loop()
+static portMUX_TYPE mqttMux = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool linkUp = false;
+static volatile int ackedMsgId = -1;
+static volatile int deletedMsgId = -1;  // Dropped from the outbox unacknowledged
+static char* pendingCommand = nullptr;
+static size_t pendingCommandLength = 0;
+static char pendingCommandName[16];
+
+// A command split over several DATA events (MQTT task only)
+static char* partialCommand = nullptr;
+static size_t partialCommandLength = 0;
+static char partialCommandName[16];
+
+// ====================================================================
+// SETTINGS
+// ====================================================================
+
+static void loadSettings() {
+  Preferences prefs;
+  prefs.begin("mqtt", true);
+  settings.enabled = prefs.getBool("enabled", false);
+  settings.uri = prefs.getString("uri", "");
+  settings.username = prefs.getString("user", "");
+  settings.password = prefs.getString("pass", "");
+  settings.topic = prefs.getString("topic", MQTT_DEFAULT_TOPIC);
+  settings.sampleSeconds = prefs.getUShort("interval", MQTT_DEFAULT_SAMPLE_SECONDS);
+  settings.batchSize = prefs.getUChar("batch", MQTT_DEFAULT_BATCH);
+  prefs.end();
+
+  if (settings.sampleSeconds == 0) settings.sampleSeconds = MQTT_DEFAULT_SAMPLE_SECONDS;
+  if (settings.batchSize == 0 || settings.batchSize > MQTT_MAX_BATCH) settings.batchSize = MQTT_DEFAULT_BATCH;
+}
+
+static void buildTopics() {
+  telemetryTopic = settings.topic + "/telemetry";
+  statusTopic = settings.topic + "/status";
+  resultTopic = settings.topic + "/cmd/result";
+  commandPrefix = settings.topic + "/cmd/";
+}
+
+const MqttSettings& getMqttSettings() {
+  return settings;
+}
+
+bool saveMqttSettings(const MqttSettings& updated, String& error) {
+  if (updated.enabled && !updated.uri.startsWith("mqtt://") && !updated.uri.startsWith("mqtts://")) {
+    error = "Broker must be an mqtt:// or mqtts:// URI";
+    return false;
+  }
+  if (updated.topic.length() == 0 || updated.topic.indexOf('+') >= 0 || updated.topic.indexOf('#') >= 0) {
+    error = "Topic must be set and contain no wildcards";
+    return false;
+  }
+  if (updated.sampleSeconds < 1 || updated.sampleSeconds > 3600) {
+    error = "Sample interval must be 1-3600 seconds";
+    return false;
+  }
+  if (updated.batchSize < 1 || updated.batchSize > MQTT_MAX_BATCH) {
+    error = "Batch size must be 1-" + String(MQTT_MAX_BATCH);
+    return false;
+  }
+
+  Preferences prefs;
+  prefs.begin("mqtt", false);
+  prefs.putBool("enabled", updated.enabled);
+  prefs.putString("uri", updated.uri);
+  prefs.putString("user", updated.username);
+  prefs.putString("pass", updated.password);
+  prefs.putString("topic", updated.topic);
+  prefs.putUShort("interval", updated.sampleSeconds);
+  prefs.putUChar("batch", updated.batchSize);
+  prefs.end();
+
+  // The client is stopped and rebuilt by loop(), not the web server task
+  restartRequested = true;
+  return true;
+}
+
+// ====================================================================
+// CLIENT
+// ====================================================================
+
+static void onMqttData(esp_mqtt_event_handle_t event) {
+  if (event->current_data_offset == 0) {
+    free(partialCommand);
+    partialCommand = nullptr;
+
+    int prefixLength = commandPrefix.length();
+    int nameLength = event->topic_len - prefixLength;
+    if (nameLength <= 0 || nameLength >= (int)sizeof(partialCommandName)) return;
+    if (strncmp(event->topic, commandPrefix.c_str(), prefixLength) != 0) return;
+    memcpy(partialCommandName, event->topic + prefixLength, nameLength);
+    partialCommandName[nameLength] = '\0';
+    if (strcmp(partialCommandName, "result") == 0) return;
+    if (event->total_data_len <= 0 || event->total_data_len > REQUEST_BODY_MAX_SCHEDULE) return;
+
+    partialCommand = (char*)malloc(event->total_data_len);
+    if (!partialCommand) return;
+    partialCommandLength = event->total_data_len;
+  }
+  if (!partialCommand || event->current_data_offset + event->data_len > (int)partialCommandLength) return;
+
+  memcpy(partialCommand + event->current_data_offset, event->data, event->data_len);
+  if (event->current_data_offset + event->data_len < (int)partialCommandLength) return;
+
+  // Complete; one command waits for loop() at a time, later ones are dropped
+  portENTER_CRITICAL(&mqttMux);
+  bool accepted = pendingCommand == nullptr;
+  if (accepted) {
+    pendingCommand = partialCommand;
+    pendingCommandLength = partialCommandLength;
+    memcpy(pendingCommandName, partialCommandName, sizeof(pendingCommandName));
+  }
+  portEXIT_CRITICAL(&mqttMux);
+  if (!accepted) free(partialCommand);
+  partialCommand = nullptr;
+}
+
+// Runs on the MQTT task: record what happened, loop() acts on it
+static void onMqttEvent(void* handlerArgs, esp_event_base_t base, int32_t eventId, void* eventData) {
+  esp_mqtt_event_handle_t event = (esp_mqtt_event_handle_t)eventData;
+
+  switch ((esp_mqtt_event_id_t)eventId) {
+    case MQTT_EVENT_CONNECTED:
+      esp_mqtt_client_subscribe(event->client, (commandPrefix + "+").c_str(), 1);
+      esp_mqtt_client_publish(event->client, statusTopic.c_str(), "online", 0, 0, 1);
+      linkUp = true;
+      break;
+    case MQTT_EVENT_DISCONNECTED:
+      linkUp = false;
+      break;
+    case MQTT_EVENT_PUBLISHED:
+      ackedMsgId = event->msg_id;
+      break;
+    case MQTT_EVENT_DELETED:
+      deletedMsgId = event->msg_id;
+      break;
+    case MQTT_EVENT_DATA:
+      onMqttData(event);
+      break;
+    default:
+      break;
+  }
+}
+
+void startMqtt() {
+  if (!started || client != nullptr || !settings.enabled || settings.uri.length() == 0) return;
+
+  esp_mqtt_client_config_t config = {};
+  config.broker.address.uri = settings.uri.c_str();
+  config.credentials.client_id = deviceId.c_str();
+  if (settings.username.length() > 0) {
+    config.credentials.username = settings.username.c_str();
+    config.credentials.authentication.password = settings.password.c_str();
+  }
+  config.session.keepalive = 30;
+  config.session.last_will.topic = statusTopic.c_str();
+  config.session.last_will.msg = "offline";
+  config.session.last_will.qos = 1;
+  config.session.last_will.retain = 1;
+  config.buffer.size = 2048;
+  config.network.reconnect_timeout_ms = 10000;
+
+  client = esp_mqtt_client_init(&config);
+  if (client == nullptr) {
+    Serial.println("MQTT: Client init failed");
+    return;
+  }
+  esp_mqtt_client_register_event(client, MQTT_EVENT_ANY, onMqttEvent, nullptr);
+  esp_mqtt_client_start(client);
+
+  Serial.print("MQTT: Connecting to ");
+  Serial.println(settings.uri);
+}
+
+static void stopMqtt() {
+  if (client == nullptr) return;
+  esp_mqtt_client_stop(client);
+  esp_mqtt_client_destroy(client);
+  client = nullptr;
+  linkUp = false;
+  // The outbox went with the client
+  if (inFlightCount > 0) inFlightMsgId = -1;
+}
+
+// ====================================================================
+// QUEUE
+// ====================================================================
+
+// Move the oldest ring samples to the spill file, or drop them if it is full
+static void spillOldest() {
+  int count = min(MQTT_SPILL_CHUNK, ringCount);
+  uint32_t bytes = count * SAMPLE_SIZE;
+
+  if (spillSize + bytes <= MQTT_SPILL_MAX_BYTES) {
+    File file = SPIFFS.open(MQTT_SPILL_FILE, FILE_APPEND);
+    // A short earlier write leaves a partial sample; append nothing after it
+    if (file && file.size() == spillSize) {
+      int first = min(count, MQTT_RING_SAMPLES - ringHead);
+      size_t written = file.write((const uint8_t*)&ring[ringHead], first * SAMPLE_SIZE);
+      if (count > first) {
+        written += file.write((const uint8_t*)ring, (count - first) * SAMPLE_SIZE);
+      }
+      file.close();
+
+      spillSize += written - written % SAMPLE_SIZE;
+      if (written == bytes) {
+        ringHead = (ringHead + count) % MQTT_RING_SAMPLES;
+        ringCount -= count;
+        return;
+      }
+    } else if (file) {
+      file.close();
+    }
+  }
+
+  ringHead = (ringHead + 1) % MQTT_RING_SAMPLES;
+  ringCount--;
+  stats.dropped++;
+}
+
+// NaN (a thermocouple fault) or out of range has no int16 conversion
+static int16_t toTenths(float value) {
+  if (!(value > -3276.0f && value < 3276.0f)) return TELEMETRY_NO_READING;
+  return (int16_t)lroundf(value * 10.0f);
+}
+
+// Tenths as a JSON number, or null
+static int printTenths(char* out, size_t size, int16_t tenths) {
+  if (tenths == TELEMETRY_NO_READING) return snprintf(out, size, "null");
+  return snprintf(out, size, "%.1f", tenths / 10.0f);
+}
+
+static void takeSample(uint32_t now) {
+  uint32_t relayOn = getRelayOnMillis();
+  uint32_t elapsed = now - lastSampleMillis;
+
+  TelemetrySample sample;
+  sample.time = timeIsSynchronized ? (uint32_t)time(nullptr) : 0;
+  sample.temp = toTenths(currentTemp);
+  sample.target = toTenths(getSmoothedTargetTemperature());
+  sample.duty = elapsed > 0 ? (uint8_t)min(100UL, (unsigned long)(relayOn - lastRelayOnMillis) * 100UL / elapsed) : 0;
+  sample.flags = (furnaceStatus ? TELEMETRY_FLAG_RELAY : 0) |
+                 (systemEnabled ? TELEMETRY_FLAG_ENABLED : 0) |
+                 (thermocoupleError ? TELEMETRY_FLAG_SENSOR_ERROR : 0) |
+                 (timeIsSynchronized ? TELEMETRY_FLAG_TIME_SET : 0);
+
+  lastSampleMillis = now;
+  lastRelayOnMillis = relayOn;
+
+  if (ringCount == MQTT_RING_SAMPLES) spillOldest();
+  ring[(ringHead + ringCount) % MQTT_RING_SAMPLES] = sample;
+  ringCount++;
+}
+
+// Next batch from the spill file first, then the ring
+static bool takeBatch() {
+  int want = settings.batchSize;
+
+  if (spillReadOffset < spillSize) {
+    File file = SPIFFS.open(MQTT_SPILL_FILE, FILE_READ);
+    int count = 0;
+    if (file && file.seek(spillReadOffset)) {
+      uint32_t available = (spillSize - spillReadOffset) / SAMPLE_SIZE;
+      count = min((uint32_t)want, available);
+      count = file.read((uint8_t*)inFlight, count * SAMPLE_SIZE) / SAMPLE_SIZE;
+    }
+    if (file) file.close();
+
+    spillReadOffset += count * SAMPLE_SIZE;
+    if (count == 0 || spillReadOffset >= spillSize) {
+      // Drained (or unreadable): start a fresh file
+      stats.dropped += (spillSize - spillReadOffset) / SAMPLE_SIZE;
+      SPIFFS.remove(MQTT_SPILL_FILE);
+      spillSize = 0;
+      spillReadOffset = 0;
+    }
+    inFlightCount = count;
+    return count > 0;
+  }
+
+  if (ringCount < want) return false;
+  for (int i = 0; i < want; i++) {
+    inFlight[i] = ring[ringHead];
+    ringHead = (ringHead + 1) % MQTT_RING_SAMPLES;
+  }
+  ringCount -= want;
+  inFlightCount = want;
+  return true;
+}
+
+static void sendInFlight(uint32_t now) {
+  static char payload[160 + MQTT_MAX_BATCH * 48];
+
+  int length = snprintf(payload, sizeof(payload), "{\"device\":\"%s\",\"seq\":%lu,\"interval\":%u,\"samples\":[",
+                        deviceId.c_str(), (unsigned long)inFlightSeq, settings.sampleSeconds);
+  for (int i = 0; i < inFlightCount && length < (int)sizeof(payload); i++) {
+    const TelemetrySample& s = inFlight[i];
+    length += snprintf(payload + length, sizeof(payload) - length, "%s[%lu,", i > 0 ? "," : "", (unsigned long)s.time);
+    if (length >= (int)sizeof(payload)) break;
+    length += printTenths(payload + length, sizeof(payload) - length, s.temp);
+    if (length >= (int)sizeof(payload)) break;
+    payload[length++] = ',';
+    length += printTenths(payload + length, sizeof(payload) - length, s.target);
+    if (length >= (int)sizeof(payload)) break;
+    length += snprintf(payload + length, sizeof(payload) - length, ",%u,%u]", s.duty, s.flags);
+  }
+  if (length < (int)sizeof(payload)) {
+    length += snprintf(payload + length, sizeof(payload) - length, "]}");
+  }
+
+  if (inFlightAttempts > 0) stats.resent++;
+  inFlightAttempts++;
+  inFlightSentAt = now;
+  // Queued to the client's outbox: publish() sends from the calling task
+  // and can block loop() for the whole network timeout on a bad link
+  int msgId = esp_mqtt_client_enqueue(client, telemetryTopic.c_str(), payload, length, 1, 0, true);
+  // The outbox retransmits it until the PUBACK; a refused one is retried later
+  inFlightMsgId = msgId >= 0 ? msgId : -2;
+}
+
+static void publishNext(uint32_t now) {
+  if (inFlightCount > 0) {
+    if (inFlightMsgId >= 0) {
+      if (ackedMsgId == inFlightMsgId) {
+        inFlightCount = 0;
+        stats.published++;
+      } else if (deletedMsgId == inFlightMsgId) {
+        sendInFlight(now);
+        return;
+      } else {
+        return;
+      }
+    } else {
+      if (inFlightMsgId == -2 && now - inFlightSentAt < MQTT_ENQUEUE_RETRY_MS) return;
+      sendInFlight(now);
+      return;
+    }
+  }
+
+  if (!takeBatch()) return;
+  inFlightSeq = nextSeq++;
+  inFlightAttempts = 0;
+  sendInFlight(now);
+}
+
+// ====================================================================
+// COMMANDS
+// ====================================================================
+
+static void publishCommandResult(const char* name, JsonVariant id, int code, int updated, const String& error) {
+  JsonDocument result;
+  result["command"] = name;
+  if (!id.isNull()) result["id"] = id;
+  result["success"] = code == 200;
+  result["status"] = code;
+  if (code == 200) {
+    result["updated"] = updated;
+  } else {
+    result["error"] = error;
+  }
+
+  char payload[256];
+  size_t length = serializeJson(result, payload, sizeof(payload));
+  // QoS 0 so its ack can never be mistaken for the telemetry batch's
+  if (client != nullptr) {
+    esp_mqtt_client_enqueue(client, resultTopic.c_str(), payload, length, 0, 0, true);
+  }
+}
+
+static void applyPendingCommand() {
+  if (pendingCommand == nullptr) return;
+
+  portENTER_CRITICAL(&mqttMux);
+  char* payload = pendingCommand;
+  size_t length = pendingCommandLength;
+  char name[sizeof(pendingCommandName)];
+  memcpy(name, pendingCommandName, sizeof(name));
+  pendingCommand = nullptr;
+  portEXIT_CRITICAL(&mqttMux);
+
+  JsonDocument doc;
+  DeserializationError parseError = deserializeJson(doc, payload, length);
+  free(payload);
+
+  int code = 400;
+  int updated = 0;
+  String error;
+
+  if (parseError) {
+    error = "Invalid JSON";
+  } else if (strcmp(name, "schedule") == 0) {
+    // Same body and validation as PATCH /api/schedule
+    code = stageScheduleBatch(doc, updated, error);
+  } else if (strcmp(name, "setpoint") == 0) {
+    if (!doc.containsKey("temp")) {
+      error = "Missing temp";
+    } else {
+      JsonDocument batch;
+      JsonArray point = batch.createNestedArray("points").createNestedArray();
+      point.add(doc.containsKey("index") ? doc["index"].as<int>() : getCurrentTempIndex());
+      point.add(doc["temp"]);
+      code = stageScheduleBatch(batch, updated, error);
+    }
+  } else {
+    code = 404;
+    error = "Unknown command";
+  }
+
+  if (code == 200) stats.commands++;
+  Serial.print("MQTT: Command ");
+  Serial.print(name);
+  Serial.print(" -> ");
+  Serial.println(code);
+  publishCommandResult(name, doc["id"], code, updated, error);
+}
+
+// ====================================================================
+// MAIN
+// ====================================================================
+
+void beginMqtt() {
+  loadSettings();
+  buildTopics();
+
+  String mac = WiFi.macAddress();
+  mac.replace(":", "");
+  mac.toLowerCase();
+  deviceId = "furnace-" + mac.substring(mac.length() - 6);
+
+  // Samples a reboot left in the spill file are replayed first
+  if (SPIFFS.exists(MQTT_SPILL_FILE)) {
+    File file = SPIFFS.open(MQTT_SPILL_FILE, FILE_READ);
+    if (file) {
+      spillSize = file.size() - file.size() % SAMPLE_SIZE;
+      file.close();
+    }
+  }
+
+  lastSampleMillis = millis();
+  lastRelayOnMillis = getRelayOnMillis();
+  started = true;
+
+  Serial.print("MQTT: ");
+  Serial.println(settings.enabled ? "Telemetry enabled" : "Telemetry disabled");
+  if (WiFi.status() == WL_CONNECTED) startMqtt();
+}
+
+void updateMqtt() {
+  if (!started) return;
+  uint32_t now = millis();
+
+  if (restartRequested) {
+    restartRequested = false;
+    stopMqtt();
+    loadSettings();
+    buildTopics();
+    if (WiFi.status() == WL_CONNECTED) startMqtt();
+  }
+
+  bool connected = linkUp;
+  if (connected != wasConnected) {
+    wasConnected = connected;
+    if (connected) {
+      stats.connects++;
+      // The outbox resends anything unacknowledged on the new session
+      Serial.println("MQTT: Connected");
+    } else {
+      Serial.println("MQTT: Disconnected");
+    }
+  }
+
+  if (settings.enabled && now - lastSampleMillis >= settings.sampleSeconds * 1000UL) {
+    takeSample(now);
+  }
+
+  applyPendingCommand();
+  if (connected) publishNext(now);
+}
+
+MqttStats getMqttStats() {
+  MqttStats current = stats;
+  current.connected = linkUp;
+  current.queued = ringCount;
+  current.spilled = (spillSize - spillReadOffset) / SAMPLE_SIZE;
+  current.inFlight = inFlightCount;
+  return current;
+}
@@ -0,0 +1,80 @@
+#ifndef MQTT_TELEMETRY_H
+#define MQTT_TELEMETRY_H
+
+#include <Arduino.h>
+
+// =================================================================
+//                  MQTT TELEMETRY
+// =================================================================
+// Publishes temperature, target, relay duty and state to <topic>/telemetry
+// through the MQTT client built into the ESP32 core, several samples per
+// message:
+//
+//   {"device":"furnace-a1b2c3","seq":42,"interval":10,
+//    "samples":[[time, temp, target, duty, flags], ...]}
+//
+// time is Unix time (0 before the clock is set), temp and target are null
+// when there is no reading, duty the percentage of the sample period the
+// relay was on, flags the TELEMETRY_FLAG_* bits.
+//
+// Samples queue in a RAM ring while the broker is unreachable. Once the
+// ring is full its oldest samples move to MQTT_SPILL_FILE, and on
+// reconnect the spill file is replayed before the ring, so batches arrive
+// in sample order. Batches are QoS 1 and leave the queue only when the
+// broker acknowledges them. The client's outbox retransmits a batch until
+// then, across reconnects; it is queued again, with the same seq, only if
+// the outbox drops it (expired, or the client restarted). A consumer may
+// still see a batch twice and should dedupe on seq.
+// loop() only queues messages in the client's outbox; the MQTT task does
+// the sending, so a slow link never stalls control.
+//
+// Commands are read from <topic>/cmd/setpoint ({"temp": 800} for the
+// current slot, or with "index") and <topic>/cmd/schedule (the PATCH
+// /api/schedule body). Both go through stageScheduleBatch() like the REST
+// edits, and the outcome is published to <topic>/cmd/result.
+
+#define TELEMETRY_FLAG_RELAY 0x01
+#define TELEMETRY_FLAG_ENABLED 0x02
+#define TELEMETRY_FLAG_SENSOR_ERROR 0x04
+#define TELEMETRY_FLAG_TIME_SET 0x08
+
+struct MqttSettings {
+    bool enabled;
+    String uri;                       // e.g. mqtt://192.168.1.10:1883
+    String username;
+    String password;
+    String topic;                     // Base topic
+    uint16_t sampleSeconds;
+    uint8_t batchSize;
+};
+
+struct MqttStats {
+    bool connected;
+    uint32_t queued;                  // Samples waiting in RAM
+    uint32_t spilled;                 // Samples waiting in the spill file
+    uint32_t inFlight;                // Samples in the unacknowledged batch
+    uint32_t published;               // Batches acknowledged by the broker
+    uint32_t resent;                  // Batches queued again after the outbox dropped them
+    uint32_t dropped;                 // Samples lost with the ring and spill file full
+    uint32_t commands;                // Commands applied
+    uint32_t connects;
+};
+
+// Load settings and start sampling (boot stage; needs SPIFFS)
+void beginMqtt();
+
+// Connect to the broker if enabled (call when the station gets an IP;
+// the client reconnects by itself afterwards)
+void startMqtt();
+
+// Sample, publish, replay and apply commands (call every loop)
+void updateMqtt();
+
+const MqttSettings& getMqttSettings();
+
+// Validate, store and apply new settings; the client restarts from loop()
+bool saveMqttSettings(const MqttSettings& settings, String& error);
+
+MqttStats getMqttStats();
+
+#endif // MQTT_TELEMETRY_H
@@ -0,0 +1,66 @@
+#include "profiler.h"
+#include <algorithm>
+
+static ProfileSite* profileSites = nullptr;
+
+ProfileSite::ProfileSite(const char* siteName)
+  : name(siteName), count(0), totalCycles(0), maxCycles(0), next(profileSites) {
+  memset(buckets, 0, sizeof(buckets));
+  profileSites = this;
+}
+
+float profileCyclesToMicros(uint64_t cycles) {
+  return (float)cycles / ESP.getCpuFreqMHz();
+}
+
+float profilePercentileMicros(const ProfileSite& site, int percent) {
+  if (site.count == 0) return 0;
+
+  uint32_t wanted = ((uint64_t)site.count * percent + 99) / 100;
+  uint32_t seen = 0;
+  for (int i = 0; i < PROFILE_BUCKETS - 1; i++) {
+    seen += site.buckets[i];
+    if (seen >= wanted) {
+      return profileCyclesToMicros((uint64_t)PROFILE_BUCKET_CYCLES << i);
+    }
+  }
+  return profileCyclesToMicros(site.maxCycles);
+}
+
+void resetProfile() {
+  for (ProfileSite* site = profileSites; site; site = site->next) {
+    site->count = 0;
+    site->totalCycles = 0;
+    site->maxCycles = 0;
+    memset(site->buckets, 0, sizeof(site->buckets));
+  }
+}
+
+// Sites in report order, slowest maximum first
+std::vector<const ProfileSite*> getProfileSitesBySlowest() {
+  std::vector<const ProfileSite*> sites;
+  for (ProfileSite* site = profileSites; site; site = site->next) {
+    sites.push_back(site);
+  }
+  std::sort(sites.begin(), sites.end(), [](const ProfileSite* a, const ProfileSite* b) {
+    return a->maxCycles > b->maxCycles;
+  });
+  return sites;
+}
+
+void printProfileReport(Print& out) {
+  out.println("Profile: site, calls, avg / p99 / max (us)");
+  for (const ProfileSite* site : getProfileSitesBySlowest()) {
+    if (site->count == 0) continue;
+    out.print("  ");
+    out.print(site->name);
+    out.print(", ");
+    out.print(site->count);
+    out.print(", ");
+    out.print(profileCyclesToMicros(site->totalCycles / site->count), 1);
+    out.print(" / ");
+    out.print(profilePercentileMicros(*site, 99), 1);
+    out.print(" / ");
+    out.println(profileCyclesToMicros(site->maxCycles), 1);
+  }
+}
@@ -0,0 +1,89 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include <vector>
+
+// =================================================================
+//                  SCOPED-TIMER PROFILER
+// =================================================================
+// PROFILE_SCOPE("name") times the rest of the enclosing block with the CPU
+// cycle counter and adds it to that call site's count, total, maximum and
+// histogram:
+//
+//   { PROFILE_SCOPE("loop.dns"); handleDNS(); }
+//
+// Each site is a static registered the first time it runs, so an entered
+// scope costs two cycle counter reads and a few adds. Sites are not locked:
+// use them from one task only (loop() and the TFT code). REST handlers are
+// timed per route by the API router instead (api_router.h).
+//
+// Without PROFILE_ENABLED (config.h) the macro compiles to nothing.
+//
+// Reported by GET /api/debug/profile, runTFTDiagnostics() and
+// printProfileReport().
+
+// Histogram bucket i counts scopes shorter than (PROFILE_BUCKET_CYCLES << i)
+// cycles, about 1 us << i at 240 MHz; the last bucket is open-ended
+#define PROFILE_BUCKETS 16
+#define PROFILE_BUCKET_CYCLES 256
+
+struct ProfileSite {
+    const char* name;
+    uint32_t count;
+    uint64_t totalCycles;
+    uint32_t maxCycles;
+    uint32_t buckets[PROFILE_BUCKETS];
+    ProfileSite* next;
+
+    explicit ProfileSite(const char* siteName);
+
+    inline void record(uint32_t cycles) {
+        count++;
+        totalCycles += cycles;
+        if (cycles > maxCycles) maxCycles = cycles;
+        uint32_t scaled = cycles / PROFILE_BUCKET_CYCLES;
+        int bucket = scaled ? 32 - __builtin_clz(scaled) : 0;
+        if (bucket >= PROFILE_BUCKETS) bucket = PROFILE_BUCKETS - 1;
+        buckets[bucket]++;
+    }
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileSite& scopeSite) : site(scopeSite), started(ESP.getCycleCount()) {}
+    ~ProfileScope() { site.record(ESP.getCycleCount() - started); }
+
+private:
+    ProfileSite& site;
+    uint32_t started;
+};
+
+#ifdef PROFILE_ENABLED
+#define PROFILE_JOIN2(a, b) a##b
+#define PROFILE_JOIN(a, b) PROFILE_JOIN2(a, b)
+#define PROFILE_SCOPE(name) \
+    static ProfileSite PROFILE_JOIN(profileSite, __LINE__)(name); \
+    ProfileScope PROFILE_JOIN(profileScope, __LINE__)(PROFILE_JOIN(profileSite, __LINE__))
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
+
+// Microseconds for a cycle count at the current CPU clock
+float profileCyclesToMicros(uint64_t cycles);
+
+// Upper bound in microseconds below which percent% of the site's scopes
+// finished (the maximum for the open-ended bucket)
+float profilePercentileMicros(const ProfileSite& site, int percent);
+
+// Registered sites, slowest maximum first
+std::vector<const ProfileSite*> getProfileSitesBySlowest();
+
+// Zero every site's figures
+void resetProfile();
+
+// Table of all sites, slowest maximum first
+void printProfileReport(Print& out);
+
+#endif // PROFILER_H
@@ -0,0 +1,154 @@
+#include "program_codec.h"
+#include <string.h>
+
+uint16_t programCodecCrc16(const uint8_t* data, size_t length) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+static uint32_t zigzagEncode(int32_t value) {
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t zigzagDecode(uint32_t value) {
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+// ====================================================================
+// WRITER
+// ====================================================================
+
+ProgramBlobWriter::ProgramBlobWriter(uint8_t* buffer, size_t capacity)
+  : buffer(buffer), capacity(capacity), length(0), count(0), overflow(false) {
+  put(PROGRAM_CODEC_MAGIC_0);
+  put(PROGRAM_CODEC_MAGIC_1);
+  put(PROGRAM_CODEC_VERSION);
+  put(0);  // Record count, filled in by finish()
+}
+
+bool ProgramBlobWriter::put(uint8_t value) {
+  if (length >= capacity) {
+    overflow = true;
+    return false;
+  }
+  buffer[length++] = value;
+  return true;
+}
+
+bool ProgramBlobWriter::putVarint(uint32_t value) {
+  while (value >= 0x80) {
+    if (!put((uint8_t)(value | 0x80))) return false;
+    value >>= 7;
+  }
+  return put((uint8_t)value);
+}
+
+bool ProgramBlobWriter::add(uint8_t index, const char* name, const float* temps, uint16_t pointCount) {
+  if (count == 255) {
+    overflow = true;
+    return false;
+  }
+
+  size_t nameLength = name ? strlen(name) : 0;
+  if (nameLength > PROGRAM_CODEC_MAX_NAME) nameLength = PROGRAM_CODEC_MAX_NAME;
+
+  // Trailing zero points are implied by the decoder
+  uint16_t stored = pointCount;
+  while (stored > 0 && programTempToTenths(temps[stored - 1]) == 0) stored--;
+
+  put(index);
+  put((uint8_t)nameLength);
+  for (size_t i = 0; i < nameLength; i++) put((uint8_t)name[i]);
+  put((uint8_t)(stored & 0xFF));
+  put((uint8_t)(stored >> 8));
+
+  int32_t previous = 0;
+  for (uint16_t i = 0; i < stored; i++) {
+    int32_t value = programTempToTenths(temps[i]);
+    putVarint(zigzagEncode(value - previous));
+    previous = value;
+  }
+
+  if (overflow) return false;
+  count++;
+  return true;
+}
+
+size_t ProgramBlobWriter::finish() {
+  if (overflow || length + PROGRAM_CODEC_CRC_SIZE > capacity) return 0;
+  buffer[3] = count;
+  uint16_t crc = programCodecCrc16(buffer, length);
+  buffer[length++] = (uint8_t)(crc & 0xFF);
+  buffer[length++] = (uint8_t)(crc >> 8);
+  return length;
+}
+
+// ====================================================================
+// READER
+// ====================================================================
+
+ProgramBlobReader::ProgramBlobReader(const uint8_t* data, size_t length)
+  : data(data), end(0), position(PROGRAM_CODEC_HEADER_SIZE), count(0), remaining(0), valid(false) {
+  if (!data || length < PROGRAM_CODEC_HEADER_SIZE + PROGRAM_CODEC_CRC_SIZE) return;
+  if (data[0] != PROGRAM_CODEC_MAGIC_0 || data[1] != PROGRAM_CODEC_MAGIC_1) return;
+  if (data[2] != PROGRAM_CODEC_VERSION) return;
+
+  end = length - PROGRAM_CODEC_CRC_SIZE;
+  uint16_t crc = data[end] | ((uint16_t)data[end + 1] << 8);
+  if (programCodecCrc16(data, end) != crc) return;
+
+  count = data[3];
+  remaining = count;
+  valid = true;
+}
+
+bool ProgramBlobReader::getVarint(uint32_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 7 * PROGRAM_CODEC_MAX_VARINT; shift += 7) {
+    if (position >= end) return false;
+    uint8_t byte = data[position++];
+    value |= (uint32_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) return true;
+  }
+  return false;
+}
+
+bool ProgramBlobReader::next(ProgramRecord& record, float* temps, uint16_t maxPoints) {
+  if (!valid || remaining <= 0) return false;
+
+  // Any malformed record ends the blob
+  valid = false;
+
+  if (end - position < 2) return false;
+  record.index = data[position++];
+  uint8_t nameLength = data[position++];
+  if (end - position < (size_t)nameLength + 2) return false;
+  memcpy(record.name, data + position, nameLength);
+  record.name[nameLength] = '\0';
+  position += nameLength;
+  record.pointCount = data[position] | ((uint16_t)data[position + 1] << 8);
+  position += 2;
+
+  int32_t value = 0;
+  for (uint16_t i = 0; i < record.pointCount; i++) {
+    uint32_t encoded;
+    if (!getVarint(encoded)) return false;
+    value += zigzagDecode(encoded);
+    if (value < -32768 || value > 32767) return false;
+    if (i < maxPoints) temps[i] = programTenthsToTemp((int16_t)value);
+  }
+  for (uint16_t i = record.pointCount; i < maxPoints; i++) {
+    temps[i] = 0.0f;
+  }
+
+  // Trailing bytes after the last record are malformed too
+  remaining--;
+  valid = remaining > 0 || position == end;
+  return valid;
+}
@@ -0,0 +1,110 @@
+#ifndef PROGRAM_CODEC_H
+#define PROGRAM_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+// =================================================================
+//                  BINARY PROGRAM FORMAT
+// =================================================================
+// Compact representation of temperature programs, used for
+// /programs.bin and the application/octet-stream variants of the
+// program endpoints. No Arduino dependencies so it builds on the host.
+//
+// Blob layout (little endian):
+//   'F' 'P' version count             4 byte header
+//   record * count
+//   crc16                             CRC-16/CCITT of everything before it
+//
+// Record layout:
+//   index      uint8                  program slot
+//   nameLength uint8, name bytes      UTF-8, not terminated
+//   pointCount uint16                 trailing zero points are not stored
+//   values     varint * pointCount    zigzag deltas of int16 tenths of a degree,
+//                                     first value relative to 0
+// Flat stretches of a schedule encode as one byte per point.
+
+#define PROGRAM_CODEC_MAGIC_0 'F'
+#define PROGRAM_CODEC_MAGIC_1 'P'
+#define PROGRAM_CODEC_VERSION 1
+#define PROGRAM_CODEC_HEADER_SIZE 4
+#define PROGRAM_CODEC_CRC_SIZE 2
+#define PROGRAM_CODEC_MAX_NAME 255
+#define PROGRAM_CODEC_MAX_VARINT 3       // zigzag of a 17 bit delta
+
+#define PROGRAM_CODEC_CONTENT_TYPE "application/octet-stream"
+
+// Worst case size of one record, for sizing buffers
+#define PROGRAM_CODEC_RECORD_MAX_SIZE(points) (2 + PROGRAM_CODEC_MAX_NAME + 2 + (points) * PROGRAM_CODEC_MAX_VARINT)
+
+// Both the JSON and the binary path store temperatures at this
+// resolution, so a program saved either way reads back identically
+inline int16_t programTempToTenths(float temp) {
+    float tenths = roundf(temp * 10.0f);
+    if (tenths > 32767.0f) return 32767;
+    if (tenths < -32768.0f) return -32768;
+    return (int16_t)tenths;
+}
+
+inline float programTenthsToTemp(int16_t tenths) {
+    return tenths / 10.0f;
+}
+
+inline float quantizeProgramTemp(float temp) {
+    return programTenthsToTemp(programTempToTenths(temp));
+}
+
+struct ProgramRecord {
+    uint8_t index;
+    char name[PROGRAM_CODEC_MAX_NAME + 1];
+    uint16_t pointCount;    // Points present in the record (may exceed maxPoints)
+};
+
+class ProgramBlobWriter {
+public:
+    ProgramBlobWriter(uint8_t* buffer, size_t capacity);
+
+    // Append one program. Names longer than PROGRAM_CODEC_MAX_NAME are cut.
+    bool add(uint8_t index, const char* name, const float* temps, uint16_t pointCount);
+
+    // Write the record count and CRC. Returns the blob length, 0 on overflow.
+    size_t finish();
+
+private:
+    uint8_t* buffer;
+    size_t capacity;
+    size_t length;
+    uint8_t count;
+    bool overflow;
+
+    bool put(uint8_t value);
+    bool putVarint(uint32_t value);
+};
+
+class ProgramBlobReader {
+public:
+    ProgramBlobReader(const uint8_t* data, size_t length);
+
+    // Magic, version and CRC match
+    bool isValid() const { return valid; }
+    int getCount() const { return count; }
+
+    // Decode the next record into temps[0..maxPoints), zero filling the
+    // rest. Returns false at the end or on a malformed record.
+    bool next(ProgramRecord& record, float* temps, uint16_t maxPoints);
+
+private:
+    const uint8_t* data;
+    size_t end;             // Offset of the CRC
+    size_t position;
+    int count;
+    int remaining;
+    bool valid;
+
+    bool getVarint(uint32_t& value);
+};
+
+uint16_t programCodecCrc16(const uint8_t* data, size_t length);
+
+#endif // PROGRAM_CODEC_H
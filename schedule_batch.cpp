@@ -0,0 +1,152 @@
+#include "schedule_batch.h"
+#include "config.h"
+#include "api_cache.h"
+#include <vector>
+
+// Staged points, written by the web server task and read by loop()
+static portMUX_TYPE scheduleBatchMux = portMUX_INITIALIZER_UNLOCKED;
+static float* stagedTemps = nullptr;
+static uint8_t* stagedMask = nullptr;
+static int stagedSize = 0;
+static volatile bool stagedPending = false;
+
+static bool readScheduleTemp(JsonVariant value, float& temp) {
+  if (!value.is<float>()) return false;
+  temp = value.as<float>();
+  return !isnan(temp) && temp >= SCHEDULE_TEMP_MIN && temp <= SCHEDULE_TEMP_MAX;
+}
+
+// Staging buffers follow the schedule size; a resolution change drops
+// anything still pending for the old layout
+static bool resizeStaging(int points) {
+  if (stagedSize == points) return true;
+
+  float* temps = (float*)malloc(points * sizeof(float));
+  uint8_t* mask = (uint8_t*)calloc(points, 1);
+  if (!temps || !mask) {
+    free(temps);
+    free(mask);
+    return false;
+  }
+
+  portENTER_CRITICAL(&scheduleBatchMux);
+  float* oldTemps = stagedTemps;
+  uint8_t* oldMask = stagedMask;
+  stagedTemps = temps;
+  stagedMask = mask;
+  stagedSize = points;
+  stagedPending = false;
+  portEXIT_CRITICAL(&scheduleBatchMux);
+
+  free(oldTemps);
+  free(oldMask);
+  return true;
+}
+
+int stageScheduleBatch(JsonDocument& doc, int& updated, String& error) {
+  int points = maxTempPoints;
+  updated = 0;
+
+  if (targetTemp == NULL || points <= 0) {
+    error = "Schedule not available";
+    return 503;
+  }
+  if (doc.containsKey("maxTempPoints") && doc["maxTempPoints"].as<int>() != points) {
+    error = "Schedule resolution changed to " + String(points) + " points, reload and retry";
+    return 409;
+  }
+
+  std::vector<float> values(points);
+  std::vector<uint8_t> changed(points, 0);
+
+  if (doc.containsKey("temps")) {
+    JsonArray temps = doc["temps"].as<JsonArray>();
+    int start = doc["start"] | 0;
+    if (temps.isNull() || start < 0 || start + (int)temps.size() > points) {
+      error = "Range must lie within 0-" + String(points - 1);
+      return 400;
+    }
+    int index = start;
+    for (JsonVariant value : temps) {
+      if (!readScheduleTemp(value, values[index])) {
+        error = "Invalid temperature for slot " + String(index);
+        return 400;
+      }
+      changed[index++] = 1;
+    }
+  }
+
+  if (doc.containsKey("points")) {
+    JsonArray pairs = doc["points"].as<JsonArray>();
+    if (pairs.isNull()) {
+      error = "points must be an array of [index, temp] pairs";
+      return 400;
+    }
+    for (JsonVariant pair : pairs) {
+      JsonArray entry = pair.as<JsonArray>();
+      if (entry.isNull() || entry.size() != 2 || !entry[0].is<int>()) {
+        error = "points must be an array of [index, temp] pairs";
+        return 400;
+      }
+      int index = entry[0].as<int>();
+      if (index < 0 || index >= points) {
+        error = "Slot " + String(index) + " outside 0-" + String(points - 1);
+        return 400;
+      }
+      if (!readScheduleTemp(entry[1], values[index])) {
+        error = "Invalid temperature for slot " + String(index);
+        return 400;
+      }
+      changed[index] = 1;
+    }
+  }
+
+  for (int i = 0; i < points; i++) {
+    updated += changed[i];
+  }
+  if (updated == 0) {
+    error = "No schedule points provided";
+    return 400;
+  }
+
+  if (!resizeStaging(points)) {
+    error = "Out of memory";
+    return 503;
+  }
+
+  // Merge with anything not yet applied; later edits win
+  portENTER_CRITICAL(&scheduleBatchMux);
+  for (int i = 0; i < points; i++) {
+    if (changed[i]) {
+      stagedTemps[i] = values[i];
+      stagedMask[i] = 1;
+    }
+  }
+  stagedPending = true;
+  portEXIT_CRITICAL(&scheduleBatchMux);
+  return 200;
+}
+
+void applyPendingScheduleBatch() {
+  if (!stagedPending) return;
+
+  int applied = 0;
+  portENTER_CRITICAL(&scheduleBatchMux);
+  bool sameLayout = stagedSize == maxTempPoints && targetTemp != NULL;
+  for (int i = 0; i < stagedSize; i++) {
+    if (stagedMask[i]) {
+      if (sameLayout) {
+        targetTemp[i] = stagedTemps[i];
+        applied++;
+      }
+      stagedMask[i] = 0;
+    }
+  }
+  stagedPending = false;
+  portEXIT_CRITICAL(&scheduleBatchMux);
+
+  bumpApiGeneration(API_RESOURCE_STATUS);
+  Serial.print("Schedule: Applied batch edit of ");
+  Serial.print(applied);
+  Serial.println(" points");
+}
@@ -0,0 +1,30 @@
+#ifndef SCHEDULE_BATCH_H
+#define SCHEDULE_BATCH_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// =================================================================
+//                  BATCH SCHEDULE EDITS
+// =================================================================
+// PATCH /api/schedule replaces the one-request-per-slot /api/updateTemp
+// loop of the web editor. Body:
+//
+//   {
+//     "maxTempPoints": 96,           optional, 409 if the resolution changed
+//     "start": 32, "temps": [...],   contiguous range starting at "start"
+//     "points": [[index, temp], ...] and/or individual slots, applied after the range
+//   }
+//
+// The whole batch is validated before anything is staged. Staged points
+// are copied into targetTemp[] by the main loop between two control ticks,
+// so controlFurnace() never runs against half an edit.
+
+// Validate a batch and stage it. Returns the HTTP status; on success
+// updated holds the number of distinct slots, otherwise error says why.
+int stageScheduleBatch(JsonDocument& doc, int& updated, String& error);
+
+// Copy staged points into targetTemp[]. Called from loop().
+void applyPendingScheduleBatch();
+
+#endif // SCHEDULE_BATCH_H
@@ -0,0 +1,203 @@
+#include "static_asset_handler.h"
+#include "config.h"
+
+static StaticAsset staticAssets[MAX_STATIC_ASSETS];
+static int staticAssetCount = 0;
+
+static StaticAsset* findStaticAsset(const String& path) {
+  for (int i = 0; i < staticAssetCount; i++) {
+    if (staticAssets[i].path == path) {
+      return &staticAssets[i];
+    }
+  }
+  return nullptr;
+}
+
+static void saveStaticAssetManifest() {
+  DynamicJsonDocument doc(1024 + staticAssetCount * 160);
+  JsonArray files = doc.createNestedArray("files");
+  for (int i = 0; i < staticAssetCount; i++) {
+    JsonObject f = files.createNestedObject();
+    f["path"] = staticAssets[i].path;
+    f["etag"] = staticAssets[i].etag;
+    f["size"] = staticAssets[i].size;
+    f["gzip"] = staticAssets[i].gzipped;
+  }
+
+  File file = SPIFFS.open(STATIC_ASSET_MANIFEST, FILE_WRITE);
+  if (!file) {
+    Serial.println("Assets: Failed to write manifest");
+    return;
+  }
+  serializeJson(doc, file);
+  file.close();
+}
+
+void loadStaticAssetManifest() {
+  staticAssetCount = 0;
+
+  if (!SPIFFS.exists(STATIC_ASSET_MANIFEST)) {
+    Serial.println("Assets: No manifest, serving files as stored (run tools/build_assets.py)");
+    return;
+  }
+
+  File file = SPIFFS.open(STATIC_ASSET_MANIFEST, FILE_READ);
+  if (!file) {
+    Serial.println("Assets: Failed to open manifest");
+    return;
+  }
+
+  DynamicJsonDocument doc(1024 + file.size() * 2);
+  DeserializationError error = deserializeJson(doc, file);
+  file.close();
+  if (error) {
+    Serial.print("Assets: Invalid manifest: ");
+    Serial.println(error.c_str());
+    return;
+  }
+
+  int gzippedCount = 0;
+  for (JsonObject f : doc["files"].as<JsonArray>()) {
+    if (staticAssetCount >= MAX_STATIC_ASSETS) {
+      Serial.println("Assets: Manifest has more files than MAX_STATIC_ASSETS, rest served untracked");
+      break;
+    }
+
+    StaticAsset& asset = staticAssets[staticAssetCount];
+    asset.path = f["path"].as<String>();
+    asset.etag = f["etag"].as<String>();
+    asset.size = f["size"] | 0;
+    asset.gzipped = f["gzip"] | false;
+
+    // Skip entries whose file was replaced or removed since the image was built
+    File stored = SPIFFS.open(asset.gzipped ? asset.path + ".gz" : asset.path, FILE_READ);
+    bool valid = stored && !stored.isDirectory() && stored.size() == asset.size && asset.etag.length() > 0;
+    if (stored) stored.close();
+    if (!valid) {
+      Serial.print("Assets: Stale manifest entry ignored: ");
+      Serial.println(asset.path);
+      continue;
+    }
+
+    if (asset.gzipped) gzippedCount++;
+    staticAssetCount++;
+  }
+
+  Serial.print("Assets: Loaded manifest with ");
+  Serial.print(staticAssetCount);
+  Serial.print(" files (");
+  Serial.print(gzippedCount);
+  Serial.println(" gzipped)");
+}
+
+bool sendStaticAsset(AsyncWebServerRequest *request, const String& path) {
+  StaticAsset* asset = findStaticAsset(path);
+  String quotedEtag = asset ? "\"" + asset->etag + "\"" : String();
+
+  // Only URLs carrying the current content hash may be cached forever
+  const char* cacheControl = STATIC_CACHE_REVALIDATE;
+  if (asset && request->hasParam("v")) {
+    const String& version = request->getParam("v")->value();
+    if (version.length() >= STATIC_VERSION_LENGTH && asset->etag.startsWith(version)) {
+      cacheControl = STATIC_CACHE_IMMUTABLE;
+    }
+  }
+
+  if (asset && request->hasHeader("If-None-Match")) {
+    const String& ifNoneMatch = request->getHeader("If-None-Match")->value();
+    if (ifNoneMatch.indexOf(quotedEtag) >= 0 || ifNoneMatch == "*") {
+      AsyncWebServerResponse *response = request->beginResponse(304);
+      response->addHeader("ETag", quotedEtag);
+      response->addHeader("Cache-Control", cacheControl);
+      request->send(response);
+      return true;
+    }
+  }
+
+  bool acceptsGzip = request->hasHeader("Accept-Encoding") &&
+                     request->getHeader("Accept-Encoding")->value().indexOf("gzip") >= 0;
+  String gzPath = path + ".gz";
+  bool hasPlain = SPIFFS.exists(path);
+
+  // Images built by tools/build_assets.py only store the .gz variant, so it is
+  // sent even to clients that don't advertise gzip when there is no plain file
+  String storedPath;
+  if ((acceptsGzip || !hasPlain) && SPIFFS.exists(gzPath)) {
+    storedPath = gzPath;
+  } else if (hasPlain) {
+    storedPath = path;
+  } else {
+    return false;
+  }
+
+  File file = SPIFFS.open(storedPath, FILE_READ);
+  if (!file || file.isDirectory()) {
+    if (file) file.close();
+    return false;
+  }
+
+  // The response adds Content-Encoding: gzip itself when a .gz file is sent
+  // under its plain path, and derives the content type from that path
+  AsyncWebServerResponse *response = request->beginResponse(file, path);
+  if (asset && asset->gzipped == storedPath.endsWith(".gz")) {
+    response->addHeader("ETag", quotedEtag);
+  }
+  response->addHeader("Cache-Control", cacheControl);
+  response->addHeader("Vary", "Accept-Encoding");
+  request->send(response);
+  return true;
+}
+
+// Page URLs served from an HTML file
+static const struct {
+  const char* url;
+  const char* file;
+} pageRoutes[] = {
+  { "/",            "/index.html" },
+  { "/setup",       "/setup.html" },
+  { "/settings",    "/settings.html" },
+  { "/programs",    "/programs.html" },
+  { "/filemanager", "/filemanager.html" },
+};
+
+void handleStaticRequest(AsyncWebServerRequest *request) {
+  const String& url = request->url();
+  for (size_t i = 0; i < sizeof(pageRoutes) / sizeof(pageRoutes[0]); i++) {
+    if (url == pageRoutes[i].url) {
+      sendStaticAsset(request, pageRoutes[i].file);
+      return;
+    }
+  }
+
+  if (!sendStaticAsset(request, url) && !sendStaticAsset(request, "/index.html")) {
+    request->send(404, "text/plain", "Not Found");
+  }
+}
+
+void invalidateStaticAsset(const String& path) {
+  String basePath = path.endsWith(".gz") ? path.substring(0, path.length() - 3) : path;
+  String dirPrefix = basePath.endsWith("/") ? basePath : basePath + "/";
+
+  bool changed = false;
+  for (int i = 0; i < staticAssetCount; ) {
+    if (staticAssets[i].path == basePath || staticAssets[i].path.startsWith(dirPrefix)) {
+      staticAssets[i] = staticAssets[--staticAssetCount];
+      changed = true;
+    } else {
+      i++;
+    }
+  }
+
+  // A plain file written over a gzipped asset replaces it - otherwise the old
+  // .gz would keep being preferred
+  String gzPath = basePath + ".gz";
+  if (!path.endsWith(".gz") && SPIFFS.exists(gzPath)) {
+    SPIFFS.remove(gzPath);
+    Serial.print("Assets: Removed superseded ");
+    Serial.println(gzPath);
+  }
+
+  if (changed) {
+    saveStaticAssetManifest();
+  }
+}
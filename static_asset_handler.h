@@ -0,0 +1,41 @@
+#ifndef STATIC_ASSET_HANDLER_H
+#define STATIC_ASSET_HANDLER_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <SPIFFS.h>
+#include <ArduinoJson.h>
+
+// Maximum number of assets tracked from the build manifest
+#define MAX_STATIC_ASSETS 40
+
+// Cache policy: versioned URLs (?v=<etag prefix>) never change, everything
+// else is revalidated with If-None-Match on each load
+#define STATIC_CACHE_IMMUTABLE "public, max-age=31536000, immutable"
+#define STATIC_CACHE_REVALIDATE "no-cache"
+#define STATIC_VERSION_LENGTH 8       // ?v= prefix length, VERSION_LENGTH in tools/build_assets.py
+
+// One file from the manifest produced by tools/build_assets.py
+struct StaticAsset {
+    String path;      // Request path, e.g. "/index.html"
+    String etag;      // Content hash of the stored bytes
+    uint32_t size;    // Size of the stored file, used to detect stale entries
+    bool gzipped;     // Stored as path + ".gz"
+};
+
+// Load the asset manifest from SPIFFS (call once after SPIFFS is mounted)
+void loadStaticAssetManifest();
+
+// Send a file from SPIFFS, preferring the pre-gzipped variant and answering
+// If-None-Match with 304. Returns false if neither variant exists.
+bool sendStaticAsset(AsyncWebServerRequest *request, const String& path);
+
+// GET handler for everything outside /api/: page URLs (/settings, ...),
+// static files and the index.html fallback for SPA routing
+void handleStaticRequest(AsyncWebServerRequest *request);
+
+// Drop the manifest entry for a file (or directory) that was changed through
+// the file manager, so a stale ETag or .gz variant is never served for it
+void invalidateStaticAsset(const String& path);
+
+#endif // STATIC_ASSET_HANDLER_H
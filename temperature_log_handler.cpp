@@ -6,10 +6,10 @@
 #define TEMP_LOG_FILE "/temp_log.csv"
 #endif
 
-void setupTemperatureLogHandler(AsyncWebServer& server) {
+void setupTemperatureLogHandler(ApiRouter& api) {
   
   // Main endpoint for temperature log retrieval (CSV, supports ?max=N)
-  server.on("/api/templog", HTTP_GET, [](AsyncWebServerRequest *request) {
+  api.on("/api/templog", HTTP_GET, [](AsyncWebServerRequest *request) {
     
     int maxLines = 0;
     if (request->hasParam("max")) {
@@ -25,7 +25,7 @@ void setupTemperatureLogHandler(AsyncWebServer& server) {
       // Try to create the file
       File tempFile = SPIFFS.open(TEMP_LOG_FILE, FILE_WRITE);
       if (tempFile) {
-        tempFile.println("Timestamp,Temperature,Target,FurnaceStatus");
+        tempFile.println(TEMP_LOG_HEADER);
         tempFile.close();
       } else {
         request->send(500, "text/plain", "Failed to create temperature log file");
@@ -6,8 +6,9 @@
 #include <ESPAsyncWebServer.h>
 #include <SPIFFS.h>
 #include <ArduinoJson.h>
+#include "api_router.h"
 
 // Forward declaration of the setup function
-void setupTemperatureLogHandler(AsyncWebServer& server);
+void setupTemperatureLogHandler(ApiRouter& api);
 
 #endif // TEMPERATURE_LOG_HANDLER_H
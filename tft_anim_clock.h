@@ -0,0 +1,43 @@
+#ifndef TFT_ANIM_CLOCK_H
+#define TFT_ANIM_CLOCK_H
+
+#include <stdint.h>
+
+// =================================================================
+//                  FIXED-TIMESTEP ANIMATION CLOCK
+// =================================================================
+// Physics always advances in ANIM_STEP_MS steps no matter how late the
+// loop gets to update(); the remainder carries over and is used to
+// interpolate the drawn position. After a long stall (SPIFFS writes, HTTP)
+// at most ANIM_MAX_STEPS are run and the rest of the backlog is dropped
+// instead of overshooting. Time comes in as an argument and there are no
+// Arduino dependencies, so the clock builds on the host
+// (tools/anim_clock_test.cpp).
+
+#define ANIM_STEP_MS 8        // 125 Hz physics
+#define ANIM_MAX_STEPS 8      // Catch up at most 64 ms per frame
+#define ANIM_FRAME_MS 33      // ~30 fps UI updates while anything animates
+
+struct TFT_AnimClock {
+    uint32_t lastTime = 0;            // millis() of the last advance
+    uint32_t accumulator = 0;         // Time not yet run as steps
+    
+    void reset(uint32_t now) { lastTime = now; accumulator = 0; }
+    
+    // Number of fixed steps to run now
+    int advance(uint32_t now) {
+        accumulator += now - lastTime;
+        lastTime = now;
+        
+        int steps = accumulator / ANIM_STEP_MS;
+        accumulator -= steps * ANIM_STEP_MS;
+        
+        // Frame skipping - drop the backlog of a long stall
+        return steps < ANIM_MAX_STEPS ? steps : ANIM_MAX_STEPS;
+    }
+    
+    // Fraction of a step carried over, for interpolating between steps
+    float alpha() const { return accumulator / (float)ANIM_STEP_MS; }
+};
+
+#endif // TFT_ANIM_CLOCK_H
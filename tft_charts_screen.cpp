@@ -1,4 +1,5 @@
 #include "tft_ui.h"
+#include "profiler.h"
 #include <WiFi.h>
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
@@ -90,6 +91,7 @@ void ChartsScreen::init() {
 
 // Update screen data
 void ChartsScreen::update() {
+    PROFILE_SCOPE("tft.charts.update");
     unsigned long currentTime = millis();
     
     // Check for theme changes and update chart colors accordingly
@@ -159,7 +161,12 @@ void ChartsScreen::update() {
 // Draw screen
 void ChartsScreen::draw() {
     if (!needsRedraw) return;
-    
+    PROFILE_SCOPE("tft.charts.draw");
+    drawContent();
+    needsRedraw = false;
+}
+
+void ChartsScreen::drawContent() {
     // Clear main content area (avoid status bar and navigation bar)
     const TFT_Theme& theme = ui->getTheme();
     ui->getTFT().fillRect(0, 20, TFT_WIDTH, TFT_HEIGHT - 50, theme.backgroundColor);
@@ -180,8 +187,6 @@ void ChartsScreen::draw() {
     for (int i = 0; i < textCount; i++) {
         ui->drawText(texts[i]);
     }
-    
-    needsRedraw = false;
 }
 
 // Handle touch input
@@ -200,6 +205,23 @@ void ChartsScreen::onShow() {
     updateChartData(); // Load initial data, but won't auto-refresh afterwards
 }
 
+// Content signature for the screen render cache
+uint32_t ChartsScreen::getContentSignature() {
+    uint32_t hash = hashScreenElements(CONTENT_HASH_SEED, *this);
+    hash = hashContent(hash, &scheduleChart.pointCount, sizeof(scheduleChart.pointCount));
+    for (int i = 0; scheduleChart.points && i < scheduleChart.pointCount; i++) {
+        hash = hashContent(hash, &scheduleChart.points[i].x, sizeof(float));
+        hash = hashContent(hash, &scheduleChart.points[i].y, sizeof(float));
+    }
+    hash = hashContent(hash, &scheduleChart.minY, sizeof(scheduleChart.minY));
+    hash = hashContent(hash, &scheduleChart.maxY, sizeof(scheduleChart.maxY));
+    
+    // Current time indicator position
+    int currentIndex = getCurrentTempIndex();
+    hash = hashContent(hash, &currentIndex, sizeof(currentIndex));
+    return hash;
+}
+
 // Update chart data from target temperature array
 void ChartsScreen::updateChartData() {
     if (!scheduleChart.points || !targetTemp) return;
@@ -1,4 +1,5 @@
 #include "tft_integration.h"
+#include "profiler.h"
 #include <WiFi.h>
 
 // Global integration instance
@@ -183,6 +184,25 @@ void runTFTDiagnostics() {
     
     // Print performance stats
     printTFTPerformanceStats();
+    printProfileReport(Serial);
+
+    // Screen switch latency on screen too
+    const TFT_SwitchStats& switches = ui.getSwitchStats();
+    if (switches.switchCount > 0) {
+        ui.showMessage("Switch avg " + String(switches.avgSwitchUs / 1000.0, 1) + " ms, max " +
+                       String(switches.maxSwitchUs / 1000.0, 1) + " ms (" + String(switches.cachedCount) + "/" +
+                       String(switches.switchCount) + " cached)", TFT_WHITE, 3000);
+        delay(3000);
+    }
+
+#ifdef PROFILE_ENABLED
+    // Slowest profiled stage on screen, the full table is on Serial
+    std::vector<const ProfileSite*> sites = getProfileSitesBySlowest();
+    if (!sites.empty() && sites[0]->count > 0) {
+        ui.showMessage("Slowest: " + String(sites[0]->name) + " " +
+                       String(profileCyclesToMicros(sites[0]->maxCycles) / 1000.0, 1) + " ms", TFT_WHITE, 3000);
+    }
+#endif
 }
 
 // Utility functions
@@ -3,6 +3,7 @@
 
 #include "tft_ui.h"
 #include "config.h"
+#include "metrics.h"
 
 // Integration constants - Optimized for performance when using both TFT and Web
 #define TFT_UPDATE_INTERVAL 200  // 5 FPS for better performance (was 10 FPS)
@@ -47,12 +48,16 @@ public:
         
         unsigned long currentTime = millis();
         
-        // Update UI at regular intervals
-        if (currentTime - lastUpdate >= TFT_UPDATE_INTERVAL) {
+        // Update UI at regular intervals - picker wheels need the animation
+        // frame rate while they move, the idle rate would cap them at 5 FPS
+        unsigned long interval = tftUI.hasActiveAnimations() ? ANIM_FRAME_MS : TFT_UPDATE_INTERVAL;
+        if (currentTime - lastUpdate >= interval) {
             lastUpdate = currentTime;
             
             // Update TFT UI
+            unsigned long frameStarted = micros();
             tftUI.update();
+            observeMetric(METRIC_TFT_FRAME, micros() - frameStarted);
             
             // Disable automatic theme refresh to prevent unnecessary full screen redraws
             // Theme refresh should only happen when explicitly requested
@@ -127,8 +132,39 @@ public:
     // Performance monitoring
     void printPerformanceStats() {
         if (initialized) {
-            unsigned long currentTime = millis();
-            float fps = 1000.0 / (currentTime - lastUpdate);
+            const TFT_FrameStats& stats = tftUI.getFrameStats();
+
+            Serial.println("TFT: Performance stats");
+            Serial.print("  DMA band rendering: ");
+            Serial.println(tftUI.isBandRenderingEnabled() ? "enabled" : "disabled (direct drawing)");
+            Serial.print("  Frames rendered: ");
+            Serial.println(stats.frameCount);
+            if (stats.frameCount > 0) {
+                Serial.print("  Frame time last/avg/max (ms): ");
+                Serial.print(stats.lastFrameUs / 1000.0, 2);
+                Serial.print(" / ");
+                Serial.print(stats.avgFrameUs / 1000.0, 2);
+                Serial.print(" / ");
+                Serial.println(stats.maxFrameUs / 1000.0, 2);
+                Serial.print("  Bands per frame: ");
+                Serial.println(stats.bandCount);
+            }
+            
+            const TFT_SwitchStats& switches = tftUI.getSwitchStats();
+            Serial.print("  Screen render cache: ");
+            Serial.println(tftUI.isScreenCacheEnabled() ? "enabled (PSRAM)" : "disabled");
+            Serial.print("  Screen switches (cached/total): ");
+            Serial.print(switches.cachedCount);
+            Serial.print(" / ");
+            Serial.println(switches.switchCount);
+            if (switches.switchCount > 0) {
+                Serial.print("  Switch time last/avg/max (ms): ");
+                Serial.print(switches.lastSwitchUs / 1000.0, 2);
+                Serial.print(" / ");
+                Serial.print(switches.avgSwitchUs / 1000.0, 2);
+                Serial.print(" / ");
+                Serial.println(switches.maxSwitchUs / 1000.0, 2);
+            }
         }
     }
     
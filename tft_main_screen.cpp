@@ -1,8 +1,11 @@
 #include "tft_ui.h"
+#include "profiler.h"
 #include <WiFi.h>
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
 #include "web_server_handler.h"
+#include "api_cache.h"
+#include "energy_meter.h"
 
 // External variables from main firmware
 extern float currentTemp;
@@ -24,6 +27,13 @@ static void onTargetTempUp();
 static void onTargetTempDown();
 static void onRefresh();
 
+// Value bindings for the readouts (see TFT_TextFormatter)
+static void formatCurrentTemp(TFT_Label& text, uint16_t& color);
+static void formatTargetTemp(TFT_Label& text, uint16_t& color);
+static void formatSystemStatus(TFT_Label& text, uint16_t& color);
+static void formatFurnaceStatus(TFT_Label& text, uint16_t& color);
+static void formatFiringEnergy(TFT_Label& text, uint16_t& color);
+
 // Constructor
 MainScreen::MainScreen(TFT_UI* ui) : ui(ui) {
     mainScreenInstance = this;
@@ -36,13 +46,6 @@ MainScreen::MainScreen(TFT_UI* ui) : ui(ui) {
     lastChartUpdate = 0;
     lastSecondUpdate = 0; // Initialize 1-second update timer
     
-    // Initialize change tracking variables for anti-flashing
-    lastDisplayedCurrentTemp = -999.0;
-    lastDisplayedTargetTemp = -999.0;
-    lastDisplayedFurnaceStatus = false;
-    lastDisplayedSystemEnabled = false;
-    lastTimeString = "";
-    
     // Clear chart data
     for (int i = 0; i < chartDataSize; i++) {
         chartData[i] = 0.0;
@@ -51,9 +54,9 @@ MainScreen::MainScreen(TFT_UI* ui) : ui(ui) {
     
     // Initialize temperature chart - expanded to fill space where temp bar was
     tempChart.x = 10;
-    tempChart.y = 72;  // Moved down 5px from 67
+    tempChart.y = 76;  // Moved down 4px from 72 for the energy line
     tempChart.width = 230;  // Reduced by 5px from 240
-    tempChart.height = 100;  // Reduced by 5px from 105
+    tempChart.height = 96;  // Reduced by 4px from 100
     tempChart.minX = 0;
     tempChart.maxX = chartDataSize - 1;
     tempChart.minY = 0;
@@ -165,7 +168,7 @@ void MainScreen::init() {
     buttons[3].pressDuration = 100;
     
     // Initialize text elements
-    textCount = 4;  // Reduced from 5 - removing time display (already in status bar)
+    textCount = 5;  // Time display removed (already in status bar), energy added
     texts = new TFT_Text[textCount];
     
     // Current temperature display (moved 5px left)
@@ -176,6 +179,8 @@ void MainScreen::init() {
     texts[0].color = ui->getTheme().textColor;
     texts[0].visible = true;
     texts[0].centered = false;
+    texts[0].formatter = formatCurrentTemp;
+    texts[0].refreshInterval = 1500;  // 1.5 seconds for temp
     
     // Target temperature display (moved 5px left)
     texts[1].x = 135;
@@ -185,6 +190,8 @@ void MainScreen::init() {
     texts[1].color = ui->getTheme().textColor;
     texts[1].visible = true;
     texts[1].centered = false;
+    texts[1].formatter = formatTargetTemp;
+    texts[1].refreshInterval = 3000;
     
     // System status display (moved up)
     texts[2].x = 15;
@@ -194,6 +201,8 @@ void MainScreen::init() {
     texts[2].color = ui->getTheme().textColor;
     texts[2].visible = true;
     texts[2].centered = false;
+    texts[2].formatter = formatSystemStatus;
+    texts[2].refreshInterval = 3000;
     
     // Furnace status display (moved up)
     texts[3].x = 15;
@@ -203,6 +212,19 @@ void MainScreen::init() {
     texts[3].color = ui->getTheme().textColor;
     texts[3].visible = true;
     texts[3].centered = false;
+    texts[3].formatter = formatFurnaceStatus;
+    texts[3].refreshInterval = 3000;
+    
+    // Energy of the current firing
+    texts[4].x = 15;
+    texts[4].y = 65;
+    texts[4].text = "Energy: 0.00kWh";
+    texts[4].size = 1;
+    texts[4].color = ui->getTheme().textColor;
+    texts[4].visible = true;
+    texts[4].centered = false;
+    texts[4].formatter = formatFiringEnergy;
+    texts[4].refreshInterval = 5000;
     
     // Initialize chart points
     if (tempChart.points) {
@@ -216,29 +238,12 @@ void MainScreen::init() {
 
 // Update screen data
 void MainScreen::update() {
+    PROFILE_SCOPE("tft.main.update");
     unsigned long currentTime = millis();
     
-    // Check what needs updating to avoid unnecessary redraws (V20 anti-flashing technique)
-    bool tempChanged = (abs(currentTemp - lastDisplayedCurrentTemp) > 0.1);
-    bool furnaceChanged = (furnaceStatus != lastDisplayedFurnaceStatus);
-    bool systemChanged = (systemEnabled != lastDisplayedSystemEnabled);
     bool chartDataChanged = false;
-    bool timeChanged = false;
     bool buttonStateChanged = false;
     
-    // Get current time string and check if it changed
-    String currentTimeStr = getCurrentTime();
-    timeChanged = (currentTimeStr != lastTimeString);
-    
-    // Get smoothed target temperature from API
-    float displayTargetTemp = 0.0;
-    int tempIndex = getCurrentTempIndex();
-    if (tempIndex >= 0 && tempIndex < maxTempPoints && targetTemp) {
-        // Use smoothed target temperature if available, otherwise fall back to raw target
-        displayTargetTemp = getSmoothedTargetTemperature();
-    }
-    bool targetChanged = (abs(displayTargetTemp - lastDisplayedTargetTemp) > 0.1);
-    
     // Update temperature chart data every 15 seconds (reduced frequency for performance)
     if (currentTime - lastChartUpdate > 15000) {
         lastChartUpdate = currentTime;
@@ -262,26 +267,6 @@ void MainScreen::update() {
         chartDataChanged = true;
     }
     
-    // Update frequency control - optimized for performance when using both TFT and Web
-    static unsigned long lastCurrentTempUpdate = 0;
-    static unsigned long lastTimeUpdate = 0;
-    static unsigned long lastOtherUpdate = 0;
-    
-    bool shouldUpdateCurrentTemp = (currentTime - lastCurrentTempUpdate > 1500); // 1.5 seconds for temp (was 1s)
-    bool shouldUpdateTime = (currentTime - lastTimeUpdate > 2000); // 2 seconds for time (was 1s)
-    bool shouldUpdateOthers = (currentTime - lastOtherUpdate > 3000); // 3 seconds for others (was 2s)
-    
-    // Update timers
-    if (tempChanged && shouldUpdateCurrentTemp) {
-        lastCurrentTempUpdate = currentTime;
-    }
-    if (timeChanged && shouldUpdateTime) {
-        lastTimeUpdate = currentTime;
-    }
-    if ((systemChanged || furnaceChanged || targetChanged || buttonStateChanged || chartDataChanged) && shouldUpdateOthers) {
-        lastOtherUpdate = currentTime;
-    }
-    
     // Handle button text changes (state is managed in the button reset logic)
     static bool prevSystemEnabled = false;
     bool systemStateChanged = (systemEnabled != prevSystemEnabled);
@@ -340,41 +325,12 @@ void MainScreen::update() {
     
     // SELECTIVE DRAWING - Only draw what changed (V20 technique)
     
-    // Draw current temperature if changed (Primary color) - 1.5 second update
-    if (tempChanged && shouldUpdateCurrentTemp) {
-        extern bool thermocoupleError;
-        texts[0].text = "C:" + formatTemperature(currentTemp);
-        texts[0].color = thermocoupleError ? ui->getTheme().errorColor : ui->getTheme().primaryColor;  // Red for error, primary color for normal
-        drawSelectiveText(0); // Only redraw this text element
-        lastDisplayedCurrentTemp = currentTemp;
-    }
-    
-    // Draw target temperature if changed (Error color) - 3 second update
-    if (targetChanged && shouldUpdateOthers) {
-        if (tempIndex >= 0 && tempIndex < maxTempPoints && targetTemp) {
-            texts[1].text = "T:" + formatTemperature(displayTargetTemp);
-        } else {
-            texts[1].text = "T: --C";
+    // Bound readouts report their own changes, throttled per text
+    // (1.5 seconds for current temperature, 3 seconds for the others)
+    for (int i = 0; i < textCount; i++) {
+        if (ui->refreshBoundText(texts[i], currentTime)) {
+            drawSelectiveText(i); // Only redraw this text element
         }
-        texts[1].color = ui->getTheme().errorColor;  // Color code with Error color
-        drawSelectiveText(1); // Only redraw this text element
-        lastDisplayedTargetTemp = displayTargetTemp;
-    }
-    
-    // Draw system status if changed - 3 second update
-    if (systemChanged && shouldUpdateOthers) {
-        texts[2].text = "System: " + String(systemEnabled ? "ON" : "OFF");
-        texts[2].color = systemEnabled ? ui->getTheme().successColor : ui->getTheme().errorColor;
-        drawSelectiveText(2); // Only redraw this text element
-        lastDisplayedSystemEnabled = systemEnabled;
-    }
-    
-    // Draw furnace status if changed - 3 second update
-    if (furnaceChanged && shouldUpdateOthers) {
-        texts[3].text = "Furnace: " + String(furnaceStatus ? "ON" : "OFF");
-        texts[3].color = furnaceStatus ? ui->getTheme().successColor : ui->getTheme().errorColor;
-        drawSelectiveText(3); // Only redraw this text element
-        lastDisplayedFurnaceStatus = furnaceStatus;
     }
     
     // Draw button if state changed - IMMEDIATE update for responsive feedback
@@ -392,18 +348,18 @@ void MainScreen::update() {
         lastChartDraw = currentTime;
     }
     
-    // Update time string tracking
-    if (timeChanged) {
-        lastTimeString = currentTimeStr;
-    }
-    
     // DON'T set needsRedraw = true here - we've already drawn what changed
 }
 
 // Draw screen
 void MainScreen::draw() {
     if (!needsRedraw) return;
-    
+    PROFILE_SCOPE("tft.main.draw");
+    drawContent();
+    needsRedraw = false;
+}
+
+void MainScreen::drawContent() {
     // Full screen redraw (only for initial draw or theme changes)
     // Clear main content area only - avoid status bar (top 20px) and navigation bar (bottom 30px)
     const TFT_Theme& theme = ui->getTheme();
@@ -425,16 +381,30 @@ void MainScreen::draw() {
     
     // Draw text elements
     for (int i = 0; i < textCount; i++) {
-        ui->drawText(texts[i]);
+        if (!drawCachedReadout(i)) {
+            ui->drawText(texts[i]);
+        }
     }
-    
-    needsRedraw = false;
 }
 
 // Selective drawing methods (V20 anti-flashing technique)
 void MainScreen::drawSelectiveText(int index) {
     if (index < 0 || index >= textCount) return;
     
+    // Large readouts are blitted from the glyph cache with their background,
+    // so only the tail left behind by a longer previous value is cleared
+    if (texts[index].size == 2 && texts[index].visible) {
+        const int readoutRight = 242; // Inside the temperature card border
+        int tailX = texts[index].x + texts[index].text.length() * GLYPH_WIDTH;
+        if (drawCachedReadout(index)) {
+            if (tailX < readoutRight) {
+                ui->getTFT().fillRect(tailX, texts[index].y - 2, readoutRight - tailX,
+                                      GLYPH_HEIGHT + 4, ui->getTheme().cardBackground);
+            }
+            return;
+        }
+    }
+    
     // Calculate text dimensions for background clearing
     int textWidth = texts[index].text.length() * 6 * texts[index].size + 10; // Extra padding
     int textHeight = 8 * texts[index].size + 4; // Extra padding
@@ -472,6 +442,16 @@ void MainScreen::drawSelectiveChart() {
     ui->drawChart(tempChart);
 }
 
+// Draw a size 2 readout from the glyph cache (returns false to fall back to drawText)
+bool MainScreen::drawCachedReadout(int index) {
+    if (texts[index].size != 2 || !texts[index].visible || texts[index].centered) {
+        return false;
+    }
+    
+    return ui->drawCachedText(texts[index].x, texts[index].y, texts[index].text.c_str(),
+                              texts[index].color, ui->getTheme().cardBackground);
+}
+
 // Progress bar drawing method removed - no longer needed
 
 // Handle touch input
@@ -482,21 +462,17 @@ void MainScreen::handleTouch(TouchPoint& touch) {
     }
     
     // Check regular buttons
-    for (int i = 0; i < buttonCount; i++) {
-        if (ui->isTouchInButton(touch, buttons[i])) {
-            if (buttons[i].onPress) {
-                buttons[i].state = BTN_PRESSED;
-                buttons[i].pressedTime = millis();
-                buttons[i].pressDuration = 100; // 100ms press duration
-                
-                // Use selective drawing for button press
-                drawSelectiveButton(i);
-                
-                // Call button callback
-                buttons[i].onPress();
-            }
-            break;
-        }
+    int i = hitTestButtons(touch);
+    if (i >= 0 && buttons[i].onPress) {
+        buttons[i].state = BTN_PRESSED;
+        buttons[i].pressedTime = millis();
+        buttons[i].pressDuration = 100; // 100ms press duration
+        
+        // Use selective drawing for button press
+        drawSelectiveButton(i);
+        
+        // Call button callback
+        buttons[i].onPress();
     }
     // Button state reset is handled by timer in update() method for proper visual feedback
 }
@@ -505,8 +481,10 @@ void MainScreen::handleTouch(TouchPoint& touch) {
 void MainScreen::onShow() {
     needsRedraw = true;
     
-    // Ensure chart has initial data regardless of WiFi connectivity
-    if (chartData && targetTempData) {
+    // Ensure chart has initial data regardless of WiFi connectivity. Only seed
+    // an empty chart so returning to this screen does not add a sample (and
+    // invalidate the cached render) on every visit.
+    if (chartData && targetTempData && tempChart.pointCount == 0) {
         // Always add current readings to ensure chart displays something (only if sensor is working)
         extern bool thermocoupleError;
         if (!thermocoupleError) {
@@ -519,6 +497,18 @@ void MainScreen::onShow() {
     updateChart();
 }
 
+// Content signature for the screen render cache
+uint32_t MainScreen::getContentSignature() {
+    uint32_t hash = hashScreenElements(CONTENT_HASH_SEED, *this);
+    bool wifiConnected = (WiFi.status() == WL_CONNECTED);
+    hash = hashContent(hash, &wifiConnected, sizeof(wifiConnected));
+    hash = hashContent(hash, &chartIndex, sizeof(chartIndex));
+    hash = hashContent(hash, &tempChart.pointCount, sizeof(tempChart.pointCount));
+    hash = hashContent(hash, &tempChart.minY, sizeof(tempChart.minY));
+    hash = hashContent(hash, &tempChart.maxY, sizeof(tempChart.maxY));
+    return hash;
+}
+
 // Draw temperature card
 void MainScreen::drawTemperatureCard() {
     ui->drawCard(5, 22, 240, 155, "Temperature Monitor");  // Reduced height from 165 to 155
@@ -681,15 +671,14 @@ static void onSystemToggle() {
     if (!mainScreenInstance) return;
     
     // Toggle system state directly (more efficient than HTTP request)
-    extern bool systemEnabled, furnaceStatus;
+    extern bool systemEnabled;
     
     systemEnabled = !systemEnabled;
     
     // Handle system state change (same logic as web API)
     if (!systemEnabled) {
         // When turning off, ensure furnace is off
-        furnaceStatus = false;
-        digitalWrite(RELAY_PIN, LOW);  // RELAY_PIN is a macro from config.h
+        stopHeating();
     }
     // When turning on, let the main loop handle furnace control
     
@@ -705,6 +694,7 @@ static void onTargetTempUp() {
         if (newTemp <= 1200.0) {
             // Update temperature directly (more efficient than HTTP request)
             targetTemp[tempIndex] = newTemp;
+            bumpApiGeneration(API_RESOURCE_STATUS);
             mainScreenInstance->getUI()->showSuccess("Target: " + mainScreenInstance->formatTempForCallback(newTemp));
         } else {
             mainScreenInstance->getUI()->showError("Maximum temperature reached");
@@ -721,6 +711,7 @@ static void onTargetTempDown() {
         if (newTemp >= 0.0) {
             // Update temperature directly (more efficient than HTTP request)
             targetTemp[tempIndex] = newTemp;
+            bumpApiGeneration(API_RESOURCE_STATUS);
             mainScreenInstance->getUI()->showSuccess("Target: " + mainScreenInstance->formatTempForCallback(newTemp));
         } else {
             mainScreenInstance->getUI()->showError("Minimum temperature reached");
@@ -733,4 +724,49 @@ static void onRefresh() {
     mainScreenInstance->needsRedraw = true;
 }
 
- 
\ No newline at end of file
+ 
+// Readout formatters - same text as MainScreen::formatTemperature, written
+// straight into the label
+static void formatCurrentTemp(TFT_Label& text, uint16_t& color) {
+    extern bool thermocoupleError;
+    const TFT_Theme& theme = mainScreenInstance->getUI()->getTheme();
+    
+    if (thermocoupleError) {
+        text = "C:ERROR";
+    } else {
+        text.format("C:%.1fC", currentTemp);
+    }
+    color = thermocoupleError ? theme.errorColor : theme.primaryColor;  // Red for error, primary color for normal
+}
+
+static void formatTargetTemp(TFT_Label& text, uint16_t& color) {
+    extern bool thermocoupleError;
+    
+    // Use smoothed target temperature if available, otherwise fall back to raw target
+    int tempIndex = getCurrentTempIndex();
+    if (tempIndex < 0 || tempIndex >= maxTempPoints || !targetTemp) {
+        text = "T: --C";
+    } else if (thermocoupleError) {
+        text = "T:ERROR";
+    } else {
+        text.format("T:%.1fC", getSmoothedTargetTemperature());
+    }
+    color = mainScreenInstance->getUI()->getTheme().errorColor;  // Color code with Error color
+}
+
+static void formatSystemStatus(TFT_Label& text, uint16_t& color) {
+    const TFT_Theme& theme = mainScreenInstance->getUI()->getTheme();
+    text = systemEnabled ? "System: ON" : "System: OFF";
+    color = systemEnabled ? theme.successColor : theme.errorColor;
+}
+
+static void formatFurnaceStatus(TFT_Label& text, uint16_t& color) {
+    const TFT_Theme& theme = mainScreenInstance->getUI()->getTheme();
+    text = furnaceStatus ? "Furnace: ON" : "Furnace: OFF";
+    color = furnaceStatus ? theme.successColor : theme.errorColor;
+}
+
+static void formatFiringEnergy(TFT_Label& text, uint16_t& color) {
+    text.format("Energy: %.2fkWh", energyKWh(getEnergySnapshot().firing));
+    color = mainScreenInstance->getUI()->getTheme().textColor;
+}
@@ -32,7 +32,7 @@ public:
         
         // Only navigate if different screen
         if (targetScreen != ui->getCurrentScreen()) {
-            ui->setScreen(targetScreen);
+            ui->setScreenWithAnimation(targetScreen);
             return true;
         }
         
@@ -298,30 +298,43 @@ void TFT_UI::handleNavigationTouch(const TouchPoint& touch) {
     }
 }
 
-// Screen transition with animation support
+// Screen transition - with animate set, the new screen is rendered off-panel
+// through the DMA band buffers and appears as a single clean frame instead of
+// being painted element by element over a cleared content area. If the last
+// render of the screen is cached and still current it is blitted instead.
 void TFT_UI::setScreenWithAnimation(ScreenType screen, bool animate) {
     if (screen == currentScreen) return;
     
-    if (animate) {
-        // Simple fade animation
-        for (int alpha = 255; alpha >= 0; alpha -= 15) {
-            // Fade out current screen
-            delay(10);
-        }
-    }
-    
     // Save navigation state
     getNavigation().saveNavigationState(currentScreen);
     
-    // Switch screens
-    setScreen(screen);
+    if (!animate || !isBandRenderingEnabled() || screen < 0 || screen >= SCREEN_COUNT || !screens[screen]) {
+        setScreen(screen);
+        return;
+    }
     
-    if (animate) {
-        // Fade in new screen
-        for (int alpha = 0; alpha <= 255; alpha += 15) {
-            delay(10);
-        }
+    unsigned long switchStart = micros();
+    
+    if (screens[currentScreen]) {
+        screens[currentScreen]->onHide();
+    }
+    
+    currentScreen = screen;
+    screens[currentScreen]->onShow();
+    
+    // No fillRect on the content area - the cached frame or the banded render
+    // covers every pixel
+    bool fromCache = restoreScreenCache(screen);
+    if (!fromCache) {
+        renderContentBanded();
     }
+    screenNeedsRedraw = false;
+    
+    // Ensure status bar and navigation bar are redrawn
+    drawBufferedStatusBar();
+    drawBufferedNavBar();
+    
+    recordSwitchTime(micros() - switchStart, fromCache);
 }
 
 // Navigation utility functions
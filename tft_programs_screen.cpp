@@ -1,4 +1,5 @@
 #include "tft_ui.h"
+#include "profiler.h"
 #include <WiFi.h>
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
@@ -8,6 +9,7 @@ extern String programNames[MAX_PROGRAMS];
 extern int activeProgram;
 extern float** programTemps;
 extern int maxTempPoints;
+extern void ensureProgramLoaded(int programIndex);
 extern float currentTemp;
 extern float* targetTemp;
 extern bool furnaceStatus;
@@ -81,6 +83,7 @@ bool validateProgramData(int programIndex) {
     }
     
     // Check if program has any meaningful temperature data
+    ensureProgramLoaded(programIndex);
     TrimmedProgramData trimmed = trimProgramData(programTemps[programIndex], maxTempPoints);
     if (trimmed.trimmedLength <= 1) {
         return false;
@@ -211,6 +214,7 @@ void ProgramsScreen::init() {
 
 // Update screen data
 void ProgramsScreen::update() {
+    PROFILE_SCOPE("tft.programs.update");
     // Update temperature picker if visible (highest priority)
     if (tempPicker && showingTempPicker) {
         tempPicker->update();
@@ -243,6 +247,7 @@ void ProgramsScreen::update() {
     bool hasValidData = false;
     int dataPoints = 0;
     if (selectedProgram >= 0 && selectedProgram < MAX_PROGRAMS && programNames[selectedProgram].length() > 0) {
+        ensureProgramLoaded(selectedProgram);
         TrimmedProgramData trimmed = trimProgramData(programTemps[selectedProgram], maxTempPoints);
         hasValidData = (trimmed.trimmedLength > 1);
         dataPoints = trimmed.trimmedLength;
@@ -297,6 +302,7 @@ void ProgramsScreen::draw() {
     if (!needsRedraw) {
         return;
     }
+    PROFILE_SCOPE("tft.programs.draw");
     
     // Don't redraw the main screen when any picker is active
     if ((timePicker && showingTimeScheduler) || (tempPicker && showingTempPicker)) {
@@ -320,6 +326,21 @@ void ProgramsScreen::draw() {
         return;
     }
     
+    drawContent();
+    
+    // Draw time picker if visible (draws on top of everything)
+    if (timePicker && showingTimeScheduler) {
+        // Validate picker state and fix if out of sync
+        timePicker->validateState();
+        
+        // Don't redraw the picker here - it's already drawn in showTimeScheduler()
+        // The picker handles its own drawing and updates
+    }
+    
+    needsRedraw = false;
+}
+
+void ProgramsScreen::drawContent() {
     // Draw program list
     drawProgramList();
     
@@ -328,7 +349,7 @@ void ProgramsScreen::draw() {
     
     // Draw program controls
     drawProgramControls();
-    
+
     // Draw buttons
     for (int i = 0; i < buttonCount; i++) {
         ui->drawButton(buttons[i]);
@@ -338,17 +359,6 @@ void ProgramsScreen::draw() {
     for (int i = 0; i < textCount; i++) {
         ui->drawText(texts[i]);
     }
-    
-    // Draw time picker if visible (draws on top of everything)
-    if (timePicker && showingTimeScheduler) {
-        // Validate picker state and fix if out of sync
-        timePicker->validateState();
-        
-        // Don't redraw the picker here - it's already drawn in showTimeScheduler()
-        // The picker handles its own drawing and updates
-    }
-    
-    needsRedraw = false;
 }
 
 // Handle touch input
@@ -399,22 +409,18 @@ void ProgramsScreen::handleTouch(TouchPoint& touch) {
     }
     
     // Check button touches
-    for (int i = 0; i < buttonCount; i++) {
-        if (ui->isTouchInButton(touch, buttons[i])) {
-            if (buttons[i].state != BTN_DISABLED) {
-                buttons[i].state = BTN_PRESSED;
-                buttons[i].pressedTime = millis();
-                buttons[i].pressDuration = 100; // 100ms press duration
-                needsRedraw = true;
-                
-                // Handle button press or call callback
-                if (buttons[i].onPress) {
-                    buttons[i].onPress();
-                } else {
-                    handleButtonPress(i);
-                }
-            }
-            break;
+    int i = hitTestButtons(touch);
+    if (i >= 0 && buttons[i].state != BTN_DISABLED) {
+        buttons[i].state = BTN_PRESSED;
+        buttons[i].pressedTime = millis();
+        buttons[i].pressDuration = 100; // 100ms press duration
+        needsRedraw = true;
+        
+        // Handle button press or call callback
+        if (buttons[i].onPress) {
+            buttons[i].onPress();
+        } else {
+            handleButtonPress(i);
         }
     }
     
@@ -424,8 +430,7 @@ void ProgramsScreen::handleTouch(TouchPoint& touch) {
         if (programIndex >= 0 && programIndex < 4) { // 4 visible programs
             int actualProgram = scrollOffset + programIndex;
             if (actualProgram < MAX_PROGRAMS) {
-                selectedProgram = actualProgram;
-                needsRedraw = true;
+                selectProgram(actualProgram);
             }
         }
     }
@@ -486,6 +491,7 @@ void ProgramsScreen::drawProgramPreview() {
     
     // Draw simple program visualization
     if (selectedProgram >= 0 && selectedProgram < MAX_PROGRAMS && programTemps && programTemps[selectedProgram]) {
+        ensureProgramLoaded(selectedProgram);
         // Draw temperature curve
         int chartX = 15;
         int chartY = 45; // Adjusted for top card
@@ -598,12 +604,19 @@ void ProgramsScreen::drawProgramControls() {
     tft.setCursor(245, 175); // Moved right: 240 -> 245 (additional 5px)
     tft.print("Target:");
     
-    // Draw temperature values with selective clearing
     // Display current temperature with error handling
     extern bool thermocoupleError;
-    String tempStr = thermocoupleError ? "ERROR" : String(currentTemp, 1) + "C";
+    String tempStr, targetStr;
+    formatControlTemperatures(tempStr, targetStr);
     uint16_t tempColor = thermocoupleError ? theme.errorColor : theme.textColor;
-    drawSelectiveTemperature(245, 160, tempStr, lastCurrentTempStr, tempColor); // Moved right: 240 -> 245 (additional 5px)
+    drawControlTemperature(245, 160, tempStr, tempColor); // Moved right: 240 -> 245 (additional 5px)
+    drawControlTemperature(245, 185, targetStr, theme.errorColor); // Moved right: 240 -> 245 (additional 5px) and fixed to use smoothed target
+}
+
+// Format the current/target values shown in the info box
+void ProgramsScreen::formatControlTemperatures(String& currentStr, String& targetStr) {
+    extern bool thermocoupleError;
+    currentStr = thermocoupleError ? "ERROR" : String(currentTemp, 1) + "C";
     
     // Get smoothed target temperature (same logic as main screen)
     float displayTargetTemp = 0.0;
@@ -615,7 +628,34 @@ void ProgramsScreen::drawProgramControls() {
             displayTargetTemp = targetTemp[currentIndex];
         }
     }
-    drawSelectiveTemperature(245, 185, String(displayTargetTemp, 1) + "C", lastTargetTempStr, theme.errorColor); // Moved right: 240 -> 245 (additional 5px) and fixed to use smoothed target
+    targetStr = String(displayTargetTemp, 1) + "C";
+}
+
+// Content signature for the screen render cache
+uint32_t ProgramsScreen::getContentSignature() {
+    // Dialogs and pickers are not part of the cached screen
+    if (showingStartDialog || showingCreateDialog || showingTimeScheduler || showingTempPicker) {
+        return 0;
+    }
+    
+    uint32_t hash = hashScreenElements(CONTENT_HASH_SEED, *this);
+    hash = hashContent(hash, &selectedProgram, sizeof(selectedProgram));
+    hash = hashContent(hash, &scrollOffset, sizeof(scrollOffset));
+    hash = hashContent(hash, &programRunning, sizeof(programRunning));
+    hash = hashContent(hash, &activeProgram, sizeof(activeProgram));
+    for (int i = 0; i < 4 && scrollOffset + i < MAX_PROGRAMS; i++) {
+        hash = hashContent(hash, programNames[scrollOffset + i]);
+    }
+    // The selected program was loaded when it was selected (selectProgram)
+    if (selectedProgram >= 0 && selectedProgram < MAX_PROGRAMS && programTemps && programTemps[selectedProgram]) {
+        hash = hashContent(hash, programTemps[selectedProgram], maxTempPoints * sizeof(float));
+    }
+    
+    String currentStr, targetStr;
+    formatControlTemperatures(currentStr, targetStr);
+    hash = hashContent(hash, currentStr);
+    hash = hashContent(hash, targetStr);
+    return hash;
 }
 
 // Draw scroll indicator
@@ -636,39 +676,19 @@ void ProgramsScreen::drawScrollIndicator() {
     ui->getTFT().fillRect(indicatorX + 1, thumbY, 1, thumbHeight, ui->getTheme().primaryColor);
 }
 
-// Selective temperature drawing method to prevent text artifacts
-void ProgramsScreen::drawSelectiveTemperature(int x, int y, const String& newText, String& oldText, uint32_t textColor) {
-    // Force redraw every 10th call to handle edge cases where values don't update
-    static int forceRedrawCounter = 0;
-    forceRedrawCounter++;
-    bool forceRedraw = (forceRedrawCounter % 10 == 0);
-    
-    // Only redraw if text has changed or forced refresh
-    if (newText != oldText || forceRedraw) {
-        TFT_eSPI& tft = ui->getTFT();
-        const TFT_Theme& theme = ui->getTheme();
-        
-        // Calculate text dimensions for clearing
-        int textWidth = max(newText.length() * 6, oldText.length() * 6) + 15; // Extra padding for safety
-        int textHeight = 8 + 6; // Text size 1 + more padding
-        
-        // Clear the text area using card background (not white)
-        tft.fillRect(x - 3, y - 3, textWidth, textHeight, theme.cardBackground);
-        
-        // Draw the new text with specified color
-        tft.setTextColor(textColor);
-        tft.setTextSize(1);
-        tft.setCursor(x, y);
-        tft.print(newText);
-        
-        // Update the stored text
-        oldText = newText;
-        
-        // Debug output for temperature updates
-        if (forceRedraw) {
-            Serial.println("TFT: Forced temperature display refresh");
-        }
-    }
+// Draw one info box value. The box is repainted with every full draw and the
+// values are part of the content signature, so there is nothing to track.
+void ProgramsScreen::drawControlTemperature(int x, int y, const String& text, uint32_t textColor) {
+    TFT_eSPI& tft = ui->getTFT();
+    const TFT_Theme& theme = ui->getTheme();
+    
+    // Clear the text area using card background (not white)
+    tft.fillRect(x - 3, y - 3, text.length() * 6 + 15, 8 + 6, theme.cardBackground);
+    
+    tft.setTextColor(textColor);
+    tft.setTextSize(1);
+    tft.setCursor(x, y);
+    tft.print(text);
 }
 
 // Handle button press
@@ -676,30 +696,41 @@ void ProgramsScreen::handleButtonPress(int buttonIndex) {
     switch (buttonIndex) {
         case 0: // Up button - smart selection/scrolling
             if (selectedProgram > 0) {
-                selectedProgram--;
+                selectProgram(selectedProgram - 1);
                 
                 // If selection moved above visible area, scroll up
                 if (selectedProgram < scrollOffset) {
                     scrollOffset = selectedProgram;
                 }
-                needsRedraw = true;
             }
             break;
             
         case 1: // Down button - smart selection/scrolling
             if (selectedProgram < MAX_PROGRAMS - 1) {
-                selectedProgram++;
+                selectProgram(selectedProgram + 1);
                 
                 // If selection moved below visible area, scroll down
                 if (selectedProgram >= scrollOffset + 4) {
                     scrollOffset = selectedProgram - 3;
                 }
-                needsRedraw = true;
             }
             break;
     }
 }
 
+// Select a program and load its schedule, so drawing and the content
+// signature only read what is already in memory
+void ProgramsScreen::selectProgram(int programIndex) {
+    selectedProgram = programIndex;
+    ensureProgramLoaded(programIndex);
+    needsRedraw = true;
+}
+
+// On screen show
+void ProgramsScreen::onShow() {
+    selectProgram(selectedProgram);
+}
+
 // Update program status
 void ProgramsScreen::updateProgramStatus() {
     // Check if program is actually running and has valid temperature data
@@ -1225,16 +1256,19 @@ void ProgramsScreen::saveProgramToServer() {
                 hideProgramCreateDialog();
                 
                 // Update local data immediately for UI responsiveness
-                programNames[emptySlot] = editingProgramName;
-                for (int i = 0; i < maxTempPoints; i++) {
-                    if (i < (int)trimmed.temps.size()) {
-                        programTemps[emptySlot][i] = trimmed.temps[i];
-                    } else {
-                        programTemps[emptySlot][i] = 0.0f;
+                {
+                    ProgramStoreLock lock;
+                    programNames[emptySlot] = editingProgramName;
+                    for (int i = 0; i < maxTempPoints; i++) {
+                        if (i < (int)trimmed.temps.size()) {
+                            programTemps[emptySlot][i] = trimmed.temps[i];
+                        } else {
+                            programTemps[emptySlot][i] = 0.0f;
+                        }
                     }
                 }
                 
-                selectedProgram = emptySlot; // Select the newly created program
+                selectProgram(emptySlot); // Select the newly created program
             } else {
                 String error = responseDoc["error"].as<String>();
                 ui->showError("Save failed: " + error);
@@ -1,4 +1,5 @@
 #include "tft_ui.h"
+#include "profiler.h"
 #include <WiFi.h>
 
 // External variables from main firmware
@@ -252,6 +253,7 @@ void SettingsScreen::onShow() {
 
 // Update screen data
 void SettingsScreen::update() {
+    PROFILE_SCOPE("tft.settings.update");
     // Update number picker if visible
     if (numberPicker && showingNumberPicker) {
         numberPicker->update();
@@ -303,12 +305,29 @@ void SettingsScreen::draw() {
     if (!needsRedraw) {
         return;
     }
+    PROFILE_SCOPE("tft.settings.draw");
     
     // Validate that UI is available
     if (!ui) {
         return;
     }
     
+    drawContent();
+    
+    // Draw number picker if visible (draws on top of everything)
+    if (numberPicker && showingNumberPicker) {
+        // Validate picker state and fix if out of sync
+        numberPicker->validateState();
+        
+        // Draw the picker overlay (background, buttons, decimal point only)
+        // Individual wheels are drawn separately in the main update loop
+        numberPicker->drawStaticElements();
+    }
+    
+    needsRedraw = false;
+}
+
+void SettingsScreen::drawContent() {
     // Validate that TFT is available
     TFT_eSPI& tft = ui->getTFT();
     
@@ -349,18 +368,6 @@ void SettingsScreen::draw() {
             ui->drawText(texts[i]);
         }
     }
-    
-    // Draw number picker if visible (draws on top of everything)
-    if (numberPicker && showingNumberPicker) {
-        // Validate picker state and fix if out of sync
-        numberPicker->validateState();
-        
-        // Draw the picker overlay (background, buttons, decimal point only)
-        // Individual wheels are drawn separately in the main update loop
-        numberPicker->drawStaticElements();
-    }
-    
-    needsRedraw = false;
 }
 
 // Handle touch input
@@ -387,21 +394,19 @@ void SettingsScreen::handleTouch(TouchPoint& touch) {
     }
     
     // Check button touches
-    for (int i = 0; i < buttonCount; i++) {
-        if (ui->isTouchInButton(touch, buttons[i])) {
-            if (buttons[i].onPress) {
-                buttons[i].state = BTN_PRESSED;
-                buttons[i].pressedTime = millis();
-                buttons[i].pressDuration = 100; // 100ms press duration
-                needsRedraw = true;
-                
-                // Call button callback
-                buttons[i].onPress();
-            } else {
-                // Handle scroll and edit buttons
-                handleButtonPress(i);
-            }
-            break;
+    int i = hitTestButtons(touch);
+    if (i >= 0) {
+        if (buttons[i].onPress) {
+            buttons[i].state = BTN_PRESSED;
+            buttons[i].pressedTime = millis();
+            buttons[i].pressDuration = 100; // 100ms press duration
+            needsRedraw = true;
+            
+            // Call button callback
+            buttons[i].onPress();
+        } else {
+            // Handle scroll and edit buttons
+            handleButtonPress(i);
         }
     }
     
@@ -691,6 +696,10 @@ void SettingsScreen::performAction(int settingIndex) {
 // Handle scrolling
 void SettingsScreen::handleScrolling(TouchPoint& touch) {
     // Simple scroll handling - could be enhanced with momentum
+    // The list moves a whole row at a time and is repainted through the
+    // banded renderer rather than by blitting rows: the ILI9341 scroll
+    // window spans the full panel width, and these rows share their lines
+    // with the scroll indicator and the buttons.
     static int lastTouchY = 0;
     static unsigned long lastScrollTime = 0;
     
@@ -762,17 +771,10 @@ void SettingsScreen::onTimeSync() {
         return;
     }
     
-    // Call the main firmware's time sync function directly
+    // Runs in the background; the clock updates when the server answers
     extern void syncTime();
     syncTime();
-    
-    // Check if time sync was successful
-    extern bool timeIsSynchronized;
-    if (timeIsSynchronized) {
-        settingsScreenInstance->ui->showSuccess("Time synchronized");
-    } else {
-        settingsScreenInstance->ui->showError("Failed to sync time");
-    }
+    settingsScreenInstance->ui->showSuccess("Time sync started");
 }
 
 void SettingsScreen::onSaveSettings() {
@@ -856,6 +858,26 @@ bool SettingsScreen::hasActiveAnimations() {
     return false;
 }
 
+// Content signature for the screen render cache
+uint32_t SettingsScreen::getContentSignature() {
+    // The picker overlay is drawn outside draw(), never serve it from the cache
+    if (showingNumberPicker) {
+        return 0;
+    }
+    
+    uint32_t hash = hashScreenElements(CONTENT_HASH_SEED, *this);
+    hash = hashContent(hash, &scrollOffset, sizeof(scrollOffset));
+    hash = hashContent(hash, &selectedSetting, sizeof(selectedSetting));
+    for (int i = 0; i < 7; i++) {
+        int settingIndex = scrollOffset + i;
+        if (settingIndex < MAX_SETTINGS) {
+            hash = hashContent(hash, settingsItems[settingIndex].name);
+            hash = hashContent(hash, settingsItems[settingIndex].value);
+        }
+    }
+    return hash;
+}
+
 // Check if number picker is active (for modal blocking)
 bool SettingsScreen::hasActiveNumberPicker() {
     return numberPicker && showingNumberPicker && numberPicker->isVisible();
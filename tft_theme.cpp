@@ -50,12 +50,11 @@ public:
                 theme.highlightColor = hexToColor565(themeColors["highlightColor"].as<String>());
                 
                 // Set standard colors
-                theme.successColor = hexToColor565("#5cb85c");
-                theme.warningColor = hexToColor565("#f0ad4e");
-                theme.errorColor = hexToColor565("#d9534f");
-                theme.disabledColor = hexToColor565("#6c757d");
+                setStandardColors(theme);
                 theme.isDarkMode = isDark;
+                compilePalette(theme);
                 
+                http.end();
                 return true;
             }
         }
@@ -74,25 +73,23 @@ public:
         theme.highlightColor = hexToColor565(highlightColor);
         
         // Set standard colors
-        theme.successColor = hexToColor565("#5cb85c");
-        theme.warningColor = hexToColor565("#f0ad4e");
-        theme.errorColor = hexToColor565("#d9534f");
-        theme.disabledColor = hexToColor565("#6c757d");
+        setStandardColors(theme);
         theme.isDarkMode = isDarkMode;
+        compilePalette(theme);
     }
     
     uint16_t hexToColor565(const String& hex) {
-        if (hex.length() < 6) {
-            return 0x0000; // Black as fallback
+        // Parse in place - no substring copy on the heap
+        const char* digits = hex.c_str();
+        if (*digits == '#') {
+            digits++;
         }
-        
-        String cleanHex = hex;
-        if (cleanHex.startsWith("#")) {
-            cleanHex = cleanHex.substring(1);
+        if (strlen(digits) < 6) {
+            return 0x0000; // Black as fallback
         }
         
         // Convert hex to RGB
-        long number = strtol(cleanHex.c_str(), nullptr, 16);
+        unsigned long number = strtoul(digits, nullptr, 16);
         uint8_t r = (number >> 16) & 0xFF;
         uint8_t g = (number >> 8) & 0xFF;
         uint8_t b = number & 0xFF;
@@ -123,10 +120,51 @@ public:
         }
         
         // Common colors
-        theme.successColor = hexToColor565("#5cb85c");
-        theme.warningColor = hexToColor565("#f0ad4e");
-        theme.errorColor = hexToColor565("#d9534f");
-        theme.disabledColor = hexToColor565("#6c757d");
+        setStandardColors(theme);
+        compilePalette(theme);
+    }
+    
+    // Fixed status colors shared by every theme
+    void setStandardColors(TFT_Theme& theme) {
+        theme.successColor = THEME_SUCCESS_565;
+        theme.warningColor = THEME_WARNING_565;
+        theme.errorColor = THEME_ERROR_565;
+        theme.disabledColor = THEME_DISABLED_565;
+    }
+    
+    // Compile the theme into its palette table, including every derived shade
+    // used by the drawing code. Runs once per theme load.
+    void compilePalette(TFT_Theme& theme) {
+        uint16_t* pal = theme.palette;
+        
+        pal[PAL_PRIMARY] = theme.primaryColor;
+        pal[PAL_BACKGROUND] = theme.backgroundColor;
+        pal[PAL_CARD] = theme.cardBackground;
+        pal[PAL_TEXT] = theme.textColor;
+        pal[PAL_BORDER] = theme.borderColor;
+        pal[PAL_HIGHLIGHT] = theme.highlightColor;
+        pal[PAL_SUCCESS] = theme.successColor;
+        pal[PAL_WARNING] = theme.warningColor;
+        pal[PAL_ERROR] = theme.errorColor;
+        pal[PAL_DISABLED] = theme.disabledColor;
+        
+        // Button fills per state
+        pal[PAL_BUTTON_NORMAL] = theme.primaryColor;
+        pal[PAL_BUTTON_PRESSED] = darkenColor(theme.primaryColor, 0.2);
+        pal[PAL_BUTTON_DISABLED] = theme.disabledColor;
+        pal[PAL_BUTTON_ACTIVE] = lightenColor(theme.primaryColor, 0.2);
+        
+        // Button labels per state - contrast against the fill
+        pal[PAL_BUTTON_TEXT_NORMAL] = getContrastColor(pal[PAL_BUTTON_NORMAL]);
+        pal[PAL_BUTTON_TEXT_PRESSED] = getContrastColor(pal[PAL_BUTTON_PRESSED]);
+        pal[PAL_BUTTON_TEXT_DISABLED] = blendColors(theme.textColor, theme.backgroundColor, 0.5);
+        pal[PAL_BUTTON_TEXT_ACTIVE] = getContrastColor(pal[PAL_BUTTON_ACTIVE]);
+        
+        // Card shadow and chart grid
+        pal[PAL_CARD_SHADOW] = theme.isDarkMode ?
+            lightenColor(theme.backgroundColor, 0.1) :
+            darkenColor(theme.backgroundColor, 0.1);
+        pal[PAL_GRID] = blendColors(theme.textColor, theme.backgroundColor, 0.3);
     }
     
     String color565ToHex(uint16_t color) {
@@ -220,6 +258,9 @@ void TFT_UI::applyTheme() {
         return;
     }
     
+    // Cached screen renders may use colours the change check below ignores
+    invalidateScreenCaches();
+    
     // Check if theme has actually changed to avoid unnecessary full screen redraws
     static TFT_Theme lastTheme = {};
     static bool firstRun = true;
@@ -291,45 +332,37 @@ void TFT_UI::checkForThemeUpdates() {
     }
 }
 
-// Additional theme-related utility functions
+// Additional theme-related utility functions - palette lookups
 uint16_t getButtonColor(const TFT_Theme& theme, ButtonState state) {
-    switch (state) {
-        case BTN_NORMAL:
-            return theme.primaryColor;
-        case BTN_PRESSED:
-            return TFT_ThemeManager::getInstance().darkenColor(theme.primaryColor, 0.2);
-        case BTN_DISABLED:
-            return theme.disabledColor;
-        case BTN_ACTIVE:
-            return TFT_ThemeManager::getInstance().lightenColor(theme.primaryColor, 0.2);
-        default:
-            return theme.primaryColor;
+    if (state < BTN_NORMAL || state > BTN_ACTIVE) {
+        return theme.palette[PAL_BUTTON_NORMAL];
     }
+    return theme.palette[PAL_BUTTON_NORMAL + state];
 }
 
 uint16_t getTextColor(const TFT_Theme& theme, ButtonState state) {
-    switch (state) {
-        case BTN_DISABLED:
-            return TFT_ThemeManager::getInstance().blendColors(theme.textColor, theme.backgroundColor, 0.5);
-        default:
-            return TFT_ThemeManager::getInstance().getContrastColor(getButtonColor(theme, state));
+    if (state < BTN_NORMAL || state > BTN_ACTIVE) {
+        return theme.palette[PAL_BUTTON_TEXT_NORMAL];
     }
+    return theme.palette[PAL_BUTTON_TEXT_NORMAL + state];
 }
 
 uint16_t getCardShadowColor(const TFT_Theme& theme) {
-    return theme.isDarkMode ? 
-        TFT_ThemeManager::getInstance().lightenColor(theme.backgroundColor, 0.1) : 
-        TFT_ThemeManager::getInstance().darkenColor(theme.backgroundColor, 0.1);
+    return theme.palette[PAL_CARD_SHADOW];
 }
 
 uint16_t getGridColor(const TFT_Theme& theme) {
-    return TFT_ThemeManager::getInstance().blendColors(theme.textColor, theme.backgroundColor, 0.3);
+    return theme.palette[PAL_GRID];
 }
 
 uint16_t getContrastColor(uint16_t backgroundColor) {
     return TFT_ThemeManager::getInstance().getContrastColor(backgroundColor);
 }
 
+uint16_t blendColor565(uint16_t color1, uint16_t color2, float ratio) {
+    return TFT_ThemeManager::getInstance().blendColors(color1, color2, ratio);
+}
+
 // Export theme manager for external use
 TFT_ThemeManager& getThemeManager() {
     return TFT_ThemeManager::getInstance();
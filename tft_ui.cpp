@@ -1,4 +1,6 @@
 #include "tft_ui.h"
+#include "profiler.h"
+#include "metrics.h"
 #include <WiFi.h>
 #include <Preferences.h>
 
@@ -11,6 +13,7 @@ extern uint16_t getTextColor(const TFT_Theme& theme, ButtonState state);
 extern uint16_t getCardShadowColor(const TFT_Theme& theme);
 extern uint16_t getGridColor(const TFT_Theme& theme);
 extern uint16_t getContrastColor(uint16_t backgroundColor);
+extern uint16_t blendColor565(uint16_t color1, uint16_t color2, float ratio);
 
 // External variables from main firmware
 extern float currentTemp;
@@ -34,6 +37,8 @@ TFT_UI::TFT_UI() : touchscreenSPI(VSPI), touchscreen(XPT2046_CS, XPT2046_IRQ) {
 TFT_UI::~TFT_UI() {
     deleteScreens();
     cleanupSmallBuffers();
+    cleanupBandBuffers();
+    cleanupScreenCache();
 }
 
 // Initialize the TFT UI system
@@ -101,6 +106,15 @@ void TFT_UI::init() {
     // Initialize small region buffers
     initSmallBuffers();
     
+    // Initialize DMA band buffers for full content renders
+    initBandBuffers();
+    
+    // Enable per-screen render snapshots (needs PSRAM and band rendering)
+    initScreenCache();
+    
+    // Pre-render the large readout glyphs
+    buildGlyphCache();
+    
     // Set initial screen
     currentScreen = SCREEN_MAIN;
     screenNeedsRedraw = true;
@@ -127,10 +141,12 @@ void TFT_UI::initializeScreens() {
     screens[SCREEN_CHARTS] = new ChartsScreen(this);
     screens[SCREEN_WIFI_SETUP] = new WiFiSetupScreen(this);
     
-    // Initialize screens
+    // Initialize screens (button layout is fixed after init, so the touch
+    // grid is built once here)
     for (int i = 0; i < SCREEN_COUNT; i++) {
         if (screens[i]) {
             screens[i]->init();
+            screens[i]->buildHitGrid();
         }
     }
 }
@@ -176,6 +192,7 @@ void TFT_UI::showScreen(ScreenType screen) {
 
 // Main update loop
 void TFT_UI::update() {
+    PROFILE_SCOPE("tft.update");
     unsigned long currentTime = millis();
     
     // Check for theme updates from backend (periodic sync)
@@ -190,6 +207,7 @@ void TFT_UI::update() {
     static unsigned long lastStatusBarUpdate = 0;
     if (currentTime - lastStatusBarUpdate >= 1000) {
         lastStatusBarUpdate = currentTime;
+        PROFILE_SCOPE("tft.statusBar");
         drawBufferedStatusBar(); // Force status bar update for time
     }
     
@@ -200,7 +218,10 @@ void TFT_UI::update() {
     lastUpdate = currentTime;
     
     // Handle touch input
-    handleTouch();
+    {
+        PROFILE_SCOPE("tft.touch");
+        handleTouch();
+    }
     
     // Update current screen
     if (screens[currentScreen]) {
@@ -231,6 +252,7 @@ void TFT_UI::update() {
     
     // SELECTIVE REDRAW - only redraw changed regions
     if (screenNeedsRedraw) {
+        PROFILE_SCOPE("tft.redraw");
         // Always use selective redraw system
         drawSelectiveScreen();
         screenNeedsRedraw = false;
@@ -334,6 +356,95 @@ bool TFT_UI::isTouchInButton(const TouchPoint& touch, const TFT_Button& button)
             touch.y <= button.y + button.height);
 }
 
+// Re-evaluate a bound text widget. Returns true when its text or colour
+// changed and it needs drawing; the refresh interval throttles how often a
+// changing value is redrawn.
+bool TFT_UI::refreshBoundText(TFT_Text& text, unsigned long now) {
+    if (!text.formatter || !text.visible || now - text.lastRefresh < text.refreshInterval) {
+        return false;
+    }
+    
+    TFT_Label value = text.text;
+    uint16_t color = text.color;
+    text.formatter(value, color);
+    if (value == text.text && color == text.color) {
+        return false;
+    }
+    
+    text.text = value;
+    text.color = color;
+    text.lastRefresh = now;
+    return true;
+}
+
+// Build the touch grid from the current button rectangles
+void TFT_Screen::buildHitGrid() {
+    memset(hitGrid, 0, sizeof(hitGrid));
+    
+    for (int i = 0; i < buttonCount && i < 32; i++) {
+        const TFT_Button& button = buttons[i];
+        int col0 = constrain(button.x / HIT_GRID_CELL, 0, HIT_GRID_COLS - 1);
+        int col1 = constrain((button.x + button.width) / HIT_GRID_CELL, 0, HIT_GRID_COLS - 1);
+        int row0 = constrain(button.y / HIT_GRID_CELL, 0, HIT_GRID_ROWS - 1);
+        int row1 = constrain((button.y + button.height) / HIT_GRID_CELL, 0, HIT_GRID_ROWS - 1);
+        
+        for (int row = row0; row <= row1; row++) {
+            for (int col = col0; col <= col1; col++) {
+                hitGrid[row][col] |= (1UL << i);
+            }
+        }
+    }
+}
+
+// Find the first visible button under the touch (same rules as isTouchInButton)
+int TFT_Screen::hitTestButtons(const TouchPoint& touch) const {
+    if (!touch.isPressed || touch.x < 0 || touch.x >= TFT_WIDTH || touch.y < 0 || touch.y >= TFT_HEIGHT) {
+        return -1;
+    }
+    
+    uint32_t candidates = hitGrid[touch.y / HIT_GRID_CELL][touch.x / HIT_GRID_CELL];
+    for (int i = 0; candidates; i++, candidates >>= 1) {
+        if (!(candidates & 1)) {
+            continue;
+        }
+        
+        const TFT_Button& button = buttons[i];
+        if (button.visible &&
+            touch.x >= button.x && touch.x <= button.x + button.width &&
+            touch.y >= button.y && touch.y <= button.y + button.height) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Copy text into the inline buffer, truncating at capacity
+bool TFT_Label::set(const char* text) {
+    if (!text) {
+        text = "";
+    }
+    
+    size_t newLength = strnlen(text, TFT_LABEL_CAPACITY - 1);
+    if (newLength == length_ && memcmp(buffer, text, newLength) == 0) {
+        return false;
+    }
+    
+    memcpy(buffer, text, newLength);
+    buffer[newLength] = '\0';
+    length_ = newLength;
+    return true;
+}
+
+// printf-style formatting straight into the label
+bool TFT_Label::format(const char* fmt, ...) {
+    char formatted[TFT_LABEL_CAPACITY];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(formatted, sizeof(formatted), fmt, args);
+    va_end(args);
+    return set(formatted);
+}
+
 // Clear screen with background color
 void TFT_UI::clearScreen() {
     // Clear the entire screen with the background color
@@ -345,18 +456,20 @@ void TFT_UI::clearScreen() {
 void TFT_UI::drawButton(const TFT_Button& button) {
     if (!button.visible) return;
     
+    TFT_eSPI& gfx = getTFT();
+    
     uint16_t bgColor = getButtonColor(theme, button.state);
     uint16_t textColor = getTextColor(theme, button.state);
     
     // Draw button background - removed rounded corners
-    tft.fillRect(button.x, button.y, button.width, button.height, bgColor);
+    gfx.fillRect(button.x, button.y, button.width, button.height, bgColor);
     
     // Draw button border - removed rounded corners
-    tft.drawRect(button.x, button.y, button.width, button.height, theme.borderColor);
+    gfx.drawRect(button.x, button.y, button.width, button.height, theme.borderColor);
     
     // Draw button text
-    tft.setTextColor(textColor);
-    tft.setTextSize(1);
+    gfx.setTextColor(textColor);
+    gfx.setTextSize(1);
     
     // Center text in button
     int textWidth = button.text.length() * 6;
@@ -364,35 +477,39 @@ void TFT_UI::drawButton(const TFT_Button& button) {
     int textX = button.x + (button.width - textWidth) / 2;
     int textY = button.y + (button.height - textHeight) / 2;
     
-    tft.setCursor(textX, textY);
-    tft.println(button.text);
+    gfx.setCursor(textX, textY);
+    gfx.println(button.text.c_str());
 }
 
 // Draw text
 void TFT_UI::drawText(const TFT_Text& text) {
     if (!text.visible) return;
     
-    tft.setTextColor(text.color);
-    tft.setTextSize(text.size);
+    TFT_eSPI& gfx = getTFT();
+    
+    gfx.setTextColor(text.color);
+    gfx.setTextSize(text.size);
     
     if (text.centered) {
         int textWidth = text.text.length() * 6 * text.size;
         int centeredX = text.x - textWidth / 2;
-        tft.setCursor(centeredX, text.y);
+        gfx.setCursor(centeredX, text.y);
     } else {
-        tft.setCursor(text.x, text.y);
+        gfx.setCursor(text.x, text.y);
     }
     
-    tft.println(text.text);
+    gfx.println(text.text.c_str());
 }
 
 // Draw progress bar
 void TFT_UI::drawProgressBar(const TFT_ProgressBar& bar) {
     if (!bar.visible) return;
     
+    TFT_eSPI& gfx = getTFT();
+    
     // Draw background
-    tft.fillRect(bar.x, bar.y, bar.width, bar.height, bar.bgColor);
-    tft.drawRect(bar.x, bar.y, bar.width, bar.height, bar.borderColor);
+    gfx.fillRect(bar.x, bar.y, bar.width, bar.height, bar.bgColor);
+    gfx.drawRect(bar.x, bar.y, bar.width, bar.height, bar.borderColor);
     
     // Draw progress fill
     float progress = bar.value / bar.maxValue;
@@ -400,7 +517,7 @@ void TFT_UI::drawProgressBar(const TFT_ProgressBar& bar) {
     int fillWidth = bar.width * progress;
     
     if (fillWidth > 0) {
-        tft.fillRect(bar.x + 1, bar.y + 1, fillWidth - 2, bar.height - 2, bar.fillColor);
+        gfx.fillRect(bar.x + 1, bar.y + 1, fillWidth - 2, bar.height - 2, bar.fillColor);
     }
 }
 
@@ -408,9 +525,11 @@ void TFT_UI::drawProgressBar(const TFT_ProgressBar& bar) {
 void TFT_UI::drawChart(const TFT_Chart& chart) {
     if (!chart.visible || chart.pointCount < 2) return;
     
+    TFT_eSPI& gfx = getTFT();
+    
     // Draw background
-    tft.fillRect(chart.x, chart.y, chart.width, chart.height, chart.bgColor);
-    tft.drawRect(chart.x, chart.y, chart.width, chart.height, theme.borderColor);
+    gfx.fillRect(chart.x, chart.y, chart.width, chart.height, chart.bgColor);
+    gfx.drawRect(chart.x, chart.y, chart.width, chart.height, theme.borderColor);
     
     // Draw grid if enabled
     if (chart.showGrid) {
@@ -419,13 +538,13 @@ void TFT_UI::drawChart(const TFT_Chart& chart) {
         // Vertical grid lines
         for (int i = 1; i < 4; i++) {
             int x = chart.x + (chart.width * i) / 4;
-            tft.drawLine(x, chart.y, x, chart.y + chart.height, gridColor);
+            gfx.drawLine(x, chart.y, x, chart.y + chart.height, gridColor);
         }
         
         // Horizontal grid lines
         for (int i = 1; i < 4; i++) {
             int y = chart.y + (chart.height * i) / 4;
-            tft.drawLine(chart.x, y, chart.x + chart.width, y, gridColor);
+            gfx.drawLine(chart.x, y, chart.x + chart.width, y, gridColor);
         }
     }
     
@@ -451,31 +570,33 @@ void TFT_UI::drawChart(const TFT_Chart& chart) {
         x2 = max(chart.x, min(chart.x + chart.width, x2));
         y2 = max(chart.y, min(chart.y + chart.height, y2));
         
-        tft.drawLine(x1, y1, x2, y2, lineColor);
+        gfx.drawLine(x1, y1, x2, y2, lineColor);
     }
 }
 
 // Draw card with title
 void TFT_UI::drawCard(int x, int y, int width, int height, const String& title) {
+    TFT_eSPI& gfx = getTFT();
+    
     // Draw card background
-    tft.fillRoundRect(x, y, width, height, 8, theme.cardBackground);
+    gfx.fillRoundRect(x, y, width, height, 8, theme.cardBackground);
     
     // Draw card border
-    tft.drawRoundRect(x, y, width, height, 8, theme.borderColor);
+    gfx.drawRoundRect(x, y, width, height, 8, theme.borderColor);
     
     // Draw shadow effect
     uint16_t shadowColor = getCardShadowColor(theme);
-    tft.drawRoundRect(x + 2, y + 2, width, height, 8, shadowColor);
+    gfx.drawRoundRect(x + 2, y + 2, width, height, 8, shadowColor);
     
     // Draw title if provided
     if (title.length() > 0) {
-        tft.setTextColor(theme.textColor);
-        tft.setTextSize(1);
-        tft.setCursor(x + 8, y + 8);
-        tft.println(title);
+        gfx.setTextColor(theme.textColor);
+        gfx.setTextSize(1);
+        gfx.setCursor(x + 8, y + 8);
+        gfx.println(title);
         
         // Draw title underline
-        tft.drawLine(x + 8, y + 20, x + width - 8, y + 20, theme.borderColor);
+        gfx.drawLine(x + 8, y + 20, x + width - 8, y + 20, theme.borderColor);
     }
 }
 
@@ -777,7 +898,9 @@ DigitWheel::DigitWheel(TFT_UI* ui, int x, int y, int width, int height, int minD
     targetScrollOffset = 0.0f;
     isDragging = false;
     scrollVelocity = 0.0f;
-    lastAnimationTime = millis();
+    previousScrollOffset = 0.0f;
+    drawnScrollOffset = -1;
+    animClock.reset(millis());
     
     // Initialize constraint system
     constraintType = CONSTRAINT_NONE;
@@ -793,9 +916,32 @@ DigitWheel::~DigitWheel() {
 
 // Update animation and state
 void DigitWheel::update() {
-    unsigned long currentTime = millis();
-    float deltaTime = (currentTime - lastAnimationTime) / 1000.0f;
+    int steps = animClock.advance(millis());
+    
+    for (int i = 0; i < steps; i++) {
+        previousScrollOffset = scrollOffset;
+        stepPhysics(ANIM_STEP_MS / 1000.0f);
+    }
     
+    // Only redraw when the drawn position moves by a whole pixel
+    int renderOffset = (int)roundf(getRenderOffset());
+    if (renderOffset != drawnScrollOffset) {
+        wheelNeedsRedraw = true;
+    }
+    
+    updateScrollPosition();
+}
+
+// Offset to draw at - interpolated between the last two physics steps
+float DigitWheel::getRenderOffset() const {
+    if (isDragging) {
+        return scrollOffset;
+    }
+    return previousScrollOffset + (scrollOffset - previousScrollOffset) * animClock.alpha();
+}
+
+// One fixed physics step: inertia with friction, then easing onto the snap target
+void DigitWheel::stepPhysics(float deltaTime) {
     if (!isDragging) {
         // Reduced minimum velocity for inertial scrolling
         if (abs(scrollVelocity) > 0.8f) {
@@ -822,12 +968,10 @@ void DigitWheel::update() {
                     scrollVelocity = 0.0f;
                 }
             }
-            
-            wheelNeedsRedraw = true;
         }
         
         // Handle snapping with reduced speed
-        if (!isDragging && abs(targetScrollOffset - scrollOffset) > 0.1f) {
+        if (abs(targetScrollOffset - scrollOffset) > 0.1f) {
             float snapSpeed = 8.0f; // Reduced from 10.0f
             float delta = targetScrollOffset - scrollOffset;
             float movement = delta * snapSpeed * deltaTime;
@@ -837,7 +981,6 @@ void DigitWheel::update() {
             }
             
             scrollOffset += movement;
-            wheelNeedsRedraw = true;
             
             if (abs(targetScrollOffset - scrollOffset) < 0.1f) {
                 scrollOffset = targetScrollOffset;
@@ -845,9 +988,6 @@ void DigitWheel::update() {
             }
         }
     }
-    
-    updateScrollPosition();
-    lastAnimationTime = currentTime;
 }
 
 // Draw the wheel
@@ -877,7 +1017,8 @@ void DigitWheel::draw() {
     // Draw selection border
     //tft->drawRect(wheelX + 1, centerY - itemHeight/2, wheelWidth - 2, itemHeight, ui->getDrawingColor(theme.primaryColor));
     
-    // Draw digit items
+    // Draw digit items at the interpolated position
+    drawnScrollOffset = (int)roundf(getRenderOffset());
     drawWheelItems();
     
     // Draw top and bottom fade areas LAST so they appear over the numbers
@@ -913,7 +1054,7 @@ void DigitWheel::handleTouch(TouchPoint& touch) {
         
         if (touch.isPressed) {
             unsigned long currentTime = millis();
-            float deltaTime = (currentTime - lastTouchTime) / 1000.0f;
+            float deltaTime = max((currentTime - lastTouchTime) / 1000.0f, 0.001f);
             
             if (!isDragging) {
                 isDragging = true;
@@ -960,6 +1101,7 @@ void DigitWheel::handleTouch(TouchPoint& touch) {
             }
         } else if (isDragging) {
             isDragging = false;
+            previousScrollOffset = scrollOffset;
             
             // Adjusted velocity threshold for inertial scrolling
             if (abs(scrollVelocity) > 40.0f) {
@@ -971,6 +1113,7 @@ void DigitWheel::handleTouch(TouchPoint& touch) {
         }
     } else if (isDragging) {
         isDragging = false;
+        previousScrollOffset = scrollOffset;
         snapToNearest();
     }
 }
@@ -983,6 +1126,7 @@ void DigitWheel::setValue(int value) {
     // Position the scroll so the selected value is centered
     scrollOffset = (float)(index * itemHeight);
     targetScrollOffset = scrollOffset;
+    previousScrollOffset = scrollOffset;
     
     // Reset animation state
     scrollVelocity = 0.0f;
@@ -996,12 +1140,12 @@ void DigitWheel::setValue(int value) {
 // Draw wheel items
 void DigitWheel::drawWheelItems() {
     int totalItems = maxDigit - minDigit + 1;
-    int startIndex = max(0, (int)(scrollOffset / (float)itemHeight) - 2);
+    int startIndex = max(0, drawnScrollOffset / itemHeight - 2);
     int endIndex = min(totalItems - 1, startIndex + (wheelHeight / itemHeight) + 4);
     
     for (int i = startIndex; i <= endIndex; i++) {
         int digit = minDigit + i;
-        int itemY = wheelY + (i * itemHeight) - (int)scrollOffset + (wheelHeight / 2);
+        int itemY = wheelY + (i * itemHeight) - drawnScrollOffset + (wheelHeight / 2);
         
         // Only draw if item is visible
         if (itemY >= wheelY - itemHeight && itemY <= wheelY + wheelHeight) {
@@ -2164,14 +2308,387 @@ void TFT_UI::drawBufferedTempDisplay(int x, int y, int width, int height, const
 
 // ========================= END SMALL REGION BUFFERING =========================
 
+// ========================= DMA BAND RENDERING =========================
+// A full content-area buffer (320x190) does not fit next to the web server,
+// so full renders go through two thin bands instead: one band is drawn while
+// the other is pushed to the panel by DMA.
+
+// Initialize the two band buffers
+void TFT_UI::initBandBuffers() {
+    cleanupBandBuffers();
+
+    // SPI DMA cannot read from PSRAM, so bands always come from internal RAM.
+    // When PSRAM is present the other sprites live there and the bands can be
+    // taller, which halves the number of DMA transfers per frame.
+    bandHeight = psramFound() ? BAND_HEIGHT_PSRAM : BAND_HEIGHT_INTERNAL;
+
+    for (int i = 0; i < 2; i++) {
+        bandBuffers[i] = new TFT_eSprite(&tft);
+        bandBuffers[i]->setAttribute(PSRAM_ENABLE, false);
+        if (!bandBuffers[i]->createSprite(TFT_WIDTH, bandHeight)) {
+            // Not enough internal RAM - fall back to direct drawing
+            cleanupBandBuffers();
+            return;
+        }
+    }
+
+    if (!tft.initDMA()) {
+        cleanupBandBuffers();
+    }
+}
+
+// Clean up band buffers
+void TFT_UI::cleanupBandBuffers() {
+    for (int i = 0; i < 2; i++) {
+        if (bandBuffers[i]) {
+            bandBuffers[i]->deleteSprite();
+            delete bandBuffers[i];
+            bandBuffers[i] = nullptr;
+        }
+    }
+}
+
+// Render the current screen's content area as one clean frame.
+// The screen's drawContent() runs once per band with the band as drawing
+// target; the viewport datum shifts the band so screens keep using panel
+// coordinates. drawContent() only draws; needsRedraw is cleared once for the
+// whole frame after the last band.
+bool TFT_UI::renderContentBanded() {
+    TFT_Screen* screen = screens[currentScreen];
+    if (!isBandRenderingEnabled() || !screen) {
+        return false;
+    }
+
+    unsigned long frameStart = micros();
+    int contentBottom = CONTENT_AREA_Y + CONTENT_AREA_HEIGHT;
+    int bandIndex = 0;
+    int bands = 0;
+
+    // Snapshot is invalid until the whole frame has been captured
+    uint16_t* snapshot = nullptr;
+    if (screenCacheEnabled) {
+        screenCacheSignature[currentScreen] = 0;
+        if (!screenCache[currentScreen]) {
+            screenCache[currentScreen] = (uint16_t*)ps_malloc(TFT_WIDTH * CONTENT_AREA_HEIGHT * sizeof(uint16_t));
+        }
+        snapshot = screenCache[currentScreen];
+    }
+
+    // Sprite pixels are already in panel byte order
+    bool oldSwapBytes = tft.getSwapBytes();
+    tft.setSwapBytes(false);
+    tft.startWrite();
+
+    for (int bandY = CONTENT_AREA_Y; bandY < contentBottom; bandY += bandHeight) {
+        int rows = min(bandHeight, contentBottom - bandY);
+        TFT_eSprite* band = bandBuffers[bandIndex];
+
+        // Draw this band while the previous one is still transferring
+        band->fillSprite(theme.backgroundColor);
+        band->setViewport(0, -bandY, TFT_WIDTH, TFT_HEIGHT);
+        drawTarget = band;
+        screen->drawContent();
+        drawTarget = &tft;
+        band->resetViewport();
+
+        // Keep a copy of the band for the next visit to this screen
+        if (snapshot) {
+            memcpy(snapshot + (bandY - CONTENT_AREA_Y) * TFT_WIDTH, band->getPointer(),
+                   TFT_WIDTH * rows * sizeof(uint16_t));
+        }
+
+        // Previous band must be on the panel before this one is queued
+        tft.dmaWait();
+        tft.pushImageDMA(0, bandY, TFT_WIDTH, rows, (uint16_t*)band->getPointer());
+
+        bandIndex ^= 1;
+        bands++;
+    }
+
+    tft.dmaWait();
+    tft.endWrite();
+    tft.setSwapBytes(oldSwapBytes);
+
+    screen->needsRedraw = false;
+    if (snapshot) {
+        screenCacheSignature[currentScreen] = screen->getContentSignature();
+    }
+    frameStats.bandCount = bands;
+    recordFrameTime(micros() - frameStart);
+    return true;
+}
+
+// Track frame time for performance stats
+void TFT_UI::recordFrameTime(unsigned long frameUs) {
+    frameStats.frameCount++;
+    frameStats.lastFrameUs = frameUs;
+    if (frameUs > frameStats.maxFrameUs) {
+        frameStats.maxFrameUs = frameUs;
+    }
+
+    // Exponential moving average (1/8 weight for the new sample)
+    if (frameStats.frameCount == 1) {
+        frameStats.avgFrameUs = frameUs;
+    } else {
+        frameStats.avgFrameUs = (frameStats.avgFrameUs * 7 + frameUs) / 8;
+    }
+}
+
+// ========================= END DMA BAND RENDERING =========================
+
+// ========================= SCREEN RENDER CACHE =========================
+// Each banded render also leaves a copy of the content area in PSRAM. Going
+// back to a screen whose content signature has not changed is then a single
+// blit instead of a full draw. Without PSRAM there is no room for the
+// snapshots and every switch renders.
+
+// Enable the cache when PSRAM is available (snapshots are allocated lazily)
+void TFT_UI::initScreenCache() {
+    cleanupScreenCache();
+    screenCacheEnabled = psramFound() && isBandRenderingEnabled();
+}
+
+// Free all snapshots
+void TFT_UI::cleanupScreenCache() {
+    for (int i = 0; i < SCREEN_COUNT; i++) {
+        if (screenCache[i]) {
+            free(screenCache[i]);
+            screenCache[i] = nullptr;
+        }
+        screenCacheSignature[i] = 0;
+    }
+    screenCacheEnabled = false;
+}
+
+// Drop all snapshots (theme change, anything that alters every screen)
+void TFT_UI::invalidateScreenCaches() {
+    for (int i = 0; i < SCREEN_COUNT; i++) {
+        screenCacheSignature[i] = 0;
+    }
+}
+
+// Put a screen's cached content on the panel if it is still current
+bool TFT_UI::restoreScreenCache(ScreenType screen) {
+    if (!screenCacheEnabled || !screenCache[screen] || !screens[screen]) {
+        return false;
+    }
+
+    uint32_t signature = screens[screen]->getContentSignature();
+    if (signature == 0 || signature != screenCacheSignature[screen]) {
+        return false;
+    }
+
+    // Snapshot is in panel byte order. PSRAM is not DMA capable, so this is a
+    // regular blocking push.
+    bool oldSwapBytes = tft.getSwapBytes();
+    tft.setSwapBytes(false);
+    tft.pushImage(0, CONTENT_AREA_Y, TFT_WIDTH, CONTENT_AREA_HEIGHT, screenCache[screen]);
+    tft.setSwapBytes(oldSwapBytes);
+
+    screens[screen]->needsRedraw = false;
+    return true;
+}
+
+// Track screen switch latency for performance stats
+void TFT_UI::recordSwitchTime(unsigned long switchUs, bool fromCache) {
+    observeMetric(METRIC_TFT_SWITCH, switchUs);
+    switchStats.switchCount++;
+    if (fromCache) {
+        switchStats.cachedCount++;
+    }
+    switchStats.lastSwitchUs = switchUs;
+    if (switchUs > switchStats.maxSwitchUs) {
+        switchStats.maxSwitchUs = switchUs;
+    }
+
+    // Exponential moving average (1/8 weight for the new sample)
+    if (switchStats.switchCount == 1) {
+        switchStats.avgSwitchUs = switchUs;
+    } else {
+        switchStats.avgSwitchUs = (switchStats.avgSwitchUs * 7 + switchUs) / 8;
+    }
+}
+
+// FNV-1a over raw bytes
+uint32_t hashContent(uint32_t hash, const void* data, size_t length) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+uint32_t hashContent(uint32_t hash, const String& text) {
+    return hashContent(hash, text.c_str(), text.length() + 1);
+}
+
+uint32_t hashContent(uint32_t hash, const TFT_Label& text) {
+    return hashContent(hash, text.c_str(), text.length() + 1);
+}
+
+// Hash the generic text and button elements every screen draws
+uint32_t hashScreenElements(uint32_t hash, const TFT_Screen& screen) {
+    for (int i = 0; i < screen.textCount; i++) {
+        const TFT_Text& text = screen.texts[i];
+        hash = hashContent(hash, text.text);
+        hash = hashContent(hash, &text.color, sizeof(text.color));
+        hash = hashContent(hash, &text.visible, sizeof(text.visible));
+    }
+    for (int i = 0; i < screen.buttonCount; i++) {
+        const TFT_Button& button = screen.buttons[i];
+        hash = hashContent(hash, button.text);
+        hash = hashContent(hash, &button.state, sizeof(button.state));
+        hash = hashContent(hash, &button.visible, sizeof(button.visible));
+    }
+    return hash;
+}
+
+// ========================= END SCREEN RENDER CACHE =========================
+
+// ========================= GLYPH CACHE =========================
+// The size 2 readouts are the most frequently redrawn text on the panel.
+// Drawing them through print() issues a fillRect per font pixel; the cache
+// stores each glyph as a 12x16 coverage mask and pushes it in one window.
+
+// Build coverage masks for GLYPH_CACHE_CHARS
+void TFT_UI::buildGlyphCache() {
+    glyphCache.ready = false;
+    
+    TFT_eSprite mask(&tft);
+    mask.setColorDepth(1);
+    if (!mask.createSprite(6, 8)) {
+        return; // Readouts fall back to print()
+    }
+    mask.setTextSize(1);
+    mask.setTextColor(TFT_WHITE);
+    
+    const char* chars = GLYPH_CACHE_CHARS;
+    for (int g = 0; g < (int)GLYPH_CACHE_COUNT; g++) {
+        // Render the 6x8 font cell
+        bool src[8][6];
+        mask.fillSprite(TFT_BLACK);
+        mask.setCursor(0, 0);
+        mask.print(chars[g]);
+        for (int sy = 0; sy < 8; sy++) {
+            for (int sx = 0; sx < 6; sx++) {
+                src[sy][sx] = mask.readPixel(sx, sy) != TFT_BLACK;
+            }
+        }
+        
+        // Scale 2x with Scale2x (EPX) so diagonals step by one pixel instead
+        // of two. Pixels that Scale2x adds or removes get half coverage, which
+        // softens the edges when blended against the background.
+        uint8_t* alpha = glyphCache.alpha[g];
+        memset(alpha, 0, sizeof(glyphCache.alpha[g]));
+        for (int sy = 0; sy < 8; sy++) {
+            for (int sx = 0; sx < 6; sx++) {
+                bool p = src[sy][sx];
+                bool a = sy > 0 && src[sy - 1][sx];
+                bool b = sx < 5 && src[sy][sx + 1];
+                bool c = sx > 0 && src[sy][sx - 1];
+                bool d = sy < 7 && src[sy + 1][sx];
+                
+                bool e[4] = { p, p, p, p };
+                if (c == a && c != d && a != b) e[0] = a;
+                if (a == b && a != c && b != d) e[1] = b;
+                if (d == c && d != b && c != a) e[2] = c;
+                if (b == d && b != a && d != c) e[3] = d;
+                
+                for (int k = 0; k < 4; k++) {
+                    uint8_t level = (e[k] != p) ? 8 : (e[k] ? 15 : 0);
+                    int index = (sy * 2 + (k >> 1)) * GLYPH_WIDTH + sx * 2 + (k & 1);
+                    alpha[index >> 1] |= (index & 1) ? level : (level << 4);
+                }
+            }
+        }
+    }
+    
+    mask.deleteSprite();
+    
+    for (int i = 0; i < GLYPH_LUT_SLOTS; i++) {
+        glyphCache.lutValid[i] = false;
+    }
+    glyphCache.nextLutSlot = 0;
+    glyphCache.ready = true;
+}
+
+// Get the 16-level blend table for a foreground/background pair
+const uint16_t* TFT_UI::getGlyphLut(uint16_t fg, uint16_t bg) {
+    for (int i = 0; i < GLYPH_LUT_SLOTS; i++) {
+        if (glyphCache.lutValid[i] && glyphCache.lutFg[i] == fg && glyphCache.lutBg[i] == bg) {
+            return glyphCache.lut[i];
+        }
+    }
+    
+    // Compile into the oldest slot
+    int slot = glyphCache.nextLutSlot;
+    glyphCache.nextLutSlot = (slot + 1) % GLYPH_LUT_SLOTS;
+    
+    for (int level = 0; level < 16; level++) {
+        glyphCache.lut[slot][level] = blendColor565(bg, fg, level / 15.0f);
+    }
+    glyphCache.lut[slot][15] = fg;
+    glyphCache.lutFg[slot] = fg;
+    glyphCache.lutBg[slot] = bg;
+    glyphCache.lutValid[slot] = true;
+    
+    return glyphCache.lut[slot];
+}
+
+// Draw text from the glyph cache at size 2, background included
+bool TFT_UI::drawCachedText(int x, int y, const char* text, uint16_t fg, uint16_t bg) {
+    int length = strlen(text);
+    if (!glyphCache.ready || length == 0 || length > GLYPH_MAX_TEXT) {
+        return false;
+    }
+    
+    // Resolve every glyph first so an uncached character falls back cleanly
+    uint8_t glyphs[GLYPH_MAX_TEXT];
+    for (int i = 0; i < length; i++) {
+        const char* found = strchr(GLYPH_CACHE_CHARS, text[i]);
+        if (!found || text[i] == '\0') {
+            return false;
+        }
+        glyphs[i] = found - GLYPH_CACHE_CHARS;
+    }
+    
+    const uint16_t* lut = getGlyphLut(fg, bg);
+    uint16_t pixels[GLYPH_WIDTH * GLYPH_HEIGHT];
+    
+    TFT_eSPI& gfx = getTFT();
+    bool oldSwapBytes = gfx.getSwapBytes();
+    gfx.setSwapBytes(true);  // pixels[] is in native byte order
+    
+    for (int i = 0; i < length; i++) {
+        const uint8_t* alpha = glyphCache.alpha[glyphs[i]];
+        for (int p = 0; p < GLYPH_WIDTH * GLYPH_HEIGHT; p += 2) {
+            pixels[p] = lut[alpha[p >> 1] >> 4];
+            pixels[p + 1] = lut[alpha[p >> 1] & 0x0F];
+        }
+        gfx.pushImage(x + i * GLYPH_WIDTH, y, GLYPH_WIDTH, GLYPH_HEIGHT, pixels);
+    }
+    
+    gfx.setSwapBytes(oldSwapBytes);
+    return true;
+}
+
+// ========================= END GLYPH CACHE =========================
+
 // New selective screen drawing method
 void TFT_UI::drawSelectiveScreen() {
     // Always draw status bar first
     drawStatusBar();
     
-    // Draw the current screen content
+    // Draw the current screen content. Full redraws of cacheable content go
+    // through the bands so the screen's cached render stays in step with the
+    // panel; dialogs and pickers (signature 0) are drawn directly over it.
     if (screens[currentScreen]) {
-        screens[currentScreen]->draw();
+        bool banded = screens[currentScreen]->needsRedraw && !hasActiveModal() &&
+                      screens[currentScreen]->getContentSignature() != 0 && renderContentBanded();
+        if (!banded) {
+            screens[currentScreen]->draw();
+        }
     }
     
     // Draw navigation bar last unless there's an active modal
@@ -2192,19 +2709,21 @@ bool TFT_UI::hasTextChanged(const String& newText, const String& oldText) {
 // Optimized text drawing that only redraws if text has changed
 void TFT_UI::drawOptimizedText(int x, int y, const String& newText, String& oldText, 
                               uint16_t color, uint8_t size, bool clearBackground) {
+    TFT_eSPI& gfx = getTFT();
+    
     if (hasTextChanged(newText, oldText)) {
         if (clearBackground) {
             // Clear previous text area
             int textWidth = oldText.length() * 6 * size;
             int textHeight = 8 * size;
-            tft.fillRect(x, y, textWidth, textHeight, theme.backgroundColor);
+            gfx.fillRect(x, y, textWidth, textHeight, theme.backgroundColor);
         }
         
         // Draw new text
-        tft.setTextColor(color);
-        tft.setTextSize(size);
-        tft.setCursor(x, y);
-        tft.print(newText);
+        gfx.setTextColor(color);
+        gfx.setTextSize(size);
+        gfx.setCursor(x, y);
+        gfx.print(newText);
         
         // Update stored text
         oldText = newText;
@@ -2223,21 +2742,23 @@ void TFT_UI::drawCardOptimized(int x, int y, int width, int height, const String
                               bool forceRedraw) {
     if (!forceRedraw) return;
     
+    TFT_eSPI& gfx = getTFT();
+    
     // Draw outline first to establish boundaries
-    tft.drawRoundRect(x, y, width, height, 8, theme.borderColor);
+    gfx.drawRoundRect(x, y, width, height, 8, theme.borderColor);
     
     // Fill interior (slightly smaller to avoid overdrawing border)
-    tft.fillRoundRect(x + 1, y + 1, width - 2, height - 2, 7, theme.cardBackground);
+    gfx.fillRoundRect(x + 1, y + 1, width - 2, height - 2, 7, theme.cardBackground);
     
     // Draw title if provided
     if (title.length() > 0) {
-        tft.setTextColor(theme.textColor);
-        tft.setTextSize(1);
-        tft.setCursor(x + 8, y + 8);
-        tft.print(title);
+        gfx.setTextColor(theme.textColor);
+        gfx.setTextSize(1);
+        gfx.setCursor(x + 8, y + 8);
+        gfx.print(title);
         
         // Draw title underline
-        tft.drawLine(x + 8, y + 20, x + width - 8, y + 20, theme.borderColor);
+        gfx.drawLine(x + 8, y + 20, x + width - 8, y + 20, theme.borderColor);
     }
 }
 
@@ -2252,28 +2773,28 @@ void TFT_UI::adjustUpdateFrequency() {
     // Check if there's been recent touch activity
     bool recentActivity = (currentTime - lastTouchTime < 2000);
     
-    // Check if any animations are actually running
-    bool animationsRunning = false;
-    if (currentScreen == SCREEN_SETTINGS) {
-        SettingsScreen* settingsScreen = static_cast<SettingsScreen*>(screens[SCREEN_SETTINGS]);
-        if (settingsScreen && settingsScreen->hasActiveAnimations()) {
-            animationsRunning = true;
-        }
-    } else if (currentScreen == SCREEN_PROGRAMS) {
-        ProgramsScreen* programsScreen = static_cast<ProgramsScreen*>(screens[SCREEN_PROGRAMS]);
-        if (programsScreen && programsScreen->hasActiveAnimations()) {
-            animationsRunning = true;
-        }
-    }
-    
     // Adjust update interval based on activity
-    if (recentActivity || animationsRunning) {
+    if (hasActiveAnimations()) {
+        updateInterval = ANIM_FRAME_MS; // 30 FPS while wheels move
+    } else if (recentActivity) {
         updateInterval = 50; // 20 FPS for smooth interaction
     } else {
         updateInterval = 100; // 10 FPS for idle state
     }
 }
 
+// Check if any animations are actually running on the current screen
+bool TFT_UI::hasActiveAnimations() {
+    if (currentScreen == SCREEN_SETTINGS) {
+        SettingsScreen* settingsScreen = static_cast<SettingsScreen*>(screens[SCREEN_SETTINGS]);
+        return settingsScreen && settingsScreen->hasActiveAnimations();
+    } else if (currentScreen == SCREEN_PROGRAMS) {
+        ProgramsScreen* programsScreen = static_cast<ProgramsScreen*>(screens[SCREEN_PROGRAMS]);
+        return programsScreen && programsScreen->hasActiveAnimations();
+    }
+    return false;
+}
+
 // Force high frequency updates temporarily
 void TFT_UI::forceHighFrequencyUpdates(int durationMs) {
     updateInterval = 33; // 30 FPS
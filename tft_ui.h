@@ -6,6 +6,7 @@
 #include <HTTPClient.h>
 #include <WiFi.h>
 #include <ArduinoJson.h>
+#include "tft_anim_clock.h"
 
 // Screen dimensions
 #define TFT_WIDTH 320
@@ -56,6 +57,38 @@
 #define COLOR_YELLOW 0xFFE0
 #define COLOR_ORANGE 0xFD20
 
+// Semantic palette roles. The theme is compiled into a flat table once per
+// theme load, so draw calls look colors up instead of doing shade math.
+enum PaletteRole {
+    PAL_PRIMARY = 0,
+    PAL_BACKGROUND,
+    PAL_CARD,
+    PAL_TEXT,
+    PAL_BORDER,
+    PAL_HIGHLIGHT,
+    PAL_SUCCESS,
+    PAL_WARNING,
+    PAL_ERROR,
+    PAL_DISABLED,
+    PAL_BUTTON_NORMAL,          // PAL_BUTTON_NORMAL + ButtonState
+    PAL_BUTTON_PRESSED,
+    PAL_BUTTON_DISABLED,
+    PAL_BUTTON_ACTIVE,
+    PAL_BUTTON_TEXT_NORMAL,     // PAL_BUTTON_TEXT_NORMAL + ButtonState
+    PAL_BUTTON_TEXT_PRESSED,
+    PAL_BUTTON_TEXT_DISABLED,
+    PAL_BUTTON_TEXT_ACTIVE,
+    PAL_CARD_SHADOW,
+    PAL_GRID,
+    PAL_COUNT
+};
+
+// Fixed status colors (RGB 565 of the web UI's #5cb85c, #f0ad4e, #d9534f, #6c757d)
+#define THEME_SUCCESS_565 0x5DCB
+#define THEME_WARNING_565 0xF569
+#define THEME_ERROR_565 0xDA89
+#define THEME_DISABLED_565 0x6BAF
+
 // Theme structure
 struct TFT_Theme {
     uint16_t primaryColor;
@@ -69,8 +102,57 @@ struct TFT_Theme {
     uint16_t errorColor;
     uint16_t disabledColor;
     bool isDarkMode;
+    uint16_t palette[PAL_COUNT];  // Compiled from the colors above
+};
+
+// Glyph cache for the large (size 2) temperature readouts - 4-bit coverage
+// masks built once at init and blitted with a per-color-pair blend table
+#define GLYPH_CACHE_CHARS "0123456789.-:CT "
+#define GLYPH_CACHE_COUNT (sizeof(GLYPH_CACHE_CHARS) - 1)
+#define GLYPH_WIDTH 12
+#define GLYPH_HEIGHT 16
+#define GLYPH_LUT_SLOTS 4
+#define GLYPH_MAX_TEXT 12
+
+struct TFT_GlyphCache {
+    uint8_t alpha[GLYPH_CACHE_COUNT][GLYPH_WIDTH * GLYPH_HEIGHT / 2];  // 2 pixels per byte
+    uint16_t lutFg[GLYPH_LUT_SLOTS];
+    uint16_t lutBg[GLYPH_LUT_SLOTS];
+    uint16_t lut[GLYPH_LUT_SLOTS][16];
+    bool lutValid[GLYPH_LUT_SLOTS];
+    uint8_t nextLutSlot;
+    bool ready;
+};
+
+// Content area between the status bar and the navigation bar
+#define CONTENT_AREA_Y STATUS_BAR_HEIGHT
+#define CONTENT_AREA_HEIGHT (TFT_HEIGHT - STATUS_BAR_HEIGHT - NAV_BAR_HEIGHT)
+
+// DMA band rendering - bands live in internal DMA-capable RAM
+#define BAND_HEIGHT_INTERNAL 19   // 10 bands, 2 x 12.2KB when only internal RAM is available
+#define BAND_HEIGHT_PSRAM 38      // 5 bands, 2 x 24.3KB when PSRAM holds the other sprites
+
+// Frame timing for full content renders
+struct TFT_FrameStats {
+    unsigned long frameCount;
+    unsigned long lastFrameUs;
+    unsigned long avgFrameUs;
+    unsigned long maxFrameUs;
+    unsigned long bandCount;
+};
+
+// Screen switch latency, split by how the new screen got on the panel
+struct TFT_SwitchStats {
+    unsigned long switchCount;
+    unsigned long cachedCount;      // Restored from the screen render cache
+    unsigned long lastSwitchUs;
+    unsigned long avgSwitchUs;
+    unsigned long maxSwitchUs;
 };
 
+// Seed for hashContent() signatures (FNV-1a offset basis)
+#define CONTENT_HASH_SEED 2166136261UL
+
 // Screen types
 enum ScreenType {
     SCREEN_MAIN = 0,
@@ -98,10 +180,45 @@ struct TouchPoint {
     unsigned long timestamp;
 };
 
+// Fixed-capacity widget text stored inline. Assignment copies into the
+// buffer (truncating at capacity), so label updates never touch the heap.
+#define TFT_LABEL_CAPACITY 32
+
+class TFT_Label {
+public:
+    TFT_Label() : length_(0) { buffer[0] = '\0'; }
+    TFT_Label(const char* text) : length_(0) { buffer[0] = '\0'; set(text); }
+    TFT_Label& operator=(const char* text) { set(text); return *this; }
+    TFT_Label& operator=(const String& text) { set(text.c_str()); return *this; }
+    
+    // Both return true if the content changed
+    bool set(const char* text);
+    bool format(const char* fmt, ...);
+    
+    const char* c_str() const { return buffer; }
+    unsigned int length() const { return length_; }
+    
+    bool operator==(const char* other) const { return strcmp(buffer, other) == 0; }
+    bool operator!=(const char* other) const { return strcmp(buffer, other) != 0; }
+    bool operator==(const String& other) const { return *this == other.c_str(); }
+    bool operator!=(const String& other) const { return *this != other.c_str(); }
+    bool operator==(const TFT_Label& other) const { return *this == other.buffer; }
+    bool operator!=(const TFT_Label& other) const { return *this != other.buffer; }
+    
+private:
+    char buffer[TFT_LABEL_CAPACITY];
+    uint8_t length_;
+};
+
+// Value binding for a text widget: writes the current controller state into
+// the label and colour. TFT_UI::refreshBoundText() compares the result with
+// what is on the panel, so screens need no shadow copies of the values.
+typedef void (*TFT_TextFormatter)(TFT_Label& text, uint16_t& color);
+
 // UI components
 struct TFT_Button {
     int x, y, width, height;
-    String text;
+    TFT_Label text;
     ButtonState state;
     bool visible;
     uint16_t bgColor;
@@ -115,11 +232,14 @@ struct TFT_Button {
 
 struct TFT_Text {
     int x, y;
-    String text;
+    TFT_Label text;
     uint8_t size;
     uint16_t color;
     bool visible;
     bool centered;
+    TFT_TextFormatter formatter = nullptr;  // nullptr for static text
+    unsigned long refreshInterval = 0;      // Minimum ms between redraws of a bound value
+    unsigned long lastRefresh = 0;
 };
 
 struct TFT_ProgressBar {
@@ -150,6 +270,11 @@ struct TFT_Chart {
     bool showGrid;
 };
 
+// Touch hit grid (cells of HIT_GRID_CELL pixels, up to 32 buttons per screen)
+#define HIT_GRID_CELL 40
+#define HIT_GRID_COLS (TFT_WIDTH / HIT_GRID_CELL)
+#define HIT_GRID_ROWS (TFT_HEIGHT / HIT_GRID_CELL)
+
 // Base screen class
 class TFT_Screen {
 public:
@@ -161,12 +286,31 @@ public:
     virtual void onShow() {}
     virtual void onHide() {}
     
+    // Paint the whole content area from the current state. Banded rendering
+    // runs this once per band, so it only draws: clearing needsRedraw and any
+    // other per-frame bookkeeping stays in draw(). Required for screens with
+    // a non-zero content signature.
+    virtual void drawContent() {}
+    
+    // Signature of everything draw() puts on the panel. A cached render of the
+    // content area is reused only while the signature is unchanged; 0 means
+    // the screen is never served from the cache.
+    virtual uint32_t getContentSignature() { return 0; }
+    
+    // Touch hit testing through a coarse grid over the buttons. The grid is
+    // built once after init(); returns the button index or -1.
+    void buildHitGrid();
+    int hitTestButtons(const TouchPoint& touch) const;
+    
     // Common screen elements
     int buttonCount = 0;
     TFT_Button* buttons = nullptr;
     int textCount = 0;
     TFT_Text* texts = nullptr;
     bool needsRedraw = true;
+    
+    // Bit i set = button i overlaps the cell
+    uint32_t hitGrid[HIT_GRID_ROWS][HIT_GRID_COLS] = {};
 };
 
 // Main TFT UI Manager class
@@ -193,6 +337,7 @@ public:
     // Update and rendering
     void update();
     void forceRedraw();
+    bool refreshBoundText(TFT_Text& text, unsigned long now);
     
     // Touch handling
     void handleTouch();
@@ -235,6 +380,9 @@ public:
     // Selective drawing methods to reduce flickering
     void drawSelectiveScreen();
     
+    // Cached glyph text - returns false if any character is not cached
+    bool drawCachedText(int x, int y, const char* text, uint16_t fg, uint16_t bg);
+    
     // Anti-flickering utilities
     bool hasTextChanged(const String& newText, const String& oldText);
     void drawOptimizedText(int x, int y, const String& newText, String& oldText, 
@@ -247,17 +395,29 @@ public:
     void adjustUpdateFrequency();
     void forceHighFrequencyUpdates(int durationMs = 1000);
     bool shouldUseHighFrequency();
+    bool hasActiveAnimations();
     
     // Data access
     TFT_Theme& getTheme() { return theme; }
     bool isThemeLoaded() { return themeLoaded; }
     
-    // Hardware access
-    TFT_eSPI& getTFT() { return tft; }
+    // Hardware access - getTFT() returns the current drawing target, which is
+    // a band sprite while renderContentBanded() is running
+    TFT_eSPI& getTFT() { return *drawTarget; }
     XPT2046_Touchscreen& getTouchscreen() { return touchscreen; }
-    
-    // Get current drawing target (always main TFT)
-    TFT_eSPI* getDrawingTFT() { return &tft; }
+
+    // Get current drawing target (main TFT or active band buffer)
+    TFT_eSPI* getDrawingTFT() { return drawTarget; }
+
+    // DMA band rendering
+    bool renderContentBanded();
+    bool isBandRenderingEnabled() { return bandBuffers[0] && bandBuffers[1]; }
+    const TFT_FrameStats& getFrameStats() { return frameStats; }
+
+    // Per-screen render cache (content area snapshots, PSRAM only)
+    bool isScreenCacheEnabled() { return screenCacheEnabled; }
+    void invalidateScreenCaches();
+    const TFT_SwitchStats& getSwitchStats() { return switchStats; }
     
     // Color conversion for drawing operations (simplified)
     uint32_t getDrawingColor(uint16_t color565) { return color565; }
@@ -273,7 +433,23 @@ private:
     TFT_eSprite* statusBarBuffer = nullptr;
     TFT_eSprite* navBarBuffer = nullptr;
     bool smallBuffersEnabled = true;
-    
+
+    // DMA band buffers - the content area is rendered into one band while
+    // the other is being pushed to the panel
+    TFT_eSprite* bandBuffers[2] = { nullptr, nullptr };
+    int bandHeight = 0;
+    TFT_eSPI* drawTarget = &tft;
+    TFT_FrameStats frameStats = { 0, 0, 0, 0, 0 };
+
+    // Content area snapshot per screen, captured during banded renders
+    uint16_t* screenCache[SCREEN_COUNT] = {};
+    uint32_t screenCacheSignature[SCREEN_COUNT] = {};
+    bool screenCacheEnabled = false;
+    TFT_SwitchStats switchStats = { 0, 0, 0, 0, 0 };
+
+    // Pre-rendered readout glyphs
+    TFT_GlyphCache glyphCache = {};
+
     // Theme
     TFT_Theme theme;
     bool themeLoaded = false;
@@ -315,7 +491,22 @@ private:
     void drawBufferedStatusBar();
     void drawBufferedNavBar();
     void drawBufferedTempDisplay(int x, int y, int width, int height, const String& text);
-    
+
+    // DMA band buffer methods
+    void initBandBuffers();
+    void cleanupBandBuffers();
+    void recordFrameTime(unsigned long frameUs);
+
+    // Screen render cache methods
+    void initScreenCache();
+    void cleanupScreenCache();
+    bool restoreScreenCache(ScreenType screen);
+    void recordSwitchTime(unsigned long switchUs, bool fromCache);
+
+    // Glyph cache methods
+    void buildGlyphCache();
+    const uint16_t* getGlyphLut(uint16_t fg, uint16_t bg);
+
     // Default theme colors
     void setDefaultTheme();
 };
@@ -339,7 +530,7 @@ public:
     
     void forceRedraw() { wheelNeedsRedraw = true; }
     bool needsRedraw() const { return wheelNeedsRedraw; }
-    bool isAnimating() const { return abs(scrollVelocity) > 0.1f || abs(targetScrollOffset - scrollOffset) > 1.0f; }
+    bool isAnimating() const { return isDragging || abs(scrollVelocity) > 0.1f || abs(targetScrollOffset - scrollOffset) > 0.1f; }
     
     // Enhanced constraint methods
     void setTimeConstraints(int position, int maxValue = 235959);
@@ -361,7 +552,11 @@ private:
     float scrollVelocity;
     bool isDragging;
     int itemHeight;
-    unsigned long lastAnimationTime;
+    
+    // Fixed-step integration; the wheel is drawn at the interpolated offset
+    TFT_AnimClock animClock;
+    float previousScrollOffset;
+    int drawnScrollOffset;
     
     // Drawing
     bool wheelNeedsRedraw = true;
@@ -382,6 +577,8 @@ private:
     void updateScrollPosition();
     void snapToNearest();
     int getDigitAtPosition(int y);
+    void stepPhysics(float deltaTime);
+    float getRenderOffset() const;
     
     // Constraint calculation methods
     void calculateConstraintsForDigit();
@@ -468,8 +665,10 @@ public:
     void init() override;
     void update() override;
     void draw() override;
+    void drawContent() override;
     void handleTouch(TouchPoint& touch) override;
     void onShow() override;
+    uint32_t getContentSignature() override;
     
     // Public accessor methods for static callbacks
     TFT_UI* getUI() { return ui; }
@@ -486,13 +685,6 @@ private:
     unsigned long lastChartUpdate;
     unsigned long lastSecondUpdate; // Timer for 1-second updates
     
-    // Change tracking variables for anti-flashing (from V20 technique)
-    float lastDisplayedCurrentTemp;
-    float lastDisplayedTargetTemp;
-    bool lastDisplayedFurnaceStatus;
-    bool lastDisplayedSystemEnabled;
-    String lastTimeString;
-    
     // UI components
     TFT_Chart tempChart;
     TFT_ProgressBar tempBar;
@@ -509,6 +701,7 @@ private:
     void drawSelectiveButton(int index);
     void drawSelectiveChart();
     void drawSelectiveProgressBar();
+    bool drawCachedReadout(int index);
 
     // Helper methods
     String formatTemperature(float temp);
@@ -522,8 +715,10 @@ public:
     void init() override;
     void update() override;
     void draw() override;
+    void drawContent() override;
     void handleTouch(TouchPoint& touch) override;
     void onShow() override;
+    uint32_t getContentSignature() override;
     
     // Animation checking for adaptive update frequency
     bool hasActiveAnimations();
@@ -583,7 +778,10 @@ public:
     void init() override;
     void update() override;
     void draw() override;
+    void drawContent() override;
     void handleTouch(TouchPoint& touch) override;
+    void onShow() override;
+    uint32_t getContentSignature() override;
     
     // Animation checking for adaptive update frequency
     bool hasActiveAnimations();
@@ -600,10 +798,6 @@ private:
     bool programRunning = false;
     int scrollOffset = 0; // Add scrolling support
     
-    // Temperature display tracking for selective drawing
-    String lastCurrentTempStr = "";
-    String lastTargetTempStr = "";
-    
     // Program start dialog state
     bool showingStartDialog = false;
     bool showingTimeScheduler = false;
@@ -631,6 +825,7 @@ private:
     void updateProgramStatus();
     void drawScrollIndicator();
     void handleButtonPress(int buttonIndex);
+    void selectProgram(int programIndex);
     
     // Program start dialog methods
     void showProgramStartDialog();
@@ -666,8 +861,8 @@ private:
     static void onTimeSelected(float value);
     static void onTimeScheduleCancelled();
     
-    // Selective drawing method to prevent temperature text artifacts
-    void drawSelectiveTemperature(int x, int y, const String& newText, String& oldText, uint32_t textColor);
+    void drawControlTemperature(int x, int y, const String& text, uint32_t textColor);
+    void formatControlTemperatures(String& currentStr, String& targetStr);
 };
 
 class ChartsScreen : public TFT_Screen {
@@ -678,8 +873,10 @@ public:
     void init() override;
     void update() override;
     void draw() override;
+    void drawContent() override;
     void handleTouch(TouchPoint& touch) override;
     void onShow() override;
+    uint32_t getContentSignature() override;
     
     // Public members for chart display
     float minTempDisplay;
@@ -715,8 +912,10 @@ public:
     void init() override;
     void update() override;
     void draw() override;
+    void drawContent() override;
     void handleTouch(TouchPoint& touch) override;
     void onShow() override;
+    uint32_t getContentSignature() override;
     
 private:
     TFT_UI* ui;
@@ -736,6 +935,12 @@ String formatTime(unsigned long timestamp);
 String formatTemperature(float temp);
 String formatDuration(unsigned long duration);
 
+// Content signature helpers (FNV-1a)
+uint32_t hashContent(uint32_t hash, const void* data, size_t length);
+uint32_t hashContent(uint32_t hash, const String& text);
+uint32_t hashContent(uint32_t hash, const TFT_Label& text);
+uint32_t hashScreenElements(uint32_t hash, const TFT_Screen& screen);
+
 // External functions from main firmware
 extern String getCurrentTime();
 
@@ -1,4 +1,5 @@
 #include "tft_ui.h"
+#include "profiler.h"
 
 // Static instance for callbacks
 static WiFiSetupScreen* wifiSetupScreenInstance = nullptr;
@@ -71,6 +72,7 @@ void WiFiSetupScreen::init() {
 
 // Update screen data
 void WiFiSetupScreen::update() {
+    PROFILE_SCOPE("tft.wifiSetup.update");
     // Get actual AP password from wifi_manager
     extern String ap_password;
     String passwordText = "Password: " + (ap_password.length() > 0 ? ap_password : "generating...");
@@ -107,7 +109,12 @@ void WiFiSetupScreen::update() {
 // Draw screen
 void WiFiSetupScreen::draw() {
     if (!needsRedraw) return;
-    
+    PROFILE_SCOPE("tft.wifiSetup.draw");
+    drawContent();
+    needsRedraw = false;
+}
+
+void WiFiSetupScreen::drawContent() {
     // Clear main content area
     const TFT_Theme& theme = ui->getTheme();
     ui->getTFT().fillRect(0, 20, TFT_WIDTH, TFT_HEIGHT - 50, theme.backgroundColor);
@@ -125,7 +132,7 @@ void WiFiSetupScreen::draw() {
             ui->getTFT().setTextSize(texts[i].size);
             ui->getTFT().setTextColor(texts[i].color);
             ui->getTFT().setCursor(centeredX, texts[i].y);
-            ui->getTFT().print(texts[i].text);
+            ui->getTFT().print(texts[i].text.c_str());
         } else {
             ui->drawText(texts[i]);
         }
@@ -133,8 +140,6 @@ void WiFiSetupScreen::draw() {
     
     // Draw button
     ui->drawButton(buttons[0]);
-    
-    needsRedraw = false;
 }
 
 // Handle touch input
@@ -145,7 +150,7 @@ void WiFiSetupScreen::handleTouch(TouchPoint& touch) {
     }
     
     // Check button touch
-    if (ui->isTouchInButton(touch, buttons[0])) {
+    if (hitTestButtons(touch) == 0) {
         if (buttons[0].onPress) {
             buttons[0].state = BTN_PRESSED;
             buttons[0].pressedTime = millis();
@@ -165,6 +170,11 @@ void WiFiSetupScreen::onShow() {
     needsRedraw = true;
 }
 
+// Content signature for the screen render cache
+uint32_t WiFiSetupScreen::getContentSignature() {
+    return hashScreenElements(CONTENT_HASH_SEED, *this);
+}
+
 // Static callback for skip button
 void WiFiSetupScreen::onSkip() {
     if (wifiSetupScreenInstance && wifiSetupScreenInstance->ui) {
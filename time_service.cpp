@@ -0,0 +1,127 @@
+#include "time_service.h"
+#include "config.h"
+#include "api_cache.h"
+#include <esp_sntp.h>
+#include <sys/time.h>
+
+extern bool timeIsSynchronized;
+extern bool useManualTime;
+
+// Written by the SNTP callback on the lwIP task, consumed by loop()
+static portMUX_TYPE timeSyncMux = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool syncPending = false;
+static int64_t pendingOffsetMs = 0;
+static bool pendingSlewed = false;
+static uint32_t pendingSyncMillis = 0;
+
+static volatile bool syncRequested = false;
+static bool serviceStarted = false;
+static bool sntpPaused = false;       // Stopped while manual time is in use
+static TimeSyncStats stats;
+
+// In smooth mode SNTP has just started adjtime() when this runs, so the
+// local clock still shows the uncorrected time. A stepped sync (first sync
+// or a very large error) has already been applied and has no offset left.
+static void onTimeSynced(struct timeval *tv) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  int64_t offset = ((int64_t)tv->tv_sec - now.tv_sec) * 1000 + ((int64_t)tv->tv_usec - now.tv_usec) / 1000;
+  bool slewed = sntp_get_sync_status() == SNTP_SYNC_STATUS_IN_PROGRESS;
+
+  portENTER_CRITICAL(&timeSyncMux);
+  pendingOffsetMs = slewed ? offset : 0;
+  pendingSlewed = slewed;
+  pendingSyncMillis = millis();
+  syncPending = true;
+  portEXIT_CRITICAL(&timeSyncMux);
+}
+
+// SNTP would step or slew away a time set by hand, and its drift figure
+// means nothing against a clock it is still adjusting: it is stopped
+// while manual time is on and started again when it is turned off
+static void applyManualTimeMode() {
+  if (!serviceStarted) return;
+  if (useManualTime && !sntpPaused) {
+    sntp_stop();
+    // Cancel what is left of a smooth correction
+    struct timeval zero = { 0, 0 };
+    adjtime(&zero, NULL);
+    sntpPaused = true;
+    Serial.println("Time: SNTP stopped for manual time");
+  } else if (!useManualTime && sntpPaused) {
+    sntp_init();
+    sntpPaused = false;
+    Serial.println("Time: SNTP restarted");
+  }
+}
+
+void beginTimeService() {
+  if (serviceStarted) {
+    requestTimeSync();
+    return;
+  }
+
+  sntp_set_time_sync_notification_cb(onTimeSynced);
+  sntp_set_sync_interval(TIME_SYNC_INTERVAL_SEC * 1000UL);
+  sntp_set_sync_mode(SNTP_SYNC_MODE_SMOOTH);
+  configTime(GMT_OFFSET_SEC, DAYLIGHT_OFFSET_SEC, NTP_SERVER);
+  serviceStarted = true;
+  Serial.println("Time: SNTP started");
+  applyManualTimeMode();
+}
+
+void requestTimeSync() {
+  syncRequested = true;
+}
+
+void updateTimeService() {
+  applyManualTimeMode();
+
+  if (syncRequested) {
+    syncRequested = false;
+    if (serviceStarted && !sntpPaused) {
+      sntp_restart();
+      Serial.println("Time: Sync requested");
+    }
+  }
+
+  if (!syncPending) return;
+
+  portENTER_CRITICAL(&timeSyncMux);
+  int64_t offset = pendingOffsetMs;
+  bool slewed = pendingSlewed;
+  uint32_t syncMillis = pendingSyncMillis;
+  syncPending = false;
+  portEXIT_CRITICAL(&timeSyncMux);
+
+  // Landed just before SNTP was stopped; its correction was cancelled
+  if (sntpPaused) return;
+
+  // The previous sync left the clock right, so the whole offset is drift
+  if (slewed && stats.syncs > 0 && syncMillis > stats.lastSyncMillis) {
+    stats.driftPpm = (float)offset * 1000000.0f / (syncMillis - stats.lastSyncMillis);
+  }
+  stats.lastOffsetMs = (int32_t)offset;
+  stats.lastSyncMillis = syncMillis;
+  stats.syncs++;
+
+  timeIsSynchronized = true;
+  bumpApiGeneration(API_RESOURCE_STATUS);
+
+  Serial.print("Time: Synchronized, ");
+  if (slewed) {
+    Serial.print("slewing ");
+    Serial.print((long)offset);
+    Serial.print(" ms, drift ");
+    Serial.print(stats.driftPpm, 1);
+    Serial.println(" ppm");
+  } else {
+    Serial.println("clock stepped");
+  }
+}
+
+TimeSyncStats getTimeSyncStats() {
+  TimeSyncStats current = stats;
+  current.slewing = serviceStarted && !sntpPaused && sntp_get_sync_status() == SNTP_SYNC_STATUS_IN_PROGRESS;
+  return current;
+}
@@ -0,0 +1,40 @@
+#ifndef TIME_SERVICE_H
+#define TIME_SERVICE_H
+
+#include <Arduino.h>
+
+// =================================================================
+//                  NTP TIME SERVICE
+// =================================================================
+// SNTP runs in the background and reports each sync through a callback,
+// so nothing waits for a time server. Syncs after the first use smooth
+// mode: the clock is slewed towards NTP time instead of stepped, so the
+// schedule never jumps mid-ramp (only errors over ~35 minutes are
+// stepped). Each sync's offset against the local clock, and the drift it
+// implies since the previous sync, are kept for /api/status. SNTP is
+// stopped while manual time is on, so it cannot move a time set by hand.
+
+// Seconds between background syncs
+#define TIME_SYNC_INTERVAL_SEC 3600
+
+struct TimeSyncStats {
+    uint32_t syncs;                   // Syncs since boot
+    uint32_t lastSyncMillis;          // millis() at the last sync, 0 if none
+    int32_t lastOffsetMs;             // NTP time minus local time at the last sync
+    float driftPpm;                   // Local clock drift between the last two syncs
+    bool slewing;                     // A smooth correction is still being applied
+};
+
+// Start SNTP (call when the station gets an IP; safe to call again)
+void beginTimeService();
+
+// Ask for a sync now. Returns at once; completion shows in the stats.
+void requestTimeSync();
+
+// Apply completed syncs to timeIsSynchronized and log them, and stop or
+// restart SNTP when manual time is switched (call every loop)
+void updateTimeService();
+
+TimeSyncStats getTimeSyncStats();
+
+#endif // TIME_SERVICE_H
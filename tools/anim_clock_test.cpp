@@ -0,0 +1,133 @@
+// Host tests for the fixed-timestep animation clock (tft_anim_clock.h):
+// steps are capped after a stall, the remainder of a step carries over
+// between frames, and the interpolation alpha puts a steadily moving
+// wheel where continuous motion would have it.
+//
+// Build and run from the repository root:
+//
+//   g++ -std=c++17 -O1 -g -Wall -fsanitize=address,undefined -I. -o anim_clock_test tools/anim_clock_test.cpp && ./anim_clock_test
+//
+// Exits 1 if any check fails. Frame times are seeded, so a failure
+// repeats; pass a seed as the first argument to try others.
+
+#include "tft_anim_clock.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define RANDOM_FRAMES 100000
+
+static int failures = 0;
+static uint32_t rngState = 1;
+
+#define CHECK(condition, ...) do { \
+    if (!(condition)) { \
+      failures++; \
+      fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+      fprintf(stderr, __VA_ARGS__); \
+      fprintf(stderr, "\n"); \
+    } \
+  } while (0)
+
+static uint32_t nextRandom() {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState;
+}
+
+// A long stall runs at most ANIM_MAX_STEPS and drops the rest of the
+// backlog; only the part of a step carries over
+static void testStepCap() {
+  TFT_AnimClock clock;
+  clock.reset(1000);
+  int steps = clock.advance(1000 + 5000 + 3);
+  CHECK(steps == ANIM_MAX_STEPS, "5 s stall ran %d steps", steps);
+  CHECK(clock.accumulator == 3, "stall left %u ms in the accumulator", clock.accumulator);
+
+  steps = clock.advance(1000 + 5000 + 3 + ANIM_STEP_MS);
+  CHECK(steps == 1, "frame after the stall ran %d steps", steps);
+
+  // Exactly the cap is not a stall
+  clock.reset(0);
+  steps = clock.advance(ANIM_MAX_STEPS * ANIM_STEP_MS);
+  CHECK(steps == ANIM_MAX_STEPS && clock.accumulator == 0, "%d steps, %u ms left at the cap",
+        steps, clock.accumulator);
+}
+
+// Frames shorter than a step add up: 3 ms frames run a step every third
+// frame or so, and no time is lost along the way
+static void testCarry() {
+  TFT_AnimClock clock;
+  clock.reset(0);
+  int total = 0;
+  uint32_t now = 0;
+  for (int i = 0; i < 1000; i++) {
+    now += 3;
+    int steps = clock.advance(now);
+    CHECK(steps <= 1, "3 ms frame ran %d steps", steps);
+    total += steps;
+  }
+  CHECK(total == 3000 / ANIM_STEP_MS, "3000 ms ran %d steps", total);
+  CHECK(total * ANIM_STEP_MS + clock.accumulator == 3000, "%u ms carried after %d steps",
+        clock.accumulator, total);
+
+  // millis() wraps after 49 days; the delta stays right across the wrap
+  clock.reset(0xFFFFFFFFu - 2);
+  int steps = clock.advance(0xFFFFFFFFu - 2 + ANIM_STEP_MS + 1);
+  CHECK(steps == 1 && clock.accumulator == 1, "across the wrap: %d steps, %u ms left",
+        steps, clock.accumulator);
+}
+
+// Random frame times: alpha stays in [0, 1), and interpolating between the
+// last two steps of a wheel moving at a constant speed gives its position
+// at the frame time whenever no steps were dropped
+static void testInterpolation() {
+  const float speed = 0.25f;              // Pixels per ms
+  TFT_AnimClock clock;
+  clock.reset(0);
+  uint32_t now = 0;
+  uint32_t simulated = 0;            // Time covered by the steps run
+  float offset = 0, previous = 0;
+
+  for (int i = 0; i < RANDOM_FRAMES; i++) {
+    uint32_t frame = nextRandom() % 8 == 0 ? nextRandom() % 200 : nextRandom() % 40;
+    now += frame;
+    int steps = clock.advance(now);
+    CHECK(steps >= 0 && steps <= ANIM_MAX_STEPS, "frame of %u ms ran %d steps", frame, steps);
+    CHECK(clock.alpha() >= 0.0f && clock.alpha() < 1.0f, "alpha %f", clock.alpha());
+
+    for (int s = 0; s < steps; s++) {
+      previous = offset;
+      offset += speed * ANIM_STEP_MS;
+      simulated += ANIM_STEP_MS;
+    }
+
+    // Dropped steps move the wheel's clock behind the wall clock, never ahead
+    uint32_t behind = now - (simulated + clock.accumulator);
+    CHECK(behind % ANIM_STEP_MS == 0, "%u ms lost is not whole steps", behind);
+    if (simulated >= ANIM_STEP_MS) {
+      float drawn = previous + (offset - previous) * clock.alpha();
+      float expected = speed * (now - behind - ANIM_STEP_MS);
+      CHECK(fabsf(drawn - expected) < 0.01f * (1 + expected / 1000), "frame %d drawn at %f, expected %f",
+            i, drawn, expected);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  rngState = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 1;
+  if (rngState == 0) rngState = 1;
+
+  testStepCap();
+  testCarry();
+  testInterpolation();
+
+  if (failures > 0) {
+    fprintf(stderr, "%d checks failed\n", failures);
+    return 1;
+  }
+  printf("anim clock: all checks passed\n");
+  return 0;
+}
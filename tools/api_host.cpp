@@ -0,0 +1,546 @@
+// Serve the firmware's API layer on a PC: the real ApiRouter dispatch
+// (api_router.cpp), JSON arenas and body collection (json_arena.cpp) and
+// the /api/debug/routes and /api/debug/heap handlers, behind a plain
+// socket that stands in for AsyncWebServer. tools/api_loadgen.py replays
+// browser traffic against it like against a controller, so dispatch,
+// arena and serialization costs can be compared before flashing.
+//
+// The other routes are stand-ins that build documents of the same shape
+// and size as the firmware's handlers for the routes the pages poll; the
+// table is padded to the firmware's route count so lookups go as deep.
+// For the firmware's own handlers use the full host build
+// (tools/host_build.py).
+//
+// Build from the repository root (ArduinoJson's src/ directory as for
+// tools/host_build.py; only the Arduino.h shim of tools/host/ is used):
+//
+//   g++ -std=gnu++17 -O2 -Wall -Itools/host -I. -I<ArduinoJson/src> -o api_host tools/api_host.cpp tools/api_stubs.cpp api_router.cpp json_arena.cpp
+//
+// Run, and replay traffic in another shell:
+//
+//   ./api_host --port 8080
+//   python3 tools/api_loadgen.py 127.0.0.1:8080 --keep-alive --duration 10
+//
+// Connections stay open and pipelined requests are answered in order
+// unless --close is given, which closes after each response like the
+// controller does. Request bodies reach the router in TCP-segment sized
+// chunks, so collectBody() collects them as it does on the controller;
+// multipart uploads are not parsed. A request's arena is released once
+// its response is queued (on the controller: once it has been sent).
+// Ctrl-C prints the route table with handler times and allocations.
+
+#include <Arduino.h>
+#include "api_router.h"
+#include "json_arena.h"
+#include "api_stubs.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#define FIRMWARE_ROUTE_COUNT 51           // apiRouter.getRouteCount() on the controller
+#define TCP_SEGMENT_SIZE 1436             // Body chunk size the controller's server hands over
+#define MAX_HEADER_BYTES 8192
+
+// ====================================================================
+// STAND-IN HANDLERS
+// ====================================================================
+// Same keys and sizes as the firmware's documents, with fixed values
+
+static float pidKp = 2.0, pidKi = 0.1, pidKd = 0.05;
+
+static void handleStatusLite(ApiRequest& request) {
+  ArenaJsonDocument doc(request);
+  doc["currentTemp"] = 812.25;
+  doc["currentTime"] = "14:32:05";
+  doc["targetTemp"] = 820.0;
+  doc["systemEnabled"] = true;
+  doc["furnaceStatus"] = true;
+  doc["temperatureSmoothingEnabled"] = true;
+  doc["smoothedTargetTemp"] = 816.5;
+  sendJson(request, 200, doc);
+}
+
+static void handleStatus(ApiRequest& request) {
+  ArenaJsonDocument doc(request);
+  doc["currentTemp"] = 812.25;
+  doc["currentTime"] = "14:32:05";
+  doc["currentDate"] = "2026-01-05";
+  doc["targetTemp"] = 820.0;
+  doc["systemEnabled"] = true;
+  doc["furnaceStatus"] = true;
+  doc["thermocoupleError"] = false;
+  doc["pidEnabled"] = false;
+  doc["pwmEnabled"] = true;
+  doc["pwmOnTimeMs"] = 6200;
+  doc["uptime"] = millis() / 1000;
+  doc["freeHeap"] = ESP.getFreeHeap();
+  doc["wifiRssi"] = -58;
+  doc["ip"] = "192.168.1.50";
+  doc["activeProgram"] = "Glaze 1000";
+  doc["timeResolution"] = 15;
+  JsonArray targets = doc.createNestedArray("targetTemps");
+  for (int i = 0; i < 96; i++) targets.add(i < 40 ? 20 + i * 25 : 1000);
+  sendJson(request, 200, doc);
+}
+
+static void handlePrograms(ApiRequest& request) {
+  ArenaJsonDocument doc(request);
+  JsonArray programs = doc.createNestedArray("programs");
+  const char* names[] = { "Default", "Bisque", "Glaze 1000", "Slump", "Anneal" };
+  for (int p = 0; p < 5; p++) {
+    JsonObject program = programs.createNestedObject();
+    program["name"] = names[p];
+    program["description"] = "Ramp, hold and cool";
+    program["timeResolution"] = 15;
+    JsonArray temps = program.createNestedArray("temps");
+    for (int i = 0; i < 96; i++) temps.add(p * 100 + i * 8);
+  }
+  sendJson(request, 200, doc);
+}
+
+static void handleTheme(ApiRequest& request) {
+  static const char* keys[] = {
+    "primary", "secondary", "accent", "background", "surface", "text", "textMuted", "border",
+    "success", "warning", "danger", "info", "chartLine", "chartTarget", "chartGrid", "heaterOn",
+  };
+  ArenaJsonDocument doc(request);
+  doc["name"] = "Ember";
+  JsonObject colors = doc.createNestedObject("colors");
+  for (const char* key : keys) colors[key] = "#d9480f";
+  sendJson(request, 200, doc);
+}
+
+static void handleScan(ApiRequest& request) {
+  ArenaJsonDocument doc(request);
+  JsonArray networks = doc.createNestedArray("networks");
+  for (int i = 0; i < 8; i++) {
+    JsonObject network = networks.createNestedObject();
+    network["ssid"] = String("Network-") + i;
+    network["rssi"] = -40 - i * 6;
+    network["secure"] = i % 3 != 0;
+  }
+  sendJson(request, 200, doc);
+}
+
+static void handleSettingsTemperature(ApiRequest& request) {
+  ArenaJsonDocument doc(request);
+  doc["tempIncrement"] = 5;
+  doc["temperatureIncrement"] = 5;
+  doc["tempResolution"] = 1;
+  sendJson(request, 200, doc);
+}
+
+static void handlePwm(ApiRequest& request) {
+  ArenaJsonDocument doc(request);
+  doc["enabled"] = true;
+  doc["frequency"] = 0.1;
+  sendJson(request, 200, doc);
+}
+
+static void handlePidGet(ApiRequest& request) {
+  ArenaJsonDocument doc(request);
+  doc["enabled"] = false;
+  doc["kp"] = pidKp;
+  doc["ki"] = pidKi;
+  doc["kd"] = pidKd;
+  doc["sampleTime"] = 1.0;
+  doc["outputMin"] = 0;
+  doc["outputMax"] = 100;
+  doc["setpointWindow"] = 5.0;
+  sendJson(request, 200, doc);
+}
+
+static void handlePidPost(ApiRequest& request, uint8_t *data, size_t len, size_t index, size_t total) {
+  ArenaJsonDocument doc(request);
+  if (deserializeJson(doc, data, len)) {
+    request.send(400, "application/json", "{\"success\":false,\"error\":\"Invalid JSON\"}");
+    return;
+  }
+  if (doc.containsKey("kp")) pidKp = doc["kp"].as<float>();
+  if (doc.containsKey("ki")) pidKi = doc["ki"].as<float>();
+  if (doc.containsKey("kd")) pidKd = doc["kd"].as<float>();
+
+  ArenaJsonDocument responseDoc(request);
+  responseDoc["success"] = true;
+  responseDoc["message"] = "PID settings saved successfully";
+  sendJson(request, 200, responseDoc);
+}
+
+// A day of 30 s samples, the size /api/templog sends the dashboard.
+// Built before the heap baseline is taken; the controller streams it
+// from SPIFFS.
+static String templogCsv;
+
+static void handleTemplog(ApiRequest& request) {
+  request.send(200, "text/csv", templogCsv);
+}
+
+static void registerRoutes() {
+  static char fillerPaths[FIRMWARE_ROUTE_COUNT][32];
+
+  templogCsv = "timestamp,temperature,target\n";
+  for (int i = 0; i < 2880; i++) {
+    templogCsv += String(1767571200L + i * 30L) + "," + String(20 + i % 1000) + ".25," + String(20 + i % 1000) + "\n";
+  }
+
+  apiRouter.on("/api/debug/routes", API_METHOD_GET, handleApiRoutesRequest);
+  apiRouter.on("/api/debug/heap", API_METHOD_GET, handleApiHeapRequest);
+  apiRouter.on("/api/status", API_METHOD_GET, handleStatus);
+  apiRouter.on("/api/status/lite", API_METHOD_GET, handleStatusLite);
+  apiRouter.on("/api/programs", API_METHOD_GET, handlePrograms);
+  apiRouter.on("/api/theme", API_METHOD_GET, handleTheme);
+  apiRouter.on("/api/scan", API_METHOD_GET, handleScan);
+  apiRouter.on("/api/settings/temperature", API_METHOD_GET, handleSettingsTemperature);
+  apiRouter.on("/api/pwm", API_METHOD_GET, handlePwm);
+  apiRouter.on("/api/settings/pid", API_METHOD_GET, handlePidGet);
+  apiRouter.on("/api/settings/pid", API_METHOD_POST, [](ApiRequest& request) {}, nullptr,
+               collectBody(REQUEST_BODY_MAX, handlePidPost));
+  apiRouter.on("/api/templog", API_METHOD_GET, handleTemplog);
+
+  for (int i = 0; apiRouter.getRouteCount() < FIRMWARE_ROUTE_COUNT; i++) {
+    snprintf(fillerPaths[i], sizeof(fillerPaths[i]), "/api/unused/%02d", i);
+    apiRouter.on(fillerPaths[i], API_METHOD_GET, [](ApiRequest& request) {
+      request.send(200, "application/json", "{\"success\":true}");
+    });
+  }
+}
+
+// ====================================================================
+// SOCKET STAND-IN FOR ASYNCWEBSERVER
+// ====================================================================
+
+struct Connection {
+  int fd;
+  std::string in;
+  std::string out;
+  bool closing;                 // Close once out has been written
+};
+
+struct ServerStats {
+  uint32_t connections;
+  uint32_t requests;
+  uint32_t pipelined;           // Requests that arrived behind another one
+};
+
+static ServerStats stats = {};
+static bool closeAfterResponse = false;
+static volatile sig_atomic_t stopping = 0;
+
+class SocketApiRequest : public ApiRequest {
+public:
+    SocketApiRequest(const String& url, ApiMethod method)
+        : path(url), requestMethod(method), code(0), noCopyBody(nullptr), noCopyLength(0), tempObject(nullptr) {}
+
+    ~SocketApiRequest() {
+        if (disconnectFn) disconnectFn();
+        free(tempObject);
+    }
+
+    const void* id() const override { return this; }
+    const String& url() const override { return path; }
+    ApiMethod method() const override { return requestMethod; }
+
+    void addHeader(const char* name, const String& value) override {
+        headers += name;
+        headers += ": ";
+        headers += value.c_str();
+        headers += "\r\n";
+    }
+
+    // The first response wins, as with AsyncWebServerRequest::send()
+    void send(int code, const char* contentType, const String& body) override {
+        if (this->code) return;
+        this->code = code;
+        this->contentType = contentType;
+        copiedBody.assign(body.c_str(), body.length());
+    }
+
+    void sendNoCopy(int code, const char* contentType, const uint8_t* body, size_t length) override {
+        if (this->code) return;
+        this->code = code;
+        this->contentType = contentType;
+        noCopyBody = body;
+        noCopyLength = length;
+    }
+
+    void onDisconnect(std::function<void()> fn) override { disconnectFn = fn; }
+
+    void* getTempObject() const override { return tempObject; }
+    void setTempObject(void* block) override { tempObject = block; }
+
+    // Append the response to the connection's output
+    void writeResponse(std::string& out, bool keepAlive) const {
+        int status = code ? code : 500;
+        const char* body = noCopyBody ? (const char*)noCopyBody : copiedBody.data();
+        size_t length = noCopyBody ? noCopyLength : copiedBody.size();
+        if (!code) {
+            body = "Handler sent no response";
+            length = strlen(body);
+        }
+
+        char head[256];
+        snprintf(head, sizeof(head), "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: %s\r\n",
+                 status, reasonPhrase(status), code ? contentType.c_str() : "text/plain", length,
+                 keepAlive ? "keep-alive" : "close");
+        out += head;
+        out += headers;
+        out += "\r\n";
+        if (requestMethod != API_METHOD_HEAD) out.append(body, length);
+    }
+
+private:
+    String path;
+    ApiMethod requestMethod;
+    int code;
+    std::string contentType;
+    std::string headers;
+    std::string copiedBody;
+    const uint8_t* noCopyBody;
+    size_t noCopyLength;
+    void* tempObject;
+    std::function<void()> disconnectFn;
+
+    static const char* reasonPhrase(int code) {
+        switch (code) {
+            case 200: return "OK";
+            case 204: return "No Content";
+            case 400: return "Bad Request";
+            case 404: return "Not Found";
+            case 413: return "Payload Too Large";
+            case 500: return "Internal Server Error";
+            case 503: return "Service Unavailable";
+            default: return "Status";
+        }
+    }
+};
+
+static ApiMethod parseMethod(const std::string& name) {
+  if (name == "GET") return API_METHOD_GET;
+  if (name == "POST") return API_METHOD_POST;
+  if (name == "DELETE") return API_METHOD_DELETE;
+  if (name == "PUT") return API_METHOD_PUT;
+  if (name == "PATCH") return API_METHOD_PATCH;
+  if (name == "HEAD") return API_METHOD_HEAD;
+  if (name == "OPTIONS") return API_METHOD_OPTIONS;
+  return 0;
+}
+
+static std::string headerValue(const std::string& head, const char* name) {
+  size_t nameLength = strlen(name);
+  size_t pos = head.find("\r\n");
+  while (pos != std::string::npos && pos + 2 < head.size()) {
+    size_t start = pos + 2;
+    size_t end = head.find("\r\n", start);
+    if (end == std::string::npos) end = head.size();
+    if (end - start > nameLength && head[start + nameLength] == ':' &&
+        strncasecmp(head.c_str() + start, name, nameLength) == 0) {
+      size_t value = start + nameLength + 1;
+      while (value < end && head[value] == ' ') value++;
+      return head.substr(value, end - value);
+    }
+    pos = end;
+  }
+  return "";
+}
+
+static void sendPlain(Connection& connection, int code, const char* reason, const char* body) {
+  char response[256];
+  snprintf(response, sizeof(response), "HTTP/1.1 %d %s\r\nContent-Type: text/plain\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n%s",
+           code, reason, strlen(body), body);
+  connection.out += response;
+  connection.closing = true;
+}
+
+// Answer every complete request in the input, in order. Returns false
+// when the input is not a request this server understands.
+static bool handleInput(Connection& connection) {
+  bool first = true;
+  while (!connection.closing) {
+    size_t headEnd = connection.in.find("\r\n\r\n");
+    if (headEnd == std::string::npos) {
+      if (connection.in.size() > MAX_HEADER_BYTES) return false;
+      return true;
+    }
+    std::string head = connection.in.substr(0, headEnd);
+    size_t contentLength = strtoul(headerValue(head, "Content-Length").c_str(), nullptr, 10);
+    if (connection.in.size() < headEnd + 4 + contentLength) return true;
+
+    char methodName[16], target[1024], version[16];
+    if (sscanf(head.c_str(), "%15s %1023s %15s", methodName, target, version) != 3) return false;
+    std::string url = target;
+    size_t query = url.find('?');
+    if (query != std::string::npos) url.resize(query);
+
+    std::string connectionHeader = headerValue(head, "Connection");
+    bool keepAlive = !closeAfterResponse &&
+                     (strcmp(version, "HTTP/1.1") == 0 ? strcasecmp(connectionHeader.c_str(), "close") != 0
+                                                       : strcasecmp(connectionHeader.c_str(), "keep-alive") == 0);
+    stats.requests++;
+    if (!first) stats.pipelined++;
+    first = false;
+
+    ApiMethod method = parseMethod(methodName);
+    uint8_t* body = (uint8_t*)connection.in.data() + headEnd + 4;
+    if (method == 0) {
+      sendPlain(connection, 501, "Not Implemented", "Not Implemented");
+    } else if (url != "/api" && url.compare(0, 5, "/api/") != 0) {
+      // The controller's static file handler; not part of the API layer
+      sendPlain(connection, 404, "Not Found", "Not Found");
+    } else {
+      SocketApiRequest request(url.c_str(), method);
+      for (size_t index = 0; index < contentLength; index += TCP_SEGMENT_SIZE) {
+        size_t len = min((size_t)TCP_SEGMENT_SIZE, contentLength - index);
+        apiRouter.handleBody(request, body + index, len, index, contentLength);
+      }
+      apiRouter.handleRequest(request);
+      request.writeResponse(connection.out, keepAlive);
+      if (!keepAlive) connection.closing = true;
+    }
+    connection.in.erase(0, headEnd + 4 + contentLength);
+  }
+  return true;
+}
+
+static int listenOn(uint16_t port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (bind(fd, (sockaddr*)&address, sizeof(address)) != 0 || listen(fd, 64) != 0) {
+    perror("listen");
+    exit(1);
+  }
+  fcntl(fd, F_SETFL, O_NONBLOCK);
+  return fd;
+}
+
+static void serve(int listenFd) {
+  std::vector<Connection> connections;
+  std::vector<pollfd> fds;
+  char buffer[16384];
+
+  while (!stopping) {
+    fds.clear();
+    fds.push_back({ listenFd, POLLIN, 0 });
+    for (Connection& connection : connections) {
+      fds.push_back({ connection.fd, (short)(connection.out.empty() ? POLLIN : POLLOUT), 0 });
+    }
+    if (poll(fds.data(), fds.size(), 200) < 0) {
+      if (errno == EINTR) continue;
+      perror("poll");
+      break;
+    }
+
+    for (size_t i = 0; i < connections.size(); i++) {
+      Connection& connection = connections[i];
+      short events = fds[i + 1].revents;
+      bool drop = (events & (POLLERR | POLLNVAL)) != 0;
+
+      if (!drop && (events & POLLOUT)) {
+        ssize_t sent = write(connection.fd, connection.out.data(), connection.out.size());
+        if (sent > 0) connection.out.erase(0, sent);
+        else if (errno != EAGAIN) drop = true;
+        // Give the buffer back so the heap figures show the API layer's use
+        if (connection.out.empty()) connection.out.shrink_to_fit();
+        if (connection.out.empty() && connection.closing) drop = true;
+      } else if (!drop && (events & (POLLIN | POLLHUP))) {
+        ssize_t received = read(connection.fd, buffer, sizeof(buffer));
+        if (received <= 0) {
+          drop = received == 0 || errno != EAGAIN;
+        } else {
+          connection.in.append(buffer, received);
+          if (!handleInput(connection)) sendPlain(connection, 400, "Bad Request", "Bad Request");
+          if (connection.in.empty()) connection.in.shrink_to_fit();
+        }
+      }
+
+      if (drop) {
+        close(connection.fd);
+        connections.erase(connections.begin() + i);
+        fds.erase(fds.begin() + i + 1);
+        i--;
+      }
+    }
+
+    if (fds[0].revents & POLLIN) {
+      int fd;
+      while ((fd = accept(listenFd, nullptr, nullptr)) >= 0) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        connections.push_back({ fd, "", "", false });
+        stats.connections++;
+      }
+    }
+  }
+
+  for (Connection& connection : connections) close(connection.fd);
+}
+
+// ====================================================================
+// REPORT
+// ====================================================================
+
+static void printReport() {
+  const JsonArenaStats& arena = getJsonArenaStats();
+  printf("\n%u requests on %u connections, %u pipelined\n", stats.requests, stats.connections, stats.pipelined);
+  printf("arenas: %u pooled requests, %u fallback, %u arena allocations, %u heap allocations, heap peak %zu bytes\n",
+         arena.pooledRequests, arena.fallbackRequests, arena.arenaAllocs, arena.heapAllocs, apiStubsHeapPeak());
+  printf("%-8s %-28s %8s %8s %8s %8s %8s %8s\n", "method", "path", "requests", "avg us", "p99 us", "max us",
+         "arena/rq", "heap/rq");
+  for (int i = 0; i < apiRouter.getRouteCount(); i++) {
+    const ApiRoute& route = apiRouter.getRoute(i);
+    uint32_t calls = ApiRouter::getCallCount(route);
+    if (route.requests == 0) continue;
+    printf("%-8s %-28s %8u %8u %8u %8u %8.1f %8.1f\n", ApiRouter::methodName(route.method), route.path,
+           route.requests, calls ? (uint32_t)(route.handlerMicros / calls) : 0,
+           ApiRouter::latencyPercentile(route, 99), route.maxHandlerMicros,
+           (double)route.arenaAllocs / route.requests, (double)route.heapAllocs / route.requests);
+  }
+}
+
+static void onSignal(int) {
+  stopping = 1;
+}
+
+int main(int argc, char** argv) {
+  uint16_t port = 8080;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) port = (uint16_t)atoi(argv[++i]);
+    else if (strcmp(argv[i], "--close") == 0) closeAfterResponse = true;
+    else if (strcmp(argv[i], "--quiet") == 0) apiStubsSetQuiet(true);
+    else {
+      fprintf(stderr, "usage: api_host [--port PORT] [--close] [--quiet]\n");
+      return 2;
+    }
+  }
+
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  signal(SIGPIPE, SIG_IGN);
+
+  registerRoutes();
+  apiStubsMarkHeapBase();
+  int listenFd = listenOn(port);
+  fprintf(stderr, "API on http://127.0.0.1:%u/ with %d routes%s\n", port, apiRouter.getRouteCount(),
+          closeAfterResponse ? ", closing after each response" : "");
+
+  serve(listenFd);
+  close(listenFd);
+  printReport();
+  return 0;
+}
@@ -0,0 +1,280 @@
+#!/usr/bin/env python3
+"""
+Replay browser API traffic against a running furnace controller and report
+how the API holds up.
+
+Each simulated client behaves like one open page (or the service worker)
+and issues that page's requests, weighted by how often the page polls them.
+By default requests are sent back to back to find the sustainable rate;
+--realtime keeps the pages' real polling intervals instead, to see how
+latency behaves under a normal multi-tab load.
+
+Reported per route:
+  - requests, errors and throughput,
+  - client side latency p50/p99/max (network + server),
+  - handler time p50/p99 as measured on the device (/api/debug/routes),
+  - JSON arena and heap allocations per request (/api/debug/heap),
+and the change in free heap and largest free block over the run.
+
+Usage:
+  python3 tools/api_loadgen.py 192.168.1.50 [--mix dashboard,settings,sw]
+                               [--clients 4] [--duration 30] [--keep-alive]
+                               [--realtime]
+
+Only read-only endpoints are replayed, so the tool is safe to run against a
+controller that is heating.
+
+Without a controller, run it against tools/api_host.cpp (the router and
+JSON arenas on a PC) or the full host build (tools/host_build.py), e.g.
+127.0.0.1:8080.
+"""
+
+import argparse
+import http.client
+import json
+import random
+import sys
+import threading
+import time
+
+# (path, polling interval in seconds) per page, from data/*.html and data/sw.js.
+# Requests a page only makes once on load use the page reload interval.
+PAGE_RELOAD = 300
+MIXES = {
+    "dashboard": [
+        ("/api/status/lite", 2),
+        ("/api/status", 30),
+        ("/api/templog", 30),
+        ("/api/programs", PAGE_RELOAD),
+    ],
+    "settings": [
+        ("/api/status", PAGE_RELOAD),
+        ("/api/settings/temperature", PAGE_RELOAD),
+        ("/api/settings/pid", PAGE_RELOAD),
+        ("/api/pwm", PAGE_RELOAD),
+        ("/api/theme", PAGE_RELOAD),
+    ],
+    "sw": [
+        ("/api/status", 30),
+        ("/api/templog", 30),
+    ],
+    # Only served while the controller is in Wi-Fi setup (captive portal) mode
+    "setup": [
+        ("/api/scan", 5),
+        ("/api/status", 5),
+    ],
+}
+
+
+def percentile(values, percent):
+    if not values:
+        return 0.0
+    ordered = sorted(values)
+    index = min(len(ordered) - 1, max(0, int(round(percent / 100.0 * len(ordered) + 0.5)) - 1))
+    return ordered[index]
+
+
+class Results:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.latencies = {}
+        self.errors = {}
+        self.bytes = 0
+        self.connections = 0
+
+    def record(self, path, seconds, ok, size):
+        with self.lock:
+            self.latencies.setdefault(path, []).append(seconds)
+            if not ok:
+                self.errors[path] = self.errors.get(path, 0) + 1
+            self.bytes += size
+
+    def connected(self):
+        with self.lock:
+            self.connections += 1
+
+
+class Client(threading.Thread):
+    def __init__(self, host, port, mix, args, results, deadline):
+        super().__init__(daemon=True)
+        self.host = host
+        self.port = port
+        self.mix = mix
+        self.args = args
+        self.results = results
+        self.deadline = deadline
+        self.connection = None
+
+    def connect(self):
+        self.connection = http.client.HTTPConnection(self.host, self.port, timeout=self.args.timeout)
+        self.results.connected()
+
+    def fetch(self, path):
+        headers = {"Accept": "application/json"}
+        if not self.args.keep_alive:
+            headers["Connection"] = "close"
+        start = time.monotonic()
+        try:
+            if self.connection is None:
+                self.connect()
+            self.connection.request("GET", path, headers=headers)
+            response = self.connection.getresponse()
+            body = response.read()
+            ok = response.status < 400
+            # The server may close after every response even when asked to keep alive
+            if not self.args.keep_alive or response.will_close:
+                self.connection.close()
+                self.connection = None
+        except (OSError, http.client.HTTPException):
+            body = b""
+            ok = False
+            if self.connection is not None:
+                self.connection.close()
+            self.connection = None
+        self.results.record(path, time.monotonic() - start, ok, len(body))
+
+    def run(self):
+        if self.args.realtime:
+            self.run_realtime()
+        else:
+            self.run_saturated()
+
+    def run_saturated(self):
+        paths = [path for path, _ in self.mix]
+        weights = [1.0 / interval for _, interval in self.mix]
+        while time.monotonic() < self.deadline:
+            self.fetch(random.choices(paths, weights)[0])
+
+    def run_realtime(self):
+        # Stagger the clients like tabs opened at different times
+        now = time.monotonic()
+        due = {path: now + random.uniform(0, min(interval, 2)) for path, interval in self.mix}
+        intervals = dict(self.mix)
+        while True:
+            path = min(due, key=due.get)
+            wait = due[path] - time.monotonic()
+            if due[path] >= self.deadline:
+                return
+            if wait > 0:
+                time.sleep(wait)
+            self.fetch(path)
+            due[path] += intervals[path]
+
+
+def get_json(host, port, path, timeout):
+    try:
+        connection = http.client.HTTPConnection(host, port, timeout=timeout)
+        connection.request("GET", path, headers={"Connection": "close"})
+        response = connection.getresponse()
+        body = response.read()
+        connection.close()
+        if response.status != 200:
+            return None
+        return json.loads(body)
+    except (OSError, http.client.HTTPException, ValueError):
+        return None
+
+
+def snapshot(host, port, timeout):
+    heap = get_json(host, port, "/api/debug/heap", timeout)
+    routes = get_json(host, port, "/api/debug/routes", timeout)
+    heap_routes = {}
+    if heap:
+        heap_routes = {r["path"]: r for r in heap.get("routes", []) if r.get("method") == "GET"}
+    route_times = {}
+    if routes:
+        route_times = {r["path"]: r for r in routes.get("endpoints", []) if r.get("method") == "GET"}
+    return heap, heap_routes, route_times
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("host", help="controller address, host or host:port")
+    parser.add_argument("--mix", default="dashboard,settings,sw",
+                        help="comma separated pages to simulate: " + ", ".join(MIXES))
+    parser.add_argument("--clients", type=int, default=1, help="clients per page (default 1)")
+    parser.add_argument("--duration", type=float, default=30, help="seconds to run (default 30)")
+    parser.add_argument("--keep-alive", action="store_true", help="reuse connections when the server allows it")
+    parser.add_argument("--realtime", action="store_true", help="keep the pages' polling intervals")
+    parser.add_argument("--timeout", type=float, default=10, help="per request timeout in seconds")
+    args = parser.parse_args()
+
+    host, _, port = args.host.partition(":")
+    port = int(port) if port else 80
+
+    pages = [page.strip() for page in args.mix.split(",") if page.strip()]
+    unknown = [page for page in pages if page not in MIXES]
+    if unknown:
+        print("Unknown mix: " + ", ".join(unknown), file=sys.stderr)
+        return 1
+
+    before_heap, before_routes, _ = snapshot(host, port, args.timeout)
+    if before_heap is None:
+        print("Warning: /api/debug/heap not available, allocation figures are skipped", file=sys.stderr)
+
+    results = Results()
+    started = time.monotonic()
+    deadline = started + args.duration
+    clients = [Client(host, port, MIXES[page], args, results, deadline)
+               for page in pages for _ in range(args.clients)]
+    for client in clients:
+        client.start()
+    for client in clients:
+        client.join()
+    elapsed = time.monotonic() - started
+
+    after_heap, after_routes, route_times = snapshot(host, port, args.timeout)
+
+    total = sum(len(v) for v in results.latencies.values())
+    total_errors = sum(results.errors.values())
+    mode = "realtime" if args.realtime else "saturated"
+    print(f"{len(clients)} clients ({', '.join(pages)}), {mode}, "
+          f"{'keep-alive' if args.keep_alive else 'connection per request'}, {elapsed:.1f} s")
+    print(f"{total} requests, {total_errors} errors, {total / elapsed:.1f} req/s, "
+          f"{results.bytes / elapsed / 1024:.1f} KB/s, {results.connections} connections")
+    print()
+
+    header = (f"{'route':<28} {'reqs':>6} {'err':>4} {'req/s':>6} {'p50 ms':>7} {'p99 ms':>7} "
+              f"{'max ms':>7} {'dev p50':>8} {'dev p99':>8} {'alloc/req':>9} {'heap/req':>8}")
+    print(header)
+    print("-" * len(header))
+    for path in sorted(results.latencies):
+        latencies = results.latencies[path]
+        line = (f"{path:<28} {len(latencies):>6} {results.errors.get(path, 0):>4} "
+                f"{len(latencies) / elapsed:>6.1f} {percentile(latencies, 50) * 1000:>7.1f} "
+                f"{percentile(latencies, 99) * 1000:>7.1f} {max(latencies) * 1000:>7.1f}")
+
+        # Handler time is cumulative since boot on the device
+        timing = route_times.get(path, {})
+        if "p50Micros" in timing:
+            line += f" {timing['p50Micros'] / 1000:>8.2f} {timing['p99Micros'] / 1000:>8.2f}"
+        else:
+            line += f" {'-':>8} {'-':>8}"
+
+        before = before_routes.get(path, {})
+        after = after_routes.get(path, {})
+        served = after.get("requests", 0) - before.get("requests", 0)
+        if served > 0:
+            allocs = (after.get("arenaAllocs", 0) - before.get("arenaAllocs", 0) +
+                      after.get("heapAllocs", 0) - before.get("heapAllocs", 0))
+            heap_allocs = after.get("heapAllocs", 0) - before.get("heapAllocs", 0)
+            line += f" {allocs / served:>9.1f} {heap_allocs / served:>8.1f}"
+        else:
+            line += f" {'-':>9} {'-':>8}"
+        print(line)
+
+    if before_heap and after_heap:
+        print()
+        print(f"free heap      {before_heap['freeHeap']:>8} -> {after_heap['freeHeap']:>8} bytes")
+        print(f"largest block  {before_heap['largestFreeBlock']:>8} -> {after_heap['largestFreeBlock']:>8} bytes")
+        print(f"min free heap  {after_heap['minFreeHeap']:>8} bytes since boot")
+        arena_before = before_heap.get("arena", {})
+        arena_after = after_heap.get("arena", {})
+        fallback = arena_after.get("fallbackRequests", 0) - arena_before.get("fallbackRequests", 0)
+        print(f"requests that found every JSON arena busy: {fallback}")
+
+    return 1 if total == 0 or total_errors > total // 100 else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,80 @@
+#include "api_stubs.h"
+#include "api_cache.h"
+#include "metrics.h"
+#include <chrono>
+#include <malloc.h>
+
+#define ESP32_HEAP_SIZE 327680            // Internal heap the ESP32 reports
+
+HardwareSerial Serial;
+EspClass ESP;
+
+static bool quiet = false;
+static const auto startTime = std::chrono::steady_clock::now();
+static size_t heapBase = 0;
+static size_t heapPeak = 0;
+
+void apiStubsSetQuiet(bool value) {
+  quiet = value;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  if (!quiet) fputc(c, stdout);
+  return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  if (!quiet) fwrite(buffer, 1, size, stdout);
+  return size;
+}
+
+unsigned long micros() {
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned long millis() {
+  return micros() / 1000;
+}
+
+// ====================================================================
+// HEAP
+// ====================================================================
+
+void apiStubsMarkHeapBase() {
+  heapBase = mallinfo2().uordblks;
+  heapPeak = 0;
+}
+
+static size_t heapUsed() {
+  size_t used = mallinfo2().uordblks;
+  used = used > heapBase ? used - heapBase : 0;
+  if (used > heapPeak) heapPeak = used;
+  return used;
+}
+
+size_t apiStubsHeapPeak() {
+  heapUsed();
+  return heapPeak;
+}
+
+uint32_t EspClass::getHeapSize() { return ESP32_HEAP_SIZE; }
+uint32_t EspClass::getFreeHeap() { return ESP32_HEAP_SIZE - min(heapUsed(), (size_t)ESP32_HEAP_SIZE); }
+uint32_t EspClass::getMinFreeHeap() { return ESP32_HEAP_SIZE - min(apiStubsHeapPeak(), (size_t)ESP32_HEAP_SIZE); }
+uint32_t EspClass::getMaxAllocHeap() { return getFreeHeap(); }
+
+// ====================================================================
+// METRICS AND CACHE GENERATIONS
+// ====================================================================
+
+std::atomic<uint32_t> metricCounters[METRIC_COUNTER_COUNT];
+std::atomic<float> metricGauges[METRIC_GAUGE_COUNT];
+MetricHistogramSlots metricHistograms[METRIC_HISTOGRAM_COUNT] = {
+  { 7 }, { 4 }, { 8 }, { 10 }, { 10 }, { 4 }
+};
+
+static uint32_t apiGenerations[API_RESOURCE_COUNT];
+
+void bumpApiGeneration(ApiResource resource) {
+  apiGenerations[resource]++;
+}
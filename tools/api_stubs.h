@@ -0,0 +1,21 @@
+#ifndef API_STUBS_H
+#define API_STUBS_H
+
+#include <Arduino.h>
+
+// What the API layer (api_router.cpp, json_arena.cpp) needs from the rest
+// of the firmware, for host tools that link it on its own: Serial, the
+// clock, the ESP heap figures, the metric slots the arena allocator
+// records into and the cache generation a write bumps. tools/api_host.cpp
+// and tools/route_bench.cpp link tools/api_stubs.cpp with it; the full
+// host build (tools/host_build.py) has the real ones.
+
+// Drop Serial output
+void apiStubsSetQuiet(bool quiet);
+
+// The heap figures are the ESP32's heap less what the process has
+// allocated since this was called
+void apiStubsMarkHeapBase();
+size_t apiStubsHeapPeak();
+
+#endif // API_STUBS_H
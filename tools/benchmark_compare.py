@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+"""
+Run the controller's control benchmark suite (see control_benchmark.h) and
+compare reports.
+
+  # Run the suite (system must be disabled) and keep the report
+  python3 tools/benchmark_compare.py run --host 192.168.1.50 -o before.json
+  python3 tools/benchmark_compare.py run --host 192.168.1.50 --profiles step \\
+      --model deadTimeSeconds=40 --seed 3 -o step.json
+
+  # Change PID/PWM settings, run again, then compare
+  python3 tools/benchmark_compare.py compare before.json after.json
+
+compare prints each figure per profile with the change, and exits 1 when a
+figure got worse by more than --tolerance percent (default 5), so it can
+gate a control change. Reports written by tools/host_benchmark.cpp, which
+runs the same suite on a PC, compare the same way.
+"""
+
+import argparse
+import http.client
+import json
+import sys
+import time
+
+# (key, label, lower is better)
+FIGURES = [
+    ("iae", "IAE C*s", True),
+    ("meanAbsError", "mean |error| C", True),
+    ("maxOvershoot", "max overshoot C", True),
+    ("maxUndershoot", "max undershoot C", True),
+    ("settlingSeconds", "settling s", True),
+    ("unsettledHolds", "unsettled holds", True),
+    ("relayCycles", "relay cycles", True),
+    ("energyKWh", "energy kWh", True),
+    ("controlUsPerTick", "control us/tick", True),
+]
+
+
+def request(host, port, method, path, body=None):
+    connection = http.client.HTTPConnection(host, port, timeout=30)
+    headers = {"Connection": "close"}
+    if body is not None:
+        headers["Content-Type"] = "application/json"
+    connection.request(method, path, body=body, headers=headers)
+    response = connection.getresponse()
+    data = response.read()
+    connection.close()
+    try:
+        payload = json.loads(data)
+    except ValueError:
+        payload = {"error": data.decode(errors="replace")}
+    return response.status, payload
+
+
+def parse_model(pairs):
+    model = {}
+    for pair in pairs or []:
+        key, _, value = pair.partition("=")
+        if not value:
+            raise SystemExit("benchmark_compare: --model takes key=value, got %r" % pair)
+        model[key] = float(value)
+    return model
+
+
+def run(args):
+    body = {}
+    if args.profiles:
+        body["profiles"] = args.profiles
+    model = parse_model(args.model)
+    if model:
+        body["model"] = model
+    if args.seed is not None:
+        body["seed"] = args.seed
+
+    status, reply = request(args.host, args.port, "POST", "/api/debug/benchmark", json.dumps(body))
+    if status != 200:
+        raise SystemExit("benchmark_compare: start refused (%d): %s" % (status, reply.get("error")))
+
+    last = None
+    while True:
+        time.sleep(1)
+        status, report = request(args.host, args.port, "GET", "/api/debug/benchmark")
+        if status != 200:
+            raise SystemExit("benchmark_compare: /api/debug/benchmark answered %d" % status)
+        state = report.get("state")
+        progress = report.get("progress")
+        if progress and progress != last:
+            sys.stderr.write("      %s: %.1f h simulated\n" % (
+                progress["profile"], progress["simulatedSeconds"] / 3600.0))
+            last = progress
+        if state == "done":
+            break
+        if state not in ("starting", "running"):
+            raise SystemExit("benchmark_compare: benchmark %s" % state)
+
+    text = json.dumps(report, indent=2)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text + "\n")
+    else:
+        print(text)
+    summarize(report)
+
+
+def summarize(report):
+    for entry in report["runs"]:
+        sys.stderr.write("      %-9s IAE %.0f, overshoot %.1f C, %d relay cycles, %.2f kWh\n" % (
+            entry["profile"], entry["iae"], entry["maxOvershoot"], entry["relayCycles"], entry["energyKWh"]))
+
+
+def changed(old, new):
+    if old == new:
+        return 0.0
+    if old == 0:
+        return float("inf") if new > old else float("-inf")
+    return (new - old) * 100.0 / abs(old)
+
+
+def compare(args):
+    reports = []
+    for path in (args.before, args.after):
+        with open(path) as f:
+            reports.append(json.load(f))
+    before, after = reports
+
+    if before.get("model") != after.get("model") or before.get("seed") != after.get("seed"):
+        print("note: the reports ran on different models or noise seeds")
+    for key in sorted(set(before.get("settings", {})) | set(after.get("settings", {}))):
+        old = before.get("settings", {}).get(key)
+        new = after.get("settings", {}).get(key)
+        if old != new:
+            print("setting %s: %s -> %s" % (key, old, new))
+
+    old_runs = {entry["profile"]: entry for entry in before["runs"]}
+    worse = 0
+    for entry in after["runs"]:
+        old = old_runs.get(entry["profile"])
+        if not old:
+            print("\n%s: not in %s" % (entry["profile"], args.before))
+            continue
+        print("\n%s" % entry["profile"])
+        for key, label, lower_better in FIGURES:
+            if key not in old or key not in entry:
+                continue
+            delta = changed(old[key], entry[key])
+            got_worse = delta > args.tolerance if lower_better else delta < -args.tolerance
+            # CPU time varies from run to run; it never fails the comparison
+            if got_worse and key != "controlUsPerTick":
+                worse += 1
+            print("  %-17s %12.2f %12.2f %+8.1f%%%s" % (
+                label, old[key], entry[key], delta, "  worse" if got_worse else ""))
+
+    print()
+    print(("FAIL  %d figures worse" % worse) if worse else "ok    nothing worse by more than %g%%" % args.tolerance)
+    return worse == 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Run and compare furnace control benchmarks")
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    run_parser = commands.add_parser("run", help="run the suite on a controller")
+    run_parser.add_argument("--host", required=True)
+    run_parser.add_argument("--port", type=int, default=80)
+    run_parser.add_argument("--profiles", nargs="+", help="bisque, glaze, slowCool, step (default: all)")
+    run_parser.add_argument("--model", nargs="+", metavar="KEY=VALUE",
+                            help="thermal model overrides, e.g. deadTimeSeconds=40 noiseC=1")
+    run_parser.add_argument("--seed", type=int, help="sensor noise sequence")
+    run_parser.add_argument("-o", "--output", help="report file (default stdout)")
+
+    compare_parser = commands.add_parser("compare", help="compare two saved reports")
+    compare_parser.add_argument("before")
+    compare_parser.add_argument("after")
+    compare_parser.add_argument("--tolerance", type=float, default=5.0,
+                                help="percent a figure may get worse before failing")
+
+    args = parser.parse_args()
+    if args.command == "run":
+        run(args)
+    else:
+        sys.exit(0 if compare(args) else 1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+"""
+Build the SPIFFS image contents for the web UI.
+
+Copies data/ into an output directory (default build/data) with:
+  - text assets stored gzipped (name.gz) when that saves space,
+  - script/stylesheet/icon URLs in the HTML pages tagged with ?v=<hash>,
+  - /.assets.json listing the ETag (content hash) of every stored file.
+
+The firmware (static_asset_handler.cpp) serves the .gz variant with
+Content-Encoding: gzip, sends the ETag and answers If-None-Match with 304.
+Versioned URLs are cached by the browser for a year, everything else is
+revalidated on each load.
+
+Finally a report of the bytes on the wire per page is printed, before and
+after.
+
+Usage:
+  python3 tools/build_assets.py [--src data] [--out build/data]
+
+Upload the output directory instead of data/, e.g. with mkspiffs + esptool.
+"""
+
+import argparse
+import gzip
+import hashlib
+import json
+import os
+import re
+import shutil
+import sys
+
+MANIFEST_NAME = ".assets.json"          # STATIC_ASSET_MANIFEST in config.h
+SPIFFS_MAX_PATH = 31                    # SPIFFS_OBJ_NAME_LEN - 1
+COMPRESSIBLE = (".html", ".htm", ".js", ".css", ".json", ".svg", ".ico", ".txt", ".xml")
+MIN_SAVING = 0.10                       # Keep the .gz only if it saves 10% or more
+HASH_LENGTH = 16
+VERSION_LENGTH = 8
+
+# src="/js/app.js" / href="/css/theme.css" / href="/favicon.ico"
+ASSET_REF = re.compile(r'''((?:src|href)\s*=\s*["'])(/[^"'?#]+\.(?:js|css|ico|svg|png))(["'])''')
+
+
+def content_hash(data):
+    return hashlib.sha256(data).hexdigest()[:HASH_LENGTH]
+
+
+def compress(data):
+    # mtime=0 keeps the output (and therefore the ETag) reproducible
+    return gzip.compress(data, compresslevel=9, mtime=0)
+
+
+def collect_files(src):
+    files = []
+    for root, dirs, names in os.walk(src):
+        dirs[:] = sorted(d for d in dirs if not d.startswith("."))
+        for name in sorted(names):
+            if name.startswith(".") or name.endswith(".gz"):
+                continue
+            full = os.path.join(root, name)
+            rel = "/" + os.path.relpath(full, src).replace(os.sep, "/")
+            files.append((rel, full))
+    return files
+
+
+def is_page(path):
+    return path.endswith((".html", ".htm"))
+
+
+def build(src, out):
+    files = collect_files(src)
+    if not files:
+        sys.exit("build_assets: no files found in " + src)
+
+    if os.path.abspath(out) == os.path.abspath(src):
+        sys.exit("build_assets: output directory must differ from the source directory")
+    if os.path.isdir(out):
+        shutil.rmtree(out)
+
+    manifest = []
+    stored = {}   # path -> {"raw": bytes, "stored": bytes, "gzip": bool, "etag": str}
+
+    # Pages last, so the hashes of the assets they reference are known
+    for path, full in sorted(files, key=lambda f: is_page(f[0])):
+        with open(full, "rb") as f:
+            raw = f.read()
+
+        if is_page(path):
+            def tag(match):
+                asset = stored.get(match.group(2))
+                if not asset:
+                    return match.group(0)
+                return "%s%s?v=%s%s" % (match.group(1), match.group(2),
+                                        asset["etag"][:VERSION_LENGTH], match.group(3))
+            raw = ASSET_REF.sub(tag, raw.decode("utf-8")).encode("utf-8")
+
+        data = raw
+        gzipped = False
+        if path.endswith(COMPRESSIBLE):
+            packed = compress(raw)
+            if len(packed) <= len(raw) * (1 - MIN_SAVING):
+                if len(path) + 3 > SPIFFS_MAX_PATH:
+                    print("warning: %s.gz exceeds the SPIFFS name limit, stored uncompressed" % path)
+                else:
+                    data = packed
+                    gzipped = True
+
+        stored_path = path + ".gz" if gzipped else path
+        if len(stored_path) > SPIFFS_MAX_PATH:
+            sys.exit("build_assets: %s exceeds the %d character SPIFFS name limit"
+                     % (stored_path, SPIFFS_MAX_PATH))
+
+        target = os.path.join(out, stored_path.lstrip("/"))
+        os.makedirs(os.path.dirname(target), exist_ok=True)
+        with open(target, "wb") as f:
+            f.write(data)
+
+        etag = content_hash(data)
+        stored[path] = {"raw": raw, "stored": data, "gzip": gzipped, "etag": etag}
+        manifest.append({"path": path, "etag": etag, "size": len(data), "gzip": gzipped})
+
+    with open(os.path.join(out, MANIFEST_NAME), "w") as f:
+        json.dump({"files": manifest}, f, separators=(",", ":"))
+
+    return files, stored
+
+
+def page_assets(page_bytes):
+    refs = []
+    for match in ASSET_REF.finditer(page_bytes.decode("utf-8", "replace")):
+        if match.group(2) not in refs:
+            refs.append(match.group(2))
+    return refs
+
+
+def report(files, stored):
+    def kb(n):
+        return "%8.1f KB" % (n / 1024.0)
+
+    print()
+    print("%-22s %11s %11s %7s" % ("Page (cold load)", "before", "after", "ratio"))
+    for path, full in files:
+        if not is_page(path) or path.startswith("/partials/"):
+            continue
+        with open(full, "rb") as f:
+            original = f.read()
+        before = len(original)
+        after = len(stored[path]["stored"])
+        for ref in page_assets(original):
+            if ref in stored:
+                before += len(stored[ref]["raw"])
+                after += len(stored[ref]["stored"])
+        print("%-22s %s %s %6.1fx" % (path, kb(before), kb(after), before / float(max(after, 1))))
+
+    total_raw = sum(len(s["raw"]) for s in stored.values())
+    total_stored = sum(len(s["stored"]) for s in stored.values())
+    gzipped = sum(1 for s in stored.values() if s["gzip"])
+    print()
+    print("Image: %d files (%d gzipped), %s -> %s" % (len(stored), gzipped, kb(total_raw).strip(), kb(total_stored).strip()))
+    print("Warm loads only send 304s for unchanged pages; versioned assets are not requested at all.")
+
+
+def main():
+    repo = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    parser = argparse.ArgumentParser(description="Gzip and content-hash the web UI for SPIFFS")
+    parser.add_argument("--src", default=os.path.join(repo, "data"), help="source directory (default: data/)")
+    parser.add_argument("--out", default=os.path.join(repo, "build", "data"), help="output directory (default: build/data)")
+    args = parser.parse_args()
+
+    files, stored = build(args.src, args.out)
+    report(files, stored)
+    print("Wrote " + args.out)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""
+Check resumable downloads and directory listing cost on a running furnace
+controller.
+
+For the given file (the temperature log by default) the tool:
+  - downloads it in full and notes the ETag,
+  - downloads it again as an interrupted transfer resumed with
+    Range + If-Range, and checks the pieces add up to the same bytes,
+  - checks a stale If-Range gets the whole file (200) and a range past
+    the end gets 416.
+It then lists the given directory a few times and reports the handler time
+/api/debug/routes measured for /api/list.
+
+Usage:
+  python3 tools/download_check.py 192.168.1.50 [--path /temp_log.csv]
+                                  [--list-path /] [--list-runs 20]
+"""
+
+import argparse
+import http.client
+import json
+import sys
+import urllib.parse
+
+
+def get(host, port, path, headers=None, timeout=30):
+    connection = http.client.HTTPConnection(host, port, timeout=timeout)
+    request_headers = {"Connection": "close"}
+    request_headers.update(headers or {})
+    connection.request("GET", path, headers=request_headers)
+    response = connection.getresponse()
+    body = response.read()
+    connection.close()
+    return response.status, dict((k.lower(), v) for k, v in response.getheaders()), body
+
+
+def check(condition, message):
+    print(("ok    " if condition else "FAIL  ") + message)
+    return condition
+
+
+def check_ranges(host, port, path):
+    url = "/api/download?path=" + urllib.parse.quote(path)
+    status, headers, full = get(host, port, url)
+    if status != 200:
+        print(f"FAIL  {url} returned {status}")
+        return False
+    etag = headers.get("etag", "")
+    size = len(full)
+    print(f"{path}: {size} bytes, ETag {etag}")
+
+    passed = check(headers.get("accept-ranges") == "bytes", "Accept-Ranges: bytes")
+    if size < 2:
+        print("File too small to split, range checks skipped")
+        return passed
+
+    # Interrupted download: first part, then resume from where it stopped
+    cut = size // 3
+    status, headers, first = get(host, port, url, {"Range": f"bytes=0-{cut - 1}"})
+    passed &= check(status == 206 and len(first) == cut, f"first part 0-{cut - 1} -> {status}, {len(first)} bytes")
+    passed &= check(headers.get("content-range") == f"bytes 0-{cut - 1}/{size}",
+                    f"Content-Range {headers.get('content-range')}")
+
+    status, headers, rest = get(host, port, url, {"Range": f"bytes={cut}-", "If-Range": etag})
+    passed &= check(status == 206 and first + rest == full, f"resume from {cut} -> {status}, {len(rest)} bytes, content matches")
+
+    status, _, tail = get(host, port, url, {"Range": "bytes=-10"})
+    passed &= check(status == 206 and tail == full[-10:], f"suffix range -10 -> {status}")
+
+    status, _, body = get(host, port, url, {"Range": f"bytes={cut}-", "If-Range": '"stale"'})
+    passed &= check(status == 200 and len(body) == size, f"stale If-Range -> {status}, whole file")
+
+    status, headers, _ = get(host, port, url, {"Range": f"bytes={size}-"})
+    passed &= check(status == 416 and headers.get("content-range") == f"bytes */{size}", f"range past end -> {status}")
+    return passed
+
+
+def list_timing(host, port, path, runs):
+    url = "/api/list?path=" + urllib.parse.quote(path)
+    entries = 0
+    for _ in range(runs):
+        status, _, body = get(host, port, url)
+        if status != 200:
+            print(f"FAIL  {url} returned {status}")
+            return False
+        entries = len(json.loads(body))
+
+    status, _, body = get(host, port, "/api/debug/routes")
+    if status != 200:
+        print(f"{url}: {entries} entries, /api/debug/routes not available")
+        return True
+    for route in json.loads(body).get("endpoints", []):
+        if route.get("path") == "/api/list" and route.get("method") == "GET":
+            print(f"{url}: {entries} entries, handler p50 {route.get('p50Micros', 0) / 1000:.2f} ms, "
+                  f"p99 {route.get('p99Micros', 0) / 1000:.2f} ms over {route.get('calls', 0)} calls since boot")
+    return True
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("host", help="controller address, host or host:port")
+    parser.add_argument("--path", default="/temp_log.csv", help="file to download (default /temp_log.csv)")
+    parser.add_argument("--list-path", default="/", help="directory to list (default /)")
+    parser.add_argument("--list-runs", type=int, default=20, help="listings to time (default 20)")
+    args = parser.parse_args()
+
+    host, _, port = args.host.partition(":")
+    port = int(port) if port else 80
+
+    passed = check_ranges(host, port, args.path)
+    passed &= list_timing(host, port, args.list_path, args.list_runs)
+    return 0 if passed else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
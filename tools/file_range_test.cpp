@@ -0,0 +1,217 @@
+// Host tests for resumable downloads (file_range.h): Range headers parsed
+// against known answers and random input, and downloads of an in-memory
+// file read in chunks the way sendFileWithRanges() fills its response -
+// in full, as a range, and dropped part way and resumed - checked byte
+// for byte, with every read after the first ending on a FILE_READ_ALIGN
+// boundary.
+//
+// Build and run from the repository root:
+//
+//   g++ -std=c++17 -O1 -g -Wall -fsanitize=address,undefined -I. -o file_range_test tools/file_range_test.cpp file_range.cpp && ./file_range_test
+//
+// Exits 1 if any check fails. The generator is seeded, so a failure repeats;
+// pass a seed as the first argument to try others.
+
+#include "file_range.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#define TCP_WINDOW_MAX 5744               // Largest maxLen the server asks a filler for
+#define DOWNLOADS 400
+#define RANDOM_HEADERS 20000
+
+static int failures = 0;
+static uint32_t rngState = 1;
+
+#define CHECK(condition, ...) do { \
+    if (!(condition)) { \
+      failures++; \
+      fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+      fprintf(stderr, __VA_ARGS__); \
+      fprintf(stderr, "\n"); \
+    } \
+  } while (0)
+
+static uint32_t nextRandom() {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState;
+}
+
+static uint32_t randomBelow(uint32_t limit) {
+  return limit ? nextRandom() % limit : 0;
+}
+
+// Sizes around the alignment unit and up to a log of a few days
+static std::vector<uint8_t> makeFile() {
+  size_t size;
+  switch (randomBelow(4)) {
+    case 0: size = randomBelow(3 * FILE_READ_ALIGN); break;
+    case 1: size = FILE_READ_ALIGN * (1 + randomBelow(8)) + randomBelow(3) - 1; break;
+    case 2: size = randomBelow(65536); break;
+    default: size = randomBelow(1500000); break;
+  }
+  std::vector<uint8_t> file(size);
+  for (size_t i = 0; i < size; i++) file[i] = (uint8_t)nextRandom();
+  return file;
+}
+
+// Read [start, end) of the file like the response filler does, with the
+// send window changing between chunks. Stops after stopAfter bytes, as a
+// dropped connection would.
+static std::vector<uint8_t> download(const std::vector<uint8_t>& file, size_t start, size_t end,
+                                     size_t stopAfter = (size_t)-1) {
+  std::vector<uint8_t> received;
+  uint8_t buffer[TCP_WINDOW_MAX];
+  size_t index = 0;
+  while (received.size() < stopAfter) {
+    size_t maxLen = 1 + randomBelow(TCP_WINDOW_MAX);
+    size_t position = start + index;
+    size_t length = fileChunkLength(position, end, maxLen);
+    if (length == 0) {
+      CHECK(position == end, "chunk at %zu of [%zu, %zu) was empty", position, start, end);
+      break;
+    }
+    CHECK(length <= maxLen, "chunk of %zu bytes for a window of %zu", length, maxLen);
+    CHECK(position + length <= end, "chunk at %zu of %zu bytes runs past %zu", position, length, end);
+    if (position + length > end) break;
+    CHECK(length <= FILE_READ_ALIGN || (position + length) % FILE_READ_ALIGN == 0 || position + length == end,
+          "chunk [%zu, %zu) of more than %d bytes ends off the alignment", position, position + length, FILE_READ_ALIGN);
+
+    memcpy(buffer, file.data() + position, length);
+    received.insert(received.end(), buffer, buffer + length);
+    index += length;
+  }
+  return received;
+}
+
+static bool sameBytes(const std::vector<uint8_t>& file, size_t start, const std::vector<uint8_t>& received) {
+  return start + received.size() <= file.size() &&
+         memcmp(file.data() + start, received.data(), received.size()) == 0;
+}
+
+struct RangeCase {
+  const char* header;
+  size_t size;
+  FileRangeResult result;
+  size_t start;
+  size_t end;
+};
+
+static const RangeCase rangeCases[] = {
+  { "bytes=0-",          1000, FILE_RANGE_PARTIAL,       0,   1000 },
+  { "bytes=100-",        1000, FILE_RANGE_PARTIAL,       100, 1000 },
+  { "bytes=100-199",     1000, FILE_RANGE_PARTIAL,       100, 200 },
+  { "bytes=999-999",     1000, FILE_RANGE_PARTIAL,       999, 1000 },
+  { "bytes=100-5000",    1000, FILE_RANGE_PARTIAL,       100, 1000 },
+  { "bytes= 100-199 ",   1000, FILE_RANGE_PARTIAL,       100, 200 },
+  { "bytes=-300",        1000, FILE_RANGE_PARTIAL,       700, 1000 },
+  { "bytes=-5000",       1000, FILE_RANGE_PARTIAL,       0,   1000 },
+  { "bytes=1000-",       1000, FILE_RANGE_UNSATISFIABLE, 0,   0 },
+  { "bytes=5000-6000",   1000, FILE_RANGE_UNSATISFIABLE, 0,   0 },
+  { "bytes=-0",          1000, FILE_RANGE_UNSATISFIABLE, 0,   0 },
+  { "bytes=0-",          0,    FILE_RANGE_UNSATISFIABLE, 0,   0 },
+  { "bytes=-10",         0,    FILE_RANGE_UNSATISFIABLE, 0,   0 },
+  { "bytes=200-100",     1000, FILE_RANGE_FULL,          0,   0 },
+  { "bytes=0-99,200-",   1000, FILE_RANGE_FULL,          0,   0 },
+  { "items=0-99",        1000, FILE_RANGE_FULL,          0,   0 },
+  { "bytes=abc-",        1000, FILE_RANGE_FULL,          0,   0 },
+  { "bytes=10",          1000, FILE_RANGE_FULL,          0,   0 },
+  { "bytes=-",           1000, FILE_RANGE_FULL,          0,   0 },
+  { "bytes=1-2x",        1000, FILE_RANGE_FULL,          0,   0 },
+  { "bytes=99999999999999999999999-", 1000, FILE_RANGE_FULL, 0, 0 },
+  { "",                  1000, FILE_RANGE_FULL,          0,   0 },
+};
+
+static void testKnownRanges() {
+  for (const RangeCase& test : rangeCases) {
+    size_t start = 0, end = 0;
+    FileRangeResult result = parseFileRange(test.header, test.size, start, end);
+    CHECK(result == test.result, "\"%s\" of %zu bytes: result %d, wanted %d", test.header, test.size, result, test.result);
+    if (result == FILE_RANGE_PARTIAL && test.result == FILE_RANGE_PARTIAL) {
+      CHECK(start == test.start && end == test.end, "\"%s\" of %zu bytes: [%zu, %zu), wanted [%zu, %zu)",
+            test.header, test.size, start, end, test.start, test.end);
+    }
+  }
+}
+
+// Whatever the header, a partial answer lies inside the file and is not empty
+static void testRandomHeaders() {
+  static const char alphabet[] = "bytes=0123456789-, \t";
+  for (int i = 0; i < RANDOM_HEADERS; i++) {
+    std::string header = randomBelow(2) ? "bytes=" : "";
+    size_t length = randomBelow(24);
+    for (size_t j = 0; j < length; j++) header += alphabet[randomBelow(sizeof(alphabet) - 1)];
+    size_t size = randomBelow(4) == 0 ? randomBelow(4) : randomBelow(100000);
+    size_t start = 0, end = 0;
+    if (parseFileRange(header.c_str(), size, start, end) == FILE_RANGE_PARTIAL) {
+      CHECK(start < end && end <= size, "\"%s\" of %zu bytes: [%zu, %zu)", header.c_str(), size, start, end);
+    }
+  }
+}
+
+// Whole files and single ranges come out byte for byte
+static void testDownloads() {
+  for (int i = 0; i < DOWNLOADS; i++) {
+    std::vector<uint8_t> file = makeFile();
+    std::vector<uint8_t> whole = download(file, 0, file.size());
+    CHECK(whole.size() == file.size() && sameBytes(file, 0, whole),
+          "full download of %zu bytes came out as %zu", file.size(), whole.size());
+
+    if (file.empty()) continue;
+    size_t from = randomBelow(file.size());
+    size_t to = from + randomBelow(file.size() - from);
+    std::string header = "bytes=" + std::to_string(from) + "-" + std::to_string(to);
+    size_t start = 0, end = 0;
+    CHECK(parseFileRange(header.c_str(), file.size(), start, end) == FILE_RANGE_PARTIAL, "%s refused", header.c_str());
+    std::vector<uint8_t> part = download(file, start, end);
+    CHECK(part.size() == to - from + 1 && sameBytes(file, from, part),
+          "%s of %zu bytes came out as %zu bytes", header.c_str(), file.size(), part.size());
+  }
+}
+
+// A download dropped part way, resumed with "bytes=N-" from what arrived,
+// gives the original file
+static void testResume() {
+  for (int i = 0; i < DOWNLOADS; i++) {
+    std::vector<uint8_t> file = makeFile();
+    if (file.size() < 2) continue;
+    std::vector<uint8_t> received = download(file, 0, file.size(), 1 + randomBelow(file.size() - 1));
+
+    // Possibly dropped more than once
+    while (received.size() < file.size()) {
+      std::string header = "bytes=" + std::to_string(received.size()) + "-";
+      size_t start = 0, end = 0;
+      FileRangeResult result = parseFileRange(header.c_str(), file.size(), start, end);
+      CHECK(result == FILE_RANGE_PARTIAL && start == received.size() && end == file.size(),
+            "resume %s of %zu bytes: result %d [%zu, %zu)", header.c_str(), file.size(), result, start, end);
+      if (result != FILE_RANGE_PARTIAL) break;
+      size_t stopAfter = randomBelow(3) == 0 ? 1 + randomBelow(end - start) : (size_t)-1;
+      std::vector<uint8_t> rest = download(file, start, end, stopAfter);
+      received.insert(received.end(), rest.begin(), rest.end());
+    }
+    CHECK(received.size() == file.size() && sameBytes(file, 0, received),
+          "resumed download of %zu bytes came out as %zu", file.size(), received.size());
+  }
+}
+
+int main(int argc, char** argv) {
+  rngState = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 1;
+  if (rngState == 0) rngState = 1;
+
+  testKnownRanges();
+  testRandomHeaders();
+  testDownloads();
+  testResume();
+
+  if (failures > 0) {
+    fprintf(stderr, "%d checks failed\n", failures);
+    return 1;
+  }
+  printf("file ranges: all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,397 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// =================================================================
+//                  HOST SHIM: ARDUINO CORE
+// =================================================================
+// The parts of the ESP32 Arduino core the firmware uses, for the host
+// build (tools/host_build.py). Time is virtual: millis() and micros() run
+// with the host clock plus whatever the driver and delay() skip ahead, so
+// a long firing can run much faster than real time (host_sim.h).
+//
+// Types keep the host's widths: unsigned long is 64 bits here, so millis()
+// and micros() never wrap during a run.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <math.h>
+#include <time.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <string>
+
+using std::min;
+using std::max;
+using std::isnan;
+using std::isinf;
+using std::abs;
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef uint16_t word;
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define PI 3.1415926535897932384626433832795
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define PROGMEM
+#define IRAM_ATTR
+#define F(string_literal) (string_literal)
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define radians(deg) ((deg) * DEG_TO_RAD)
+#define degrees(rad) ((rad) * RAD_TO_DEG)
+#define sq(x) ((x) * (x))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+
+class Print;
+
+// ---- String ----
+
+class String {
+public:
+    String(const char* cstr = "") : buffer(cstr ? cstr : "") {}
+    String(const char* cstr, unsigned int length) : buffer(cstr ? std::string(cstr, length) : std::string()) {}
+    String(const String& other) = default;
+    String(String&& other) = default;
+    explicit String(char c) : buffer(1, c) {}
+    explicit String(unsigned char value, unsigned char base = 10) { setNumber(value, base); }
+    explicit String(int value, unsigned char base = 10) { setNumber(value, base); }
+    explicit String(unsigned int value, unsigned char base = 10) { setNumber(value, base); }
+    explicit String(long value, unsigned char base = 10) { setNumber(value, base); }
+    explicit String(unsigned long value, unsigned char base = 10) { setNumber(value, base); }
+    explicit String(long long value, unsigned char base = 10) { setNumber(value, base); }
+    explicit String(unsigned long long value, unsigned char base = 10) { setNumber(value, base); }
+    explicit String(float value, unsigned int decimalPlaces = 2) { setFloat(value, decimalPlaces); }
+    explicit String(double value, unsigned int decimalPlaces = 2) { setFloat(value, decimalPlaces); }
+
+    String& operator=(const String& other) = default;
+    String& operator=(String&& other) = default;
+    String& operator=(const char* cstr) { buffer = cstr ? cstr : ""; return *this; }
+
+    unsigned int length() const { return (unsigned int)buffer.size(); }
+    bool isEmpty() const { return buffer.empty(); }
+    const char* c_str() const { return buffer.c_str(); }
+    bool reserve(unsigned int size) { buffer.reserve(size); return true; }
+    void clear() { buffer.clear(); }
+
+    bool concat(const String& s) { buffer += s.buffer; return true; }
+    bool concat(const char* cstr) { if (cstr) buffer += cstr; return cstr != nullptr; }
+    bool concat(const char* cstr, unsigned int length) { if (cstr) buffer.append(cstr, length); return cstr != nullptr; }
+    bool concat(const uint8_t* data, unsigned int length) { return concat((const char*)data, length); }
+    bool concat(char c) { buffer += c; return true; }
+    bool concat(unsigned char value) { return concat(String(value)); }
+    bool concat(int value) { return concat(String(value)); }
+    bool concat(unsigned int value) { return concat(String(value)); }
+    bool concat(long value) { return concat(String(value)); }
+    bool concat(unsigned long value) { return concat(String(value)); }
+    bool concat(long long value) { return concat(String(value)); }
+    bool concat(unsigned long long value) { return concat(String(value)); }
+    bool concat(float value) { return concat(String(value)); }
+    bool concat(double value) { return concat(String(value)); }
+
+    template<typename T> String& operator+=(const T& value) { concat(value); return *this; }
+    String& operator+=(const char* cstr) { concat(cstr); return *this; }
+
+    int compareTo(const String& s) const { return strcmp(c_str(), s.c_str()); }
+    bool equals(const String& s) const { return buffer == s.buffer; }
+    bool equals(const char* cstr) const { return buffer == (cstr ? cstr : ""); }
+    bool equalsIgnoreCase(const String& s) const { return strcasecmp(c_str(), s.c_str()) == 0 && length() == s.length(); }
+    bool operator==(const String& s) const { return equals(s); }
+    bool operator==(const char* cstr) const { return equals(cstr); }
+    bool operator!=(const String& s) const { return !equals(s); }
+    bool operator!=(const char* cstr) const { return !equals(cstr); }
+    bool operator<(const String& s) const { return compareTo(s) < 0; }
+    bool operator>(const String& s) const { return compareTo(s) > 0; }
+    bool operator<=(const String& s) const { return compareTo(s) <= 0; }
+    bool operator>=(const String& s) const { return compareTo(s) >= 0; }
+    bool startsWith(const String& prefix) const { return startsWith(prefix, 0); }
+    bool startsWith(const String& prefix, unsigned int offset) const {
+        return offset <= buffer.size() && buffer.compare(offset, prefix.buffer.size(), prefix.buffer) == 0 &&
+               buffer.size() - offset >= prefix.buffer.size();
+    }
+    bool endsWith(const String& suffix) const {
+        return buffer.size() >= suffix.buffer.size() &&
+               buffer.compare(buffer.size() - suffix.buffer.size(), suffix.buffer.size(), suffix.buffer) == 0;
+    }
+
+    char charAt(unsigned int index) const { return index < buffer.size() ? buffer[index] : 0; }
+    void setCharAt(unsigned int index, char c) { if (index < buffer.size()) buffer[index] = c; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    char& operator[](unsigned int index) { static char dummy; return index < buffer.size() ? buffer[index] : (dummy = 0); }
+    void getBytes(unsigned char* buf, unsigned int bufsize, unsigned int index = 0) const { copyOut((char*)buf, bufsize, index); }
+    void toCharArray(char* buf, unsigned int bufsize, unsigned int index = 0) const { copyOut(buf, bufsize, index); }
+    const char* begin() const { return buffer.c_str(); }
+    const char* end() const { return buffer.c_str() + buffer.size(); }
+
+    int indexOf(char c, unsigned int fromIndex = 0) const { return found(buffer.find(c, fromIndex)); }
+    int indexOf(const String& s, unsigned int fromIndex = 0) const { return found(buffer.find(s.buffer, fromIndex)); }
+    int lastIndexOf(char c) const { return found(buffer.rfind(c)); }
+    int lastIndexOf(char c, unsigned int fromIndex) const { return found(buffer.rfind(c, fromIndex)); }
+    int lastIndexOf(const String& s) const { return found(buffer.rfind(s.buffer)); }
+    int lastIndexOf(const String& s, unsigned int fromIndex) const { return found(buffer.rfind(s.buffer, fromIndex)); }
+    String substring(unsigned int beginIndex) const { return substring(beginIndex, length()); }
+    String substring(unsigned int beginIndex, unsigned int endIndex) const {
+        if (beginIndex > endIndex) std::swap(beginIndex, endIndex);
+        if (beginIndex >= buffer.size()) return String();
+        endIndex = std::min(endIndex, length());
+        return String(buffer.substr(beginIndex, endIndex - beginIndex).c_str(), endIndex - beginIndex);
+    }
+
+    void replace(char find, char replacement) { std::replace(buffer.begin(), buffer.end(), find, replacement); }
+    void replace(const String& find, const String& replacement) {
+        if (find.buffer.empty()) return;
+        size_t at = 0;
+        while ((at = buffer.find(find.buffer, at)) != std::string::npos) {
+            buffer.replace(at, find.buffer.size(), replacement.buffer);
+            at += replacement.buffer.size();
+        }
+    }
+    void remove(unsigned int index) { if (index < buffer.size()) buffer.erase(index); }
+    void remove(unsigned int index, unsigned int count) { if (index < buffer.size()) buffer.erase(index, count); }
+    void toLowerCase() { for (char& c : buffer) c = (char)tolower((unsigned char)c); }
+    void toUpperCase() { for (char& c : buffer) c = (char)toupper((unsigned char)c); }
+    void trim() {
+        size_t first = buffer.find_first_not_of(" \t\r\n\f\v");
+        if (first == std::string::npos) { buffer.clear(); return; }
+        buffer = buffer.substr(first, buffer.find_last_not_of(" \t\r\n\f\v") - first + 1);
+    }
+
+    long toInt() const { return atol(c_str()); }
+    float toFloat() const { return (float)atof(c_str()); }
+    double toDouble() const { return atof(c_str()); }
+
+private:
+    template<typename T> void setNumber(T value, unsigned char base) {
+        if (base == 10) { buffer = std::to_string(value); return; }
+        bool negative = value < 0;
+        unsigned long long magnitude = negative ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+        char digits[72];
+        int n = 0;
+        do { int d = magnitude % base; digits[n++] = (char)(d < 10 ? '0' + d : 'a' + d - 10); magnitude /= base; } while (magnitude);
+        if (negative) digits[n++] = '-';
+        buffer.assign(digits, n);
+        std::reverse(buffer.begin(), buffer.end());
+    }
+    void setFloat(double value, unsigned int decimalPlaces) {
+        char text[64];
+        if (isnan(value)) snprintf(text, sizeof(text), "nan");
+        else if (isinf(value)) snprintf(text, sizeof(text), value < 0 ? "-inf" : "inf");
+        else snprintf(text, sizeof(text), "%.*f", (int)decimalPlaces, value);
+        buffer = text;
+    }
+    void copyOut(char* buf, unsigned int bufsize, unsigned int index) const {
+        if (!bufsize || !buf) return;
+        if (index >= buffer.size()) { buf[0] = 0; return; }
+        unsigned int n = std::min(bufsize - 1, (unsigned int)(buffer.size() - index));
+        memcpy(buf, buffer.data() + index, n);
+        buf[n] = 0;
+    }
+    static int found(size_t at) { return at == std::string::npos ? -1 : (int)at; }
+
+    std::string buffer;
+};
+
+inline String operator+(const String& a, const String& b) { String s(a); s.concat(b); return s; }
+inline String operator+(const String& a, const char* b) { String s(a); s.concat(b); return s; }
+inline String operator+(const char* a, const String& b) { String s(a); s.concat(b); return s; }
+inline String operator+(const String& a, char b) { String s(a); s.concat(b); return s; }
+inline String operator+(char a, const String& b) { String s(&a, 1); s.concat(b); return s; }
+template<typename T> String operator+(const String& a, T b) { String s(a); s.concat(b); return s; }
+inline bool operator==(const char* a, const String& b) { return b.equals(a); }
+inline bool operator!=(const char* a, const String& b) { return !b.equals(a); }
+
+// ---- Print / Stream ----
+
+class Printable {
+public:
+    virtual ~Printable() {}
+    virtual size_t printTo(Print& p) const = 0;
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t n = 0;
+        while (size--) n += write(*buffer++);
+        return n;
+    }
+    size_t write(const char* str) { return str ? write((const uint8_t*)str, strlen(str)) : 0; }
+    size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+    virtual void flush() {}
+
+    size_t print(const String& s) { return write(s.c_str(), s.length()); }
+    size_t print(const char* str) { return write(str); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(int value, int base = DEC) { return print((long)value, base); }
+    size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(long value, int base = DEC) { return print((long long)value, base); }
+    size_t print(unsigned long value, int base = DEC) { return print((unsigned long long)value, base); }
+    size_t print(long long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(unsigned long long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(double value, int digits = 2) { return print(String(value, (unsigned int)digits)); }
+    size_t print(const Printable& p) { return p.printTo(*this); }
+
+    template<typename T> size_t println(const T& value) { size_t n = print(value); return n + println(); }
+    template<typename T> size_t println(const T& value, int format) { size_t n = print(value, format); return n + println(); }
+    size_t println() { return write("\r\n"); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout) { streamTimeout = timeout; }
+    size_t readBytes(char* buffer, size_t length) {
+        size_t n = 0;
+        while (n < length) {
+            int c = read();
+            if (c < 0) break;
+            buffer[n++] = (char)c;
+        }
+        return n;
+    }
+    size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+    String readString() {
+        String s;
+        int c;
+        while ((c = read()) >= 0) s += (char)c;
+        return s;
+    }
+    String readStringUntil(char terminator) {
+        String s;
+        int c;
+        while ((c = read()) >= 0 && c != terminator) s += (char)c;
+        return s;
+    }
+
+protected:
+    unsigned long streamTimeout = 1000;
+};
+
+// Serial goes to stdout; the driver can silence it (--quiet)
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long) {}
+    void end() {}
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    void flush() override { fflush(stdout); }
+    explicit operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+// ---- Time, GPIO, random ----
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+uint32_t esp_random();
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+float temperatureRead();
+int64_t esp_timer_get_time();
+
+// Local time once the clock has been set (configTime / SNTP); waits up to
+// ms of virtual time for it like the ESP32 core does
+bool getLocalTime(struct tm* info, uint32_t ms = 5000);
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1,
+                const char* server2 = nullptr, const char* server3 = nullptr);
+
+// ---- Chip and heap ----
+// The CYD has no PSRAM. The heap figures are the firmware's own
+// allocations since setup() against the ESP32's internal heap size (see
+// host_sim.h), not the host's.
+
+bool psramFound();
+void* ps_malloc(size_t size);
+
+class EspClass {
+public:
+    uint32_t getHeapSize();
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    uint32_t getPsramSize() { return 0; }
+    uint32_t getFreePsram() { return 0; }
+    uint32_t getCpuFreqMHz() { return 240; }
+    uint32_t getCycleCount();
+    const char* getSdkVersion() { return "host"; }
+    const char* getChipModel() { return "host"; }
+    uint8_t getChipRevision() { return 0; }
+    uint32_t getFlashChipSize() { return 4 * 1024 * 1024; }
+    uint64_t getEfuseMac() { return 0x0000c3b2a1f0cf24ULL; }
+    [[noreturn]] void restart();
+};
+
+extern EspClass ESP;
+
+// ---- FreeRTOS ----
+// Everything runs on the loop task; the web server and Wi-Fi events are
+// pumped between loop() passes, so critical sections have nothing to
+// exclude.
+
+typedef void* TaskHandle_t;
+typedef void* SemaphoreHandle_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define portMAX_DELAY 0xffffffffUL
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) (ms)
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+// Bytes of the loop task's stack never touched (painted stack, host_sim.h)
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex();
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t mutex, TickType_t wait);
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t mutex);
+
+typedef struct { uint32_t owner; uint32_t count; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED { 0, 0 }
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+
+#endif // HOST_ARDUINO_H
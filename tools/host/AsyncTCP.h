@@ -0,0 +1,11 @@
+#ifndef HOST_ASYNCTCP_H
+#define HOST_ASYNCTCP_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+// The web server shim talks to its sockets itself (web_host.cpp); the
+// firmware only includes this for the types
+class AsyncClient;
+
+#endif // HOST_ASYNCTCP_H
@@ -0,0 +1,16 @@
+#ifndef HOST_DNSSERVER_H
+#define HOST_DNSSERVER_H
+
+#include <IPAddress.h>
+
+// The captive portal's DNS answers nobody on the host: there is no AP
+// client to ask it
+class DNSServer {
+public:
+    bool start(uint16_t port, const String& domainName, const IPAddress& resolvedIP) { return true; }
+    void stop() {}
+    void processNextRequest() {}
+    void setErrorReplyCode(int) {}
+};
+
+#endif // HOST_DNSSERVER_H
@@ -0,0 +1,333 @@
+#ifndef HOST_ESPASYNCWEBSERVER_H
+#define HOST_ESPASYNCWEBSERVER_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <AsyncTCP.h>
+#include <functional>
+#include <vector>
+
+// =================================================================
+//                  HOST SHIM: ESPAsyncWebServer
+// =================================================================
+// The request and response classes of ESPAsyncWebServer over a local TCP
+// socket (hostSetHttpPort()), pumped from hostPoll() on the loop task.
+// Dispatch follows the library: handlers are tried in registration order
+// with their filters, then the catch-all; a raw body goes to the
+// handler's body callback in segment-sized chunks as it arrives, a
+// multipart one to its upload callback, and the request callback runs
+// once the body is in. Responses are filled lazily a TCP window at a time,
+// a filler may answer RESPONSE_TRY_AGAIN, and every connection closes
+// after its response, as in the library.
+
+typedef enum {
+    HTTP_GET     = 0b00000001,
+    HTTP_POST    = 0b00000010,
+    HTTP_DELETE  = 0b00000100,
+    HTTP_PUT     = 0b00001000,
+    HTTP_PATCH   = 0b00010000,
+    HTTP_HEAD    = 0b00100000,
+    HTTP_OPTIONS = 0b01000000,
+    HTTP_ANY     = 0b01111111
+} WebRequestMethod;
+typedef uint8_t WebRequestMethodComposite;
+
+#define RESPONSE_TRY_AGAIN 0xFFFFFFFF
+
+class AsyncWebServer;
+class AsyncWebServerRequest;
+class AsyncWebHandler;
+struct HostWebConnection;
+
+typedef std::function<void(AsyncWebServerRequest*)> ArRequestHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest*, const String&, size_t, uint8_t*, size_t, bool)> ArUploadHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest*, uint8_t*, size_t, size_t, size_t)> ArBodyHandlerFunction;
+typedef std::function<bool(AsyncWebServerRequest*)> ArRequestFilterFunction;
+typedef std::function<size_t(uint8_t*, size_t, size_t)> AwsResponseFiller;
+typedef std::function<String(const String&)> AwsTemplateProcessor;
+typedef std::function<void()> ArDisconnectHandler;
+
+class AsyncWebParameter {
+public:
+    AsyncWebParameter(const String& name, const String& value, bool form = false, bool file = false, size_t size = 0)
+        : _name(name), _value(value), _size(size), _isForm(form), _isFile(file) {}
+    const String& name() const { return _name; }
+    const String& value() const { return _value; }
+    size_t size() const { return _size; }
+    bool isPost() const { return _isForm; }
+    bool isFile() const { return _isFile; }
+
+private:
+    String _name;
+    String _value;
+    size_t _size;
+    bool _isForm;
+    bool _isFile;
+};
+
+class AsyncWebHeader {
+public:
+    AsyncWebHeader(const String& name, const String& value) : _name(name), _value(value) {}
+    const String& name() const { return _name; }
+    const String& value() const { return _value; }
+
+private:
+    String _name;
+    String _value;
+};
+
+// ---- Responses ----
+
+class AsyncWebServerResponse {
+public:
+    AsyncWebServerResponse();
+    virtual ~AsyncWebServerResponse() {}
+
+    void setCode(int code) { _code = code; }
+    void setContentLength(size_t length) { _contentLength = length; }
+    void setContentType(const String& type) { _contentType = type; }
+    void addHeader(const String& name, const String& value) { _headers.emplace_back(name, value); }
+
+    // Status line and headers, as the library assembles them
+    String assembleHead(uint8_t httpVersion);
+    // Next piece of the body: bytes written, 0 at the end or
+    // RESPONSE_TRY_AGAIN when the data is not ready yet
+    virtual size_t fillBody(uint8_t* buffer, size_t maxLen) = 0;
+    virtual bool sourceValid() const { return true; }
+
+protected:
+    int _code;
+    String _contentType;
+    size_t _contentLength;
+    bool _sendContentLength;
+    bool _chunked;
+    size_t _sentLength;              // Body bytes produced so far
+    std::vector<AsyncWebHeader> _headers;
+};
+
+class AsyncBasicResponse : public AsyncWebServerResponse {
+public:
+    AsyncBasicResponse(int code, const String& contentType = String(), const String& content = String());
+    size_t fillBody(uint8_t* buffer, size_t maxLen) override;
+
+private:
+    String _content;
+};
+
+// Reads the content where it lies as the body goes out, like the library
+class AsyncProgmemResponse : public AsyncWebServerResponse {
+public:
+    AsyncProgmemResponse(int code, const String& contentType, const uint8_t* content, size_t length);
+    size_t fillBody(uint8_t* buffer, size_t maxLen) override;
+
+private:
+    const uint8_t* _content;
+};
+
+class AsyncFileResponse : public AsyncWebServerResponse {
+public:
+    AsyncFileResponse(FS& fs, const String& path, const String& contentType = String(), bool download = false);
+    AsyncFileResponse(File content, const String& path, const String& contentType = String(), bool download = false);
+    ~AsyncFileResponse() override;
+    size_t fillBody(uint8_t* buffer, size_t maxLen) override;
+    bool sourceValid() const override { return (bool)_content; }
+
+private:
+    File _content;
+    void setContentTypeFor(const String& path);
+    void setDisposition(const String& path, bool download);
+};
+
+// Length known up front (beginResponse with a filler)
+class AsyncCallbackResponse : public AsyncWebServerResponse {
+public:
+    AsyncCallbackResponse(const String& contentType, size_t length, AwsResponseFiller callback);
+    size_t fillBody(uint8_t* buffer, size_t maxLen) override;
+
+private:
+    AwsResponseFiller _callback;
+};
+
+class AsyncChunkedResponse : public AsyncWebServerResponse {
+public:
+    AsyncChunkedResponse(const String& contentType, AwsResponseFiller callback);
+    size_t fillBody(uint8_t* buffer, size_t maxLen) override;
+
+private:
+    AwsResponseFiller _callback;
+    bool _finished;                  // Terminating chunk sent
+};
+
+class AsyncResponseStream : public AsyncWebServerResponse, public Print {
+public:
+    AsyncResponseStream(const String& contentType, size_t bufferSize);
+    size_t fillBody(uint8_t* buffer, size_t maxLen) override;
+    using Print::write;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* data, size_t length) override;
+
+private:
+    std::string _content;
+};
+
+// ---- Request ----
+
+class AsyncWebServerRequest {
+public:
+    explicit AsyncWebServerRequest(AsyncWebServer* server);
+    ~AsyncWebServerRequest();
+
+    WebRequestMethodComposite method() const { return _method; }
+    const char* methodToString() const;
+    const String& url() const { return _url; }
+    const String& host() const { return _host; }
+    const String& contentType() const { return _contentType; }
+    size_t contentLength() const { return _contentLength; }
+    bool multipart() const { return _isMultipart; }
+
+    void send(AsyncWebServerResponse* response);
+    void send(int code, const String& contentType = String(), const String& content = String());
+    void send(FS& fs, const String& path, const String& contentType = String(), bool download = false,
+              AwsTemplateProcessor callback = nullptr);
+    void send(const String& contentType, size_t length, AwsResponseFiller callback,
+              AwsTemplateProcessor templateCallback = nullptr);
+    void redirect(const String& url);
+
+    AsyncWebServerResponse* beginResponse(int code, const String& contentType = String(), const String& content = String());
+    AsyncWebServerResponse* beginResponse(FS& fs, const String& path, const String& contentType = String(),
+                                          bool download = false, AwsTemplateProcessor callback = nullptr);
+    AsyncWebServerResponse* beginResponse(File content, const String& path, const String& contentType = String(),
+                                          bool download = false, AwsTemplateProcessor callback = nullptr);
+    AsyncWebServerResponse* beginResponse(const String& contentType, size_t length, AwsResponseFiller callback,
+                                          AwsTemplateProcessor templateCallback = nullptr);
+    AsyncWebServerResponse* beginChunkedResponse(const String& contentType, AwsResponseFiller callback,
+                                                 AwsTemplateProcessor templateCallback = nullptr);
+    AsyncResponseStream* beginResponseStream(const String& contentType, size_t bufferSize = 1460);
+    AsyncWebServerResponse* beginResponse_P(int code, const String& contentType, const uint8_t* content, size_t length,
+                                            AwsTemplateProcessor callback = nullptr);
+    AsyncWebServerResponse* beginResponse_P(int code, const String& contentType, const char* content,
+                                            AwsTemplateProcessor callback = nullptr);
+
+    size_t params() const { return _params.size(); }
+    bool hasParam(const String& name, bool post = false, bool file = false) const;
+    AsyncWebParameter* getParam(const String& name, bool post = false, bool file = false) const;
+    AsyncWebParameter* getParam(size_t index) const;
+
+    size_t headers() const { return _headers.size(); }
+    bool hasHeader(const String& name) const;
+    AsyncWebHeader* getHeader(const String& name) const;
+    const String& header(const char* name) const;
+
+    void onDisconnect(ArDisconnectHandler fn) { _onDisconnectFn = fn; }
+
+    void* _tempObject;
+    File _tempFile;
+
+private:
+    friend struct HostWebConnection;
+
+    AsyncWebServer* _server;
+    AsyncWebHandler* _handler;
+    AsyncWebServerResponse* _response;
+    ArDisconnectHandler _onDisconnectFn;
+
+    WebRequestMethodComposite _method;
+    uint8_t _version;
+    String _url;
+    String _host;
+    String _contentType;
+    String _boundary;
+    size_t _contentLength;
+    bool _isMultipart;
+    bool _isPlainPost;
+    std::vector<AsyncWebHeader*> _headers;
+    std::vector<AsyncWebParameter*> _params;
+};
+
+// ---- Handlers and server ----
+
+class AsyncWebHandler {
+public:
+    virtual ~AsyncWebHandler() {}
+    AsyncWebHandler& setFilter(ArRequestFilterFunction fn) { _filter = fn; return *this; }
+    bool filter(AsyncWebServerRequest* request) { return _filter == nullptr || _filter(request); }
+    virtual bool canHandle(AsyncWebServerRequest*) { return false; }
+    virtual void handleRequest(AsyncWebServerRequest*) {}
+    virtual void handleUpload(AsyncWebServerRequest*, const String&, size_t, uint8_t*, size_t, bool) {}
+    virtual void handleBody(AsyncWebServerRequest*, uint8_t*, size_t, size_t, size_t) {}
+
+protected:
+    ArRequestFilterFunction _filter;
+};
+
+class AsyncCallbackWebHandler : public AsyncWebHandler {
+public:
+    AsyncCallbackWebHandler() : _method(HTTP_ANY) {}
+    void setUri(const String& uri) { _uri = uri; }
+    void setMethod(WebRequestMethodComposite method) { _method = method; }
+    void onRequest(ArRequestHandlerFunction fn) { _onRequest = fn; }
+    void onUpload(ArUploadHandlerFunction fn) { _onUpload = fn; }
+    void onBody(ArBodyHandlerFunction fn) { _onBody = fn; }
+
+    bool canHandle(AsyncWebServerRequest* request) override;
+    void handleRequest(AsyncWebServerRequest* request) override;
+    void handleUpload(AsyncWebServerRequest* request, const String& filename, size_t index,
+                      uint8_t* data, size_t len, bool final) override;
+    void handleBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) override;
+
+private:
+    String _uri;
+    WebRequestMethodComposite _method;
+    ArRequestHandlerFunction _onRequest;
+    ArUploadHandlerFunction _onUpload;
+    ArBodyHandlerFunction _onBody;
+};
+
+class AsyncWebServer {
+public:
+    explicit AsyncWebServer(uint16_t port) : _port(port) {}
+    ~AsyncWebServer();
+
+    void begin();
+    void end();
+    void reset();
+
+    AsyncCallbackWebHandler& on(const char* uri, ArRequestHandlerFunction onRequest);
+    AsyncCallbackWebHandler& on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest);
+    AsyncCallbackWebHandler& on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest,
+                                ArUploadHandlerFunction onUpload);
+    AsyncCallbackWebHandler& on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest,
+                                ArUploadHandlerFunction onUpload, ArBodyHandlerFunction onBody);
+    AsyncWebHandler& addHandler(AsyncWebHandler* handler);
+    void onNotFound(ArRequestHandlerFunction fn) { _catchAll.onRequest(fn); }
+    void onFileUpload(ArUploadHandlerFunction fn) { _catchAll.onUpload(fn); }
+    void onRequestBody(ArBodyHandlerFunction fn) { _catchAll.onBody(fn); }
+
+    // First handler whose filter and matcher take the request, else the
+    // catch-all
+    AsyncWebHandler* attachHandler(AsyncWebServerRequest* request);
+
+private:
+    uint16_t _port;
+    std::vector<AsyncWebHandler*> _handlers;
+    AsyncCallbackWebHandler _catchAll;
+};
+
+class DefaultHeaders {
+public:
+    static DefaultHeaders& Instance() {
+        static DefaultHeaders instance;
+        return instance;
+    }
+    void addHeader(const String& name, const String& value) { _headers.emplace_back(name, value); }
+    const std::vector<AsyncWebHeader>& headers() const { return _headers; }
+
+private:
+    DefaultHeaders() {}
+    std::vector<AsyncWebHeader> _headers;
+};
+
+bool ON_AP_FILTER(AsyncWebServerRequest* request);
+bool ON_STA_FILTER(AsyncWebServerRequest* request);
+
+#endif // HOST_ESPASYNCWEBSERVER_H
@@ -0,0 +1,97 @@
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+// =================================================================
+//                  HOST SHIM: FILESYSTEM
+// =================================================================
+// fs::File and fs::FS over a host directory, with SPIFFS's rules: the
+// namespace is flat (a directory listing walks every file under it),
+// paths are at most 31 characters and there are no directories to make
+// or remove.
+
+#include <Arduino.h>
+#include <memory>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+class FS;
+struct FileImpl;
+
+class File : public Stream {
+public:
+    File() {}
+    explicit File(std::shared_ptr<FileImpl> impl) : impl(impl) {}
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    int available() override;
+    int read() override;
+    int peek() override;
+    void flush() override;
+    size_t read(uint8_t* buffer, size_t size);
+    size_t readBytes(char* buffer, size_t length) { return read((uint8_t*)buffer, length); }
+
+    bool seek(uint32_t pos, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    void close();
+    explicit operator bool() const;
+    time_t getLastWrite();
+    const char* path() const;
+    const char* name() const;
+
+    bool isDirectory();
+    File openNextFile(const char* mode = FILE_READ);
+    void rewindDirectory();
+
+private:
+    std::shared_ptr<FileImpl> impl;
+};
+
+class FS {
+public:
+    File open(const char* path, const char* mode = FILE_READ, bool create = false);
+    File open(const String& path, const char* mode = FILE_READ, bool create = false) {
+        return open(path.c_str(), mode, create);
+    }
+    bool exists(const char* path);
+    bool exists(const String& path) { return exists(path.c_str()); }
+    bool remove(const char* path);
+    bool remove(const String& path) { return remove(path.c_str()); }
+    bool rename(const char* from, const char* to);
+    bool rename(const String& from, const String& to) { return rename(from.c_str(), to.c_str()); }
+    bool mkdir(const char*) { return false; }
+    bool mkdir(const String&) { return false; }
+    bool rmdir(const char*) { return false; }
+    bool rmdir(const String&) { return false; }
+
+protected:
+    friend struct FileImpl;
+    friend class File;
+
+    // Host path for a filesystem path, or "" when the path is not valid here
+    std::string hostPath(const char* path) const;
+    size_t walkUsedBytes() const;
+    void changed() { usedCache = (size_t)-1; }
+
+    std::string root;
+    size_t capacity = 0;
+    size_t usedCache = (size_t)-1;
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+
+#endif // HOST_FS_H
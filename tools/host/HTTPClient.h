@@ -0,0 +1,25 @@
+#ifndef HOST_HTTPCLIENT_H
+#define HOST_HTTPCLIENT_H
+
+#include <WiFi.h>
+
+#define HTTP_CODE_OK 200
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+
+// The touch screens fetch the controller's own API over HTTP. The host
+// runs the web server on the loop task between passes, so a blocking
+// request to it could never be answered: every request is refused.
+class HTTPClient {
+public:
+    bool begin(const String&) { return true; }
+    void end() {}
+    void addHeader(const String&, const String&) {}
+    void setTimeout(uint16_t) {}
+    void setConnectTimeout(int32_t) {}
+    int GET() { return HTTPC_ERROR_CONNECTION_REFUSED; }
+    int POST(const String&) { return HTTPC_ERROR_CONNECTION_REFUSED; }
+    String getString() { return String(); }
+    int getSize() { return -1; }
+};
+
+#endif // HOST_HTTPCLIENT_H
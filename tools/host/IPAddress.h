@@ -0,0 +1,45 @@
+#ifndef HOST_IPADDRESS_H
+#define HOST_IPADDRESS_H
+
+#include <Arduino.h>
+
+class IPAddress : public Printable {
+public:
+    IPAddress() {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : octets{a, b, c, d} {}
+    // The address as the ESP32 keeps it: first octet in the low byte
+    IPAddress(uint32_t address) { memcpy(octets, &address, sizeof(octets)); }
+
+    operator uint32_t() const {
+        uint32_t address;
+        memcpy(&address, octets, sizeof(address));
+        return address;
+    }
+    uint8_t operator[](int index) const { return octets[index]; }
+    bool operator==(const IPAddress& other) const { return memcmp(octets, other.octets, sizeof(octets)) == 0; }
+    bool operator!=(const IPAddress& other) const { return !(*this == other); }
+
+    bool fromString(const char* text) {
+        unsigned a, b, c, d;
+        char tail;
+        if (sscanf(text, "%u.%u.%u.%u%c", &a, &b, &c, &d, &tail) != 4 || a > 255 || b > 255 || c > 255 || d > 255) {
+            return false;
+        }
+        *this = IPAddress(a, b, c, d);
+        return true;
+    }
+    bool fromString(const String& text) { return fromString(text.c_str()); }
+
+    String toString() const {
+        char text[16];
+        snprintf(text, sizeof(text), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+        return String(text);
+    }
+
+    size_t printTo(Print& out) const override { return out.print(toString()); }
+
+private:
+    uint8_t octets[4] = {0, 0, 0, 0};
+};
+
+#endif // HOST_IPADDRESS_H
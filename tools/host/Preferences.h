@@ -0,0 +1,75 @@
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include <Arduino.h>
+
+// =================================================================
+//                  HOST SHIM: PREFERENCES
+// =================================================================
+// NVS namespaces in memory, saved to the file given to
+// hostSetPreferencesFile() on end() when there is one. As in NVS, a value
+// keeps the type it was written with and a get of another type returns
+// the default.
+
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr);
+    void end();
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+    size_t freeEntries() { return 256; }
+
+    size_t putBool(const char* key, bool value) { return putValue(key, 'b', &value, sizeof(value)); }
+    size_t putUChar(const char* key, uint8_t value) { return putValue(key, 'C', &value, sizeof(value)); }
+    size_t putShort(const char* key, int16_t value) { return putValue(key, 's', &value, sizeof(value)); }
+    size_t putUShort(const char* key, uint16_t value) { return putValue(key, 'S', &value, sizeof(value)); }
+    size_t putInt(const char* key, int32_t value) { return putValue(key, 'i', &value, sizeof(value)); }
+    size_t putUInt(const char* key, uint32_t value) { return putValue(key, 'I', &value, sizeof(value)); }
+    size_t putLong(const char* key, int32_t value) { return putValue(key, 'i', &value, sizeof(value)); }
+    size_t putULong(const char* key, uint32_t value) { return putValue(key, 'I', &value, sizeof(value)); }
+    size_t putLong64(const char* key, int64_t value) { return putValue(key, 'l', &value, sizeof(value)); }
+    size_t putULong64(const char* key, uint64_t value) { return putValue(key, 'L', &value, sizeof(value)); }
+    size_t putFloat(const char* key, float value) { return putValue(key, 'f', &value, sizeof(value)); }
+    size_t putDouble(const char* key, double value) { return putValue(key, 'd', &value, sizeof(value)); }
+    size_t putString(const char* key, const char* value) { return putValue(key, 'z', value, strlen(value)); }
+    size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+    size_t putBytes(const char* key, const void* value, size_t length) { return putValue(key, 'B', value, length); }
+
+    bool getBool(const char* key, bool fallback = false) { return getScalar(key, 'b', fallback); }
+    uint8_t getUChar(const char* key, uint8_t fallback = 0) { return getScalar(key, 'C', fallback); }
+    int16_t getShort(const char* key, int16_t fallback = 0) { return getScalar(key, 's', fallback); }
+    uint16_t getUShort(const char* key, uint16_t fallback = 0) { return getScalar(key, 'S', fallback); }
+    int32_t getInt(const char* key, int32_t fallback = 0) { return getScalar(key, 'i', fallback); }
+    uint32_t getUInt(const char* key, uint32_t fallback = 0) { return getScalar(key, 'I', fallback); }
+    int32_t getLong(const char* key, int32_t fallback = 0) { return getScalar(key, 'i', fallback); }
+    uint32_t getULong(const char* key, uint32_t fallback = 0) { return getScalar(key, 'I', fallback); }
+    int64_t getLong64(const char* key, int64_t fallback = 0) { return getScalar(key, 'l', fallback); }
+    uint64_t getULong64(const char* key, uint64_t fallback = 0) { return getScalar(key, 'L', fallback); }
+    float getFloat(const char* key, float fallback = 0) { return getScalar(key, 'f', fallback); }
+    double getDouble(const char* key, double fallback = 0) { return getScalar(key, 'd', fallback); }
+    String getString(const char* key, const String& fallback = String());
+    size_t getString(const char* key, char* value, size_t maxLength);
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* buffer, size_t maxLength);
+
+private:
+    size_t putValue(const char* key, char type, const void* data, size_t length);
+    // The stored bytes when key holds a value of this type, else nullptr
+    const std::string* find(const char* key, char type);
+
+    template <typename T>
+    T getScalar(const char* key, char type, T fallback) {
+        const std::string* stored = find(key, type);
+        if (!stored || stored->size() != sizeof(T)) return fallback;
+        T value;
+        memcpy(&value, stored->data(), sizeof(T));
+        return value;
+    }
+
+    std::string space;
+    bool started = false;
+    bool readOnly = false;
+};
+
+#endif // HOST_PREFERENCES_H
@@ -0,0 +1,19 @@
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include <Arduino.h>
+
+#define HSPI 2
+#define VSPI 3
+
+class SPIClass {
+public:
+    explicit SPIClass(uint8_t bus = HSPI) {}
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {}
+    void end() {}
+    void setFrequency(uint32_t) {}
+};
+
+extern SPIClass SPI;
+
+#endif // HOST_SPI_H
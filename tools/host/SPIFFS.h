@@ -0,0 +1,23 @@
+#ifndef HOST_SPIFFS_H
+#define HOST_SPIFFS_H
+
+#include <FS.h>
+
+// The CYD's default partition table gives SPIFFS about 1.4 MB. Usage is
+// counted in 256-byte pages, and a write that would not fit fails.
+#define HOST_SPIFFS_BYTES (1408 * 1024)
+
+class SPIFFSFS : public fs::FS {
+public:
+    // Mounts the directory given to hostMountSpiffs()
+    bool begin(bool formatOnFail = false, const char* basePath = "/spiffs",
+               uint8_t maxOpenFiles = 10, const char* partitionLabel = nullptr);
+    void end() {}
+    bool format();
+    size_t totalBytes();
+    size_t usedBytes();
+};
+
+extern SPIFFSFS SPIFFS;
+
+#endif // HOST_SPIFFS_H
@@ -0,0 +1,159 @@
+#ifndef HOST_TFT_ESPI_H
+#define HOST_TFT_ESPI_H
+
+#include <Arduino.h>
+
+// =================================================================
+//                  HOST SHIM: TFT_eSPI
+// =================================================================
+// The panel is a 16-bit framebuffer that hostWritePng() dumps; sprites are
+// heap buffers like on the device, so their memory shows in the heap
+// figures. Text is the GLCD font in 6x8 cells, scaled by the text size.
+//
+// Byte order follows the library: a sprite stores its pixels swapped, as
+// the panel wants them over SPI, and pushImage() takes native pixels with
+// setSwapBytes(true) and panel-order ones without. DMA transfers finish
+// before they return.
+
+#define TFT_BLACK       0x0000
+#define TFT_NAVY        0x000F
+#define TFT_DARKGREEN   0x03E0
+#define TFT_DARKCYAN    0x03EF
+#define TFT_MAROON      0x7800
+#define TFT_PURPLE      0x780F
+#define TFT_OLIVE       0x7BE0
+#define TFT_LIGHTGREY   0xD69A
+#define TFT_DARKGREY    0x7BEF
+#define TFT_BLUE        0x001F
+#define TFT_GREEN       0x07E0
+#define TFT_CYAN        0x07FF
+#define TFT_RED         0xF800
+#define TFT_MAGENTA     0xF81F
+#define TFT_YELLOW      0xFFE0
+#define TFT_WHITE       0xFFFF
+#define TFT_ORANGE      0xFDA0
+#define TFT_GREENYELLOW 0xB7E0
+#define TFT_PINK        0xFE19
+#define TFT_GREY        0x5AEB
+
+#define PSRAM_ENABLE 3
+
+// ILI9341 in portrait, as TFT_eSPI's User_Setup declares it
+#define HOST_TFT_PANEL_WIDTH 240
+#define HOST_TFT_PANEL_HEIGHT 320
+
+class TFT_eSPI : public Print {
+public:
+    TFT_eSPI(int16_t width = HOST_TFT_PANEL_WIDTH, int16_t height = HOST_TFT_PANEL_HEIGHT);
+    virtual ~TFT_eSPI() {}
+
+    void init(uint8_t tabColour = 0);
+    void begin(uint8_t tabColour = 0) { init(tabColour); }
+    void setRotation(uint8_t rotation);
+    uint8_t getRotation() { return rotation; }
+
+    int16_t width() { return xWidth; }
+    int16_t height() { return yHeight; }
+
+    virtual void fillScreen(uint32_t color);
+    virtual void drawPixel(int32_t x, int32_t y, uint32_t color);
+    virtual void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+    virtual void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color);
+    virtual void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color);
+    virtual void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+    void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+    void drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color);
+    void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color);
+    void drawCircle(int32_t x, int32_t y, int32_t r, uint32_t color);
+    void fillCircle(int32_t x, int32_t y, int32_t r, uint32_t color);
+    uint16_t readPixel(int32_t x, int32_t y);
+
+    void setTextColor(uint16_t color);
+    void setTextColor(uint16_t color, uint16_t background, bool fill = false);
+    void setTextSize(uint8_t size) { textSize = size > 0 ? size : 1; }
+    void setTextWrap(bool wrapX, bool wrapY = false) { textWrapX = wrapX; textWrapY = wrapY; }
+    void setCursor(int16_t x, int16_t y) { cursorX = x; cursorY = y; }
+    int16_t getCursorX() { return cursorX; }
+    int16_t getCursorY() { return cursorY; }
+    int16_t textWidth(const char* text);
+    int16_t textWidth(const String& text) { return textWidth(text.c_str()); }
+    int16_t fontHeight() { return 8 * textSize; }
+    void drawChar(int32_t x, int32_t y, uint16_t c, uint32_t color, uint32_t background, uint8_t size);
+
+    using Print::write;
+    size_t write(uint8_t c) override;
+
+    void setSwapBytes(bool swap) { swapBytes = swap; }
+    bool getSwapBytes() { return swapBytes; }
+    void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data);
+    void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data, uint16_t* buffer = nullptr) {
+        pushImage(x, y, w, h, data);
+    }
+    bool initDMA(bool ctrlCs = false) { return true; }
+    void deInitDMA() {}
+    void dmaWait() {}
+    bool dmaBusy() { return false; }
+    void startWrite() {}
+    void endWrite() {}
+
+    void setViewport(int32_t x, int32_t y, int32_t w, int32_t h, bool vpDatum = true);
+    void resetViewport();
+    int32_t getViewportX() { return xDatum; }
+    int32_t getViewportY() { return yDatum; }
+
+    uint16_t color565(uint8_t r, uint8_t g, uint8_t b) {
+        return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+    }
+
+    // The panel's pixels, native RGB565, for hostWritePng()
+    const uint16_t* panelPixels() const { return pixels; }
+    int32_t panelRowWidth() const { return fullWidth; }
+    int32_t panelRows() const { return fullHeight; }
+
+protected:
+    // Pixel store: the panel's static framebuffer, or a sprite's buffer
+    uint16_t* pixels = nullptr;
+    bool storesSwapped = false;
+    bool oneBit = false;             // 1-bit sprite: any colour but black is set
+
+    int32_t panelWidth, panelHeight; // Unrotated
+    int32_t fullWidth, fullHeight;   // Of the pixel store, after rotation
+    uint8_t rotation = 0;
+
+    // Viewport, as TFT_eSPI keeps it: drawing coordinates are offset by the
+    // datum and clipped to [vpX, vpW) x [vpY, vpH)
+    int32_t xDatum = 0, yDatum = 0;
+    int32_t xWidth, yHeight;
+    int32_t vpX = 0, vpY = 0, vpW, vpH;
+
+    int32_t cursorX = 0, cursorY = 0;
+    uint16_t textColor = TFT_WHITE, textBackground = TFT_WHITE;
+    uint8_t textSize = 1;
+    bool textWrapX = true, textWrapY = false;
+    bool swapBytes = false;
+
+    void storePixel(int32_t x, int32_t y, uint16_t color);   // Absolute, clipped
+    void setStore(uint16_t* store, int32_t width, int32_t height);
+};
+
+class TFT_eSprite : public TFT_eSPI {
+public:
+    explicit TFT_eSprite(TFT_eSPI* parent) : parent(parent) {}
+    ~TFT_eSprite() override { deleteSprite(); }
+
+    void* createSprite(int16_t width, int16_t height, uint8_t frames = 1);
+    void deleteSprite();
+    bool created() { return pixels != nullptr; }
+    void setColorDepth(int8_t depth) { colorDepth = depth; }
+    int8_t getColorDepth() { return colorDepth; }
+    void setAttribute(uint8_t attribute, uint8_t value) {}
+    void* getPointer() { return pixels; }
+    void fillSprite(uint32_t color) { fillScreen(color); }
+    void pushSprite(int32_t x, int32_t y);
+
+private:
+    TFT_eSPI* parent;
+    int8_t colorDepth = 16;
+};
+
+#endif // HOST_TFT_ESPI_H
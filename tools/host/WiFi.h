@@ -0,0 +1,122 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+// =================================================================
+//                  HOST SHIM: WI-FI
+// =================================================================
+// One access point exists, named by hostSetWifiNetwork(). A station that
+// asks for it associates about 1.5 s of virtual time later; any other
+// SSID fails with NO_AP_FOUND after 3 s. Events are queued and delivered
+// from hostPoll(), as the ESP32's event task would between loop() passes.
+// The station's address is the loopback, where the web server listens.
+
+typedef enum {
+    WL_NO_SHIELD = 255,
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL,
+    WL_SCAN_COMPLETED,
+    WL_CONNECTED,
+    WL_CONNECT_FAILED,
+    WL_CONNECTION_LOST,
+    WL_DISCONNECTED
+} wl_status_t;
+
+typedef enum {
+    WIFI_MODE_NULL = 0,
+    WIFI_MODE_STA,
+    WIFI_MODE_AP,
+    WIFI_MODE_APSTA
+} wifi_mode_t;
+#define WIFI_OFF WIFI_MODE_NULL
+#define WIFI_STA WIFI_MODE_STA
+#define WIFI_AP WIFI_MODE_AP
+#define WIFI_AP_STA WIFI_MODE_APSTA
+
+typedef enum {
+    ARDUINO_EVENT_WIFI_READY = 0,
+    ARDUINO_EVENT_WIFI_SCAN_DONE,
+    ARDUINO_EVENT_WIFI_STA_START,
+    ARDUINO_EVENT_WIFI_STA_STOP,
+    ARDUINO_EVENT_WIFI_STA_CONNECTED,
+    ARDUINO_EVENT_WIFI_STA_DISCONNECTED,
+    ARDUINO_EVENT_WIFI_STA_AUTHMODE_CHANGE,
+    ARDUINO_EVENT_WIFI_STA_GOT_IP,
+    ARDUINO_EVENT_WIFI_STA_LOST_IP
+} arduino_event_id_t;
+typedef arduino_event_id_t WiFiEvent_t;
+
+#define WIFI_REASON_ASSOC_LEAVE 8
+#define WIFI_REASON_NO_AP_FOUND 201
+
+typedef struct {
+    struct {
+        uint8_t ssid[33];
+        uint8_t ssid_len;
+        uint8_t bssid[6];
+        uint8_t reason;
+    } wifi_sta_disconnected;
+    struct {
+        uint8_t bssid[6];
+        uint8_t channel;
+    } wifi_sta_connected;
+} arduino_event_info_t;
+typedef arduino_event_info_t WiFiEventInfo_t;
+
+typedef int wifi_auth_mode_t;
+#define WIFI_AUTH_OPEN 0
+#define WIFI_AUTH_WPA2_PSK 3
+
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+
+typedef size_t wifi_event_id_t;
+typedef std::function<void(arduino_event_id_t, arduino_event_info_t)> WiFiEventFuncCb;
+
+class WiFiClass {
+public:
+    wl_status_t begin(const char* ssid, const char* passphrase = nullptr, int32_t channel = 0,
+                      const uint8_t* bssid = nullptr, bool connect = true);
+    wl_status_t status();
+    bool isConnected() { return status() == WL_CONNECTED; }
+    bool disconnect(bool wifiOff = false, bool eraseAp = false);
+    bool mode(wifi_mode_t mode);
+    wifi_mode_t getMode() { return currentMode; }
+    bool config(IPAddress localIp, IPAddress gateway, IPAddress subnet,
+                IPAddress dns1 = IPAddress(), IPAddress dns2 = IPAddress());
+    bool setHostname(const char*) { return true; }
+    bool setAutoReconnect(bool) { return true; }
+    bool persistent(bool) { return true; }
+    bool setSleep(bool) { return true; }
+    wifi_event_id_t onEvent(WiFiEventFuncCb callback, arduino_event_id_t event = ARDUINO_EVENT_WIFI_READY);
+
+    IPAddress localIP();
+    String SSID();
+    int32_t RSSI();
+    String macAddress();
+    uint8_t* BSSID();
+    String BSSIDstr();
+    int32_t channel();
+
+    bool softAP(const char* ssid, const char* passphrase = nullptr, int channel = 1,
+                int hidden = 0, int maxConnections = 4);
+    bool softAPConfig(IPAddress localIp, IPAddress gateway, IPAddress subnet);
+    bool softAPdisconnect(bool wifiOff = false);
+    IPAddress softAPIP();
+
+    int16_t scanNetworks(bool async = false, bool showHidden = false);
+    int16_t scanComplete();
+    void scanDelete();
+    String SSID(uint8_t index);
+    int32_t RSSI(uint8_t index);
+    wifi_auth_mode_t encryptionType(uint8_t index);
+
+private:
+    wifi_mode_t currentMode = WIFI_MODE_NULL;
+};
+
+extern WiFiClass WiFi;
+
+#endif // HOST_WIFI_H
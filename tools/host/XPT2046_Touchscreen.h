@@ -0,0 +1,21 @@
+#ifndef HOST_XPT2046_TOUCHSCREEN_H
+#define HOST_XPT2046_TOUCHSCREEN_H
+
+#include <Arduino.h>
+#include <SPI.h>
+
+struct TS_Point {
+    int16_t x, y, z;
+};
+
+class XPT2046_Touchscreen {
+public:
+    XPT2046_Touchscreen(uint8_t cs, uint8_t irq = 255) {}
+    bool begin(SPIClass& spi);
+    void setRotation(uint8_t) {}
+    bool touched();
+    bool tirqTouched();
+    TS_Point getPoint();
+};
+
+#endif // HOST_XPT2046_TOUCHSCREEN_H
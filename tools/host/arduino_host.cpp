@@ -0,0 +1,455 @@
+#include "Arduino.h"
+#include "host_sim.h"
+#include "host_internal.h"
+#include <malloc.h>
+#include <mutex>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// ====================================================================
+// SERIAL
+// ====================================================================
+
+static bool quietOutput = false;
+
+void hostSetQuiet(bool quiet) {
+  quietOutput = quiet;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  if (quietOutput) return size;
+  // The firmware ends lines with \r\n; a terminal wants \n
+  for (size_t i = 0; i < size; i++) {
+    if (buffer[i] != '\r') fputc(buffer[i], stdout);
+  }
+  return size;
+}
+
+size_t Print::printf(const char* format, ...) {
+  char small[256];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(small, sizeof(small), format, args);
+  va_end(args);
+  if (length < 0) return 0;
+  if ((size_t)length < sizeof(small)) return write((const uint8_t*)small, length);
+
+  std::string large(length + 1, '\0');
+  va_start(args, format);
+  vsnprintf(&large[0], large.size(), format, args);
+  va_end(args);
+  return write((const uint8_t*)large.data(), length);
+}
+
+// ====================================================================
+// VIRTUAL CLOCK
+// ====================================================================
+
+static uint64_t monotonicMicros() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static const uint64_t bootMicros = monotonicMicros();
+static uint64_t skippedMicros = 0;
+static bool realtimeClock = false;
+
+uint64_t hostMicros() {
+  return monotonicMicros() - bootMicros + skippedMicros;
+}
+
+uint64_t hostCpuMicros() {
+  return monotonicMicros();
+}
+
+void hostSkip(uint64_t micros) {
+  skippedMicros += micros;
+}
+
+void hostSetRealtime(bool realtime) {
+  realtimeClock = realtime;
+}
+
+unsigned long millis() {
+  return hostMicros() / 1000;
+}
+
+unsigned long micros() {
+  return hostMicros();
+}
+
+void delay(unsigned long ms) {
+  if (realtimeClock) {
+    usleep(ms * 1000);
+  } else {
+    hostSkip((uint64_t)ms * 1000);
+  }
+}
+
+void delayMicroseconds(unsigned int us) {
+  if (realtimeClock) {
+    usleep(us);
+  } else {
+    hostSkip(us);
+  }
+}
+
+void yield() {}
+
+int64_t esp_timer_get_time() {
+  return (int64_t)hostMicros();
+}
+
+void vTaskDelay(TickType_t ticks) {
+  delay(ticks * portTICK_PERIOD_MS);
+}
+
+TickType_t xTaskGetTickCount() {
+  return (TickType_t)(millis() / portTICK_PERIOD_MS);
+}
+
+uint32_t EspClass::getCycleCount() {
+  return (uint32_t)(monotonicMicros() * getCpuFreqMHz());
+}
+
+// ====================================================================
+// WALL CLOCK
+// ====================================================================
+// The ESP32 boots at the Unix epoch and SNTP sets it. time(),
+// gettimeofday(), settimeofday() and adjtime() are replaced for the whole
+// process, so the firmware sets a clock of its own and never the host's.
+// adjtime() slews like newlib on the ESP32: the correction is spread over
+// six times its length.
+
+#define ADJTIME_SLEW_FACTOR 6
+#define ADJTIME_MAX_MICROS (35LL * 60 * 1000000)
+
+static int64_t wallOffsetMicros = 0;     // Wall clock minus virtual time, slew excluded
+static int64_t slewTotalMicros = 0;
+static uint64_t slewStartedAt = 0;
+
+static int64_t slewAppliedMicros(uint64_t now) {
+  if (slewTotalMicros == 0) return 0;
+  int64_t elapsed = (int64_t)((now - slewStartedAt) / ADJTIME_SLEW_FACTOR);
+  if (elapsed >= llabs(slewTotalMicros)) return slewTotalMicros;
+  return slewTotalMicros < 0 ? -elapsed : elapsed;
+}
+
+static int64_t wallMicros() {
+  uint64_t now = hostMicros();
+  return (int64_t)now + wallOffsetMicros + slewAppliedMicros(now);
+}
+
+// Fold a finished or cancelled slew into the offset
+static void settleSlew() {
+  wallOffsetMicros += slewAppliedMicros(hostMicros());
+  slewTotalMicros = 0;
+}
+
+bool hostSlewing() {
+  return slewTotalMicros != 0 && slewAppliedMicros(hostMicros()) != slewTotalMicros;
+}
+
+extern "C" {
+
+time_t time(time_t* out) noexcept {
+  time_t now = (time_t)(wallMicros() / 1000000);
+  if (out) *out = now;
+  return now;
+}
+
+int gettimeofday(struct timeval* tv, void*) noexcept {
+  int64_t now = wallMicros();
+  tv->tv_sec = (time_t)(now / 1000000);
+  tv->tv_usec = (suseconds_t)(now % 1000000);
+  return 0;
+}
+
+int settimeofday(const struct timeval* tv, const struct timezone*) noexcept {
+  if (!tv) return 0;
+  slewTotalMicros = 0;
+  wallOffsetMicros = (int64_t)tv->tv_sec * 1000000 + tv->tv_usec - (int64_t)hostMicros();
+  return 0;
+}
+
+int adjtime(const struct timeval* delta, struct timeval* olddelta) noexcept {
+  uint64_t now = hostMicros();
+  if (olddelta) {
+    int64_t left = slewTotalMicros - slewAppliedMicros(now);
+    olddelta->tv_sec = (time_t)(left / 1000000);
+    olddelta->tv_usec = (suseconds_t)(left % 1000000);
+  }
+  if (!delta) return 0;
+  int64_t micros = (int64_t)delta->tv_sec * 1000000 + delta->tv_usec;
+  if (llabs(micros) > ADJTIME_MAX_MICROS) return -1;
+  settleSlew();
+  slewTotalMicros = micros;
+  slewStartedAt = now;
+  return 0;
+}
+
+}
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1, const char*, const char*) {
+  // POSIX TZ offsets count west of UTC, as the ESP32 core writes them
+  long west = -(gmtOffsetSec + daylightOffsetSec);
+  char tz[32];
+  snprintf(tz, sizeof(tz), "UTC%c%ld:%02ld", west < 0 ? '-' : '+', labs(west) / 3600, (labs(west) % 3600) / 60);
+  setenv("TZ", tz, 1);
+  tzset();
+  hostSntpConfigure(server1);
+}
+
+bool getLocalTime(struct tm* info, uint32_t ms) {
+  uint32_t start = millis();
+  for (;;) {
+    time_t now = time(nullptr);
+    localtime_r(&now, info);
+    if (info->tm_year > (2016 - 1900)) return true;
+    if (millis() - start > ms) return false;
+    delay(10);
+  }
+}
+
+// ====================================================================
+// GPIO AND RANDOM
+// ====================================================================
+
+static uint8_t pinLevels[64];
+
+void pinMode(uint8_t, uint8_t) {}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if (pin >= sizeof(pinLevels)) return;
+  uint8_t level = value ? HIGH : LOW;
+  if (pinLevels[pin] != level) {
+    pinLevels[pin] = level;
+    hostPinChanged(pin, level);
+  }
+}
+
+int digitalRead(uint8_t pin) {
+  return pin < sizeof(pinLevels) ? pinLevels[pin] : LOW;
+}
+
+static uint32_t randomState = 1;
+
+void hostSetSeed(uint32_t seed) {
+  randomState = seed != 0 ? seed : 1;
+}
+
+// xorshift32, so runs with the same seed repeat
+uint32_t hostRandom() {
+  uint32_t x = randomState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  randomState = x;
+  return x;
+}
+
+uint32_t esp_random() {
+  return hostRandom();
+}
+
+void randomSeed(unsigned long seed) {
+  if (seed != 0) hostSetSeed((uint32_t)seed);
+}
+
+long random(long howbig) {
+  return howbig > 0 ? (long)(hostRandom() % (uint32_t)howbig) : 0;
+}
+
+long random(long howsmall, long howbig) {
+  return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall);
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  if (inMax == inMin) return outMin;
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+float temperatureRead() {
+  return 45.0f;
+}
+
+// ====================================================================
+// HEAP
+// ====================================================================
+// An ESP32 without PSRAM has about 320 KB of internal heap. Free heap is
+// that less what the firmware allocated after hostMarkHeapBase(). Host
+// pointers are twice as wide, so the figure runs pessimistic; it is for
+// comparing runs, not for sizing the device.
+
+#define HOST_ESP32_HEAP_SIZE 327680
+
+static size_t heapBase = 0;
+static size_t heapPeak = 0;
+
+static size_t processHeapInUse() {
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+void hostMarkHeapBase() {
+  mallopt(M_ARENA_MAX, 1);
+  heapBase = processHeapInUse();
+  heapPeak = 0;
+}
+
+size_t hostHeapUsed() {
+  size_t inUse = processHeapInUse();
+  return inUse > heapBase ? inUse - heapBase : 0;
+}
+
+void hostSampleHeap() {
+  size_t used = hostHeapUsed();
+  if (used > heapPeak) heapPeak = used;
+}
+
+size_t hostHeapPeak() {
+  hostSampleHeap();
+  return heapPeak;
+}
+
+size_t hostPeakRssKb() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+static uint32_t freeHeapFor(size_t used) {
+  return used < HOST_ESP32_HEAP_SIZE ? (uint32_t)(HOST_ESP32_HEAP_SIZE - used) : 0;
+}
+
+uint32_t EspClass::getHeapSize() {
+  return HOST_ESP32_HEAP_SIZE;
+}
+
+uint32_t EspClass::getFreeHeap() {
+  hostSampleHeap();
+  return freeHeapFor(hostHeapUsed());
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  return freeHeapFor(hostHeapPeak());
+}
+
+// No fragmentation model: the largest block is all of the free heap
+uint32_t EspClass::getMaxAllocHeap() {
+  return getFreeHeap();
+}
+
+bool psramFound() {
+  return false;
+}
+
+void* ps_malloc(size_t) {
+  return nullptr;
+}
+
+static void (*restartHandler)() = nullptr;
+
+void hostOnRestart(void (*handler)()) {
+  restartHandler = handler;
+}
+
+void EspClass::restart() {
+  fflush(stdout);
+  if (restartHandler) restartHandler();
+  exit(0);
+}
+
+// ====================================================================
+// LOOP TASK AND MUTEXES
+// ====================================================================
+
+#define STACK_PAINT 0xa5a5a5a5a5a5a5a5ULL
+
+static uint64_t* loopStackBottom = nullptr;
+static size_t loopStackWords = 0;
+static pthread_t loopThread;
+
+struct LoopTaskStart {
+  void (*fn)();
+};
+
+static void* loopTaskMain(void* arg) {
+  static_cast<LoopTaskStart*>(arg)->fn();
+  return nullptr;
+}
+
+void hostRunLoopTask(size_t stackBytes, void (*fn)()) {
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  stackBytes = (stackBytes + page - 1) / page * page;
+
+  // One guard page below the stack turns an overflow into a crash
+  uint8_t* region = (uint8_t*)mmap(nullptr, stackBytes + page, PROT_READ | PROT_WRITE,
+                                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (region == MAP_FAILED) {
+    perror("mmap");
+    exit(1);
+  }
+  mprotect(region, page, PROT_NONE);
+  loopStackBottom = (uint64_t*)(region + page);
+  loopStackWords = stackBytes / sizeof(uint64_t);
+  for (size_t i = 0; i < loopStackWords; i++) loopStackBottom[i] = STACK_PAINT;
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setstack(&attr, loopStackBottom, stackBytes);
+  LoopTaskStart start = { fn };
+  if (pthread_create(&loopThread, &attr, loopTaskMain, &start) != 0) {
+    fprintf(stderr, "cannot start the loop task\n");
+    exit(1);
+  }
+  pthread_join(loopThread, nullptr);
+  pthread_attr_destroy(&attr);
+}
+
+// Like FreeRTOS: count the painted words up from the end of the stack
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) {
+  if (!loopStackBottom) return 0;
+  size_t clean = 0;
+  while (clean < loopStackWords && loopStackBottom[clean] == STACK_PAINT) clean++;
+  return (UBaseType_t)(clean * sizeof(uint64_t));
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+  return new std::recursive_timed_mutex();
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t mutex, TickType_t wait) {
+  auto* m = static_cast<std::recursive_timed_mutex*>(mutex);
+  if (wait == (TickType_t)portMAX_DELAY) {
+    m->lock();
+    return pdTRUE;
+  }
+  return m->try_lock_for(std::chrono::milliseconds(wait)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t mutex) {
+  static_cast<std::recursive_timed_mutex*>(mutex)->unlock();
+  return pdTRUE;
+}
+
+// ====================================================================
+// BACKGROUND TASKS
+// ====================================================================
+
+void hostPoll() {
+  hostWifiPoll();
+  hostSntpPoll();
+  hostWebPoll();
+  hostSampleHeap();
+}
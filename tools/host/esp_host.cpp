@@ -0,0 +1,162 @@
+#include "esp_sntp.h"
+#include "mqtt_client.h"
+#include "Arduino.h"
+#include "host_sim.h"
+#include "host_internal.h"
+
+// ====================================================================
+// SNTP
+// ====================================================================
+
+// The IDF steps instead of slewing above this error (adjtime()'s limit)
+#define SNTP_SMOOTH_LIMIT_US (35LL * 60 * 1000000)
+#define SNTP_FIRST_SYNC_MS 500
+#define SNTP_RETRY_MS 2000
+
+static sntp_sync_time_cb_t syncCallback = nullptr;
+static sntp_sync_mode_t syncMode = SNTP_SYNC_MODE_IMMED;
+static sntp_sync_status_t syncStatus = SNTP_SYNC_STATUS_RESET;
+static uint32_t syncIntervalMs = 3600000;
+static bool sntpRunning = false;
+static unsigned long nextSyncAt = 0;
+
+static time_t networkTimeAtBoot = 0;
+
+void hostSetNetworkTime(time_t unixTime) {
+  networkTimeAtBoot = unixTime;
+}
+
+static void scheduleSync(uint32_t delayMs) {
+  nextSyncAt = millis() + delayMs;
+}
+
+// Called by configTime(); the ESP32 core restarts SNTP with the new server
+void hostSntpConfigure(const char*) {
+  sntpRunning = true;
+  scheduleSync(SNTP_FIRST_SYNC_MS);
+}
+
+void hostSntpPoll() {
+  if (!sntpRunning || (long)(millis() - nextSyncAt) < 0) return;
+  if (!hostStationUp()) {
+    scheduleSync(SNTP_RETRY_MS);
+    return;
+  }
+  scheduleSync(syncIntervalMs);
+
+  uint64_t now = hostMicros();
+  struct timeval server;
+  server.tv_sec = networkTimeAtBoot + (time_t)(now / 1000000);
+  server.tv_usec = (suseconds_t)(now % 1000000);
+
+  struct timeval local;
+  gettimeofday(&local, nullptr);
+  int64_t errorUs = ((int64_t)server.tv_sec - local.tv_sec) * 1000000 + (server.tv_usec - local.tv_usec);
+
+  bool slew = syncMode == SNTP_SYNC_MODE_SMOOTH && llabs(errorUs) < SNTP_SMOOTH_LIMIT_US;
+  if (slew) {
+    struct timeval delta = { (time_t)(errorUs / 1000000), (suseconds_t)(errorUs % 1000000) };
+    slew = adjtime(&delta, nullptr) == 0;
+  }
+  if (slew) {
+    syncStatus = SNTP_SYNC_STATUS_IN_PROGRESS;
+  } else {
+    settimeofday(&server, nullptr);
+    syncStatus = SNTP_SYNC_STATUS_COMPLETED;
+  }
+  if (syncCallback) syncCallback(&server);
+}
+
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback) {
+  syncCallback = callback;
+}
+
+void sntp_set_sync_mode(sntp_sync_mode_t mode) {
+  syncMode = mode;
+}
+
+// As in the IDF: a slew in progress reports IN_PROGRESS until adjtime()
+// has nothing left to apply
+sntp_sync_status_t sntp_get_sync_status(void) {
+  if (syncStatus == SNTP_SYNC_STATUS_IN_PROGRESS && !hostSlewing()) {
+    syncStatus = SNTP_SYNC_STATUS_COMPLETED;
+  }
+  sntp_sync_status_t status = syncStatus;
+  if (status == SNTP_SYNC_STATUS_COMPLETED) syncStatus = SNTP_SYNC_STATUS_RESET;
+  return status;
+}
+
+void sntp_set_sync_interval(uint32_t intervalMs) {
+  syncIntervalMs = intervalMs < 15000 ? 15000 : intervalMs;
+}
+
+bool sntp_restart(void) {
+  if (!sntpRunning) return false;
+  scheduleSync(SNTP_FIRST_SYNC_MS);
+  return true;
+}
+
+bool sntp_enabled(void) {
+  return sntpRunning;
+}
+
+void sntp_stop(void) {
+  sntpRunning = false;
+}
+
+void sntp_init(void) {
+  sntpRunning = true;
+  scheduleSync(SNTP_FIRST_SYNC_MS);
+}
+
+// ====================================================================
+// MQTT
+// ====================================================================
+
+struct esp_mqtt_client {
+  int nextMsgId;
+  bool started;
+};
+
+esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t* config) {
+  if (!config || !config->broker.address.uri) return nullptr;
+  return new esp_mqtt_client{ 1, false };
+}
+
+esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client, esp_mqtt_event_id_t,
+                                         esp_event_handler_t, void*) {
+  return client ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t client) {
+  if (!client) return ESP_FAIL;
+  client->started = true;
+  return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_stop(esp_mqtt_client_handle_t client) {
+  if (!client || !client->started) return ESP_FAIL;
+  client->started = false;
+  return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_destroy(esp_mqtt_client_handle_t client) {
+  delete client;
+  return ESP_OK;
+}
+
+// Needs a connection, which never comes
+int esp_mqtt_client_subscribe(esp_mqtt_client_handle_t, const char*, int) {
+  return -1;
+}
+
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t, const char*, const char*, int, int, int) {
+  return -1;
+}
+
+// The outbox takes it; without a broker it is never acknowledged
+int esp_mqtt_client_enqueue(esp_mqtt_client_handle_t client, const char*, const char*,
+                            int, int qos, int, bool) {
+  if (!client) return -1;
+  return qos > 0 ? client->nextMsgId++ : 0;
+}
@@ -0,0 +1,39 @@
+#ifndef HOST_ESP_SNTP_H
+#define HOST_ESP_SNTP_H
+
+#include <sys/time.h>
+#include <stdint.h>
+
+// =================================================================
+//                  HOST SHIM: SNTP
+// =================================================================
+// The IDF SNTP client against a server that answers with the time given
+// to hostSetNetworkTime(), advanced with virtual time. A sync needs the
+// station up; the first one follows about half a second after
+// configTime() or sntp_restart(), the rest come at the sync interval.
+// Smooth mode slews through adjtime() and steps when the error is too
+// large for it, as the IDF does.
+
+typedef void (*sntp_sync_time_cb_t)(struct timeval* tv);
+
+typedef enum {
+    SNTP_SYNC_MODE_IMMED,
+    SNTP_SYNC_MODE_SMOOTH
+} sntp_sync_mode_t;
+
+typedef enum {
+    SNTP_SYNC_STATUS_RESET,
+    SNTP_SYNC_STATUS_COMPLETED,
+    SNTP_SYNC_STATUS_IN_PROGRESS
+} sntp_sync_status_t;
+
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback);
+void sntp_set_sync_mode(sntp_sync_mode_t mode);
+sntp_sync_status_t sntp_get_sync_status(void);
+void sntp_set_sync_interval(uint32_t intervalMs);
+bool sntp_restart(void);
+bool sntp_enabled(void);
+void sntp_stop(void);
+void sntp_init(void);
+
+#endif // HOST_ESP_SNTP_H
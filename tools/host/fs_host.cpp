@@ -0,0 +1,297 @@
+#include "FS.h"
+#include "SPIFFS.h"
+#include "host_sim.h"
+#include <dirent.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+SPIFFSFS SPIFFS;
+
+#define SPIFFS_PATH_MAX 31
+#define SPIFFS_PAGE_BYTES 256
+
+namespace fs {
+
+struct FileImpl {
+  FS* owner = nullptr;
+  FILE* fp = nullptr;
+  std::string path;                  // Filesystem path, "/a/b.txt"
+  std::string name;                  // Last component
+  bool directory = false;
+  bool writable = false;
+  bool open = false;
+  std::vector<std::string> entries;  // Directory: every file below it
+  size_t nextEntry = 0;
+
+  ~FileImpl() { close(); }
+
+  void close() {
+    if (!open) return;
+    open = false;
+    if (!fp) return;
+    fclose(fp);
+    fp = nullptr;
+    if (writable) {
+      // Stamp the file with the firmware's clock, which getLastWrite() reads
+      struct timespec stamp[2];
+      stamp[0].tv_sec = stamp[1].tv_sec = time(nullptr);
+      stamp[0].tv_nsec = stamp[1].tv_nsec = 0;
+      utimensat(AT_FDCWD, owner->hostPath(path.c_str()).c_str(), stamp, 0);
+      owner->changed();
+    }
+  }
+};
+
+static void listFiles(const std::string& hostDir, const std::string& fsDir, std::vector<std::string>& out) {
+  DIR* dir = opendir(hostDir.c_str());
+  if (!dir) return;
+  while (struct dirent* entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name == "." || name == "..") continue;
+    std::string hostChild = hostDir + "/" + name;
+    std::string fsChild = (fsDir == "/" ? "" : fsDir) + "/" + name;
+    struct stat info;
+    if (stat(hostChild.c_str(), &info) != 0) continue;
+    if (S_ISDIR(info.st_mode)) {
+      listFiles(hostChild, fsChild, out);
+    } else if (S_ISREG(info.st_mode)) {
+      out.push_back(fsChild);
+    }
+  }
+  closedir(dir);
+}
+
+static bool makeParents(const std::string& hostFile) {
+  for (size_t slash = hostFile.find('/', 1); slash != std::string::npos; slash = hostFile.find('/', slash + 1)) {
+    std::string dir = hostFile.substr(0, slash);
+    if (::mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) return false;
+  }
+  return true;
+}
+
+// Drop directories left empty by a remove or rename, up to the root
+static void pruneParents(const std::string& root, std::string hostFile) {
+  for (size_t slash = hostFile.rfind('/'); slash != std::string::npos && slash > root.size();
+       slash = hostFile.rfind('/')) {
+    hostFile.resize(slash);
+    if (::rmdir(hostFile.c_str()) != 0) break;
+  }
+}
+
+std::string FS::hostPath(const char* path) const {
+  if (root.empty() || !path || path[0] != '/' || strlen(path) > SPIFFS_PATH_MAX) return "";
+  std::string p = path;
+  if (p.find("/../") != std::string::npos || (p.size() >= 3 && p.compare(p.size() - 3, 3, "/..") == 0)) return "";
+  return root + p;
+}
+
+size_t FS::walkUsedBytes() const {
+  if (usedCache != (size_t)-1) return usedCache;
+  std::vector<std::string> files;
+  listFiles(root, "/", files);
+  size_t used = 0;
+  for (const std::string& file : files) {
+    struct stat info;
+    if (stat((root + file).c_str(), &info) == 0) {
+      used += ((size_t)info.st_size + SPIFFS_PAGE_BYTES - 1) / SPIFFS_PAGE_BYTES * SPIFFS_PAGE_BYTES;
+    }
+  }
+  const_cast<FS*>(this)->usedCache = used;
+  return used;
+}
+
+File FS::open(const char* path, const char* mode, bool) {
+  std::string host = hostPath(path);
+  if (host.empty()) return File();
+
+  auto impl = std::make_shared<FileImpl>();
+  impl->owner = this;
+  impl->path = path;
+  impl->name = impl->path.substr(impl->path.rfind('/') + 1);
+
+  struct stat info;
+  bool found = stat(host.c_str(), &info) == 0;
+  if (found && S_ISDIR(info.st_mode)) {
+    if (strcmp(mode, FILE_READ) != 0) return File();
+    impl->directory = true;
+    impl->open = true;
+    listFiles(host, impl->path, impl->entries);
+    return File(impl);
+  }
+
+  bool reading = strcmp(mode, FILE_READ) == 0;
+  if (reading && !found) return File();
+  if (!reading && !makeParents(host)) return File();
+  impl->fp = fopen(host.c_str(), reading ? "rb" : (mode[0] == 'a' ? "ab" : "wb"));
+  if (!impl->fp) return File();
+  impl->writable = !reading;
+  impl->open = true;
+  if (impl->writable) changed();
+  return File(impl);
+}
+
+bool FS::exists(const char* path) {
+  std::string host = hostPath(path);
+  struct stat info;
+  return !host.empty() && stat(host.c_str(), &info) == 0 && S_ISREG(info.st_mode);
+}
+
+bool FS::remove(const char* path) {
+  std::string host = hostPath(path);
+  if (host.empty() || unlink(host.c_str()) != 0) return false;
+  pruneParents(root, host);
+  changed();
+  return true;
+}
+
+bool FS::rename(const char* from, const char* to) {
+  std::string hostFrom = hostPath(from);
+  std::string hostTo = hostPath(to);
+  if (hostFrom.empty() || hostTo.empty() || !exists(from) || !makeParents(hostTo)) return false;
+  if (::rename(hostFrom.c_str(), hostTo.c_str()) != 0) return false;
+  pruneParents(root, hostFrom);
+  changed();
+  return true;
+}
+
+// ---- File ----
+
+File::operator bool() const {
+  return impl && impl->open;
+}
+
+size_t File::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+  if (!*this || !impl->writable) return 0;
+  FS* owner = impl->owner;
+  if (owner->walkUsedBytes() + size > owner->capacity) return 0;
+  size_t written = fwrite(buffer, 1, size, impl->fp);
+  owner->usedCache += written;  // Close recounts in whole pages
+  return written;
+}
+
+int File::available() {
+  if (!*this || !impl->fp) return 0;
+  return (int)(size() - position());
+}
+
+int File::read() {
+  if (!*this || !impl->fp) return -1;
+  return fgetc(impl->fp);
+}
+
+int File::peek() {
+  if (!*this || !impl->fp) return -1;
+  int c = fgetc(impl->fp);
+  if (c != EOF) ungetc(c, impl->fp);
+  return c;
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+  if (!*this || !impl->fp) return 0;
+  return fread(buffer, 1, size, impl->fp);
+}
+
+void File::flush() {
+  if (*this && impl->fp) fflush(impl->fp);
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+  if (!*this || !impl->fp) return false;
+  int whence = mode == SeekCur ? SEEK_CUR : (mode == SeekEnd ? SEEK_END : SEEK_SET);
+  return fseek(impl->fp, pos, whence) == 0;
+}
+
+size_t File::position() const {
+  if (!*this || !impl->fp) return 0;
+  long pos = ftell(impl->fp);
+  return pos < 0 ? 0 : (size_t)pos;
+}
+
+size_t File::size() const {
+  if (!*this || !impl->fp) return 0;
+  fflush(impl->fp);
+  struct stat info;
+  return fstat(fileno(impl->fp), &info) == 0 ? (size_t)info.st_size : 0;
+}
+
+void File::close() {
+  if (impl) impl->close();
+}
+
+time_t File::getLastWrite() {
+  if (!*this) return 0;
+  struct stat info;
+  return stat(impl->owner->hostPath(impl->path.c_str()).c_str(), &info) == 0 ? info.st_mtime : 0;
+}
+
+const char* File::path() const {
+  return impl ? impl->path.c_str() : nullptr;
+}
+
+const char* File::name() const {
+  return impl ? impl->name.c_str() : nullptr;
+}
+
+bool File::isDirectory() {
+  return *this && impl->directory;
+}
+
+File File::openNextFile(const char* mode) {
+  if (!isDirectory()) return File();
+  while (impl->nextEntry < impl->entries.size()) {
+    File next = impl->owner->open(impl->entries[impl->nextEntry++].c_str(), mode);
+    if (next) return next;
+  }
+  return File();
+}
+
+void File::rewindDirectory() {
+  if (isDirectory()) impl->nextEntry = 0;
+}
+
+} // namespace fs
+
+// ---- SPIFFS ----
+
+static std::string spiffsDirectory;
+
+bool hostMountSpiffs(const char* directory) {
+  struct stat info;
+  if (stat(directory, &info) != 0 && ::mkdir(directory, 0755) != 0) return false;
+  char resolved[PATH_MAX];
+  if (!realpath(directory, resolved)) return false;
+  spiffsDirectory = resolved;
+  return true;
+}
+
+bool SPIFFSFS::begin(bool, const char*, uint8_t, const char*) {
+  if (spiffsDirectory.empty()) return false;
+  root = spiffsDirectory;
+  capacity = HOST_SPIFFS_BYTES;
+  changed();
+  return true;
+}
+
+bool SPIFFSFS::format() {
+  if (root.empty()) return false;
+  std::vector<std::string> files;
+  fs::listFiles(root, "/", files);
+  for (const std::string& file : files) remove(file.c_str());
+  return true;
+}
+
+size_t SPIFFSFS::totalBytes() {
+  return capacity;
+}
+
+size_t SPIFFSFS::usedBytes() {
+  return root.empty() ? 0 : walkUsedBytes();
+}
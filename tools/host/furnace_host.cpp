@@ -0,0 +1,237 @@
+// Run the whole firmware on a PC: the sketch's own setup() and loop() on
+// the host shims in this directory, on a virtual clock, so a 24 h firing
+// takes seconds. SPIFFS is a directory, NVS a file, the MAX31855 reads the
+// thermal model (furnace_model.h) that the relay pin heats, the TFT is a
+// framebuffer that --png dumps, and the web server answers on a local port
+// while the run goes on.
+//
+// Build from the repository root:
+//
+//   python3 tools/host_build.py -o furnace_host
+//
+// Run:
+//
+//   ./furnace_host --hours 24 --programs tools/host/firing_24h.json --quiet -o run.json --png screen.png
+//   ./furnace_host --hours 2 --realtime --port 8080 --data /tmp/spiffs   # and browse to it
+//
+// A fresh store's Default program comes out all zeros (saveProgram() copies
+// the empty target array over it), so a firing needs --programs.
+//
+// The report has the control figures of the live loop (the same ones as
+// GET /api/debug/control), CPU time per control tick and per loop() pass,
+// heap and stack high-water marks, and the speedup over real time.
+
+#include <Arduino.h>
+#include "host_sim.h"
+#include "furnace_sim.h"
+#include <filesystem>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+void setup();
+void loop();
+
+extern float controlTargetTemp;
+
+struct Options {
+  double hours = 24;
+  unsigned long stepMs = 10;
+  bool realtime = false;
+  uint16_t port = 8080;
+  std::string dataDir;
+  std::string nvsFile;
+  std::string pngFile;
+  std::string programsFile;
+  std::string reportFile;
+  std::string wifiSsid = "FurnaceLab";
+  std::string start = "2026-01-05T00:00";   // UTC, as the NTP server answers
+  uint32_t seed = 1;
+  size_t stackKb = 64;
+  bool quiet = false;
+};
+
+static Options options;
+
+struct LoopFigures {
+  uint32_t passes = 0;
+  uint64_t cpuMicros = 0;
+  uint64_t maxMicros = 0;
+};
+
+static LoopFigures loopFigures;
+static uint64_t runStartedMicros = 0;
+static bool restarted = false;
+
+static void usage() {
+  fprintf(stderr,
+          "usage: furnace_host [--hours H] [--step-ms MS] [--realtime] [--port PORT]\n"
+          "                    [--data DIR] [--nvs FILE] [--programs programs.json]\n"
+          "                    [--start YYYY-MM-DDTHH:MM] [--wifi SSID] [--seed N]\n"
+          "                    [--stack-kb KB] [--png FILE] [--quiet] [-o report.json]\n");
+  exit(2);
+}
+
+static time_t parseStart(const std::string& text) {
+  struct tm start = {};
+  if (sscanf(text.c_str(), "%d-%d-%dT%d:%d", &start.tm_year, &start.tm_mon, &start.tm_mday,
+             &start.tm_hour, &start.tm_min) != 5) {
+    fprintf(stderr, "--start wants YYYY-MM-DDTHH:MM\n");
+    exit(2);
+  }
+  start.tm_year -= 1900;
+  start.tm_mon -= 1;
+  return timegm(&start);
+}
+
+static void parseOptions(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--hours" && hasValue) options.hours = atof(argv[++i]);
+    else if (arg == "--step-ms" && hasValue) options.stepMs = strtoul(argv[++i], nullptr, 10);
+    else if (arg == "--realtime") options.realtime = true;
+    else if (arg == "--port" && hasValue) options.port = (uint16_t)atoi(argv[++i]);
+    else if (arg == "--data" && hasValue) options.dataDir = argv[++i];
+    else if (arg == "--nvs" && hasValue) options.nvsFile = argv[++i];
+    else if (arg == "--programs" && hasValue) options.programsFile = argv[++i];
+    else if (arg == "--start" && hasValue) options.start = argv[++i];
+    else if (arg == "--wifi" && hasValue) options.wifiSsid = argv[++i];
+    else if (arg == "--seed" && hasValue) options.seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    else if (arg == "--stack-kb" && hasValue) options.stackKb = strtoul(argv[++i], nullptr, 10);
+    else if (arg == "--png" && hasValue) options.pngFile = argv[++i];
+    else if (arg == "--quiet") options.quiet = true;
+    else if (arg == "-o" && hasValue) options.reportFile = argv[++i];
+    else usage();
+  }
+  if (options.hours <= 0 || options.stepMs == 0) usage();
+}
+
+// A fresh SPIFFS gets the web UI from data/ when run from the repository
+// root; the station joins the simulated network unless the store already
+// says otherwise
+static void prepareDataDir() {
+  namespace fs = std::filesystem;
+  if (options.dataDir.empty()) {
+    char pattern[] = "/tmp/furnace_spiffs_XXXXXX";
+    if (!mkdtemp(pattern)) {
+      perror("mkdtemp");
+      exit(1);
+    }
+    options.dataDir = pattern;
+    if (fs::is_directory("data")) {
+      fs::copy("data", options.dataDir, fs::copy_options::recursive);
+    }
+  }
+  fs::create_directories(options.dataDir);
+
+  fs::path wifiConfig = fs::path(options.dataDir) / "wifi_config.json";
+  if (!options.wifiSsid.empty() && !fs::exists(wifiConfig)) {
+    FILE* file = fopen(wifiConfig.c_str(), "w");
+    if (file) {
+      fprintf(file, "{\"ssid\":\"%s\",\"password\":\"\",\"use_static_ip\":false}", options.wifiSsid.c_str());
+      fclose(file);
+    }
+  }
+  // Taken by the firmware's legacy-store migration on boot
+  if (!options.programsFile.empty()) {
+    fs::copy_file(options.programsFile, fs::path(options.dataDir) / "programs.json",
+                  fs::copy_options::overwrite_existing);
+  }
+}
+
+static void writeReport() {
+  const ControlBenchmark& bench = getControlBenchmark();
+  const ControlQuality& quality = bench.quality;
+  HostPlantState plant = hostPlantState();
+  HostWebStats web = hostWebStats();
+  double virtualHours = hostMicros() / 3600e6;
+  double wallSeconds = (hostCpuMicros() - runStartedMicros) / 1e6;
+  size_t stackBytes = options.stackKb * 1024;
+
+  FILE* out = stdout;
+  if (!options.reportFile.empty()) {
+    out = fopen(options.reportFile.c_str(), "w");
+    if (!out) {
+      perror(options.reportFile.c_str());
+      return;
+    }
+  }
+  fprintf(out, "{\n");
+  fprintf(out, "  \"virtualHours\": %.3f,\n", virtualHours);
+  fprintf(out, "  \"wallSeconds\": %.3f,\n", wallSeconds);
+  fprintf(out, "  \"speedup\": %.1f,\n", wallSeconds > 0 ? virtualHours * 3600 / wallSeconds : 0);
+  fprintf(out, "  \"restarted\": %s,\n", restarted ? "true" : "false");
+  fprintf(out, "  \"control\": {\"seconds\": %.1f, \"iae\": %.1f, \"meanAbsError\": %.3f, "
+               "\"maxOvershoot\": %.2f, \"maxUndershoot\": %.2f, \"relayCycles\": %u, \"heaterOnSeconds\": %.1f},\n",
+          quality.seconds, quality.absErrorSeconds,
+          quality.seconds > 0 ? quality.absErrorSeconds / quality.seconds : 0.0f,
+          quality.maxOvershoot, quality.maxUndershoot, (unsigned)quality.relayCycles, quality.heaterOnSeconds);
+  fprintf(out, "  \"tick\": {\"count\": %u, \"avgUs\": %.1f, \"maxUs\": %u},\n", bench.ticks,
+          bench.ticks ? (double)bench.tickMicros / bench.ticks : 0.0, bench.maxTickMicros);
+  fprintf(out, "  \"loop\": {\"passes\": %u, \"avgUs\": %.1f, \"maxUs\": %llu},\n", loopFigures.passes,
+          loopFigures.passes ? (double)loopFigures.cpuMicros / loopFigures.passes : 0.0,
+          (unsigned long long)loopFigures.maxMicros);
+  fprintf(out, "  \"memory\": {\"heapPeakBytes\": %zu, \"heapUsedBytes\": %zu, \"heapMinFree\": %u, "
+               "\"loopStackBytes\": %zu, \"loopStackFree\": %u, \"peakRssKb\": %zu},\n",
+          hostHeapPeak(), hostHeapUsed(), ESP.getMinFreeHeap(), stackBytes,
+          (unsigned)uxTaskGetStackHighWaterMark(NULL), hostPeakRssKb());
+  fprintf(out, "  \"plant\": {\"chamberC\": %.2f, \"targetC\": %.2f, \"heaterOnSeconds\": %.1f, \"relayEdges\": %u},\n",
+          plant.chamberC, controlTargetTemp, plant.heaterOnSeconds, plant.relayEdges);
+  fprintf(out, "  \"web\": {\"requests\": %u, \"connections\": %u}\n", web.requests, web.connections);
+  fprintf(out, "}\n");
+  if (out != stdout) fclose(out);
+
+  if (!options.pngFile.empty() && !hostWritePng(options.pngFile.c_str())) {
+    fprintf(stderr, "cannot write %s\n", options.pngFile.c_str());
+  }
+}
+
+// ESP.restart() ends the run; a device would boot again from flash, which
+// a second run on the same --data and --nvs does
+static void onRestart() {
+  restarted = true;
+  writeReport();
+}
+
+static void runFirmware() {
+  setup();
+  uint64_t endMicros = (uint64_t)(options.hours * 3600e6);
+  while (hostMicros() < endMicros) {
+    uint64_t started = hostCpuMicros();
+    loop();
+    uint64_t spent = hostCpuMicros() - started;
+    loopFigures.passes++;
+    loopFigures.cpuMicros += spent;
+    if (spent > loopFigures.maxMicros) loopFigures.maxMicros = spent;
+
+    hostPoll();
+    delay(options.stepMs);
+  }
+  writeReport();
+}
+
+int main(int argc, char** argv) {
+  parseOptions(argc, argv);
+  prepareDataDir();
+
+  hostSetQuiet(options.quiet);
+  hostSetSeed(options.seed);
+  hostSetRealtime(options.realtime);
+  hostSetHttpPort(options.port);
+  hostSetWifiNetwork(options.wifiSsid.c_str());
+  hostSetNetworkTime(parseStart(options.start));
+  if (!options.nvsFile.empty()) hostSetPreferencesFile(options.nvsFile.c_str());
+  if (!hostMountSpiffs(options.dataDir.c_str())) {
+    fprintf(stderr, "cannot use %s as SPIFFS\n", options.dataDir.c_str());
+    return 1;
+  }
+  hostOnRestart(onRestart);
+  fprintf(stderr, "SPIFFS at %s, web server on http://127.0.0.1:%u/\n", options.dataDir.c_str(), options.port);
+
+  runStartedMicros = hostCpuMicros();
+  hostMarkHeapBase();
+  hostRunLoopTask(options.stackKb * 1024, runFirmware);
+  return 0;
+}
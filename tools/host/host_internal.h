@@ -0,0 +1,31 @@
+#ifndef HOST_INTERNAL_H
+#define HOST_INTERNAL_H
+
+#include <Arduino.h>
+
+// Hooks between the shim modules; not for the firmware or the driver
+
+// Wi-Fi station has an IP (wifi_host.cpp)
+bool hostStationUp();
+// Requests come in through the access point, not the station
+bool hostRequestsViaAp();
+
+// Pumps called from hostPoll()
+void hostWifiPoll();
+void hostSntpPoll();
+void hostWebPoll();
+
+// configTime() starts SNTP (esp_host.cpp)
+void hostSntpConfigure(const char* server);
+// adjtime() still has part of a correction to apply (arduino_host.cpp)
+bool hostSlewing();
+
+// A GPIO output changed level (the relay drives the thermal model)
+void hostPinChanged(uint8_t pin, uint8_t level);
+
+// Record the current heap use for the peak and ESP.getMinFreeHeap()
+void hostSampleHeap();
+
+uint32_t hostRandom();
+
+#endif // HOST_INTERNAL_H
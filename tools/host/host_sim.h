@@ -0,0 +1,78 @@
+#ifndef HOST_SIM_H
+#define HOST_SIM_H
+
+#include <Arduino.h>
+
+// =================================================================
+//                  HOST SHIM: SIMULATION CONTROL
+// =================================================================
+// What tools/host/furnace_host.cpp uses to drive the shims: the virtual
+// clock, the pump that stands in for the ESP32's background tasks, and
+// the figures the run report is made of. The firmware never includes this.
+//
+// Virtual time is the host's monotonic clock plus a skip. The driver adds
+// a fixed step after every loop() pass and delay() adds its argument, so
+// the firmware sees its control period elapse while the host spends only
+// the CPU time of one pass on it. CPU time measured with micros() inside a
+// pass stays real.
+
+// ---- Clock ----
+
+uint64_t hostMicros();                    // Virtual microseconds since boot
+void hostSkip(uint64_t micros);           // Move virtual time forward
+void hostSetRealtime(bool realtime);      // delay() sleeps instead of skipping
+uint64_t hostCpuMicros();                 // Host monotonic clock, for CPU time
+
+// Unix time the simulated NTP server answers with at boot; it advances
+// with virtual time
+void hostSetNetworkTime(time_t unixTime);
+
+// ---- Background tasks ----
+
+// Deliver what the Wi-Fi, SNTP and network tasks would have produced
+// since the last call: link events, time syncs, HTTP requests. Call
+// between loop() passes.
+void hostPoll();
+
+// ---- Shim settings ----
+
+void hostSetQuiet(bool quiet);            // Drop Serial output
+void hostSetSeed(uint32_t seed);          // esp_random() and the sensor noise
+bool hostMountSpiffs(const char* directory);
+void hostSetPreferencesFile(const char* path);
+void hostSetWifiNetwork(const char* ssid); // The one network the station can join
+void hostSetHttpPort(uint16_t port);      // Where AsyncWebServer(80) listens
+bool hostWritePng(const char* path);      // Dump the panel framebuffer
+
+// Called by ESP.restart(); the driver reports and exits
+void hostOnRestart(void (*handler)());
+
+// ---- Loop task ----
+
+// Run fn on a thread with a painted stack of the given size, so
+// uxTaskGetStackHighWaterMark() can report what it never touched
+void hostRunLoopTask(size_t stackBytes, void (*fn)());
+
+// ---- Figures ----
+
+// Heap in use by the firmware: allocations since hostMarkHeapBase(),
+// called just before setup()
+void hostMarkHeapBase();
+size_t hostHeapUsed();
+size_t hostHeapPeak();
+size_t hostPeakRssKb();
+
+struct HostPlantState {
+    float chamberC;                       // Model chamber temperature
+    double heaterOnSeconds;
+    uint32_t relayEdges;
+};
+HostPlantState hostPlantState();
+
+struct HostWebStats {
+    uint32_t requests;
+    uint32_t connections;
+};
+HostWebStats hostWebStats();
+
+#endif // HOST_SIM_H
@@ -0,0 +1,53 @@
+#include "Adafruit_MAX31855.h"
+#include "host_sim.h"
+#include "host_internal.h"
+#include "config.h"
+#include "furnace_model.h"
+
+static FurnaceModel plant;
+static bool plantReady = false;
+static bool heaterOn = false;
+static uint64_t plantMicros = 0;        // Virtual time the model has reached
+static double heaterOnSeconds = 0;
+static uint32_t relayEdges = 0;
+
+static void startPlant() {
+  if (plantReady) return;
+  const FurnaceModelParams params = FURNACE_MODEL_DEFAULTS;
+  resetFurnaceModel(plant, params, params.ambientC, hostRandom());
+  plantMicros = hostMicros();
+  plantReady = true;
+}
+
+// Run the model up to now with the relay as it has been since the last step
+static void advancePlant() {
+  startPlant();
+  uint64_t now = hostMicros();
+  float seconds = (now - plantMicros) / 1000000.0f;
+  plantMicros = now;
+  if (seconds <= 0) return;
+  stepFurnaceModel(plant, heaterOn, seconds);
+  if (heaterOn) heaterOnSeconds += seconds;
+}
+
+void hostPinChanged(uint8_t pin, uint8_t level) {
+  if (pin != RELAY_PIN) return;
+  advancePlant();
+  if (level == HIGH && !heaterOn) relayEdges++;
+  heaterOn = level == HIGH;
+}
+
+HostPlantState hostPlantState() {
+  advancePlant();
+  return { plant.tempC, heaterOnSeconds, relayEdges };
+}
+
+bool Adafruit_MAX31855::begin() {
+  startPlant();
+  return true;
+}
+
+double Adafruit_MAX31855::readCelsius() {
+  advancePlant();
+  return readFurnaceModel(plant);
+}
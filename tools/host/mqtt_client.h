@@ -0,0 +1,79 @@
+#ifndef HOST_MQTT_CLIENT_H
+#define HOST_MQTT_CLIENT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// =================================================================
+//                  HOST SHIM: ESP-MQTT
+// =================================================================
+// A client with no broker to reach: it starts, never connects and keeps
+// what is enqueued in its outbox, which is what the firmware sees while
+// the broker is down.
+
+#define ESP_IDF_VERSION_MAJOR 5
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL (-1)
+
+typedef const char* esp_event_base_t;
+typedef void (*esp_event_handler_t)(void* handlerArgs, esp_event_base_t base, int32_t eventId, void* eventData);
+
+typedef struct esp_mqtt_client* esp_mqtt_client_handle_t;
+
+typedef enum {
+    MQTT_EVENT_ANY = -1,
+    MQTT_EVENT_ERROR = 0,
+    MQTT_EVENT_CONNECTED,
+    MQTT_EVENT_DISCONNECTED,
+    MQTT_EVENT_SUBSCRIBED,
+    MQTT_EVENT_UNSUBSCRIBED,
+    MQTT_EVENT_PUBLISHED,
+    MQTT_EVENT_DATA,
+    MQTT_EVENT_BEFORE_CONNECT,
+    MQTT_EVENT_DELETED
+} esp_mqtt_event_id_t;
+
+typedef struct {
+    esp_mqtt_event_id_t event_id;
+    esp_mqtt_client_handle_t client;
+    char* data;
+    int data_len;
+    int total_data_len;
+    int current_data_offset;
+    char* topic;
+    int topic_len;
+    int msg_id;
+} esp_mqtt_event_t;
+typedef esp_mqtt_event_t* esp_mqtt_event_handle_t;
+
+typedef struct {
+    struct { struct { const char* uri; } address; } broker;
+    struct {
+        const char* username;
+        const char* client_id;
+        struct { const char* password; } authentication;
+    } credentials;
+    struct {
+        int keepalive;
+        struct { const char* topic; const char* msg; int msg_len; int qos; int retain; } last_will;
+    } session;
+    struct { int size; int out_size; } buffer;
+    struct { int reconnect_timeout_ms; } network;
+    struct { int out_size_limit; } outbox;
+} esp_mqtt_client_config_t;
+
+esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t* config);
+esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client, esp_mqtt_event_id_t event,
+                                         esp_event_handler_t handler, void* handlerArgs);
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t client);
+esp_err_t esp_mqtt_client_stop(esp_mqtt_client_handle_t client);
+esp_err_t esp_mqtt_client_destroy(esp_mqtt_client_handle_t client);
+int esp_mqtt_client_subscribe(esp_mqtt_client_handle_t client, const char* topic, int qos);
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t client, const char* topic, const char* data,
+                            int length, int qos, int retain);
+int esp_mqtt_client_enqueue(esp_mqtt_client_handle_t client, const char* topic, const char* data,
+                            int length, int qos, int retain, bool store);
+
+#endif // HOST_MQTT_CLIENT_H
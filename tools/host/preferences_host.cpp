@@ -0,0 +1,128 @@
+#include "Preferences.h"
+#include "host_sim.h"
+#include <map>
+
+// NVS keys and namespace names are at most 15 characters
+#define NVS_KEY_NAME_MAX 15
+
+struct StoredValue {
+  char type;
+  std::string bytes;
+};
+
+// Namespace, then key
+static std::map<std::string, std::map<std::string, StoredValue>> store;
+static std::string storeFile;
+
+// One line per value: namespace, key, type and the bytes in hex, tab
+// separated
+static void loadStore() {
+  FILE* fp = fopen(storeFile.c_str(), "r");
+  if (!fp) return;
+  char line[8192];
+  while (fgets(line, sizeof(line), fp)) {
+    char* space = strtok(line, "\t\n");
+    char* key = strtok(nullptr, "\t\n");
+    char* type = strtok(nullptr, "\t\n");
+    char* hex = strtok(nullptr, "\t\n");
+    if (!space || !key || !type) continue;
+    StoredValue value = { type[0], "" };
+    for (size_t i = 0; hex && hex[i] && hex[i + 1]; i += 2) {
+      char pair[3] = { hex[i], hex[i + 1], 0 };
+      value.bytes.push_back((char)strtoul(pair, nullptr, 16));
+    }
+    store[space][key] = value;
+  }
+  fclose(fp);
+}
+
+static void saveStore() {
+  if (storeFile.empty()) return;
+  std::string temp = storeFile + ".tmp";
+  FILE* fp = fopen(temp.c_str(), "w");
+  if (!fp) return;
+  for (const auto& space : store) {
+    for (const auto& entry : space.second) {
+      fprintf(fp, "%s\t%s\t%c\t", space.first.c_str(), entry.first.c_str(), entry.second.type);
+      for (unsigned char c : entry.second.bytes) fprintf(fp, "%02x", c);
+      fputc('\n', fp);
+    }
+  }
+  fclose(fp);
+  rename(temp.c_str(), storeFile.c_str());
+}
+
+void hostSetPreferencesFile(const char* path) {
+  storeFile = path ? path : "";
+  store.clear();
+  if (!storeFile.empty()) loadStore();
+}
+
+bool Preferences::begin(const char* name, bool readOnlyMode, const char*) {
+  if (started || !name || strlen(name) > NVS_KEY_NAME_MAX) return false;
+  space = name;
+  readOnly = readOnlyMode;
+  started = true;
+  return true;
+}
+
+void Preferences::end() {
+  if (!started) return;
+  started = false;
+  if (!readOnly) saveStore();
+}
+
+bool Preferences::clear() {
+  if (!started || readOnly) return false;
+  store[space].clear();
+  return true;
+}
+
+bool Preferences::remove(const char* key) {
+  if (!started || readOnly) return false;
+  return store[space].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+  return started && store[space].count(key) > 0;
+}
+
+size_t Preferences::putValue(const char* key, char type, const void* data, size_t length) {
+  if (!started || readOnly || !key || strlen(key) > NVS_KEY_NAME_MAX) return 0;
+  store[space][key] = { type, std::string((const char*)data, length) };
+  // putString reports the length without the terminator; a zero-length
+  // string still counts as written
+  return type == 'z' && length == 0 ? 1 : length;
+}
+
+const std::string* Preferences::find(const char* key, char type) {
+  if (!started || !key) return nullptr;
+  auto& values = store[space];
+  auto it = values.find(key);
+  if (it == values.end() || it->second.type != type) return nullptr;
+  return &it->second.bytes;
+}
+
+String Preferences::getString(const char* key, const String& fallback) {
+  const std::string* stored = find(key, 'z');
+  return stored ? String(stored->c_str()) : fallback;
+}
+
+size_t Preferences::getString(const char* key, char* value, size_t maxLength) {
+  const std::string* stored = find(key, 'z');
+  if (!stored || stored->size() + 1 > maxLength) return 0;
+  memcpy(value, stored->c_str(), stored->size() + 1);
+  return stored->size() + 1;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+  const std::string* stored = find(key, 'B');
+  return stored ? stored->size() : 0;
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t maxLength) {
+  const std::string* stored = find(key, 'B');
+  if (!stored || stored->size() > maxLength) return 0;
+  memcpy(buffer, stored->data(), stored->size());
+  return stored->size();
+}
@@ -0,0 +1,430 @@
+#include "TFT_eSPI.h"
+#include "XPT2046_Touchscreen.h"
+#include "SPI.h"
+#include "host_sim.h"
+
+SPIClass SPI(VSPI);
+
+static uint16_t panelFramebuffer[HOST_TFT_PANEL_WIDTH * HOST_TFT_PANEL_HEIGHT];
+static TFT_eSPI* panel = nullptr;
+
+// Classic 5x7 GLCD font, ASCII 0x20 to 0x7E, one byte per column with the
+// top row in bit 0. Other characters draw as a blank cell.
+static const uint8_t glcdFont[][5] = {
+  {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00},
+  {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+  {0x36, 0x49, 0x56, 0x20, 0x50}, {0x00, 0x08, 0x07, 0x03, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00},
+  {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x2A, 0x1C, 0x7F, 0x1C, 0x2A}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+  {0x00, 0x80, 0x70, 0x30, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x00, 0x60, 0x60, 0x00},
+  {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+  {0x72, 0x49, 0x49, 0x49, 0x46}, {0x21, 0x41, 0x49, 0x4D, 0x33}, {0x18, 0x14, 0x12, 0x7F, 0x10},
+  {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x31}, {0x41, 0x21, 0x11, 0x09, 0x07},
+  {0x36, 0x49, 0x49, 0x49, 0x36}, {0x46, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x00, 0x14, 0x00, 0x00},
+  {0x00, 0x40, 0x34, 0x00, 0x00}, {0x00, 0x08, 0x14, 0x22, 0x41}, {0x14, 0x14, 0x14, 0x14, 0x14},
+  {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x59, 0x09, 0x06}, {0x3E, 0x41, 0x5D, 0x59, 0x4E},
+  {0x7C, 0x12, 0x11, 0x12, 0x7C}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+  {0x7F, 0x41, 0x41, 0x41, 0x3E}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01},
+  {0x3E, 0x41, 0x41, 0x51, 0x73}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+  {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40},
+  {0x7F, 0x02, 0x1C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+  {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46},
+  {0x26, 0x49, 0x49, 0x49, 0x32}, {0x03, 0x01, 0x7F, 0x01, 0x03}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+  {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F}, {0x63, 0x14, 0x08, 0x14, 0x63},
+  {0x03, 0x04, 0x78, 0x04, 0x03}, {0x61, 0x59, 0x49, 0x4D, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x41},
+  {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x41, 0x7F}, {0x04, 0x02, 0x01, 0x02, 0x04},
+  {0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x03, 0x07, 0x08, 0x00}, {0x20, 0x54, 0x54, 0x78, 0x40},
+  {0x7F, 0x28, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x28}, {0x38, 0x44, 0x44, 0x28, 0x7F},
+  {0x38, 0x54, 0x54, 0x54, 0x18}, {0x00, 0x08, 0x7E, 0x09, 0x02}, {0x18, 0xA4, 0xA4, 0x9C, 0x78},
+  {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x40, 0x3D, 0x00},
+  {0x7F, 0x10, 0x28, 0x44, 0x00}, {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x78, 0x04, 0x78},
+  {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0xFC, 0x18, 0x24, 0x24, 0x18},
+  {0x18, 0x24, 0x24, 0x18, 0xFC}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x24},
+  {0x04, 0x04, 0x3F, 0x44, 0x24}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C},
+  {0x3C, 0x40, 0x30, 0x40, 0x3C}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x4C, 0x90, 0x90, 0x90, 0x7C},
+  {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x77, 0x00, 0x00},
+  {0x00, 0x41, 0x36, 0x08, 0x00}, {0x02, 0x01, 0x02, 0x04, 0x02},
+};
+
+static inline uint16_t swap16(uint16_t value) {
+  return (uint16_t)((value >> 8) | (value << 8));
+}
+
+// ====================================================================
+// PIXEL STORE AND VIEWPORT
+// ====================================================================
+
+TFT_eSPI::TFT_eSPI(int16_t width, int16_t height) {
+  panelWidth = width;
+  panelHeight = height;
+  setStore(nullptr, width, height);
+}
+
+void TFT_eSPI::setStore(uint16_t* store, int32_t width, int32_t height) {
+  pixels = store;
+  fullWidth = width;
+  fullHeight = height;
+  resetViewport();
+}
+
+void TFT_eSPI::init(uint8_t) {
+  panel = this;
+  rotation = 0;
+  setStore(panelFramebuffer, panelWidth, panelHeight);
+  fillScreen(TFT_BLACK);
+}
+
+void TFT_eSPI::setRotation(uint8_t value) {
+  rotation = value & 3;
+  bool landscape = rotation & 1;
+  setStore(pixels, landscape ? panelHeight : panelWidth, landscape ? panelWidth : panelHeight);
+}
+
+void TFT_eSPI::setViewport(int32_t x, int32_t y, int32_t w, int32_t h, bool vpDatum) {
+  xDatum = x;
+  yDatum = y;
+  xWidth = w;
+  yHeight = h;
+  vpX = std::max<int32_t>(x, 0);
+  vpY = std::max<int32_t>(y, 0);
+  vpW = std::min<int32_t>(x + w, fullWidth);
+  vpH = std::min<int32_t>(y + h, fullHeight);
+  if (!vpDatum) {
+    xDatum = 0;
+    yDatum = 0;
+    xWidth = fullWidth;
+    yHeight = fullHeight;
+  }
+}
+
+void TFT_eSPI::resetViewport() {
+  xDatum = yDatum = 0;
+  vpX = vpY = 0;
+  xWidth = vpW = fullWidth;
+  yHeight = vpH = fullHeight;
+}
+
+void TFT_eSPI::storePixel(int32_t x, int32_t y, uint16_t color) {
+  if (!pixels || x < vpX || y < vpY || x >= vpW || y >= vpH) return;
+  if (oneBit) color = color ? TFT_WHITE : TFT_BLACK;
+  pixels[y * fullWidth + x] = storesSwapped ? swap16(color) : color;
+}
+
+uint16_t TFT_eSPI::readPixel(int32_t x, int32_t y) {
+  x += xDatum;
+  y += yDatum;
+  if (!pixels || x < vpX || y < vpY || x >= vpW || y >= vpH) return 0;
+  uint16_t stored = pixels[y * fullWidth + x];
+  return storesSwapped ? swap16(stored) : stored;
+}
+
+// ====================================================================
+// PRIMITIVES
+// ====================================================================
+
+void TFT_eSPI::fillScreen(uint32_t color) {
+  fillRect(0, 0, xWidth, yHeight, color);
+}
+
+void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color) {
+  storePixel(x + xDatum, y + yDatum, (uint16_t)color);
+}
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  if (w <= 0 || h <= 0) return;
+  x += xDatum;
+  y += yDatum;
+  int32_t x0 = std::max(x, vpX), y0 = std::max(y, vpY);
+  int32_t x1 = std::min(x + w, vpW), y1 = std::min(y + h, vpH);
+  for (int32_t row = y0; row < y1; row++) {
+    for (int32_t col = x0; col < x1; col++) storePixel(col, row, (uint16_t)color);
+  }
+}
+
+void TFT_eSPI::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) {
+  fillRect(x, y, w, 1, color);
+}
+
+void TFT_eSPI::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) {
+  fillRect(x, y, 1, h, color);
+}
+
+void TFT_eSPI::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) {
+  int32_t dx = abs(x1 - x0), dy = -abs(y1 - y0);
+  int32_t sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1;
+  int32_t error = dx + dy;
+  for (;;) {
+    drawPixel(x0, y0, color);
+    if (x0 == x1 && y0 == y1) break;
+    int32_t doubled = 2 * error;
+    if (doubled >= dy) { error += dy; x0 += sx; }
+    if (doubled <= dx) { error += dx; y0 += sy; }
+  }
+}
+
+void TFT_eSPI::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y, h, color);
+  drawFastVLine(x + w - 1, y, h, color);
+}
+
+// Quarter-circle outlines (Adafruit GFX); corners is a mask of 1 TL, 2 TR,
+// 4 BR, 8 BL
+static void drawCorners(TFT_eSPI& gfx, int32_t x0, int32_t y0, int32_t r, uint8_t corners, uint32_t color) {
+  int32_t f = 1 - r, ddx = 1, ddy = -2 * r, x = 0, y = r;
+  while (x < y) {
+    if (f >= 0) { y--; ddy += 2; f += ddy; }
+    x++; ddx += 2; f += ddx;
+    if (corners & 4) { gfx.drawPixel(x0 + x, y0 + y, color); gfx.drawPixel(x0 + y, y0 + x, color); }
+    if (corners & 2) { gfx.drawPixel(x0 + x, y0 - y, color); gfx.drawPixel(x0 + y, y0 - x, color); }
+    if (corners & 8) { gfx.drawPixel(x0 - y, y0 + x, color); gfx.drawPixel(x0 - x, y0 + y, color); }
+    if (corners & 1) { gfx.drawPixel(x0 - y, y0 - x, color); gfx.drawPixel(x0 - x, y0 - y, color); }
+  }
+}
+
+// Filled halves: sides 1 right, 2 left; delta stretches them vertically
+static void fillCorners(TFT_eSPI& gfx, int32_t x0, int32_t y0, int32_t r, uint8_t sides, int32_t delta, uint32_t color) {
+  int32_t f = 1 - r, ddx = 1, ddy = -2 * r, x = 0, y = r;
+  while (x < y) {
+    if (f >= 0) { y--; ddy += 2; f += ddy; }
+    x++; ddx += 2; f += ddx;
+    if (sides & 1) {
+      gfx.drawFastVLine(x0 + x, y0 - y, 2 * y + 1 + delta, color);
+      gfx.drawFastVLine(x0 + y, y0 - x, 2 * x + 1 + delta, color);
+    }
+    if (sides & 2) {
+      gfx.drawFastVLine(x0 - x, y0 - y, 2 * y + 1 + delta, color);
+      gfx.drawFastVLine(x0 - y, y0 - x, 2 * x + 1 + delta, color);
+    }
+  }
+}
+
+void TFT_eSPI::drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color) {
+  r = std::min(r, std::min(w, h) / 2);
+  drawFastHLine(x + r, y, w - 2 * r, color);
+  drawFastHLine(x + r, y + h - 1, w - 2 * r, color);
+  drawFastVLine(x, y + r, h - 2 * r, color);
+  drawFastVLine(x + w - 1, y + r, h - 2 * r, color);
+  drawCorners(*this, x + r, y + r, r, 1, color);
+  drawCorners(*this, x + w - r - 1, y + r, r, 2, color);
+  drawCorners(*this, x + w - r - 1, y + h - r - 1, r, 4, color);
+  drawCorners(*this, x + r, y + h - r - 1, r, 8, color);
+}
+
+void TFT_eSPI::fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color) {
+  r = std::min(r, std::min(w, h) / 2);
+  fillRect(x + r, y, w - 2 * r, h, color);
+  fillCorners(*this, x + w - r - 1, y + r, r, 1, h - 2 * r - 1, color);
+  fillCorners(*this, x + r, y + r, r, 2, h - 2 * r - 1, color);
+}
+
+void TFT_eSPI::drawCircle(int32_t x, int32_t y, int32_t r, uint32_t color) {
+  drawPixel(x, y + r, color);
+  drawPixel(x, y - r, color);
+  drawPixel(x + r, y, color);
+  drawPixel(x - r, y, color);
+  drawCorners(*this, x, y, r, 15, color);
+}
+
+void TFT_eSPI::fillCircle(int32_t x, int32_t y, int32_t r, uint32_t color) {
+  drawFastVLine(x, y - r, 2 * r + 1, color);
+  fillCorners(*this, x, y, r, 3, 0, color);
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data) {
+  for (int32_t row = 0; row < h; row++) {
+    for (int32_t col = 0; col < w; col++) {
+      uint16_t value = data[row * w + col];
+      storePixel(x + xDatum + col, y + yDatum + row, swapBytes ? value : swap16(value));
+    }
+  }
+}
+
+// ====================================================================
+// TEXT
+// ====================================================================
+
+void TFT_eSPI::setTextColor(uint16_t color) {
+  // Same colours mean a transparent background
+  textColor = textBackground = color;
+}
+
+void TFT_eSPI::setTextColor(uint16_t color, uint16_t background, bool) {
+  textColor = color;
+  textBackground = background;
+}
+
+int16_t TFT_eSPI::textWidth(const char* text) {
+  return (int16_t)(strlen(text) * 6 * textSize);
+}
+
+void TFT_eSPI::drawChar(int32_t x, int32_t y, uint16_t c, uint32_t color, uint32_t background, uint8_t size) {
+  const uint8_t* glyph = c >= 0x20 && c <= 0x7E ? glcdFont[c - 0x20] : glcdFont[0];
+  bool fillBackground = background != color;
+  for (int col = 0; col < 6; col++) {
+    uint8_t line = col < 5 ? glyph[col] : 0;
+    for (int row = 0; row < 8; row++, line >>= 1) {
+      if (line & 1) {
+        fillRect(x + col * size, y + row * size, size, size, color);
+      } else if (fillBackground) {
+        fillRect(x + col * size, y + row * size, size, size, background);
+      }
+    }
+  }
+}
+
+size_t TFT_eSPI::write(uint8_t c) {
+  int32_t cellWidth = 6 * textSize, cellHeight = 8 * textSize;
+  if (c == '\n') {
+    cursorY += cellHeight;
+    cursorX = 0;
+    return 1;
+  }
+  if (c == '\r') return 1;
+  if (textWrapX && cursorX + cellWidth > xWidth) {
+    cursorY += cellHeight;
+    cursorX = 0;
+  }
+  if (textWrapY && cursorY >= yHeight) cursorY = 0;
+  drawChar(cursorX, cursorY, c, textColor, textBackground, textSize);
+  cursorX += cellWidth;
+  return 1;
+}
+
+// ====================================================================
+// SPRITES
+// ====================================================================
+
+void* TFT_eSprite::createSprite(int16_t width, int16_t height, uint8_t) {
+  if (pixels) return pixels;
+  if (width <= 0 || height <= 0) return nullptr;
+  uint16_t* store = (uint16_t*)calloc((size_t)width * height, sizeof(uint16_t));
+  if (!store) return nullptr;
+  panelWidth = width;
+  panelHeight = height;
+  storesSwapped = colorDepth == 16;
+  oneBit = colorDepth == 1;
+  setStore(store, width, height);
+  return pixels;
+}
+
+void TFT_eSprite::deleteSprite() {
+  free(pixels);
+  setStore(nullptr, 0, 0);
+}
+
+// The sprite's pixels are in panel order whatever the parent's setting
+void TFT_eSprite::pushSprite(int32_t x, int32_t y) {
+  if (!pixels || !parent) return;
+  bool oldSwapBytes = parent->getSwapBytes();
+  parent->setSwapBytes(!storesSwapped);
+  parent->pushImage(x, y, fullWidth, fullHeight, pixels);
+  parent->setSwapBytes(oldSwapBytes);
+}
+
+// ====================================================================
+// PNG DUMP
+// ====================================================================
+// Uncompressed deflate blocks keep the writer short; a 320x240 frame is
+// about 230 KB.
+
+static uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t length) {
+  static uint32_t table[256];
+  if (table[1] == 0) {
+    for (uint32_t n = 0; n < 256; n++) {
+      uint32_t c = n;
+      for (int k = 0; k < 8; k++) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      table[n] = c;
+    }
+  }
+  crc = ~crc;
+  for (size_t i = 0; i < length; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+
+static void putBigEndian32(std::string& out, uint32_t value) {
+  out.push_back((char)(value >> 24));
+  out.push_back((char)(value >> 16));
+  out.push_back((char)(value >> 8));
+  out.push_back((char)value);
+}
+
+static void writeChunk(FILE* fp, const char* type, const std::string& data) {
+  std::string chunk;
+  putBigEndian32(chunk, (uint32_t)data.size());
+  chunk.append(type, 4);
+  chunk += data;
+  uint32_t crc = crc32Update(0, (const uint8_t*)chunk.data() + 4, chunk.size() - 4);
+  putBigEndian32(chunk, crc);
+  fwrite(chunk.data(), 1, chunk.size(), fp);
+}
+
+bool hostWritePng(const char* path) {
+  if (!panel) return false;
+  const uint16_t* source = panel->panelPixels();
+  int32_t width = panel->panelRowWidth(), height = panel->panelRows();
+
+  // Filter byte 0 then RGB888 for each row
+  std::string raw;
+  raw.reserve((size_t)height * (width * 3 + 1));
+  for (int32_t y = 0; y < height; y++) {
+    raw.push_back(0);
+    for (int32_t x = 0; x < width; x++) {
+      uint16_t c = source[y * width + x];
+      raw.push_back((char)(((c >> 11) & 0x1F) * 255 / 31));
+      raw.push_back((char)(((c >> 5) & 0x3F) * 255 / 63));
+      raw.push_back((char)((c & 0x1F) * 255 / 31));
+    }
+  }
+
+  std::string zlib = "\x78\x01";
+  uint32_t a = 1, b = 0;
+  for (size_t offset = 0; offset < raw.size(); offset += 65535) {
+    size_t length = std::min<size_t>(65535, raw.size() - offset);
+    zlib.push_back(offset + length == raw.size() ? 1 : 0);
+    zlib.push_back((char)(length & 0xFF));
+    zlib.push_back((char)(length >> 8));
+    zlib.push_back((char)(~length & 0xFF));
+    zlib.push_back((char)((~length >> 8) & 0xFF));
+    zlib.append(raw, offset, length);
+  }
+  for (unsigned char c : raw) {
+    a = (a + c) % 65521;
+    b = (b + a) % 65521;
+  }
+  putBigEndian32(zlib, (b << 16) | a);
+
+  std::string header;
+  putBigEndian32(header, (uint32_t)width);
+  putBigEndian32(header, (uint32_t)height);
+  header += std::string("\x08\x02\x00\x00\x00", 5);  // 8-bit RGB
+
+  FILE* fp = fopen(path, "wb");
+  if (!fp) return false;
+  fwrite("\x89PNG\r\n\x1a\n", 1, 8, fp);
+  writeChunk(fp, "IHDR", header);
+  writeChunk(fp, "IDAT", zlib);
+  writeChunk(fp, "IEND", "");
+  return fclose(fp) == 0;
+}
+
+// ====================================================================
+// TOUCH
+// ====================================================================
+// Nobody touches the host's panel
+
+bool XPT2046_Touchscreen::begin(SPIClass&) {
+  return true;
+}
+
+bool XPT2046_Touchscreen::touched() {
+  return false;
+}
+
+bool XPT2046_Touchscreen::tirqTouched() {
+  return false;
+}
+
+TS_Point XPT2046_Touchscreen::getPoint() {
+  return TS_Point{ 0, 0, 0 };
+}
@@ -0,0 +1,815 @@
+#include "ESPAsyncWebServer.h"
+#include "host_sim.h"
+#include "host_internal.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+
+// lwIP's MSS and the send window the library fills against
+#define HOST_TCP_MSS 1436
+#define HOST_TCP_WINDOW (4 * HOST_TCP_MSS)
+// The library's multipart item buffer
+#define HOST_UPLOAD_CHUNK 1460
+#define HOST_HEAD_LIMIT 8192
+
+static uint16_t httpPort = 8080;
+static HostWebStats webStats = {};
+
+void hostSetHttpPort(uint16_t port) {
+  httpPort = port;
+}
+
+HostWebStats hostWebStats() {
+  return webStats;
+}
+
+bool ON_AP_FILTER(AsyncWebServerRequest*) {
+  return hostRequestsViaAp();
+}
+
+bool ON_STA_FILTER(AsyncWebServerRequest*) {
+  return !hostRequestsViaAp();
+}
+
+static String urlDecode(const std::string& text) {
+  std::string out;
+  out.reserve(text.size());
+  for (size_t i = 0; i < text.size(); i++) {
+    char c = text[i];
+    if (c == '%' && i + 2 < text.size() && isxdigit((unsigned char)text[i + 1]) &&
+        isxdigit((unsigned char)text[i + 2])) {
+      out += (char)strtol(text.substr(i + 1, 2).c_str(), nullptr, 16);
+      i += 2;
+    } else {
+      out += c == '+' ? ' ' : c;
+    }
+  }
+  return String(out.c_str(), (unsigned int)out.size());
+}
+
+static const char* reasonPhrase(int code) {
+  switch (code) {
+    case 100: return "Continue";
+    case 200: return "OK";
+    case 201: return "Created";
+    case 202: return "Accepted";
+    case 204: return "No Content";
+    case 206: return "Partial Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 304: return "Not Modified";
+    case 307: return "Temporary Redirect";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 408: return "Request Time-out";
+    case 409: return "Conflict";
+    case 411: return "Length Required";
+    case 412: return "Precondition Failed";
+    case 413: return "Request Entity Too Large";
+    case 415: return "Unsupported Media Type";
+    case 416: return "Requested range not satisfiable";
+    case 422: return "Unprocessable Entity";
+    case 429: return "Too Many Requests";
+    case 500: return "Internal Server Error";
+    case 501: return "Not Implemented";
+    case 503: return "Service Unavailable";
+    default:  return "";
+  }
+}
+
+// ====================================================================
+// Responses
+// ====================================================================
+
+AsyncWebServerResponse::AsyncWebServerResponse()
+  : _code(0), _contentLength(0), _sendContentLength(true), _chunked(false), _sentLength(0) {
+  for (const AsyncWebHeader& header : DefaultHeaders::Instance().headers()) {
+    _headers.push_back(header);
+  }
+  addHeader("Connection", "close");
+}
+
+String AsyncWebServerResponse::assembleHead(uint8_t httpVersion) {
+  char line[96];
+  snprintf(line, sizeof(line), "HTTP/1.%d %d %s\r\n", httpVersion, _code, reasonPhrase(_code));
+  String out = line;
+  if (_sendContentLength) {
+    snprintf(line, sizeof(line), "Content-Length: %u\r\n", (unsigned)_contentLength);
+    out += line;
+  }
+  if (_contentType.length()) {
+    out += "Content-Type: ";
+    out += _contentType;
+    out += "\r\n";
+  }
+  for (const AsyncWebHeader& header : _headers) {
+    out += header.name();
+    out += ": ";
+    out += header.value();
+    out += "\r\n";
+  }
+  // 3.x adds these only where the handler has not set them
+  if (httpVersion) {
+    bool rangesSet = false;
+    for (const AsyncWebHeader& header : _headers) {
+      if (header.name().equalsIgnoreCase("Accept-Ranges")) rangesSet = true;
+    }
+    if (!rangesSet) out += "Accept-Ranges: none\r\n";
+    if (_chunked) out += "Transfer-Encoding: chunked\r\n";
+  }
+  out += "\r\n";
+  return out;
+}
+
+AsyncBasicResponse::AsyncBasicResponse(int code, const String& contentType, const String& content)
+  : _content(content) {
+  _code = code;
+  _contentType = contentType;
+  if (_content.length()) {
+    _contentLength = _content.length();
+    if (!_contentType.length()) _contentType = "text/plain";
+  }
+}
+
+size_t AsyncBasicResponse::fillBody(uint8_t* buffer, size_t maxLen) {
+  size_t n = std::min(maxLen, _contentLength - _sentLength);
+  memcpy(buffer, _content.c_str() + _sentLength, n);
+  _sentLength += n;
+  return n;
+}
+
+AsyncProgmemResponse::AsyncProgmemResponse(int code, const String& contentType, const uint8_t* content, size_t length)
+  : _content(content) {
+  _code = code;
+  _contentType = contentType;
+  _contentLength = length;
+}
+
+size_t AsyncProgmemResponse::fillBody(uint8_t* buffer, size_t maxLen) {
+  size_t n = std::min(maxLen, _contentLength - _sentLength);
+  memcpy(buffer, _content + _sentLength, n);
+  _sentLength += n;
+  return n;
+}
+
+AsyncFileResponse::AsyncFileResponse(FS& fs, const String& path, const String& contentType, bool download) {
+  _code = 200;
+  String servedPath = path;
+  if (!download && !fs.exists(path) && fs.exists(path + ".gz")) {
+    servedPath = path + ".gz";
+    addHeader("Content-Encoding", "gzip");
+  }
+  _content = fs.open(servedPath, "r");
+  _contentLength = _content ? _content.size() : 0;
+  if (contentType.length()) _contentType = contentType;
+  else setContentTypeFor(path);
+  setDisposition(path, download);
+}
+
+AsyncFileResponse::AsyncFileResponse(File content, const String& path, const String& contentType, bool download) {
+  _code = 200;
+  if (!download && String(content.name()).endsWith(".gz") && !path.endsWith(".gz")) {
+    addHeader("Content-Encoding", "gzip");
+  }
+  _content = content;
+  _contentLength = _content ? _content.size() : 0;
+  if (contentType.length()) _contentType = contentType;
+  else setContentTypeFor(path);
+  setDisposition(path, download);
+}
+
+AsyncFileResponse::~AsyncFileResponse() {
+  if (_content) _content.close();
+}
+
+void AsyncFileResponse::setContentTypeFor(const String& path) {
+  static const struct { const char* extension; const char* type; } types[] = {
+    { ".html", "text/html" }, { ".htm", "text/html" }, { ".css", "text/css" },
+    { ".json", "application/json" }, { ".js", "application/javascript" },
+    { ".png", "image/png" }, { ".gif", "image/gif" }, { ".jpg", "image/jpeg" },
+    { ".ico", "image/x-icon" }, { ".svg", "image/svg+xml" }, { ".eot", "font/eot" },
+    { ".woff", "font/woff" }, { ".woff2", "font/woff2" }, { ".ttf", "font/ttf" },
+    { ".xml", "text/xml" }, { ".pdf", "application/pdf" }, { ".zip", "application/zip" },
+    { ".gz", "application/x-gzip" },
+  };
+  for (const auto& entry : types) {
+    if (path.endsWith(entry.extension)) {
+      _contentType = entry.type;
+      return;
+    }
+  }
+  _contentType = "text/plain";
+}
+
+void AsyncFileResponse::setDisposition(const String& path, bool download) {
+  String disposition = download ? "attachment; filename=\"" : "inline; filename=\"";
+  disposition += path.substring(path.lastIndexOf('/') + 1);
+  disposition += "\"";
+  addHeader("Content-Disposition", disposition);
+}
+
+size_t AsyncFileResponse::fillBody(uint8_t* buffer, size_t maxLen) {
+  if (_sentLength >= _contentLength) return 0;
+  size_t n = _content.read(buffer, std::min(maxLen, _contentLength - _sentLength));
+  _sentLength += n;
+  return n;
+}
+
+AsyncCallbackResponse::AsyncCallbackResponse(const String& contentType, size_t length, AwsResponseFiller callback)
+  : _callback(callback) {
+  _code = 200;
+  _contentType = contentType;
+  _contentLength = length;
+}
+
+size_t AsyncCallbackResponse::fillBody(uint8_t* buffer, size_t maxLen) {
+  if (_sentLength >= _contentLength) return 0;
+  size_t n = _callback(buffer, std::min(maxLen, _contentLength - _sentLength), _sentLength);
+  if (n == RESPONSE_TRY_AGAIN) return n;
+  _sentLength += n;
+  return n;
+}
+
+AsyncChunkedResponse::AsyncChunkedResponse(const String& contentType, AwsResponseFiller callback)
+  : _callback(callback), _finished(false) {
+  _code = 200;
+  _contentType = contentType;
+  _sendContentLength = false;
+  _chunked = true;
+}
+
+// Each call frames one chunk; the library does the same in place
+size_t AsyncChunkedResponse::fillBody(uint8_t* buffer, size_t maxLen) {
+  const size_t framing = 8 + 2;                   // "ffffff\r\n" and the trailing "\r\n"
+  if (_finished) return 0;
+  if (maxLen <= framing + 5) return RESPONSE_TRY_AGAIN;
+  size_t n = _callback(buffer + 8, maxLen - framing, _sentLength);
+  if (n == RESPONSE_TRY_AGAIN) return n;
+  if (n == 0) {
+    _finished = true;
+    memcpy(buffer, "0\r\n\r\n", 5);
+    return 5;
+  }
+  _sentLength += n;
+  char size[9];
+  int digits = snprintf(size, sizeof(size), "%x\r\n", (unsigned)n);
+  memmove(buffer + digits, buffer + 8, n);
+  memcpy(buffer, size, digits);
+  memcpy(buffer + digits + n, "\r\n", 2);
+  return digits + n + 2;
+}
+
+AsyncResponseStream::AsyncResponseStream(const String& contentType, size_t bufferSize) {
+  _code = 200;
+  _contentType = contentType;
+  _content.reserve(bufferSize);
+}
+
+size_t AsyncResponseStream::write(const uint8_t* data, size_t length) {
+  _content.append((const char*)data, length);
+  _contentLength = _content.size();
+  return length;
+}
+
+size_t AsyncResponseStream::fillBody(uint8_t* buffer, size_t maxLen) {
+  size_t n = std::min(maxLen, _content.size() - _sentLength);
+  memcpy(buffer, _content.data() + _sentLength, n);
+  _sentLength += n;
+  return n;
+}
+
+// ====================================================================
+// Request
+// ====================================================================
+
+AsyncWebServerRequest::AsyncWebServerRequest(AsyncWebServer* server)
+  : _tempObject(nullptr), _server(server), _handler(nullptr), _response(nullptr),
+    _method(HTTP_ANY), _version(0), _contentLength(0), _isMultipart(false), _isPlainPost(false) {}
+
+AsyncWebServerRequest::~AsyncWebServerRequest() {
+  for (AsyncWebHeader* header : _headers) delete header;
+  for (AsyncWebParameter* param : _params) delete param;
+  delete _response;
+  if (_tempObject) free(_tempObject);
+  if (_tempFile) _tempFile.close();
+}
+
+const char* AsyncWebServerRequest::methodToString() const {
+  switch (_method) {
+    case HTTP_GET: return "GET";
+    case HTTP_POST: return "POST";
+    case HTTP_DELETE: return "DELETE";
+    case HTTP_PUT: return "PUT";
+    case HTTP_PATCH: return "PATCH";
+    case HTTP_HEAD: return "HEAD";
+    case HTTP_OPTIONS: return "OPTIONS";
+    default: return "UNKNOWN";
+  }
+}
+
+// The library starts sending at once and overwrites an earlier response;
+// here the first one stands and later ones are dropped
+void AsyncWebServerRequest::send(AsyncWebServerResponse* response) {
+  if (!response) return;
+  if (_response) {
+    delete response;
+    return;
+  }
+  if (!response->sourceValid()) {
+    delete response;
+    response = new AsyncBasicResponse(500);
+  }
+  _response = response;
+}
+
+void AsyncWebServerRequest::send(int code, const String& contentType, const String& content) {
+  send(beginResponse(code, contentType, content));
+}
+
+void AsyncWebServerRequest::send(FS& fs, const String& path, const String& contentType, bool download,
+                                 AwsTemplateProcessor callback) {
+  if (fs.exists(path) || (!download && fs.exists(path + ".gz"))) {
+    send(beginResponse(fs, path, contentType, download, callback));
+  } else {
+    send(404);
+  }
+}
+
+void AsyncWebServerRequest::send(const String& contentType, size_t length, AwsResponseFiller callback,
+                                 AwsTemplateProcessor templateCallback) {
+  send(beginResponse(contentType, length, callback, templateCallback));
+}
+
+void AsyncWebServerRequest::redirect(const String& url) {
+  AsyncWebServerResponse* response = beginResponse(302);
+  response->addHeader("Location", url);
+  send(response);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const String& contentType,
+                                                             const String& content) {
+  return new AsyncBasicResponse(code, contentType, content);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(FS& fs, const String& path, const String& contentType,
+                                                             bool download, AwsTemplateProcessor) {
+  return new AsyncFileResponse(fs, path, contentType, download);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(File content, const String& path,
+                                                             const String& contentType, bool download,
+                                                             AwsTemplateProcessor) {
+  return new AsyncFileResponse(content, path, contentType, download);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(const String& contentType, size_t length,
+                                                             AwsResponseFiller callback, AwsTemplateProcessor) {
+  return new AsyncCallbackResponse(contentType, length, callback);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginChunkedResponse(const String& contentType,
+                                                                    AwsResponseFiller callback,
+                                                                    AwsTemplateProcessor) {
+  return new AsyncChunkedResponse(contentType, callback);
+}
+
+AsyncResponseStream* AsyncWebServerRequest::beginResponseStream(const String& contentType, size_t bufferSize) {
+  return new AsyncResponseStream(contentType, bufferSize);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse_P(int code, const String& contentType,
+                                                               const uint8_t* content, size_t length,
+                                                               AwsTemplateProcessor) {
+  return new AsyncProgmemResponse(code, contentType, content, length);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse_P(int code, const String& contentType,
+                                                               const char* content, AwsTemplateProcessor) {
+  return new AsyncProgmemResponse(code, contentType, (const uint8_t*)content, strlen(content));
+}
+
+bool AsyncWebServerRequest::hasParam(const String& name, bool post, bool file) const {
+  return getParam(name, post, file) != nullptr;
+}
+
+AsyncWebParameter* AsyncWebServerRequest::getParam(const String& name, bool post, bool file) const {
+  for (AsyncWebParameter* param : _params) {
+    if (param->name() == name && param->isPost() == post && param->isFile() == file) return param;
+  }
+  return nullptr;
+}
+
+AsyncWebParameter* AsyncWebServerRequest::getParam(size_t index) const {
+  return index < _params.size() ? _params[index] : nullptr;
+}
+
+bool AsyncWebServerRequest::hasHeader(const String& name) const {
+  return getHeader(name) != nullptr;
+}
+
+AsyncWebHeader* AsyncWebServerRequest::getHeader(const String& name) const {
+  for (AsyncWebHeader* header : _headers) {
+    if (header->name().equalsIgnoreCase(name)) return header;
+  }
+  return nullptr;
+}
+
+const String& AsyncWebServerRequest::header(const char* name) const {
+  static const String empty;
+  AsyncWebHeader* found = getHeader(name);
+  return found ? found->value() : empty;
+}
+
+// ====================================================================
+// Handlers and server
+// ====================================================================
+
+bool AsyncCallbackWebHandler::canHandle(AsyncWebServerRequest* request) {
+  if (!_onRequest) return false;
+  if (!(_method & request->method())) return false;
+  const String& url = request->url();
+  if (_uri.length() && _uri.startsWith("/*.")) {
+    if (!url.endsWith(_uri.substring(_uri.lastIndexOf('.')))) return false;
+  } else if (_uri.length() && _uri.endsWith("*")) {
+    if (!url.startsWith(_uri.substring(0, _uri.length() - 1))) return false;
+  } else if (_uri.length() && _uri != url && !url.startsWith(_uri + "/")) {
+    return false;
+  }
+  return true;
+}
+
+void AsyncCallbackWebHandler::handleRequest(AsyncWebServerRequest* request) {
+  if (_onRequest) _onRequest(request);
+  else request->send(500);
+}
+
+void AsyncCallbackWebHandler::handleUpload(AsyncWebServerRequest* request, const String& filename, size_t index,
+                                           uint8_t* data, size_t len, bool final) {
+  if (_onUpload) _onUpload(request, filename, index, data, len, final);
+}
+
+void AsyncCallbackWebHandler::handleBody(AsyncWebServerRequest* request, uint8_t* data, size_t len,
+                                         size_t index, size_t total) {
+  if (_onBody) _onBody(request, data, len, index, total);
+}
+
+AsyncCallbackWebHandler& AsyncWebServer::on(const char* uri, ArRequestHandlerFunction onRequest) {
+  return on(uri, HTTP_ANY, onRequest, nullptr, nullptr);
+}
+
+AsyncCallbackWebHandler& AsyncWebServer::on(const char* uri, WebRequestMethodComposite method,
+                                            ArRequestHandlerFunction onRequest) {
+  return on(uri, method, onRequest, nullptr, nullptr);
+}
+
+AsyncCallbackWebHandler& AsyncWebServer::on(const char* uri, WebRequestMethodComposite method,
+                                            ArRequestHandlerFunction onRequest, ArUploadHandlerFunction onUpload) {
+  return on(uri, method, onRequest, onUpload, nullptr);
+}
+
+AsyncCallbackWebHandler& AsyncWebServer::on(const char* uri, WebRequestMethodComposite method,
+                                            ArRequestHandlerFunction onRequest, ArUploadHandlerFunction onUpload,
+                                            ArBodyHandlerFunction onBody) {
+  AsyncCallbackWebHandler* handler = new AsyncCallbackWebHandler();
+  handler->setUri(uri);
+  handler->setMethod(method);
+  handler->onRequest(onRequest);
+  handler->onUpload(onUpload);
+  handler->onBody(onBody);
+  addHandler(handler);
+  return *handler;
+}
+
+AsyncWebHandler& AsyncWebServer::addHandler(AsyncWebHandler* handler) {
+  _handlers.push_back(handler);
+  return *handler;
+}
+
+AsyncWebHandler* AsyncWebServer::attachHandler(AsyncWebServerRequest* request) {
+  for (AsyncWebHandler* handler : _handlers) {
+    if (handler->filter(request) && handler->canHandle(request)) return handler;
+  }
+  return &_catchAll;
+}
+
+void AsyncWebServer::reset() {
+  for (AsyncWebHandler* handler : _handlers) delete handler;
+  _handlers.clear();
+  _catchAll.onRequest(nullptr);
+  _catchAll.onUpload(nullptr);
+  _catchAll.onBody(nullptr);
+}
+
+AsyncWebServer::~AsyncWebServer() {
+  end();
+  reset();
+}
+
+// ====================================================================
+// Connections
+// ====================================================================
+
+struct HostWebConnection {
+  enum State { READ_HEAD, READ_BODY, HANDLED };
+
+  int fd;
+  AsyncWebServerRequest* request;
+  State state = READ_HEAD;
+  std::string input;                 // Received and not yet parsed
+  std::string form;                  // Url-encoded or multipart body, parsed once complete
+  size_t bodyReceived = 0;
+  std::string outbox;                // Response bytes not yet taken by the socket
+  bool headQueued = false;
+  bool bodyDone = false;
+  bool peerGone = false;
+
+  HostWebConnection(int fd, AsyncWebServer* server) : fd(fd), request(new AsyncWebServerRequest(server)) {}
+  ~HostWebConnection();             // Closes, then the request's onDisconnect
+
+  // One pass of receive, dispatch and send; false once the connection is over
+  bool poll();
+
+private:
+  bool parseHead(const std::string& head);
+  void addHeader(const String& name, const String& value);
+  void addParams(const std::string& query, bool post);
+  void feedBody();
+  void finishBody();
+  void parseMultipart();
+  void fillOutbox();
+};
+
+static AsyncWebServer* activeServer = nullptr;
+static int listenFd = -1;
+static std::vector<HostWebConnection*> connections;
+
+void HostWebConnection::addHeader(const String& name, const String& value) {
+  if (name.equalsIgnoreCase("Host")) {
+    request->_host = value;
+  } else if (name.equalsIgnoreCase("Content-Type")) {
+    int boundary = value.indexOf("boundary=");
+    if (value.startsWith("multipart/") && boundary >= 0) {
+      request->_contentType = value.substring(0, value.indexOf(';'));
+      request->_boundary = value.substring(boundary + 9);
+      request->_boundary.replace("\"", "");
+      request->_isMultipart = true;
+    } else {
+      request->_contentType = value;
+    }
+  } else if (name.equalsIgnoreCase("Content-Length")) {
+    request->_contentLength = (size_t)atol(value.c_str());
+  }
+  request->_headers.push_back(new AsyncWebHeader(name, value));
+}
+
+void HostWebConnection::addParams(const std::string& query, bool post) {
+  size_t start = 0;
+  while (start < query.size()) {
+    size_t end = query.find('&', start);
+    if (end == std::string::npos) end = query.size();
+    std::string pair = query.substr(start, end - start);
+    if (!pair.empty()) {
+      size_t equals = pair.find('=');
+      std::string name = equals == std::string::npos ? pair : pair.substr(0, equals);
+      std::string value = equals == std::string::npos ? std::string() : pair.substr(equals + 1);
+      request->_params.push_back(new AsyncWebParameter(urlDecode(name), urlDecode(value), post));
+    }
+    start = end + 1;
+  }
+}
+
+bool HostWebConnection::parseHead(const std::string& head) {
+  size_t lineEnd = head.find("\r\n");
+  std::string requestLine = head.substr(0, lineEnd);
+  size_t space1 = requestLine.find(' ');
+  size_t space2 = requestLine.rfind(' ');
+  if (space1 == std::string::npos || space2 == space1) return false;
+
+  static const struct { const char* name; WebRequestMethod method; } methods[] = {
+    { "GET", HTTP_GET }, { "POST", HTTP_POST }, { "DELETE", HTTP_DELETE }, { "PUT", HTTP_PUT },
+    { "PATCH", HTTP_PATCH }, { "HEAD", HTTP_HEAD }, { "OPTIONS", HTTP_OPTIONS },
+  };
+  std::string methodName = requestLine.substr(0, space1);
+  request->_method = 0;
+  for (const auto& entry : methods) {
+    if (methodName == entry.name) request->_method = entry.method;
+  }
+  if (!request->_method) return false;
+
+  std::string target = requestLine.substr(space1 + 1, space2 - space1 - 1);
+  size_t question = target.find('?');
+  request->_url = urlDecode(target.substr(0, question));
+  if (question != std::string::npos) addParams(target.substr(question + 1), false);
+  request->_version = requestLine.compare(space2 + 1, std::string::npos, "HTTP/1.0") == 0 ? 0 : 1;
+
+  size_t at = lineEnd + 2;
+  while (at < head.size()) {
+    size_t end = head.find("\r\n", at);
+    if (end == std::string::npos) end = head.size();
+    std::string line = head.substr(at, end - at);
+    size_t colon = line.find(':');
+    if (colon != std::string::npos) {
+      size_t valueAt = line.find_first_not_of(' ', colon + 1);
+      std::string value = valueAt == std::string::npos ? std::string() : line.substr(valueAt);
+      addHeader(String(line.substr(0, colon).c_str()), String(value.c_str()));
+    }
+    at = end + 2;
+  }
+  request->_isPlainPost = !request->_isMultipart &&
+                          request->_contentType.startsWith("application/x-www-form-urlencoded");
+  return true;
+}
+
+// A raw body reaches the handler a segment at a time, as it arrives
+void HostWebConnection::feedBody() {
+  size_t total = request->_contentLength;
+  while (!input.empty() && bodyReceived < total) {
+    size_t n = std::min(std::min(input.size(), (size_t)HOST_TCP_MSS), total - bodyReceived);
+    if (request->_isMultipart || request->_isPlainPost) {
+      form.append(input, 0, n);
+    } else {
+      uint8_t segment[HOST_TCP_MSS];
+      memcpy(segment, input.data(), n);
+      request->_handler->handleBody(request, segment, n, bodyReceived, total);
+    }
+    input.erase(0, n);
+    bodyReceived += n;
+  }
+  if (bodyReceived == total) finishBody();
+}
+
+void HostWebConnection::finishBody() {
+  if (request->_isPlainPost) addParams(form, true);
+  else if (request->_isMultipart) parseMultipart();
+  form.clear();
+  form.shrink_to_fit();
+  state = HANDLED;
+  request->_handler->handleRequest(request);
+}
+
+// Fields become post parameters and files go to the upload handler in
+// the library's item-buffer sized pieces, in the order they came
+void HostWebConnection::parseMultipart() {
+  std::string delimiter = std::string("--") + request->_boundary.c_str();
+  size_t at = form.find(delimiter);
+  while (at != std::string::npos) {
+    at += delimiter.size();
+    if (form.compare(at, 2, "--") == 0) break;
+    at += 2;
+    size_t headEnd = form.find("\r\n\r\n", at);
+    if (headEnd == std::string::npos) break;
+    std::string partHead = form.substr(at, headEnd - at);
+    size_t contentAt = headEnd + 4;
+    size_t next = form.find("\r\n" + delimiter, contentAt);
+    if (next == std::string::npos) break;
+
+    auto attribute = [&](const char* key) {
+      std::string marker = std::string(key) + "=\"";
+      size_t from = partHead.find(marker);
+      if (from == std::string::npos) return std::string();
+      from += marker.size();
+      return partHead.substr(from, partHead.find('"', from) - from);
+    };
+    String name = attribute(" name").c_str();
+    bool isFile = partHead.find("filename=\"") != std::string::npos;
+    size_t size = next - contentAt;
+    if (isFile) {
+      String filename = attribute("filename").c_str();
+      uint8_t chunk[HOST_UPLOAD_CHUNK];
+      size_t index = 0;
+      while (size - index >= HOST_UPLOAD_CHUNK) {
+        memcpy(chunk, form.data() + contentAt + index, HOST_UPLOAD_CHUNK);
+        request->_handler->handleUpload(request, filename, index, chunk, HOST_UPLOAD_CHUNK, false);
+        index += HOST_UPLOAD_CHUNK;
+      }
+      memcpy(chunk, form.data() + contentAt + index, size - index);
+      request->_handler->handleUpload(request, filename, index, chunk, size - index, true);
+      request->_params.push_back(new AsyncWebParameter(name, filename, true, true, size));
+    } else {
+      request->_params.push_back(new AsyncWebParameter(name, String(form.data() + contentAt, (unsigned)size), true));
+    }
+    at = next + 2;
+  }
+}
+
+void HostWebConnection::fillOutbox() {
+  AsyncWebServerResponse* response = request->_response;
+  if (!response || bodyDone) return;
+  if (!headQueued) {
+    String head = response->assembleHead(request->_version);
+    outbox.append(head.c_str(), head.length());
+    headQueued = true;
+  }
+  uint8_t buffer[HOST_TCP_WINDOW];
+  while (!bodyDone && outbox.size() < HOST_TCP_WINDOW) {
+    size_t n = response->fillBody(buffer, HOST_TCP_WINDOW - outbox.size());
+    if (n == RESPONSE_TRY_AGAIN) break;
+    if (n == 0) bodyDone = true;
+    else outbox.append((const char*)buffer, n);
+  }
+}
+
+bool HostWebConnection::poll() {
+  char buffer[4096];
+  while (!peerGone) {
+    ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+    if (n > 0) input.append(buffer, n);
+    else if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) peerGone = true;
+    if (n <= 0 || input.size() > HOST_HEAD_LIMIT) break;
+  }
+
+  if (state == READ_HEAD) {
+    size_t headEnd = input.find("\r\n\r\n");
+    if (headEnd == std::string::npos) {
+      return !peerGone && input.size() <= HOST_HEAD_LIMIT;
+    }
+    if (!parseHead(input.substr(0, headEnd))) return false;
+    input.erase(0, headEnd + 4);
+    webStats.requests++;
+    request->_handler = request->_server->attachHandler(request);
+    state = READ_BODY;
+  }
+  if (state == READ_BODY) {
+    feedBody();
+  } else {
+    input.clear();
+  }
+  if (peerGone && !request->_response) return false;
+
+  fillOutbox();
+  while (!outbox.empty()) {
+    ssize_t n = send(fd, outbox.data(), outbox.size(), MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+      return false;
+    }
+    outbox.erase(0, n);
+  }
+  return !(bodyDone && outbox.empty());
+}
+
+void AsyncWebServer::begin() {
+  if (listenFd >= 0) return;
+  listenFd = socket(AF_INET, SOCK_STREAM, 0);
+  int on = 1;
+  setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(httpPort);
+  if (bind(listenFd, (sockaddr*)&address, sizeof(address)) != 0 || listen(listenFd, 8) != 0) {
+    fprintf(stderr, "host web: cannot listen on 127.0.0.1:%u: %s\n", httpPort, strerror(errno));
+    close(listenFd);
+    listenFd = -1;
+    return;
+  }
+  fcntl(listenFd, F_SETFL, O_NONBLOCK);
+  activeServer = this;
+}
+
+HostWebConnection::~HostWebConnection() {
+  // Drain what the peer still sent so the close is a FIN, not a reset
+  shutdown(fd, SHUT_WR);
+  char sink[1024];
+  while (recv(fd, sink, sizeof(sink), 0) > 0) {}
+  close(fd);
+  if (request->_onDisconnectFn) request->_onDisconnectFn();
+  delete request;
+}
+
+void AsyncWebServer::end() {
+  if (activeServer != this) return;
+  for (HostWebConnection* connection : connections) delete connection;
+  connections.clear();
+  close(listenFd);
+  listenFd = -1;
+  activeServer = nullptr;
+}
+
+void hostWebPoll() {
+  if (listenFd < 0) return;
+  int fd;
+  while ((fd = accept(listenFd, nullptr, nullptr)) >= 0) {
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    connections.push_back(new HostWebConnection(fd, activeServer));
+    webStats.connections++;
+  }
+  for (size_t i = 0; i < connections.size();) {
+    if (connections[i]->poll()) {
+      i++;
+    } else {
+      delete connections[i];
+      connections.erase(connections.begin() + i);
+    }
+  }
+}
@@ -0,0 +1,233 @@
+#include "WiFi.h"
+#include "ESPmDNS.h"
+#include "host_sim.h"
+#include "host_internal.h"
+#include <deque>
+#include <vector>
+
+WiFiClass WiFi;
+MDNSResponder MDNS;
+
+#define HOST_WIFI_ASSOCIATE_MS 1500
+#define HOST_WIFI_NOT_FOUND_MS 3000
+#define HOST_WIFI_SCAN_MS 2000
+#define HOST_WIFI_CHANNEL 6
+#define HOST_WIFI_RSSI (-58)
+
+static const uint8_t accessPointBssid[6] = { 0x02, 0x00, 0x5e, 0x10, 0x20, 0x30 };
+static const uint8_t stationMac[6] = { 0x24, 0xcf, 0xf0, 0xa1, 0xb2, 0xc3 };
+
+static std::string networkSsid;      // The one network in range
+static std::string requestedSsid;
+static wl_status_t stationStatus = WL_IDLE_STATUS;
+static bool associating = false;
+static unsigned long associateAt = 0;
+static bool accessPointUp = false;
+static IPAddress accessPointIp(192, 168, 4, 1);
+
+static int16_t scanState = WIFI_SCAN_FAILED;  // Failed: no scan results kept
+static unsigned long scanDoneAt = 0;
+
+struct PendingEvent {
+  arduino_event_id_t event;
+  arduino_event_info_t info;
+};
+static std::deque<PendingEvent> pendingEvents;
+static std::vector<std::pair<WiFiEventFuncCb, arduino_event_id_t>> eventHandlers;
+
+void hostSetWifiNetwork(const char* ssid) {
+  networkSsid = ssid ? ssid : "";
+}
+
+bool hostStationUp() {
+  return stationStatus == WL_CONNECTED;
+}
+
+// ON_AP_FILTER: with the station down the only way in is the setup AP
+bool hostRequestsViaAp() {
+  return accessPointUp && !hostStationUp();
+}
+
+static void postDisconnected(uint8_t reason) {
+  PendingEvent pending = {};
+  pending.event = ARDUINO_EVENT_WIFI_STA_DISCONNECTED;
+  size_t length = std::min(requestedSsid.size(), (size_t)32);
+  memcpy(pending.info.wifi_sta_disconnected.ssid, requestedSsid.data(), length);
+  pending.info.wifi_sta_disconnected.ssid_len = (uint8_t)length;
+  memcpy(pending.info.wifi_sta_disconnected.bssid, accessPointBssid, 6);
+  pending.info.wifi_sta_disconnected.reason = reason;
+  pendingEvents.push_back(pending);
+}
+
+static void postConnected() {
+  PendingEvent pending = {};
+  pending.event = ARDUINO_EVENT_WIFI_STA_CONNECTED;
+  memcpy(pending.info.wifi_sta_connected.bssid, accessPointBssid, 6);
+  pending.info.wifi_sta_connected.channel = HOST_WIFI_CHANNEL;
+  pendingEvents.push_back(pending);
+  pending.event = ARDUINO_EVENT_WIFI_STA_GOT_IP;
+  pendingEvents.push_back(pending);
+}
+
+void hostWifiPoll() {
+  unsigned long now = millis();
+  if (associating) {
+    bool found = !networkSsid.empty() && requestedSsid == networkSsid;
+    if (found && (long)(now - associateAt) >= 0) {
+      associating = false;
+      stationStatus = WL_CONNECTED;
+      postConnected();
+    } else if (!found && (long)(now - associateAt - (HOST_WIFI_NOT_FOUND_MS - HOST_WIFI_ASSOCIATE_MS)) >= 0) {
+      associating = false;
+      stationStatus = WL_NO_SSID_AVAIL;
+      postDisconnected(WIFI_REASON_NO_AP_FOUND);
+    }
+  }
+
+  if (scanState == WIFI_SCAN_RUNNING && (long)(now - scanDoneAt) >= 0) {
+    scanState = networkSsid.empty() ? 0 : 1;
+  }
+
+  while (!pendingEvents.empty()) {
+    PendingEvent pending = pendingEvents.front();
+    pendingEvents.pop_front();
+    for (auto& handler : eventHandlers) {
+      if (handler.second == ARDUINO_EVENT_WIFI_READY || handler.second == pending.event) {
+        handler.first(pending.event, pending.info);
+      }
+    }
+  }
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char*, int32_t, const uint8_t*, bool connect) {
+  requestedSsid = ssid ? ssid : "";
+  if (!connect) return stationStatus;
+  if (currentMode == WIFI_MODE_NULL || currentMode == WIFI_MODE_AP) {
+    currentMode = currentMode == WIFI_MODE_AP ? WIFI_MODE_APSTA : WIFI_MODE_STA;
+  }
+  stationStatus = WL_DISCONNECTED;
+  associating = true;
+  associateAt = millis() + HOST_WIFI_ASSOCIATE_MS;
+  return stationStatus;
+}
+
+wl_status_t WiFiClass::status() {
+  return stationStatus;
+}
+
+bool WiFiClass::disconnect(bool, bool) {
+  bool wasActive = associating || stationStatus == WL_CONNECTED;
+  associating = false;
+  stationStatus = WL_DISCONNECTED;
+  if (wasActive) postDisconnected(WIFI_REASON_ASSOC_LEAVE);
+  return true;
+}
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+  currentMode = mode;
+  if (mode == WIFI_MODE_NULL || mode == WIFI_MODE_AP) {
+    associating = false;
+    if (stationStatus == WL_CONNECTED) postDisconnected(WIFI_REASON_ASSOC_LEAVE);
+    stationStatus = WL_IDLE_STATUS;
+  }
+  if (mode != WIFI_MODE_AP && mode != WIFI_MODE_APSTA) accessPointUp = false;
+  return true;
+}
+
+bool WiFiClass::config(IPAddress, IPAddress, IPAddress, IPAddress, IPAddress) {
+  return true;
+}
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventFuncCb callback, arduino_event_id_t event) {
+  eventHandlers.push_back({ callback, event });
+  return eventHandlers.size();
+}
+
+IPAddress WiFiClass::localIP() {
+  return hostStationUp() ? IPAddress(127, 0, 0, 1) : IPAddress();
+}
+
+String WiFiClass::SSID() {
+  return hostStationUp() ? String(requestedSsid.c_str()) : String();
+}
+
+int32_t WiFiClass::RSSI() {
+  return hostStationUp() ? HOST_WIFI_RSSI : 0;
+}
+
+String WiFiClass::macAddress() {
+  char text[18];
+  snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X",
+           stationMac[0], stationMac[1], stationMac[2], stationMac[3], stationMac[4], stationMac[5]);
+  return String(text);
+}
+
+uint8_t* WiFiClass::BSSID() {
+  static uint8_t bssid[6];
+  if (!hostStationUp()) return nullptr;
+  memcpy(bssid, accessPointBssid, sizeof(bssid));
+  return bssid;
+}
+
+String WiFiClass::BSSIDstr() {
+  uint8_t* bssid = BSSID();
+  if (!bssid) return String();
+  char text[18];
+  snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X",
+           bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5]);
+  return String(text);
+}
+
+int32_t WiFiClass::channel() {
+  return hostStationUp() ? HOST_WIFI_CHANNEL : 0;
+}
+
+bool WiFiClass::softAP(const char*, const char*, int, int, int) {
+  accessPointUp = true;
+  currentMode = stationStatus == WL_IDLE_STATUS && !associating ? WIFI_MODE_AP : WIFI_MODE_APSTA;
+  return true;
+}
+
+bool WiFiClass::softAPConfig(IPAddress localIp, IPAddress, IPAddress) {
+  accessPointIp = localIp;
+  return true;
+}
+
+bool WiFiClass::softAPdisconnect(bool) {
+  accessPointUp = false;
+  if (currentMode == WIFI_MODE_APSTA) currentMode = WIFI_MODE_STA;
+  return true;
+}
+
+IPAddress WiFiClass::softAPIP() {
+  return accessPointUp ? accessPointIp : IPAddress();
+}
+
+int16_t WiFiClass::scanNetworks(bool async, bool) {
+  scanState = WIFI_SCAN_RUNNING;
+  scanDoneAt = millis() + HOST_WIFI_SCAN_MS;
+  if (async) return WIFI_SCAN_RUNNING;
+  delay(HOST_WIFI_SCAN_MS);
+  hostWifiPoll();
+  return scanState;
+}
+
+int16_t WiFiClass::scanComplete() {
+  return scanState;
+}
+
+void WiFiClass::scanDelete() {
+  if (scanState != WIFI_SCAN_RUNNING) scanState = WIFI_SCAN_FAILED;
+}
+
+String WiFiClass::SSID(uint8_t index) {
+  return scanState > index ? String(networkSsid.c_str()) : String();
+}
+
+int32_t WiFiClass::RSSI(uint8_t index) {
+  return scanState > index ? HOST_WIFI_RSSI : 0;
+}
+
+wifi_auth_mode_t WiFiClass::encryptionType(uint8_t index) {
+  return scanState > index ? WIFI_AUTH_WPA2_PSK : WIFI_AUTH_OPEN;
+}
@@ -0,0 +1,197 @@
+// Run the control benchmark suite (benchmark_engine.h) on a PC: the real
+// driveFurnace() and PID against the thermal model, on the virtual clock,
+// without a controller. Writes the same JSON report as
+// GET /api/debug/benchmark, so tools/benchmark_compare.py compares the two
+// kinds interchangeably.
+//
+// Build from the repository root:
+//
+//   g++ -std=c++17 -O2 -Wall -I. -o host_benchmark tools/host_benchmark.cpp benchmark_engine.cpp furnace_control.cpp furnace_model.cpp
+//
+// Run:
+//
+//   ./host_benchmark -o before.json
+//   ./host_benchmark --profiles step glaze --seed 3 --model deadTimeSeconds=40 --set pidEnabled=1 pidKp=4 -o after.json
+//   python3 tools/benchmark_compare.py compare before.json after.json
+//
+// --set takes the controller settings the benchmark report lists; the
+// defaults are the firmware's.
+
+#include "benchmark_engine.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+// The sketch's control globals, at their firmware defaults
+float currentTemp = 0.0;
+bool furnaceStatus = false;
+bool pwmEnabled = true;
+unsigned long pwmCycleStart = 0;
+unsigned long pwmPeriodMs = 10000;
+unsigned long pwmOnTimeMs = 0;
+bool pwmRelayState = false;
+bool pidEnabled = false;
+float pidKp = 2.0;
+float pidKi = 0.1;
+float pidKd = 0.05;
+float pidSampleTime = 1.0;
+int pidOutputMin = 0;
+int pidOutputMax = 100;
+float pidSetpointWindow = 2.0;
+float pidIntegral = 0.0;
+float pidLastError = 0.0;
+unsigned long pidLastTime = 0;
+
+void setRelay(bool on) {
+  furnaceStatus = on;
+}
+
+uint32_t benchmarkMicros() {
+  using namespace std::chrono;
+  return (uint32_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static uint32_t wallMillis() {
+  return benchmarkMicros() / 1000;
+}
+
+static void usage() {
+  fprintf(stderr,
+          "usage: host_benchmark [--profiles NAME...] [--seed N] [--model KEY=VALUE...]\n"
+          "                      [--set KEY=VALUE...] [-o REPORT]\n");
+  exit(2);
+}
+
+static bool setModelParam(FurnaceModelParams& params, const std::string& key, float value) {
+  if (key == "heaterWatts") params.heaterWatts = value;
+  else if (key == "heatCapacity") params.heatCapacity = value;
+  else if (key == "lossWattsPerKelvin") params.lossWattsPerKelvin = value;
+  else if (key == "ambientC") params.ambientC = value;
+  else if (key == "deadTimeSeconds") params.deadTimeSeconds = value;
+  else if (key == "noiseC") params.noiseC = value;
+  else return false;
+  return true;
+}
+
+static bool setControlSetting(const std::string& key, float value) {
+  if (key == "pidEnabled") pidEnabled = value != 0;
+  else if (key == "pidKp") pidKp = value;
+  else if (key == "pidKi") pidKi = value;
+  else if (key == "pidKd") pidKd = value;
+  else if (key == "pidSampleTime") pidSampleTime = value;
+  else if (key == "pidSetpointWindow") pidSetpointWindow = value;
+  else if (key == "pwmEnabled") pwmEnabled = value != 0;
+  else if (key == "pwmPeriodMs") pwmPeriodMs = (unsigned long)value;
+  else return false;
+  return true;
+}
+
+// Split KEY=VALUE; false if it is not one
+static bool splitPair(const char* text, std::string& key, float& value) {
+  const char* equals = strchr(text, '=');
+  if (equals == NULL || equals[1] == '\0') return false;
+  key.assign(text, equals - text);
+  char* end;
+  value = strtof(equals + 1, &end);
+  return *end == '\0';
+}
+
+int main(int argc, char** argv) {
+  FurnaceModelParams params = FURNACE_MODEL_DEFAULTS;
+  uint32_t seed = 1;
+  unsigned profiles = 0;
+  const char* outputPath = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if (strcmp(arg, "--profiles") == 0 || strcmp(arg, "--model") == 0 || strcmp(arg, "--set") == 0) {
+      if (i + 1 >= argc || argv[i + 1][0] == '-') usage();
+      while (i + 1 < argc && argv[i + 1][0] != '-') {
+        const char* value = argv[++i];
+        std::string key;
+        float number;
+        if (strcmp(arg, "--profiles") == 0) {
+          int index = findBenchmarkProfile(value);
+          if (index < 0) {
+            fprintf(stderr, "host_benchmark: unknown profile %s\n", value);
+            return 2;
+          }
+          profiles |= 1u << index;
+        } else if (!splitPair(value, key, number) ||
+                   !(strcmp(arg, "--model") == 0 ? setModelParam(params, key, number) : setControlSetting(key, number))) {
+          fprintf(stderr, "host_benchmark: bad %s %s\n", arg, value);
+          return 2;
+        }
+      }
+    } else if (strcmp(arg, "--seed") == 0 && i + 1 < argc) {
+      seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else if (strcmp(arg, "-o") == 0 && i + 1 < argc) {
+      outputPath = argv[++i];
+    } else {
+      usage();
+    }
+  }
+  if (profiles == 0) profiles = (1u << BENCHMARK_PROFILE_COUNT) - 1;
+  if (params.heaterWatts <= 0 || params.heatCapacity <= 0 || params.lossWattsPerKelvin < 0 ||
+      params.noiseC < 0 || params.deadTimeSeconds < 0 || params.deadTimeSeconds > FURNACE_MODEL_DELAY_SLOTS - 1) {
+    fprintf(stderr, "host_benchmark: model parameter out of range\n");
+    return 2;
+  }
+
+  FILE* out = outputPath ? fopen(outputPath, "w") : stdout;
+  if (out == NULL) {
+    perror(outputPath);
+    return 1;
+  }
+
+  fprintf(out, "{\n  \"state\": \"done\",\n  \"host\": true,\n");
+  fprintf(out, "  \"tickMs\": %d,\n  \"settleBand\": %g,\n  \"seed\": %u,\n",
+          BENCHMARK_TICK_MS, BENCHMARK_SETTLE_BAND, (unsigned)seed);
+  fprintf(out, "  \"settings\": {\"pidEnabled\": %s, \"pidKp\": %g, \"pidKi\": %g, \"pidKd\": %g, "
+               "\"pidSampleTime\": %g, \"pidSetpointWindow\": %g, \"pwmEnabled\": %s, \"pwmPeriodMs\": %lu},\n",
+          pidEnabled ? "true" : "false", pidKp, pidKi, pidKd, pidSampleTime, pidSetpointWindow,
+          pwmEnabled ? "true" : "false", pwmPeriodMs);
+  fprintf(out, "  \"model\": {\"heaterWatts\": %g, \"heatCapacity\": %g, \"lossWattsPerKelvin\": %g, "
+               "\"ambientC\": %g, \"deadTimeSeconds\": %g, \"noiseC\": %g},\n",
+          params.heaterWatts, params.heatCapacity, params.lossWattsPerKelvin, params.ambientC,
+          params.deadTimeSeconds, params.noiseC);
+  fprintf(out, "  \"runs\": [");
+
+  bool first = true;
+  for (int index = 0; index < BENCHMARK_PROFILE_COUNT; index++) {
+    if (!(profiles & (1u << index))) continue;
+
+    // Each profile starts on a cold controller, like on the device
+    static BenchmarkRun run;
+    beginBenchmarkRun(run, index, params, seed);
+    loadControlState(run.control);
+    BenchmarkResult result = BenchmarkResult();
+    uint32_t started = wallMillis();
+    while (runBenchmarkTick(run, result)) {
+    }
+    result.wallMillis = wallMillis() - started;
+
+    const ControlQuality& quality = result.quality;
+    double energyKWh = quality.heaterOnSeconds * params.heaterWatts / 3600000.0;
+    fprintf(out, "%s\n    {\"profile\": \"%s\", \"seconds\": %.1f, \"iae\": %.1f, \"meanAbsError\": %.4f, "
+                 "\"maxOvershoot\": %.2f, \"maxUndershoot\": %.2f, \"settlingSeconds\": %.1f, \"unsettledHolds\": %u, "
+                 "\"relayCycles\": %u, \"heaterOnSeconds\": %.1f, \"energyKWh\": %.4f, \"controlUsPerTick\": %.3f, "
+                 "\"wallMs\": %u}",
+            first ? "" : ",", benchmarkProfiles[index].name, quality.seconds, quality.absErrorSeconds,
+            quality.seconds > 0 ? quality.absErrorSeconds / quality.seconds : 0, quality.maxOvershoot,
+            quality.maxUndershoot, result.settlingSeconds, result.unsettledHolds, quality.relayCycles,
+            quality.heaterOnSeconds, energyKWh,
+            result.ticks > 0 ? (double)result.controlMicros / result.ticks : 0, result.wallMillis);
+    first = false;
+
+    fprintf(stderr, "      %-9s IAE %.0f, overshoot %.1f C, %u relay cycles, %.2f kWh\n",
+            benchmarkProfiles[index].name, quality.absErrorSeconds, quality.maxOvershoot,
+            quality.relayCycles, energyKWh);
+  }
+
+  fprintf(out, "\n  ]\n}\n");
+  if (out != stdout) fclose(out);
+  return 0;
+}
@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""
+Build the firmware as a host program (tools/host/furnace_host.cpp).
+
+Compiles the sketch and every firmware .cpp in the repository root against
+the shims in tools/host/ instead of the ESP32 core and libraries, and links
+them with the driver. The .ino gets its function prototypes generated the
+way the Arduino builder does it.
+
+Only ArduinoJson is taken from a real library install: it is plain C++.
+Point --arduinojson at its src/ directory, or set ARDUINOJSON_SRC.
+
+Usage:
+  python3 tools/host_build.py [-o furnace_host] [--arduinojson DIR] [--debug]
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+HOST_DIR = os.path.join(ROOT, "tools", "host")
+SKETCH = "Furnace_V28_TFT.ino"
+DEFAULT_ARDUINOJSON = os.path.expanduser("~/Arduino/libraries/ArduinoJson/src")
+CONTROL_WORDS = ("if", "for", "while", "switch", "return")
+
+
+def sketch_with_prototypes(source):
+    """Sketch source with prototypes of its functions after the includes."""
+    prototypes = []
+    pattern = r'^([A-Za-z_][\w:<>\*& ]*?[\s\*&]+([A-Za-z_]\w*)\s*\(([^;{}]*)\))\s*\{'
+    for match in re.finditer(pattern, source, re.M):
+        if match.group(2) in CONTROL_WORDS:
+            continue
+        prototypes.append(re.sub(r'\s*=\s*[^,)]+', '', match.group(1)) + ';')
+    lines = source.split('\n')
+    last_include = max(i for i, line in enumerate(lines) if line.startswith('#include'))
+    return '\n'.join(lines[:last_include + 1] + prototypes +
+                     ['#line %d "%s"' % (last_include + 2, SKETCH)] + lines[last_include + 1:])
+
+
+def compile_unit(compiler, flags, source, obj, extra=()):
+    if os.path.exists(obj) and os.path.getmtime(obj) >= os.path.getmtime(source):
+        return True
+    print("  CXX", os.path.relpath(source, ROOT))
+    return subprocess.call([compiler] + flags + list(extra) + ["-c", source, "-o", obj]) == 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build the firmware as a host program")
+    parser.add_argument("-o", "--output", default="furnace_host")
+    parser.add_argument("--arduinojson", default=os.environ.get("ARDUINOJSON_SRC", DEFAULT_ARDUINOJSON),
+                        help="ArduinoJson's src/ directory")
+    parser.add_argument("--build-dir", default=os.path.join(ROOT, "build", "host"))
+    parser.add_argument("--debug", action="store_true",
+                        help="-O0 -g with AddressSanitizer (the heap figures then read 0)")
+    parser.add_argument("--cxx", default=os.environ.get("CXX", "g++"))
+    args = parser.parse_args()
+
+    if not os.path.exists(os.path.join(args.arduinojson, "ArduinoJson.h")):
+        sys.exit("ArduinoJson.h not found in %s (use --arduinojson)" % args.arduinojson)
+
+    flags = ["-std=gnu++17", "-DARDUINO=10819", "-DESP32", "-Wall", "-Wno-unused",
+             "-I" + HOST_DIR, "-I" + ROOT, "-I" + args.arduinojson]
+    flags += ["-O0", "-g", "-fsanitize=address"] if args.debug else ["-O2", "-g"]
+    os.makedirs(args.build_dir, exist_ok=True)
+
+    # Regenerated only when the sketch changes, so its object stays fresh
+    sketch_cpp = os.path.join(args.build_dir, SKETCH + ".cpp")
+    sketch_path = os.path.join(ROOT, SKETCH)
+    if not os.path.exists(sketch_cpp) or os.path.getmtime(sketch_cpp) < os.path.getmtime(sketch_path):
+        with open(sketch_path) as f:
+            generated = sketch_with_prototypes(f.read())
+        with open(sketch_cpp, "w") as f:
+            f.write(generated)
+
+    units = [(sketch_cpp, ["-include", "Arduino.h"])]
+    units += [(os.path.join(ROOT, name), []) for name in sorted(os.listdir(ROOT)) if name.endswith(".cpp")]
+    units += [(os.path.join(HOST_DIR, name), []) for name in sorted(os.listdir(HOST_DIR)) if name.endswith(".cpp")]
+
+    # Header changes are not tracked; remove the build directory after editing one
+    objects = []
+    for source, extra in units:
+        obj = os.path.join(args.build_dir, os.path.basename(source) + ".o")
+        if not compile_unit(args.cxx, flags, source, obj, extra):
+            sys.exit(1)
+        objects.append(obj)
+
+    link = [args.cxx] + objects + ["-o", args.output, "-lpthread"]
+    if args.debug:
+        link.append("-fsanitize=address")
+    print("  LD ", args.output)
+    sys.exit(subprocess.call(link))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,233 @@
+#!/usr/bin/env python3
+"""
+Minimal MQTT 3.1.1 broker to test the controller's telemetry against,
+standing in for mosquitto. It serves one client at a time, acknowledges
+QoS 1 publishes and checks the telemetry stream:
+  - batches arrive in seq order, with resends (same seq) counted apart
+    from gaps,
+  - sample timestamps never go backwards across batches.
+
+To exercise store-and-forward it can drop the connection every N telemetry
+batches without acknowledging the last one (--drop-every), and refuse
+reconnects for a while after each drop (--offline). With --setpoint it
+sends a setpoint command once the controller subscribes and prints the
+cmd/result reply.
+
+Point the controller at it with POST /api/mqtt
+{"enabled": true, "uri": "mqtt://<this-host>:1883"}.
+
+Usage:
+  python3 tools/mqtt_standin.py [--port 1883] [--topic furnace]
+                                [--drop-every 5] [--offline 60]
+                                [--setpoint 650 [--index 12]]
+
+Stop it with Ctrl-C for a summary.
+"""
+
+import argparse
+import json
+import socket
+import struct
+import sys
+import time
+
+
+def read_exact(sock, count):
+    data = b""
+    while len(data) < count:
+        chunk = sock.recv(count - len(data))
+        if not chunk:
+            raise ConnectionError("client closed the connection")
+        data += chunk
+    return data
+
+
+def read_packet(sock):
+    header = read_exact(sock, 1)[0]
+    length = 0
+    shift = 0
+    while True:
+        byte = read_exact(sock, 1)[0]
+        length |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            break
+    return header, read_exact(sock, length)
+
+
+def encode_length(length):
+    encoded = b""
+    while True:
+        byte = length & 0x7F
+        length >>= 7
+        encoded += bytes([byte | (0x80 if length else 0)])
+        if not length:
+            return encoded
+
+
+def encode_string(text):
+    data = text.encode()
+    return struct.pack(">H", len(data)) + data
+
+
+def send_publish(sock, topic, payload):
+    body = encode_string(topic) + payload.encode()
+    sock.sendall(bytes([0x30]) + encode_length(len(body)) + body)
+
+
+class Stream:
+    def __init__(self):
+        self.batches = 0
+        self.samples = 0
+        self.resends = 0
+        self.gaps = 0
+        self.out_of_order = 0
+        self.last_seq = None
+        self.last_time = 0
+        self.seen = set()
+        self.command_sent = False
+
+    def telemetry(self, payload):
+        try:
+            batch = json.loads(payload)
+        except ValueError:
+            print("FAIL  telemetry is not JSON: %r" % payload[:80])
+            return
+        seq = batch.get("seq")
+        samples = batch.get("samples", [])
+        if seq in self.seen:
+            self.resends += 1
+            print("      seq %d again (%d samples), resend" % (seq, len(samples)))
+            return
+        self.seen.add(seq)
+        if self.last_seq is not None and seq != self.last_seq + 1:
+            # A reboot restarts seq at 1
+            if seq != 1:
+                self.gaps += 1
+                print("FAIL  seq jumped from %d to %d" % (self.last_seq, seq))
+        self.last_seq = seq
+        self.batches += 1
+        self.samples += len(samples)
+        for sample in samples:
+            sample_time = sample[0]
+            if sample_time and sample_time < self.last_time:
+                self.out_of_order += 1
+                print("FAIL  sample time went back from %d to %d" % (self.last_time, sample_time))
+            if sample_time:
+                self.last_time = sample_time
+        last = samples[-1] if samples else None
+        print("      seq %d: %d samples%s" % (
+            seq, len(samples),
+            ", last %.1f C / target %.1f C, duty %d%%" % (last[1], last[2], last[3]) if last else ""))
+
+    def summary(self):
+        print()
+        print("batches %d, samples %d, resends %d" % (self.batches, self.samples, self.resends))
+        print(("ok    " if not self.gaps else "FAIL  ") + "%d seq gaps" % self.gaps)
+        print(("ok    " if not self.out_of_order else "FAIL  ") + "%d samples out of order" % self.out_of_order)
+        return not self.gaps and not self.out_of_order
+
+
+def serve_client(sock, args, stream):
+    """Returns True when the connection was dropped on purpose."""
+    received = 0
+    while True:
+        header, body = read_packet(sock)
+        kind = header >> 4
+
+        if kind == 1:  # CONNECT
+            client_id = body[12:12 + struct.unpack(">H", body[10:12])[0]].decode(errors="replace")
+            print("      client %s connected" % client_id)
+            sock.sendall(b"\x20\x02\x00\x00")
+        elif kind == 8:  # SUBSCRIBE
+            packet_id = body[:2]
+            offset = 2
+            topics = []
+            while offset < len(body):
+                length = struct.unpack(">H", body[offset:offset + 2])[0]
+                topics.append(body[offset + 2:offset + 2 + length].decode())
+                offset += 2 + length + 1
+            print("      subscribed to %s" % ", ".join(topics))
+            sock.sendall(bytes([0x90, 2 + len(topics)]) + packet_id + bytes([1] * len(topics)))
+            if args.setpoint is not None and not stream.command_sent:
+                stream.command_sent = True
+                command = {"temp": args.setpoint, "id": "standin"}
+                if args.index is not None:
+                    command["index"] = args.index
+                send_publish(sock, args.topic + "/cmd/setpoint", json.dumps(command))
+                print("      sent setpoint %s" % json.dumps(command))
+        elif kind == 3:  # PUBLISH
+            qos = (header >> 1) & 3
+            length = struct.unpack(">H", body[:2])[0]
+            topic = body[2:2 + length].decode()
+            offset = 2 + length
+            packet_id = None
+            if qos:
+                packet_id = body[offset:offset + 2]
+                offset += 2
+            payload = body[offset:].decode(errors="replace")
+
+            if topic == args.topic + "/telemetry":
+                received += 1
+                if args.drop_every and received % args.drop_every == 0:
+                    print("      dropping the connection without PUBACK")
+                    return True
+                stream.telemetry(payload)
+            elif topic == args.topic + "/cmd/result":
+                print("      command result %s" % payload)
+            else:
+                print("      %s: %s" % (topic, payload))
+            if qos == 1:
+                sock.sendall(b"\x40\x02" + packet_id)
+        elif kind == 12:  # PINGREQ
+            sock.sendall(b"\xd0\x00")
+        elif kind == 14:  # DISCONNECT
+            return False
+
+
+def main():
+    parser = argparse.ArgumentParser(description="MQTT stand-in broker for furnace telemetry tests")
+    parser.add_argument("--port", type=int, default=1883)
+    parser.add_argument("--topic", default="furnace", help="base topic set on the controller")
+    parser.add_argument("--drop-every", type=int, default=0,
+                        help="drop the connection at every Nth telemetry batch, before acknowledging it")
+    parser.add_argument("--offline", type=float, default=0,
+                        help="seconds to refuse reconnects after a drop")
+    parser.add_argument("--setpoint", type=float, help="send this setpoint once the controller subscribes")
+    parser.add_argument("--index", type=int, help="schedule slot for --setpoint (default: current slot)")
+    args = parser.parse_args()
+
+    server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind(("", args.port))
+    server.listen(1)
+    print("listening on port %d, topic %s" % (args.port, args.topic))
+
+    stream = Stream()
+    offline_until = 0
+    try:
+        while True:
+            sock, address = server.accept()
+            if time.time() < offline_until:
+                sock.close()
+                continue
+            print("      connection from %s" % address[0])
+            try:
+                dropped = serve_client(sock, args, stream)
+            except ConnectionError as error:
+                print("      %s" % error)
+                dropped = False
+            sock.close()
+            if dropped and args.offline:
+                offline_until = time.time() + args.offline
+                print("      offline for %.0f s" % args.offline)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        server.close()
+
+    sys.exit(0 if stream.summary() else 1)
+
+
+if __name__ == "__main__":
+    main()
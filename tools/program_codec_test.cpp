@@ -0,0 +1,271 @@
+// Host tests for the binary program codec (program_codec.h): round trips
+// of generated programs, and decoding of corrupted, truncated and random
+// blobs, which must be rejected or decoded within bounds - never crash or
+// read past the blob.
+//
+// Build and run from the repository root (the sanitizers catch reads past
+// the end of a blob):
+//
+//   g++ -std=c++17 -O1 -g -Wall -fsanitize=address,undefined -I. -o program_codec_test tools/program_codec_test.cpp program_codec.cpp && ./program_codec_test
+//
+// Exits 1 if any check fails. The generator is seeded, so a failure repeats;
+// pass a seed as the first argument to try others.
+
+#include "program_codec.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#define MAX_POINTS 288                    // 24 h at the finest resolution
+#define MAX_PROGRAMS_PER_BLOB 20
+#define ROUND_TRIPS 2000
+#define RANDOM_BLOBS 20000
+
+static int failures = 0;
+static uint32_t rngState = 1;
+
+#define CHECK(condition, ...) do { \
+    if (!(condition)) { \
+      failures++; \
+      fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+      fprintf(stderr, __VA_ARGS__); \
+      fprintf(stderr, "\n"); \
+    } \
+  } while (0)
+
+static uint32_t nextRandom() {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState;
+}
+
+static uint32_t randomBelow(uint32_t limit) {
+  return limit ? nextRandom() % limit : 0;
+}
+
+struct TestProgram {
+  uint8_t index;
+  std::string name;
+  std::vector<float> temps;
+};
+
+// Schedules like real ones - ramps, holds, jumps, trailing zeros - plus
+// the extremes of the tenths range
+static TestProgram makeProgram() {
+  TestProgram program;
+  program.index = randomBelow(256);
+  size_t nameLength = randomBelow(10) == 0 ? 256 + randomBelow(64) : randomBelow(40);
+  for (size_t i = 0; i < nameLength; i++) program.name += (char)(' ' + randomBelow(95));
+
+  uint16_t points = randomBelow(8) == 0 ? 0 : 1 + randomBelow(MAX_POINTS);
+  float temp = 0;
+  for (uint16_t i = 0; i < points; i++) {
+    switch (randomBelow(6)) {
+      case 0: temp = (float)((int)randomBelow(65536) - 32768) / 10.0f; break;
+      case 1: temp += (float)((int)randomBelow(2001) - 1000) / 10.0f; break;
+      case 2: temp = randomBelow(2) ? 3276.7f : -3276.8f; break;
+      case 3: temp = 0; break;
+      default: break;                     // Hold
+    }
+    program.temps.push_back(temp);
+  }
+  if (points > 0 && randomBelow(3) == 0) {
+    for (uint16_t i = points - randomBelow(points); i < points; i++) program.temps[i] = 0;
+  }
+  return program;
+}
+
+static size_t blobCapacity(size_t programs) {
+  return PROGRAM_CODEC_HEADER_SIZE + PROGRAM_CODEC_CRC_SIZE + programs * PROGRAM_CODEC_RECORD_MAX_SIZE(MAX_POINTS);
+}
+
+static std::vector<uint8_t> encode(const std::vector<TestProgram>& programs) {
+  std::vector<uint8_t> buffer(blobCapacity(programs.size()));
+  ProgramBlobWriter writer(buffer.data(), buffer.size());
+  for (const TestProgram& program : programs) {
+    bool added = writer.add(program.index, program.name.c_str(), program.temps.data(), program.temps.size());
+    CHECK(added, "add failed for a %zu point program", program.temps.size());
+  }
+  size_t length = writer.finish();
+  CHECK(length > 0, "finish failed");
+  buffer.resize(length);
+  return buffer;
+}
+
+// ====================================================================
+// ROUND TRIPS
+// ====================================================================
+
+static void testRoundTrip() {
+  for (int trip = 0; trip < ROUND_TRIPS; trip++) {
+    std::vector<TestProgram> programs(1 + randomBelow(MAX_PROGRAMS_PER_BLOB));
+    for (TestProgram& program : programs) program = makeProgram();
+    std::vector<uint8_t> blob = encode(programs);
+
+    ProgramBlobReader reader(blob.data(), blob.size());
+    CHECK(reader.isValid(), "trip %d: blob not valid", trip);
+    CHECK(reader.getCount() == (int)programs.size(), "trip %d: count %d, wrote %zu",
+          trip, reader.getCount(), programs.size());
+
+    float temps[MAX_POINTS];
+    ProgramRecord record;
+    for (const TestProgram& program : programs) {
+      bool read = reader.next(record, temps, MAX_POINTS);
+      CHECK(read, "trip %d: record missing", trip);
+      if (!read) break;
+
+      size_t nameLength = program.name.size() > PROGRAM_CODEC_MAX_NAME ? PROGRAM_CODEC_MAX_NAME : program.name.size();
+      CHECK(record.index == program.index, "trip %d: index %u, wrote %u", trip, record.index, program.index);
+      CHECK(strlen(record.name) == nameLength && memcmp(record.name, program.name.data(), nameLength) == 0,
+            "trip %d: name differs", trip);
+
+      // Trailing zeros are dropped; the reader fills them back in
+      size_t stored = program.temps.size();
+      while (stored > 0 && programTempToTenths(program.temps[stored - 1]) == 0) stored--;
+      CHECK(record.pointCount == stored, "trip %d: %u points, expected %zu", trip, record.pointCount, stored);
+      for (size_t i = 0; i < MAX_POINTS; i++) {
+        float expected = i < program.temps.size() ? quantizeProgramTemp(program.temps[i]) : 0.0f;
+        CHECK(temps[i] == expected, "trip %d point %zu: %.1f, expected %.1f", trip, i, temps[i], expected);
+      }
+    }
+    CHECK(!reader.next(record, temps, MAX_POINTS), "trip %d: extra record", trip);
+  }
+}
+
+// Decoding with fewer points than were stored keeps the first ones
+static void testShortBuffer() {
+  TestProgram program;
+  program.index = 3;
+  program.name = "short";
+  for (int i = 0; i < 100; i++) program.temps.push_back(i + 1);
+  std::vector<uint8_t> blob = encode({ program });
+
+  float temps[10];
+  ProgramRecord record;
+  ProgramBlobReader reader(blob.data(), blob.size());
+  CHECK(reader.next(record, temps, 10), "short buffer: record not read");
+  CHECK(record.pointCount == 100, "short buffer: %u points", record.pointCount);
+  for (int i = 0; i < 10; i++) CHECK(temps[i] == i + 1, "short buffer point %d: %.1f", i, temps[i]);
+}
+
+// ====================================================================
+// CORRUPT INPUT
+// ====================================================================
+
+// Decode everything in a blob held in its own allocation, so the
+// sanitizer sees any read past its end. Decoded records must be sane.
+static void decodeUntrusted(const uint8_t* data, size_t length) {
+  uint8_t* copy = (uint8_t*)malloc(length ? length : 1);
+  if (length > 0) memcpy(copy, data, length);
+
+  ProgramBlobReader reader(copy, length);
+  float temps[MAX_POINTS];
+  ProgramRecord record;
+  int records = 0;
+  while (reader.next(record, temps, MAX_POINTS)) {
+    records++;
+    CHECK(strlen(record.name) <= PROGRAM_CODEC_MAX_NAME, "decoded name too long");
+    for (int i = 0; i < MAX_POINTS; i++) {
+      CHECK(temps[i] >= -3276.8f && temps[i] <= 3276.7f, "decoded %.1f out of range", temps[i]);
+    }
+  }
+  CHECK(records <= reader.getCount(), "decoded %d records of %d", records, reader.getCount());
+  free(copy);
+}
+
+// Replace the CRC so a mutation reaches the record parser
+static void resealCrc(std::vector<uint8_t>& blob) {
+  if (blob.size() < PROGRAM_CODEC_HEADER_SIZE + PROGRAM_CODEC_CRC_SIZE) return;
+  size_t end = blob.size() - PROGRAM_CODEC_CRC_SIZE;
+  uint16_t crc = programCodecCrc16(blob.data(), end);
+  blob[end] = (uint8_t)(crc & 0xFF);
+  blob[end + 1] = (uint8_t)(crc >> 8);
+}
+
+static void testMutatedBlobs() {
+  std::vector<TestProgram> programs;
+  for (int i = 0; i < 4; i++) programs.push_back(makeProgram());
+  std::vector<uint8_t> original = encode(programs);
+
+  // Every single-bit flip must fail the CRC
+  for (size_t byte = 0; byte < original.size(); byte++) {
+    for (int bit = 0; bit < 8; bit++) {
+      std::vector<uint8_t> blob = original;
+      blob[byte] ^= 1 << bit;
+      ProgramBlobReader reader(blob.data(), blob.size());
+      CHECK(!reader.isValid(), "bit %d of byte %zu flipped but blob still valid", bit, byte);
+      decodeUntrusted(blob.data(), blob.size());
+    }
+  }
+
+  // Every truncation, with and without a matching CRC
+  for (size_t length = 0; length < original.size(); length++) {
+    std::vector<uint8_t> blob(original.begin(), original.begin() + length);
+    decodeUntrusted(blob.data(), blob.size());
+    resealCrc(blob);
+    decodeUntrusted(blob.data(), blob.size());
+  }
+
+  // Random byte edits behind a valid CRC
+  for (int i = 0; i < RANDOM_BLOBS; i++) {
+    std::vector<uint8_t> blob = original;
+    int edits = 1 + randomBelow(8);
+    for (int edit = 0; edit < edits; edit++) {
+      blob[PROGRAM_CODEC_HEADER_SIZE + randomBelow(blob.size() - PROGRAM_CODEC_HEADER_SIZE)] = randomBelow(256);
+    }
+    resealCrc(blob);
+    decodeUntrusted(blob.data(), blob.size());
+  }
+
+  // Random bodies behind a valid header and CRC
+  for (int i = 0; i < RANDOM_BLOBS; i++) {
+    std::vector<uint8_t> blob(PROGRAM_CODEC_HEADER_SIZE + randomBelow(600) + PROGRAM_CODEC_CRC_SIZE);
+    for (uint8_t& byte : blob) byte = randomBelow(256);
+    blob[0] = PROGRAM_CODEC_MAGIC_0;
+    blob[1] = PROGRAM_CODEC_MAGIC_1;
+    blob[2] = PROGRAM_CODEC_VERSION;
+    resealCrc(blob);
+    decodeUntrusted(blob.data(), blob.size());
+  }
+
+  // Trailing bytes after the last record
+  std::vector<uint8_t> padded = original;
+  padded.insert(padded.end() - PROGRAM_CODEC_CRC_SIZE, 0);
+  resealCrc(padded);
+  ProgramBlobReader reader(padded.data(), padded.size());
+  float temps[MAX_POINTS];
+  ProgramRecord record;
+  int records = 0;
+  while (reader.next(record, temps, MAX_POINTS)) records++;
+  CHECK(records == (int)programs.size() - 1, "trailing byte: %d records decoded", records);
+}
+
+// A writer out of room fails rather than writing a short blob
+static void testOverflow() {
+  TestProgram program = makeProgram();
+  program.temps.assign(MAX_POINTS, 1000.0f);
+  std::vector<uint8_t> buffer(40);
+  ProgramBlobWriter writer(buffer.data(), buffer.size());
+  CHECK(!writer.add(1, "big", program.temps.data(), program.temps.size()), "overflowing add succeeded");
+  CHECK(writer.finish() == 0, "overflowed writer finished");
+}
+
+int main(int argc, char** argv) {
+  rngState = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 1;
+  if (rngState == 0) rngState = 1;
+
+  testRoundTrip();
+  testShortBuffer();
+  testMutatedBlobs();
+  testOverflow();
+
+  if (failures > 0) {
+    fprintf(stderr, "%d checks failed\n", failures);
+    return 1;
+  }
+  printf("program codec: all checks passed\n");
+  return 0;
+}
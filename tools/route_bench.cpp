@@ -0,0 +1,244 @@
+// Compare the cost of routing a request the two ways the firmware has done
+// it: the linear chain of one server.on() handler per endpoint, which
+// ESPAsyncWebServer walks in registration order for every request, and
+// the single /api handler with ApiRouter's sorted table (api_router.cpp,
+// linked as is).
+//
+// The routes are read from the firmware's registrations in
+// web_server_handler.cpp and temperature_log_handler.cpp, in their order.
+// The chain's matcher is ESPAsyncWebServer 3.1's
+// AsyncCallbackWebHandler::canHandle() with the handler's filter call,
+// on Arduino Strings as on the controller, followed by the static file
+// handler ("/*") both setups end with. Every routed request is also
+// checked to reach the same route both ways.
+//
+// Build and run from the repository root (ArduinoJson's src/ directory as
+// for tools/host_build.py):
+//
+//   g++ -std=gnu++17 -O2 -Wall -Itools/host -I. -I<ArduinoJson/src> -o route_bench tools/route_bench.cpp tools/api_stubs.cpp api_router.cpp json_arena.cpp && ./route_bench
+//
+// Times are host nanoseconds per routed request; the controller is
+// slower, but the ratio and how each grows with the route count carry
+// over. --iterations sets the requests per measurement.
+
+#include <Arduino.h>
+#include "api_router.h"
+#include "api_stubs.h"
+#include <chrono>
+#include <fstream>
+#include <regex>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static const char* routeSources[] = { "web_server_handler.cpp", "temperature_log_handler.cpp" };
+
+struct RouteSpec {
+  std::string path;
+  ApiMethod method;
+};
+
+struct BenchRequest {
+  String url;
+  ApiMethod method;
+};
+
+static ApiMethod methodFromToken(const std::string& token) {
+  if (token == "HTTP_GET") return API_METHOD_GET;
+  if (token == "HTTP_POST") return API_METHOD_POST;
+  if (token == "HTTP_DELETE") return API_METHOD_DELETE;
+  if (token == "HTTP_PUT") return API_METHOD_PUT;
+  if (token == "HTTP_PATCH") return API_METHOD_PATCH;
+  if (token == "HTTP_HEAD") return API_METHOD_HEAD;
+  if (token == "HTTP_OPTIONS") return API_METHOD_OPTIONS;
+  return API_METHOD_ANY;
+}
+
+// Every on("/api/...", HTTP_X, ...) registration, in source order
+static std::vector<RouteSpec> readRoutes() {
+  std::vector<RouteSpec> routes;
+  std::regex registration("\\.on\\(\\s*\"(/api/[^\"]*)\"\\s*,\\s*(HTTP_[A-Z]+)");
+  for (const char* source : routeSources) {
+    std::ifstream file(source);
+    if (!file) {
+      fprintf(stderr, "cannot read %s (run from the repository root)\n", source);
+      exit(1);
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    std::string code = text.str();
+    for (std::sregex_iterator it(code.begin(), code.end(), registration), end; it != end; ++it) {
+      routes.push_back({ (*it)[1].str(), methodFromToken((*it)[2].str()) });
+    }
+  }
+  return routes;
+}
+
+// ====================================================================
+// THE LINEAR CHAIN
+// ====================================================================
+
+// AsyncCallbackWebHandler as ESPAsyncWebServer 3.1 matches it
+struct ChainHandler {
+  String uri;
+  ApiMethod method;
+  std::function<bool(const String&)> filter;
+
+  bool canHandle(const String& url, ApiMethod requestMethod) const {
+    if (!(method & requestMethod)) return false;
+    if (uri.length() && uri.startsWith("/*.")) {
+      String uriTemplate = String(uri);
+      uriTemplate = uriTemplate.substring(uriTemplate.lastIndexOf("."));
+      if (!url.endsWith(uriTemplate)) return false;
+    } else if (uri.length() && uri.endsWith("*")) {
+      String uriTemplate = String(uri);
+      uriTemplate = uriTemplate.substring(0, uriTemplate.length() - 1);
+      if (!url.startsWith(uriTemplate)) return false;
+    } else if (uri.length() && (uri != url && !url.startsWith(uri + "/"))) {
+      return false;
+    }
+    return true;
+  }
+};
+
+struct HandlerChain {
+  std::vector<ChainHandler> handlers;
+  std::vector<String> interestingHeaders;
+
+  void on(const char* uri, ApiMethod method) {
+    handlers.push_back({ String(uri), method, [](const String&) { return true; } });
+  }
+
+  // AsyncWebServer::_attachHandler(): the first handler that takes it
+  int route(const String& url, ApiMethod method) {
+    for (size_t i = 0; i < handlers.size(); i++) {
+      const ChainHandler& handler = handlers[i];
+      if (handler.filter(url) && handler.canHandle(url, method)) {
+        interestingHeaders.push_back("ANY");
+        interestingHeaders.clear();
+        return (int)i;
+      }
+    }
+    return -1;
+  }
+};
+
+// ====================================================================
+// MEASUREMENT
+// ====================================================================
+
+static HandlerChain linearChain;
+static HandlerChain tableChain;         // "/api" then "/*", as setupWebServer() attaches them
+static ApiRouter router;
+static std::vector<RouteSpec> routeSpecs;
+static int mismatches = 0;
+
+// Where each setup sends the request, as a path ("" for the static handler)
+static const char* routeLinear(const BenchRequest& request) {
+  int index = linearChain.route(request.url, request.method);
+  return index >= 0 && index < (int)routeSpecs.size() ? routeSpecs[index].path.c_str() : "";
+}
+
+static const char* routeTable(const BenchRequest& request) {
+  if (tableChain.route(request.url, request.method) != 0) return "";
+  const ApiRoute* route = router.find(request.url, request.method);
+  return route ? route->path : "";
+}
+
+template <typename Route>
+static double nanosPerRequest(const std::vector<BenchRequest>& requests, long iterations, Route route) {
+  volatile size_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; i++) {
+    sink = sink + (size_t)route(requests[i % requests.size()]);
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+static void buildSetups(size_t routeCount) {
+  linearChain.handlers.clear();
+  router = ApiRouter();
+  for (size_t i = 0; i < routeCount; i++) {
+    linearChain.on(routeSpecs[i].path.c_str(), routeSpecs[i].method);
+    router.on(routeSpecs[i].path.c_str(), routeSpecs[i].method, [](ApiRequest&) {});
+  }
+  linearChain.on("/*", API_METHOD_GET);
+}
+
+static void compare(const char* name, const std::vector<BenchRequest>& requests, long iterations) {
+  for (const BenchRequest& request : requests) {
+    const char* linear = routeLinear(request);
+    const char* table = routeTable(request);
+    if (strcmp(linear, table) != 0) {
+      mismatches++;
+      fprintf(stderr, "%s %s: chain routes to \"%s\", table to \"%s\"\n", ApiRouter::methodName(request.method),
+              request.url.c_str(), linear, table);
+    }
+  }
+  double linear = nanosPerRequest(requests, iterations, routeLinear);
+  double table = nanosPerRequest(requests, iterations, routeTable);
+  printf("%-28s %10.0f %10.0f %9.1fx\n", name, linear, table, table > 0 ? linear / table : 0);
+}
+
+int main(int argc, char** argv) {
+  long iterations = 200000;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) iterations = atol(argv[++i]);
+    else {
+      fprintf(stderr, "usage: route_bench [--iterations N]\n");
+      return 2;
+    }
+  }
+  if (iterations <= 0) iterations = 1;
+
+  apiStubsSetQuiet(true);
+  routeSpecs = readRoutes();
+  if (routeSpecs.empty()) {
+    fprintf(stderr, "no routes found\n");
+    return 1;
+  }
+  tableChain.on("/api", API_METHOD_ANY);
+  tableChain.on("/*", API_METHOD_GET);
+
+  std::vector<BenchRequest> everyRoute;
+  for (const RouteSpec& spec : routeSpecs) everyRoute.push_back({ spec.path.c_str(), spec.method });
+  std::vector<BenchRequest> firstRoute = { everyRoute.front() };
+  std::vector<BenchRequest> lastRoute = { everyRoute.back() };
+  std::vector<BenchRequest> unknown = { { "/api/nothing/here", API_METHOD_GET } };
+  std::vector<BenchRequest> staticFiles = {
+    { "/", API_METHOD_GET }, { "/index.html", API_METHOD_GET }, { "/style.css", API_METHOD_GET },
+    { "/settings.html", API_METHOD_GET }, { "/sw.js", API_METHOD_GET },
+  };
+
+  buildSetups(routeSpecs.size());
+  printf("%zu routes from %s and %s, %ld requests per figure\n\n", routeSpecs.size(), routeSources[0],
+         routeSources[1], iterations);
+  printf("%-28s %10s %10s %10s\n", "ns per request", "chain", "table", "speedup");
+  compare("every route in turn", everyRoute, iterations);
+  compare("first registered route", firstRoute, iterations);
+  compare("last registered route", lastRoute, iterations);
+  compare("unknown /api/ path", unknown, iterations);
+  compare("static files", staticFiles, iterations);
+
+  // The chain grows with every endpoint, the table's binary search barely
+  printf("\n%-28s %10s %10s %10s\n", "every route, table size", "chain", "table", "speedup");
+  for (size_t count = 8; ; count *= 2) {
+    if (count > routeSpecs.size()) count = routeSpecs.size();
+    buildSetups(count);
+    std::vector<BenchRequest> requests(everyRoute.begin(), everyRoute.begin() + count);
+    char name[32];
+    snprintf(name, sizeof(name), "%zu routes", count);
+    compare(name, requests, iterations);
+    if (count == routeSpecs.size()) break;
+  }
+
+  if (mismatches > 0) {
+    fprintf(stderr, "%d requests routed differently\n", mismatches);
+    return 1;
+  }
+  return 0;
+}
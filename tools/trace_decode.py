@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+"""
+Decode a control trace dump from /api/trace (see trace_ring.h) into CSV or
+the Chrome trace event format (open in chrome://tracing or Perfetto).
+
+The dump is a TraceHeader followed by one TraceEvent per control tick,
+oldest first. Gaps in seq (events overwritten while the dump was read, or
+before it started) are reported on stderr.
+
+Usage:
+  python3 tools/trace_decode.py trace.bin [--format csv|chrome] [-o out]
+  python3 tools/trace_decode.py --host 192.168.1.50 [--save trace.bin] ...
+
+Times are millis() since boot; when the controller's clock was set, CSV
+rows also get the wall-clock time.
+"""
+
+import argparse
+import csv
+import datetime
+import http.client
+import json
+import struct
+import sys
+
+MAGIC = 0x43525446
+HEADER = struct.Struct("<IHHIIII")
+EVENT = struct.Struct("<IIhhhhhhHBB")
+NO_VALUE = -32768
+
+FLAGS = [
+    (0x01, "relay_on"),
+    (0x02, "relay_edge"),
+    (0x04, "enabled"),
+    (0x08, "sensor_error"),
+    (0x10, "read_fault"),
+    (0x20, "mode_pid"),
+    (0x40, "mode_pwm"),
+]
+
+
+def tenths(value):
+    return None if value == NO_VALUE else value / 10.0
+
+
+def parse(data):
+    if len(data) < HEADER.size:
+        raise ValueError("dump shorter than its header")
+    magic, version, event_size, capacity, written, millis_now, unix_now = HEADER.unpack_from(data)
+    if magic != MAGIC:
+        raise ValueError("not a furnace trace (magic %08x)" % magic)
+    if version != 1 or event_size != EVENT.size:
+        raise ValueError("unsupported trace version %d / event size %d" % (version, event_size))
+
+    header = {"capacity": capacity, "written": written, "millis": millis_now, "unix": unix_now}
+    events = []
+    for offset in range(HEADER.size, len(data) - EVENT.size + 1, EVENT.size):
+        (seq, millis, raw, temp, setpoint, p, i, d, tick_ms, duty, flags) = EVENT.unpack_from(data, offset)
+        events.append({
+            "seq": seq,
+            "millis": millis,
+            "raw_temp": tenths(raw),
+            "temp": tenths(temp),
+            "setpoint": tenths(setpoint),
+            "p": tenths(p),
+            "i": tenths(i),
+            "d": tenths(d),
+            "tick_ms": tick_ms,
+            "duty": duty,
+            "flags": flags,
+        })
+    return header, events
+
+
+def report_gaps(header, events):
+    first = max(0, header["written"] - header["capacity"])
+    expected = first
+    for event in events:
+        if event["seq"] != expected:
+            sys.stderr.write("gap: seq %d-%d missing\n" % (expected, event["seq"] - 1))
+        expected = event["seq"] + 1
+    sys.stderr.write("%d events, seq %d-%d\n" % (len(events), first, header["written"] - 1))
+
+
+def wall_time(header, millis):
+    if not header["unix"]:
+        return ""
+    seconds = header["unix"] - (header["millis"] - millis) / 1000.0
+    return datetime.datetime.fromtimestamp(seconds).isoformat(timespec="milliseconds")
+
+
+def write_csv(header, events, out):
+    writer = csv.writer(out)
+    writer.writerow(["seq", "millis", "time", "raw_temp", "temp", "setpoint", "p", "i", "d", "duty",
+                     "tick_ms"] + [name for _, name in FLAGS])
+    for event in events:
+        writer.writerow([
+            event["seq"], event["millis"], wall_time(header, event["millis"]),
+            event["raw_temp"], event["temp"], event["setpoint"],
+            event["p"], event["i"], event["d"], event["duty"], event["tick_ms"],
+        ] + [1 if event["flags"] & bit else 0 for bit, _ in FLAGS])
+
+
+def counter(name, ts, values):
+    args = {key: value for key, value in values.items() if value is not None}
+    return {"name": name, "ph": "C", "ts": ts, "pid": 1, "tid": 1, "args": args}
+
+
+def write_chrome(header, events, out):
+    trace = [{"name": "process_name", "ph": "M", "pid": 1, "args": {"name": "furnace control"}}]
+    for event in events:
+        ts = event["millis"] * 1000
+        trace.append(counter("temperature", ts, {
+            "raw": event["raw_temp"], "filtered": event["temp"], "setpoint": event["setpoint"]}))
+        trace.append(counter("pid", ts, {"p": event["p"], "i": event["i"], "d": event["d"]}))
+        trace.append(counter("duty", ts, {"duty": event["duty"]}))
+        trace.append(counter("tick_ms", ts, {"tick_ms": event["tick_ms"]}))
+        if event["flags"] & 0x02:
+            trace.append({"name": "relay on" if event["flags"] & 0x01 else "relay off",
+                          "ph": "i", "s": "p", "ts": ts, "pid": 1, "tid": 1})
+        if event["flags"] & 0x10:
+            trace.append({"name": "read fault", "ph": "i", "s": "p", "ts": ts, "pid": 1, "tid": 1})
+    json.dump({"traceEvents": trace, "displayTimeUnit": "ms"}, out)
+
+
+def download(host, port):
+    connection = http.client.HTTPConnection(host, port, timeout=30)
+    connection.request("GET", "/api/trace", headers={"Connection": "close"})
+    response = connection.getresponse()
+    data = response.read()
+    connection.close()
+    if response.status != 200:
+        raise ValueError("/api/trace answered %d" % response.status)
+    return data
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode a furnace control trace")
+    parser.add_argument("file", nargs="?", help="dump saved from /api/trace")
+    parser.add_argument("--host", help="download the trace from this controller instead")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--save", help="also keep the downloaded binary dump here")
+    parser.add_argument("--format", choices=["csv", "chrome"], default="csv")
+    parser.add_argument("-o", "--output", help="output file (default stdout)")
+    args = parser.parse_args()
+
+    if args.host:
+        data = download(args.host, args.port)
+        if args.save:
+            with open(args.save, "wb") as f:
+                f.write(data)
+    elif args.file:
+        with open(args.file, "rb") as f:
+            data = f.read()
+    else:
+        parser.error("give a dump file or --host")
+
+    try:
+        header, events = parse(data)
+    except ValueError as error:
+        sys.exit("trace_decode: %s" % error)
+    report_gaps(header, events)
+
+    out = open(args.output, "w", newline="") if args.output else sys.stdout
+    try:
+        if args.format == "csv":
+            write_csv(header, events, out)
+        else:
+            write_chrome(header, events, out)
+    finally:
+        if args.output:
+            out.close()
+
+
+if __name__ == "__main__":
+    main()
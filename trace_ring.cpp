@@ -0,0 +1,81 @@
+#include "trace_ring.h"
+#include <memory>
+
+extern bool timeIsSynchronized;
+
+TraceEvent traceRing[TRACE_RING_EVENTS] __attribute__((aligned(4)));
+std::atomic<uint32_t> traceWritten(0);
+
+struct TraceReadState {
+  TraceHeader header;
+  size_t headerSent;
+  uint32_t next;                      // Next seq to send
+  uint32_t end;                       // Events recorded when the dump started
+};
+
+// Copy whole events into the response buffer, dropping any the control
+// loop was rewriting or overwrote meanwhile: the slot's seq must be the
+// expected one both before and after the copy (a seqlock)
+static size_t fillTrace(TraceReadState& state, uint8_t* buffer, size_t maxLen) {
+  size_t length = 0;
+
+  if (state.headerSent < sizeof(TraceHeader)) {
+    length = min(maxLen, sizeof(TraceHeader) - state.headerSent);
+    memcpy(buffer, (const uint8_t*)&state.header + state.headerSent, length);
+    state.headerSent += length;
+    if (state.headerSent < sizeof(TraceHeader)) return length;
+  }
+
+  while (state.next < state.end && maxLen - length >= sizeof(TraceEvent)) {
+    uint32_t seq = state.next++;
+    TraceEvent& slot = traceRing[seq & (TRACE_RING_EVENTS - 1)];
+    TraceEvent* copy = (TraceEvent*)(buffer + length);
+    uint32_t before = traceSlotSeq(slot);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    memcpy(copy, &slot, sizeof(TraceEvent));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint32_t after = traceSlotSeq(slot);
+
+    uint32_t written = traceWritten.load(std::memory_order_relaxed);
+    if (written - seq >= TRACE_RING_EVENTS) {
+      // Lapped: skip ahead to the oldest event still in the ring
+      state.next = written - TRACE_RING_EVENTS + 1;
+      continue;
+    }
+    if (before != seq || after != seq) continue;
+    copy->seq = seq;
+    length += sizeof(TraceEvent);
+  }
+
+  // A chunked response ends on the first empty chunk, so only return 0
+  // once everything is sent
+  if (length == 0 && state.next < state.end) {
+    return RESPONSE_TRY_AGAIN;
+  }
+  return length;
+}
+
+void handleTraceRequest(AsyncWebServerRequest *request) {
+  std::shared_ptr<TraceReadState> state = std::make_shared<TraceReadState>();
+  uint32_t written = traceWritten.load(std::memory_order_acquire);
+
+  state->header.magic = TRACE_MAGIC;
+  state->header.version = TRACE_VERSION;
+  state->header.eventSize = sizeof(TraceEvent);
+  state->header.capacity = TRACE_RING_EVENTS;
+  state->header.written = written;
+  state->header.millisNow = millis();
+  state->header.unixNow = timeIsSynchronized ? (uint32_t)time(nullptr) : 0;
+  state->headerSent = 0;
+  state->next = written > TRACE_RING_EVENTS ? written - TRACE_RING_EVENTS : 0;
+  state->end = written;
+
+  AsyncWebServerResponse *response = request->beginChunkedResponse("application/octet-stream",
+    [state](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+      (void)index;
+      return fillTrace(*state, buffer, maxLen);
+    });
+  response->addHeader("Cache-Control", "no-store");
+  response->addHeader("Content-Disposition", "attachment; filename=furnace_trace.bin");
+  request->send(response);
+}
@@ -0,0 +1,99 @@
+#ifndef TRACE_RING_H
+#define TRACE_RING_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <atomic>
+
+// =================================================================
+//                  CONTROL TRACE RING
+// =================================================================
+// Every control tick is recorded as one fixed-size binary event in a RAM
+// ring, so the last TRACE_RING_EVENTS ticks (about 8.5 minutes at 2 Hz)
+// can be examined after a firing went wrong - without the flash wear of
+// logging at that rate. Recording copies 24 bytes into the next slot and
+// bumps a counter; the oldest event is overwritten once the ring is full.
+//
+// GET /api/trace streams the ring oldest first:
+//
+//   TraceHeader, then TraceEvent * n    (little-endian, packed)
+//
+// Events are read while the control loop keeps writing. A slot's seq is
+// TRACE_SEQ_WRITING while its payload is being replaced, and the reader
+// checks seq before and after copying; an event overwritten while it was
+// being copied is left out, which shows as a gap in seq.
+// tools/trace_decode.py turns a dump into CSV or a Chrome trace.
+
+#define TRACE_RING_EVENTS 1024            // Power of two
+#define TRACE_MAGIC 0x43525446            // "FTRC"
+#define TRACE_VERSION 1
+#define TRACE_NO_VALUE INT16_MIN          // Temperature unavailable (failed read)
+#define TRACE_SEQ_WRITING UINT32_MAX      // Slot seq while the slot is rewritten
+
+#define TRACE_FLAG_RELAY_ON 0x01
+#define TRACE_FLAG_RELAY_EDGE 0x02        // Relay switched during this tick
+#define TRACE_FLAG_ENABLED 0x04           // Program running
+#define TRACE_FLAG_SENSOR_ERROR 0x08      // thermocoupleError set
+#define TRACE_FLAG_READ_FAULT 0x10        // This tick's reading was rejected
+#define TRACE_FLAG_MODE_PID 0x20          // Relay driven by the PID
+#define TRACE_FLAG_MODE_PWM 0x40          // Relay driven by proportional PWM
+
+struct TraceHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t eventSize;
+    uint32_t capacity;
+    uint32_t written;                     // Events recorded since boot
+    uint32_t millisNow;                   // millis() when the dump started...
+    uint32_t unixNow;                     // ...and Unix time then, 0 if the clock is not set
+} __attribute__((packed));
+
+struct TraceEvent {
+    uint32_t seq;                         // Events recorded before this one
+    uint32_t millis;
+    int16_t rawTemp;                      // Tenths of a degree, as read
+    int16_t temp;                         // Tenths, the value control used
+    int16_t setpoint;                     // Tenths
+    int16_t p;                            // PID terms at the last calculation,
+    int16_t i;                            // tenths of a percent of output
+    int16_t d;
+    uint16_t tickMs;                      // Time since the previous tick
+    uint8_t duty;                         // Relay duty the controller asked for, percent
+    uint8_t flags;                        // TRACE_FLAG_*
+} __attribute__((packed));
+
+extern TraceEvent traceRing[TRACE_RING_EVENTS];
+extern std::atomic<uint32_t> traceWritten;
+
+// Tenths of a degree (or percent) for an event field
+inline int16_t traceTenths(float value) {
+    if (isnan(value)) return TRACE_NO_VALUE;
+    float tenths = value * 10.0f;
+    if (tenths >= 32767.0f) return 32767;
+    if (tenths <= -32767.0f) return -32767;
+    return (int16_t)lroundf(tenths);
+}
+
+// seq is the first field and the ring is 4-byte aligned, so a slot's seq
+// is loaded and stored whole
+inline volatile uint32_t& traceSlotSeq(TraceEvent& slot) {
+    return *(volatile uint32_t*)&slot;
+}
+
+// Record one tick (control loop only); seq is filled in
+inline void recordTrace(const TraceEvent& event) {
+    uint32_t seq = traceWritten.load(std::memory_order_relaxed);
+    TraceEvent& slot = traceRing[seq & (TRACE_RING_EVENTS - 1)];
+    traceSlotSeq(slot) = TRACE_SEQ_WRITING;
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy((uint8_t*)&slot + sizeof(uint32_t), (const uint8_t*)&event + sizeof(uint32_t),
+           sizeof(TraceEvent) - sizeof(uint32_t));
+    std::atomic_thread_fence(std::memory_order_release);
+    traceSlotSeq(slot) = seq;
+    traceWritten.store(seq + 1, std::memory_order_release);
+}
+
+// GET /api/trace
+void handleTraceRequest(AsyncWebServerRequest *request);
+
+#endif // TRACE_RING_H
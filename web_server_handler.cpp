@@ -6,6 +6,22 @@
 #include "wifi_manager.h"
 #include "web_server_handler.h"
 #include "temperature_log_handler.h"
+#include "static_asset_handler.h"
+#include "api_router.h"
+#include "json_arena.h"
+#include "api_cache.h"
+#include "schedule_batch.h"
+#include "program_codec.h"
+#include "file_transfer.h"
+#include "boot_sequence.h"
+#include "time_service.h"
+#include "metrics.h"
+#include "mqtt_telemetry.h"
+#include "trace_ring.h"
+#include "profiler.h"
+#include "furnace_sim.h"
+#include "control_benchmark.h"
+#include "energy_meter.h"
 
 // --- Needed for resolution update logic ---
 extern void initializeTemperatureArrays();
@@ -32,6 +48,94 @@ extern void resetPID();
 
 // deleteRecursive function is defined in the main .ino file
 
+// Binary program variant requested via Accept header or ?format=bin
+static bool wantsBinaryPrograms(AsyncWebServerRequest *request) {
+  if (request->hasParam("format") && request->getParam("format")->value() == "bin") {
+    return true;
+  }
+  return request->hasHeader("Accept") &&
+         request->getHeader("Accept")->value().indexOf(PROGRAM_CODEC_CONTENT_TYPE) >= 0;
+}
+
+// Store uploaded temperatures for a program - shared by the JSON and binary
+// upload paths so both produce the same stored program. The caller holds
+// the program store lock through the save.
+// Trims to a single leading zero, removes trailing zeros and forces the last
+// point to 0.
+static void storeProgramTemps(int programIndex, const float* temps, int count) {
+  if (count > maxTempPoints) count = maxTempPoints;
+  ensureProgramLoaded(programIndex);  // So a later lazy load can't overwrite it
+
+  int firstNonZero = 0;
+  while (firstNonZero < count && quantizeProgramTemp(temps[firstNonZero]) == 0.0f) {
+    firstNonZero++;
+  }
+  int startIdx = firstNonZero > 0 ? firstNonZero - 1 : 0;
+  int lastNonZero = count - 1;
+  while (lastNonZero >= 0 && quantizeProgramTemp(temps[lastNonZero]) == 0.0f) {
+    lastNonZero--;
+  }
+
+  float* program = programTemps[programIndex];
+  int trimmedLen = 0;
+  if (startIdx <= lastNonZero) {
+    // After trimming, ensure the first value is 0
+    if (quantizeProgramTemp(temps[startIdx]) != 0.0f) {
+      program[trimmedLen++] = 0.0f;
+    }
+    for (int i = startIdx; i <= lastNonZero && trimmedLen < maxTempPoints; i++) {
+      program[trimmedLen++] = quantizeProgramTemp(temps[i]);
+    }
+  } else {
+    program[trimmedLen++] = 0.0f;
+  }
+  for (int i = trimmedLen; i < maxTempPoints; i++) {
+    program[i] = 0.0f;
+  }
+  // Ensure the last point is always 0 if there is any data
+  program[trimmedLen - 1] = 0.0f;
+}
+
+// Binary variant of /api/saveProgram: one program_codec.h record
+static void handleBinaryProgramUpload(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+  ProgramBlobReader reader(data, len);
+  if (!reader.isValid() || reader.getCount() != 1) {
+    request->send(400, "application/json", "{\"success\":false,\"error\":\"Invalid binary program\"}");
+    return;
+  }
+
+  ProgramRecord record;
+  std::vector<float> temps(maxTempPoints);
+  if (!reader.next(record, temps.data(), maxTempPoints)) {
+    request->send(400, "application/json", "{\"success\":false,\"error\":\"Invalid binary program\"}");
+    return;
+  }
+
+  if (record.index >= MAX_PROGRAMS || record.name[0] == '\0' || record.pointCount == 0) {
+    String errorMsg = "Invalid input: ";
+    if (record.index >= MAX_PROGRAMS) errorMsg += "program index out of range; ";
+    if (record.name[0] == '\0') errorMsg += "program name is empty; ";
+    if (record.pointCount == 0) errorMsg += "no temperature data provided; ";
+
+    ArenaJsonDocument errorDoc(request);
+    errorDoc["success"] = false;
+    errorDoc["error"] = errorMsg;
+    sendJson(request, 400, errorDoc);
+    return;
+  }
+
+  {
+    ProgramStoreLock lock;
+    programNames[record.index] = record.name;
+    storeProgramTemps(record.index, temps.data(), min((int)record.pointCount, maxTempPoints));
+    saveProgramToSPIFFS(record.index);
+  }
+  request->send(200, "application/json", "{\"success\":true,\"message\":\"Program saved successfully\"}");
+}
+
+// Setup pages for the access point. Every page route is filtered to the AP
+// interface, so the same routes stay registered while the station serves
+// the normal UI; the API routes are shared with the station side.
 void setupCaptivePortal() {
   // Serve setup page for the root path with proper headers
   server.on("/", HTTP_GET, [](AsyncWebServerRequest *request) {
@@ -40,7 +144,7 @@ void setupCaptivePortal() {
     response->addHeader("Pragma", "no-cache");
     response->addHeader("Expires", "0");
     request->send(response);
-  });
+  }).setFilter(ON_AP_FILTER);
   
   // Explicit setup page handler with proper headers
   server.on("/setup", HTTP_GET, [](AsyncWebServerRequest *request) {
@@ -49,65 +153,66 @@ void setupCaptivePortal() {
     response->addHeader("Pragma", "no-cache");
     response->addHeader("Expires", "0");
     request->send(response);
-  });
+  }).setFilter(ON_AP_FILTER);
   
   // Handle common captive portal detection URLs
   // Android devices - Android expects 204 No Content for successful internet, redirect for captive portal
   server.on("/generate_204", HTTP_GET, [](AsyncWebServerRequest *request) {
     request->redirect("/setup");
-  });
+  }).setFilter(ON_AP_FILTER);
   
   server.on("/gen_204", HTTP_GET, [](AsyncWebServerRequest *request) {
     request->redirect("/setup");
-  });
+  }).setFilter(ON_AP_FILTER);
   
   // Apple devices
   server.on("/hotspot-detect.html", HTTP_GET, [](AsyncWebServerRequest *request) {
     request->redirect("/setup");
-  });
+  }).setFilter(ON_AP_FILTER);
   
   server.on("/library/test/success.html", HTTP_GET, [](AsyncWebServerRequest *request) {
     request->redirect("/setup");
-  });
+  }).setFilter(ON_AP_FILTER);
   
   // Microsoft devices
   server.on("/connectivity-check.html", HTTP_GET, [](AsyncWebServerRequest *request) {
     request->redirect("/setup");
-  });
+  }).setFilter(ON_AP_FILTER);
   
   server.on("/check_network_status.txt", HTTP_GET, [](AsyncWebServerRequest *request) {
     request->redirect("/setup");
-  });
+  }).setFilter(ON_AP_FILTER);
   
   server.on("/ncsi.txt", HTTP_GET, [](AsyncWebServerRequest *request) {
     request->redirect("/setup");
-  });
+  }).setFilter(ON_AP_FILTER);
   
   server.on("/connecttest.txt", HTTP_GET, [](AsyncWebServerRequest *request) {
     request->redirect("/setup");
-  });
+  }).setFilter(ON_AP_FILTER);
   
   // Firefox
   server.on("/success.txt", HTTP_GET, [](AsyncWebServerRequest *request) {
     request->redirect("/setup");
-  });
+  }).setFilter(ON_AP_FILTER);
   
   // Ubuntu/Linux
   server.on("/connectivity-check", HTTP_GET, [](AsyncWebServerRequest *request) {
     request->redirect("/setup");
-  });
+  }).setFilter(ON_AP_FILTER);
   
   // Additional common detection URLs
   server.on("/mobile/status.php", HTTP_GET, [](AsyncWebServerRequest *request) {
     request->redirect("/setup");
-  });
+  }).setFilter(ON_AP_FILTER);
   
   server.on("/kindle-wifi/wifistub.html", HTTP_GET, [](AsyncWebServerRequest *request) {
     request->redirect("/setup");
-  });
+  }).setFilter(ON_AP_FILTER);
   
-  server.on("/api/scan", HTTP_GET, [](AsyncWebServerRequest *request) {
-    DynamicJsonDocument doc(4096);
+  // API routes share the /api dispatch table; repeated calls are rejected as duplicates
+  apiRouter.on("/api/scan", HTTP_GET, [](AsyncWebServerRequest *request) {
+    ArenaJsonDocument doc(request);
     JsonArray networks = doc.createNestedArray("networks");
     
     int n = WiFi.scanComplete();
@@ -124,24 +229,22 @@ void setupCaptivePortal() {
       WiFi.scanNetworks(true); // Start new scan
     }
     
-    String response;
-    serializeJson(doc, response);
-    
-    AsyncWebServerResponse *apiResponse = request->beginResponse(200, "application/json", response);
+    AsyncWebServerResponse *apiResponse = beginJsonResponse(request, 200, doc);
     apiResponse->addHeader("Cache-Control", "no-cache, no-store, must-revalidate");
     apiResponse->addHeader("Pragma", "no-cache");
     apiResponse->addHeader("Expires", "0");
     request->send(apiResponse);
   });
   
-  server.on("/api/connect", HTTP_POST, [](AsyncWebServerRequest *request) {
+  apiRouter.on("/api/connect", HTTP_POST, [](AsyncWebServerRequest *request) {
+    if (request->contentLength() > REQUEST_BODY_MAX) return;  // Already answered with 413
     AsyncWebServerResponse *response = request->beginResponse(200);
     response->addHeader("Cache-Control", "no-cache, no-store, must-revalidate");
     response->addHeader("Pragma", "no-cache");
     response->addHeader("Expires", "0");
     request->send(response);
-  }, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-    DynamicJsonDocument doc(768);
+  }, NULL, collectBody(REQUEST_BODY_MAX, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+    ArenaJsonDocument doc(request);
     deserializeJson(doc, data, len);
     
     wifi_config.ssid = doc["ssid"].as<String>();
@@ -165,65 +268,26 @@ void setupCaptivePortal() {
     
     delay(1000);
     ESP.restart();
-  });
-
-  // Catch-all handler for captive portal with proper headers
-  server.onNotFound([](AsyncWebServerRequest *request) {
-    // For any unhandled request, redirect to setup page
-    AsyncWebServerResponse *response = request->beginResponse(302);
-    response->addHeader("Location", "/setup");
-    response->addHeader("Cache-Control", "no-cache, no-store, must-revalidate");
-    response->addHeader("Pragma", "no-cache");
-    response->addHeader("Expires", "0");
-    request->send(response);
-  });
-
-  server.begin();
-  
-  // Add a small delay to ensure server is fully started
-  delay(100);
+  }));
 }
 
 
 void setupWebServer() {
   // First, set up the temperature log handler
-  setupTemperatureLogHandler(server);
+  setupTemperatureLogHandler(apiRouter);
+
+  // Load ETags and gzip variants of the web assets
+  loadStaticAssetManifest();
   
   // Debug endpoint to list all registered routes
   // (Removed)
   // Debug endpoint to check SPIFFS status
   // (Removed)
   
-  server.onNotFound([](AsyncWebServerRequest *request) {
-    // For API routes, return JSON 404
-    if (request->url().startsWith("/api/")) {
-      DynamicJsonDocument doc(256);
-      doc["error"] = "Not Found";
-      doc["path"] = request->url();
-      doc["method"] = request->methodToString();
-      
-      String json;
-      serializeJson(doc, json);
-      request->send(404, "application/json", json);
-    } else {
-      // For non-API routes, serve index.html for SPA routing
-      request->send(SPIFFS, "/index.html", "text/html");
-    }
-  });
-
-  server.on("/", HTTP_GET, [](AsyncWebServerRequest *request){
-    request->send(SPIFFS, "/index.html", "text/html");
-  });
-
-  // Setup page handler
-  server.on("/setup", HTTP_GET, [](AsyncWebServerRequest *request) {
-    request->send(SPIFFS, "/setup.html", "text/html");
-  });
-
   // API endpoint to load system settings
-  server.on("/api/settings/load", HTTP_GET, [](AsyncWebServerRequest *request) {
+  apiRouter.on("/api/settings/load", HTTP_GET, [](AsyncWebServerRequest *request) {
     // Create a JSON document to hold the settings
-    DynamicJsonDocument doc(1024);
+    ArenaJsonDocument doc(request);
     
     // Add system settings
     doc["useManualTime"] = useManualTime;
@@ -264,60 +328,45 @@ void setupWebServer() {
     doc["highlightColor"] = highlightColor;
     doc["isDarkMode"] = isDarkMode;
     
-    // Serialize the JSON to a string
-    String jsonResponse;
-    serializeJson(doc, jsonResponse);
-    
     // Send the response
-    request->send(200, "application/json", jsonResponse);
+    sendJson(request, 200, doc);
   });
 
   // Time Sync Endpoint
-  server.on("/api/syncTime", HTTP_POST, [](AsyncWebServerRequest *request) {
+  apiRouter.on("/api/syncTime", HTTP_POST, [](AsyncWebServerRequest *request) {
     if (!wifiConnected) {
       request->send(400, "application/json", "{\"success\":false,\"error\":\"WiFi not connected\"}");
       return;
     }
     
-    // Call the syncTime function to sync with NTP server
+    // The sync runs in the background; clients watch timeSync.syncs in
+    // /api/status to see it complete
     syncTime();
-    
-    if (timeIsSynchronized) {
-      struct tm timeinfo;
-      if (getLocalTime(&timeinfo)) {
-        char timeStr[20];
-        strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", &timeinfo);
-        String response = "{\"success\":true,\"message\":\"Time synchronized with NTP server\",\"currentTime\":\"" + String(timeStr) + "\"}";
-        request->send(200, "application/json", response);
-      } else {
-        request->send(500, "application/json", "{\"success\":false,\"error\":\"Failed to get local time after sync\"}");
-      }
-    } else {
-      request->send(500, "application/json", "{\"success\":false,\"error\":\"Time synchronization failed\"}");
-    }
+
+    ArenaJsonDocument doc(request);
+    doc["success"] = true;
+    doc["message"] = "Time sync started";
+    doc["syncs"] = getTimeSyncStats().syncs;
+    sendJson(request, 202, doc);
   });
 
   // Temperature Log Endpoints
-  server.on("/api/log/download", HTTP_GET, [](AsyncWebServerRequest *request) {
+  apiRouter.on("/api/log/download", HTTP_GET, [](AsyncWebServerRequest *request) {
     if (!SPIFFS.exists("/temp_log.csv")) {
       request->send(404, "text/plain", "Temperature log file not found");
       return;
     }
-    
-    // Set headers for file download
-    AsyncWebServerResponse *response = request->beginResponse(SPIFFS, "/temp_log.csv", "text/csv");
-    response->addHeader("Content-Disposition", "attachment; filename=temperature_log.csv");
-    response->addHeader("Cache-Control", "no-cache");
-    request->send(response);
+
+    sendFileWithRanges(request, "/temp_log.csv", "text/csv", "temperature_log.csv");
   });
 
-  server.on("/api/log/clear", HTTP_POST, [](AsyncWebServerRequest *request) {
-    if (SPIFFS.exists("/temp_log.csv")) {
-      if (SPIFFS.remove("/temp_log.csv")) {
-        // Recreate an empty log file
-        File file = SPIFFS.open("/temp_log.csv", "w");
+  apiRouter.on("/api/log/clear", HTTP_POST, [](AsyncWebServerRequest *request) {
+    if (SPIFFS.exists(TEMP_LOG_FILE)) {
+      if (SPIFFS.remove(TEMP_LOG_FILE)) {
+        // Recreate an empty log file, with the header logTemperature() writes
+        File file = SPIFFS.open(TEMP_LOG_FILE, "w");
         if (file) {
-          file.println("timestamp,temperature,setpoint");
+          file.println(TEMP_LOG_HEADER);
           file.close();
         }
         request->send(200, "application/json", "{\"success\":true,\"message\":\"Temperature log cleared successfully\"}");
@@ -331,14 +380,13 @@ void setupWebServer() {
   });
 
   // Temperature Settings Endpoints
-  server.on("/api/settings/temperature", HTTP_GET, [](AsyncWebServerRequest *request) {
-    DynamicJsonDocument doc(256);
+  apiRouter.on("/api/settings/temperature", HTTP_GET, [](AsyncWebServerRequest *request) {
+    ArenaJsonDocument doc(request);
     doc["tempIncrement"] = temperatureIncrement;
+    doc["temperatureIncrement"] = temperatureIncrement;  // Name used by settings.html
     doc["tempResolution"] = tempResolution;
     
-    String json;
-    serializeJson(doc, json);
-    request->send(200, "application/json", json);
+    sendJson(request, 200, doc);
   });
 
 
@@ -348,22 +396,35 @@ void setupWebServer() {
 
 
   // WiFi API Endpoint
-  server.on("/api/wifi", HTTP_GET, [](AsyncWebServerRequest *request) {
-    DynamicJsonDocument doc(512);
+  apiRouter.on("/api/wifi", HTTP_GET, [](AsyncWebServerRequest *request) {
+    ArenaJsonDocument doc(request);
     
     doc["ssid"] = WiFi.SSID();
     doc["rssi"] = WiFi.RSSI();
     doc["ip"] = WiFi.localIP().toString();
     doc["mac"] = WiFi.macAddress();
     doc["status"] = WiFi.status() == WL_CONNECTED ? "connected" : "disconnected";
-    
-    String json;
-    serializeJson(doc, json);
-    request->send(200, "application/json", json);
+    doc["state"] = getWifiStateName();
+    doc["apActive"] = ap_active;
+    doc["retryInMs"] = getWifiRetryIn();
+
+    const WifiMetrics& metrics = getWifiMetrics();
+    JsonObject reconnect = doc.createNestedObject("reconnect");
+    reconnect["attempts"] = metrics.attempts;
+    reconnect["failures"] = metrics.failures;
+    reconnect["connects"] = metrics.connects;
+    reconnect["disconnects"] = metrics.disconnects;
+    reconnect["fastReconnects"] = metrics.fastReconnects;
+    reconnect["lastConnectMs"] = metrics.lastConnectMillis;
+    reconnect["lastOutageMs"] = metrics.lastOutageMillis;
+    reconnect["maxOutageMs"] = metrics.maxOutageMillis;
+    reconnect["lastDisconnectReason"] = metrics.lastDisconnectReason;
+    
+    sendJson(request, 200, doc);
   });
 
   // Handle WiFi settings update
-  server.on("/api/wifi", HTTP_POST, [](AsyncWebServerRequest *request) {
+  apiRouter.on("/api/wifi", HTTP_POST, [](AsyncWebServerRequest *request) {
     // Check if the request has a body
     if (request->hasParam("ssid", true) && request->hasParam("password", true)) {
       String ssid = request->getParam("ssid", true)->value();
@@ -380,24 +441,146 @@ void setupWebServer() {
       connectToWifi();
       
       // Return success response
-      DynamicJsonDocument doc(256);
+      ArenaJsonDocument doc(request);
       doc["success"] = true;
       doc["message"] = "WiFi settings updated. Attempting to connect...";
       
-      String json;
-      serializeJson(doc, json);
-      request->send(200, "application/json", json);
+      sendJson(request, 200, doc);
     } else {
       // Return error if required parameters are missing
       request->send(400, "application/json", "{\"success\":false,\"error\":\"Missing required parameters (ssid, password)\"}");
     }
   });
 
+  // MQTT telemetry settings and queue state (mqtt_telemetry.h)
+  apiRouter.on("/api/mqtt", HTTP_GET, [](AsyncWebServerRequest *request) {
+    ArenaJsonDocument doc(request);
+
+    const MqttSettings& settings = getMqttSettings();
+    doc["enabled"] = settings.enabled;
+    doc["uri"] = settings.uri;
+    doc["username"] = settings.username;
+    doc["hasPassword"] = settings.password.length() > 0;
+    doc["topic"] = settings.topic;
+    doc["sampleSeconds"] = settings.sampleSeconds;
+    doc["batchSize"] = settings.batchSize;
+
+    MqttStats stats = getMqttStats();
+    doc["connected"] = stats.connected;
+    JsonObject queue = doc.createNestedObject("queue");
+    queue["ram"] = stats.queued;
+    queue["flash"] = stats.spilled;
+    queue["inFlight"] = stats.inFlight;
+    queue["published"] = stats.published;
+    queue["resent"] = stats.resent;
+    queue["dropped"] = stats.dropped;
+    doc["commands"] = stats.commands;
+    doc["connects"] = stats.connects;
+
+    sendJson(request, 200, doc);
+  });
+
+  // Fields left out keep their current value; the password is only
+  // replaced when "password" is sent
+  apiRouter.on("/api/mqtt", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL, collectBody(REQUEST_BODY_MAX, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+    ArenaJsonDocument doc(request);
+    if (deserializeJson(doc, data, len)) {
+      request->send(400, "application/json", "{\"success\":false,\"error\":\"Invalid JSON\"}");
+      return;
+    }
+
+    MqttSettings settings = getMqttSettings();
+    if (doc.containsKey("enabled")) settings.enabled = doc["enabled"].as<bool>();
+    if (doc.containsKey("uri")) settings.uri = doc["uri"].as<String>();
+    if (doc.containsKey("username")) settings.username = doc["username"].as<String>();
+    if (doc.containsKey("password")) settings.password = doc["password"].as<String>();
+    if (doc.containsKey("topic")) settings.topic = doc["topic"].as<String>();
+    if (doc.containsKey("sampleSeconds")) settings.sampleSeconds = doc["sampleSeconds"].as<uint16_t>();
+    if (doc.containsKey("batchSize")) settings.batchSize = doc["batchSize"].as<uint8_t>();
+
+    String error;
+    ArenaJsonDocument responseDoc(request);
+    bool saved = saveMqttSettings(settings, error);
+    responseDoc["success"] = saved;
+    if (!saved) responseDoc["error"] = error;
+    sendJson(request, saved ? 200 : 400, responseDoc);
+  }));
+
+  // Energy used per firing, per program and in total (energy_meter.h)
+  apiRouter.on("/api/energy", HTTP_GET, [](AsyncWebServerRequest *request) {
+    ArenaJsonDocument doc(request);
+
+    const EnergySettings& settings = getEnergySettings();
+    EnergySnapshot energy = getEnergySnapshot();
+    doc["elementWatts"] = settings.elementWatts;
+    doc["costPerKWh"] = settings.costPerKWh;
+    doc["relayOn"] = energy.relayOn;
+    doc["checkpointAgeSeconds"] = energy.checkpointAgeMillis / 1000;
+
+    JsonObject firing = doc.createNestedObject("firing");
+    firing["active"] = energy.firingActive;
+    firing["program"] = energy.firingProgram;
+    if (energy.firingProgram >= 0 && energy.firingProgram < MAX_PROGRAMS) {
+      firing["programName"] = programNames[energy.firingProgram];
+    }
+    firing["started"] = energy.firingStartUnix;
+    firing["kWh"] = energyKWh(energy.firing);
+    firing["onSeconds"] = (uint32_t)(energy.firing.onMillis / 1000);
+    firing["cost"] = energyKWh(energy.firing) * settings.costPerKWh;
+
+    JsonObject lifetime = doc.createNestedObject("lifetime");
+    lifetime["firings"] = energy.firings;
+    lifetime["kWh"] = energyKWh(energy.lifetime);
+    lifetime["onSeconds"] = (uint32_t)(energy.lifetime.onMillis / 1000);
+    lifetime["cost"] = energyKWh(energy.lifetime) * settings.costPerKWh;
+
+    JsonArray programs = doc.createNestedArray("programs");
+    for (int i = 0; i < MAX_PROGRAMS; i++) {
+      if (energy.programs[i].onMillis == 0) continue;
+      JsonObject entry = programs.createNestedObject();
+      entry["index"] = i;
+      entry["name"] = programNames[i];
+      entry["kWh"] = energyKWh(energy.programs[i]);
+      entry["onSeconds"] = (uint32_t)(energy.programs[i].onMillis / 1000);
+      entry["cost"] = energyKWh(energy.programs[i]) * settings.costPerKWh;
+    }
+
+    sendJson(request, 200, doc);
+  });
+
+  // Settings fields left out keep their value; "reset" zeroes "firing",
+  // "programs" or "lifetime"
+  apiRouter.on("/api/energy", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL, collectBody(REQUEST_BODY_MAX, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+    ArenaJsonDocument doc(request);
+    if (deserializeJson(doc, data, len)) {
+      request->send(400, "application/json", "{\"success\":false,\"error\":\"Invalid JSON\"}");
+      return;
+    }
+
+    String error;
+    bool ok = true;
+    if (doc.containsKey("elementWatts") || doc.containsKey("costPerKWh")) {
+      EnergySettings settings = getEnergySettings();
+      if (doc.containsKey("elementWatts")) settings.elementWatts = doc["elementWatts"].as<float>();
+      if (doc.containsKey("costPerKWh")) settings.costPerKWh = doc["costPerKWh"].as<float>();
+      ok = saveEnergySettings(settings, error);
+    }
+    if (ok && doc.containsKey("reset")) {
+      ok = resetEnergyCounters(doc["reset"].as<String>());
+      if (!ok) error = "reset must be firing, programs or lifetime";
+    }
+
+    ArenaJsonDocument responseDoc(request);
+    responseDoc["success"] = ok;
+    if (!ok) responseDoc["error"] = error;
+    sendJson(request, ok ? 200 : 400, responseDoc);
+  }));
+
   // System Logs API Endpoint
-  server.on("/api/log", HTTP_GET, [](AsyncWebServerRequest *request) {
+  apiRouter.on("/api/log", HTTP_GET, [](AsyncWebServerRequest *request) {
     // In a real implementation, you would read logs from a file or buffer
     // For now, we'll return a sample response
-    DynamicJsonDocument doc(1024);
+    ArenaJsonDocument doc(request);
     JsonArray logs = doc.createNestedArray("logs");
     
     // Add sample log entry
@@ -406,25 +589,13 @@ void setupWebServer() {
     logEntry["level"] = "info";
     logEntry["message"] = "System started";
     
-    String json;
-    serializeJson(doc, json);
-    request->send(200, "application/json", json);
+    sendJson(request, 200, doc);
   });
 
-  // Temperature Settings Endpoints
-  server.on("/api/settings/temperature", HTTP_GET, [](AsyncWebServerRequest *request) {
-    DynamicJsonDocument doc(256);
-    doc["tempIncrement"] = temperatureIncrement;
-    doc["tempResolution"] = tempResolution;
-    
-    String json;
-    serializeJson(doc, json);
-    request->send(200, "application/json", json);
-  });
 
   // Lite Status API Endpoint - Minimal data for frequent updates
-  server.on("/api/status/lite", HTTP_GET, [](AsyncWebServerRequest *request) {
-    DynamicJsonDocument doc(200); // Slightly larger buffer to include smoothing data
+  apiRouter.on("/api/status/lite", HTTP_GET, [](AsyncWebServerRequest *request) {
+    ArenaJsonDocument doc(request);
     
     // Only include frequently changing essential data
     doc["currentTemp"] = currentTemp;
@@ -439,14 +610,12 @@ void setupWebServer() {
       doc["smoothedTargetTemp"] = getSmoothedTargetTemperature();
     }
     
-    String json;
-    serializeJson(doc, json);
-    request->send(200, "application/json", json);
+    sendJson(request, 200, doc);
   });
 
   // Controls Status API Endpoint
-  server.on("/api/controls/status", HTTP_GET, [](AsyncWebServerRequest *request) {
-    DynamicJsonDocument doc(512);
+  apiRouter.on("/api/controls/status", HTTP_GET, [](AsyncWebServerRequest *request) {
+    ArenaJsonDocument doc(request);
     
     // Control Status
     doc["systemEnabled"] = systemEnabled;
@@ -462,45 +631,63 @@ void setupWebServer() {
     doc["relayStatus"] = digitalRead(RELAY_PIN) == HIGH ? "ON" : "OFF";
     #endif
     
-    String json;
-    serializeJson(doc, json);
-    request->send(200, "application/json", json);
+    sendJson(request, 200, doc);
   });
 
   // Get All Programs API Endpoint
-  server.on("/api/programs", HTTP_GET, [](AsyncWebServerRequest *request) {
-    DynamicJsonDocument doc(4096); // May need adjustment based on program count
+  apiRouter.on("/api/programs", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (wantsBinaryPrograms(request)) {
+      String etag = apiResourceEtag(API_RESOURCE_PROGRAMS, "bin");
+      if (sendIfNotModified(request, etag)) return;
+
+      size_t length;
+      uint8_t* blob = encodeAllPrograms(length);
+      if (blob == NULL) {
+        request->send(500, "application/json", "{\"error\":\"Failed to encode programs\"}");
+        return;
+      }
+      AsyncResponseStream *response = request->beginResponseStream(PROGRAM_CODEC_CONTENT_TYPE);
+      response->addHeader("ETag", etag);
+      response->addHeader("Cache-Control", "no-cache");
+      response->write(blob, length);
+      free(blob);
+      request->send(response);
+      return;
+    }
+
+    String etag = apiResourceEtag(API_RESOURCE_PROGRAMS);
+    if (serveFromApiCache(request, API_RESOURCE_PROGRAMS, etag)) return;
+
+    ArenaJsonDocument doc(request);
     JsonArray programs = doc.createNestedArray("programs");
     
+    ProgramStoreLock lock;
     for (int i = 0; i < MAX_PROGRAMS; i++) {
       if (programNames[i].length() > 0) {
         JsonObject program = programs.createNestedObject();
         program["id"] = i;
         program["name"] = programNames[i];
         // Add temperature points for this program
+        ensureProgramLoaded(i);
         JsonArray temps = program.createNestedArray("temperatures");
-        for (int j = 0; j < 96; j++) { // Assuming 96 points (15-min intervals for 24h)
+        for (int j = 0; j < maxTempPoints; j++) {
           temps.add(programTemps[i][j]);
         }
       }
     }
     
-    String json;
-    serializeJson(doc, json);
-    request->send(200, "application/json", json);
+    sendAndCacheJson(request, API_RESOURCE_PROGRAMS, etag, doc);
   });
 
   // Enhanced Load Program API Endpoint
-  server.on("/api/loadProgram", HTTP_GET, [](AsyncWebServerRequest *request) {
-    DynamicJsonDocument responseDoc(512);
+  apiRouter.on("/api/loadProgram", HTTP_GET, [](AsyncWebServerRequest *request) {
+    ArenaJsonDocument responseDoc(request);
     
     // Validate program ID parameter
     if (!request->hasParam("id")) {
       responseDoc["success"] = false;
       responseDoc["error"] = "Missing required parameter: id";
-      String json;
-      serializeJson(responseDoc, json);
-      request->send(400, "application/json", json);
+      sendJson(request, 400, responseDoc);
       return;
     }
     
@@ -511,9 +698,7 @@ void setupWebServer() {
     if (programId < 0 || programId >= MAX_PROGRAMS) {
       responseDoc["success"] = false;
       responseDoc["error"] = "Program ID out of range (0-" + String(MAX_PROGRAMS - 1) + ")";
-      String json;
-      serializeJson(responseDoc, json);
-      request->send(400, "application/json", json);
+      sendJson(request, 400, responseDoc);
       return;
     }
     
@@ -521,13 +706,13 @@ void setupWebServer() {
     if (programNames[programId].length() == 0) {
       responseDoc["success"] = false;
       responseDoc["error"] = "Program slot " + String(programId) + " is empty";
-      String json;
-      serializeJson(responseDoc, json);
-      request->send(404, "application/json", json);
+      sendJson(request, 404, responseDoc);
       return;
     }
     
     // Validate program has meaningful temperature data (using same logic as TFT)
+    ProgramStoreLock lock;
+    ensureProgramLoaded(programId);
     int firstNonZero = 0;
     while (firstNonZero < maxTempPoints && programTemps[programId][firstNonZero] == 0.0f) firstNonZero++;
     int lastNonZero = maxTempPoints - 1;
@@ -538,9 +723,7 @@ void setupWebServer() {
     if (progLen <= 1) {
       responseDoc["success"] = false;
       responseDoc["error"] = "Program '" + programNames[programId] + "' has no valid temperature data";
-      String json;
-      serializeJson(responseDoc, json);
-      request->send(422, "application/json", json); // Unprocessable Entity
+      sendJson(request, 422, responseDoc); // Unprocessable Entity
       return;
     }
     
@@ -551,9 +734,7 @@ void setupWebServer() {
       if (offset < 0 || offset >= maxTempPoints) {
         responseDoc["success"] = false;
         responseDoc["error"] = "Offset out of range (0-" + String(maxTempPoints - 1) + ")";
-        String json;
-        serializeJson(responseDoc, json);
-        request->send(400, "application/json", json);
+        sendJson(request, 400, responseDoc);
         return;
       }
     }
@@ -618,26 +799,22 @@ void setupWebServer() {
       responseDoc["estimatedStartTime"] = String(startHour) + ":" + (startMinute < 10 ? "0" : "") + String(startMinute);
     }
     
-    String json;
-    serializeJson(responseDoc, json);
-    request->send(200, "application/json", json);
+    sendJson(request, 200, responseDoc);
   });
 
   // PWM API ENDPOINTS
-  server.on("/api/pwm", HTTP_GET, [](AsyncWebServerRequest *request) {
-    DynamicJsonDocument doc(128);
+  apiRouter.on("/api/pwm", HTTP_GET, [](AsyncWebServerRequest *request) {
+    ArenaJsonDocument doc(request);
     doc["enabled"] = pwmEnabled;
     doc["frequency"] = pwmFrequency;
-    String json;
-    serializeJson(doc, json);
-    request->send(200, "application/json", json);
+    sendJson(request, 200, doc);
   });
   
-  server.on("/api/pwm", HTTP_POST, 
+  apiRouter.on("/api/pwm", HTTP_POST, 
     [](AsyncWebServerRequest *request) {},
     NULL,
-    [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-      DynamicJsonDocument doc(128);
+    collectBody(REQUEST_BODY_MAX, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+      ArenaJsonDocument doc(request);
       if (deserializeJson(doc, data, len)) {
         request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
         return;
@@ -667,11 +844,11 @@ void setupWebServer() {
       } else {
         request->send(400, "application/json", "{\"success\":false,\"error\":\"No valid fields provided\"}");
       }
-    }
+    })
   );
 
   // Temperature Smoothing API ENDPOINT
-  server.on("/api/smoothing", HTTP_POST, [](AsyncWebServerRequest *request) {
+  apiRouter.on("/api/smoothing", HTTP_POST, [](AsyncWebServerRequest *request) {
     // Toggle smoothing state
     temperatureSmoothingEnabled = !temperatureSmoothingEnabled;
     saveWifiConfig();
@@ -680,11 +857,11 @@ void setupWebServer() {
   });
 
   // Logging Settings API ENDPOINT
-  server.on("/api/settings/logging", HTTP_POST, 
+  apiRouter.on("/api/settings/logging", HTTP_POST, 
     [](AsyncWebServerRequest *request) {},
     NULL,
-    [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-      DynamicJsonDocument doc(256);
+    collectBody(REQUEST_BODY_MAX, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+      ArenaJsonDocument doc(request);
       if (deserializeJson(doc, data, len)) {
         request->send(400, "application/json", "{\"success\":false,\"error\":\"Invalid JSON\"}");
         return;
@@ -719,19 +896,22 @@ void setupWebServer() {
       } else {
         request->send(400, "application/json", "{\"success\":false,\"error\":\"No valid fields provided\"}");
       }
-    }
+    })
   );
 
   // Theme API endpoints
-  server.on("/api/theme", HTTP_GET, [](AsyncWebServerRequest *request) {
-    DynamicJsonDocument responseDoc(2048);
+  apiRouter.on("/api/theme", HTTP_GET, [](AsyncWebServerRequest *request) {
+    String etag = apiResourceEtag(API_RESOURCE_THEME);
+    if (serveFromApiCache(request, API_RESOURCE_THEME, etag)) return;
+
+    ArenaJsonDocument responseDoc(request);
     bool success = false;
     String currentMode = "light"; // Default mode
 
     if (SPIFFS.exists("/wifi_config.json")) {
       File configFile = SPIFFS.open("/wifi_config.json", "r");
       if (configFile) {
-        DynamicJsonDocument configDoc(4096);
+        ArenaJsonDocument configDoc(request);
         DeserializationError error = deserializeJson(configDoc, configFile);
         configFile.close();
 
@@ -775,20 +955,16 @@ void setupWebServer() {
     // Always include current mode in response
     responseDoc["currentMode"] = currentMode;
 
-    String jsonResponse;
-    serializeJson(responseDoc, jsonResponse);
-    request->send(200, "application/json", jsonResponse);
+    sendAndCacheJson(request, API_RESOURCE_THEME, etag, responseDoc);
   });
 
-  server.on("/api/theme", HTTP_POST, [](AsyncWebServerRequest *request) {
+  apiRouter.on("/api/theme", HTTP_POST, [](AsyncWebServerRequest *request) {
+    if (request->contentLength() > REQUEST_BODY_MAX_THEME) return;  // Already answered with 413
     // Send immediate response to prevent watchdog timeout
     request->send(200, "application/json", "{\"success\":true,\"message\":\"Theme save initiated\"}");
-  }, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-    // Only process when we have the complete payload
-    if (index + len != total) return;
-    
+  }, NULL, collectBody(REQUEST_BODY_MAX_THEME, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
     // Parse the JSON data quickly
-    DynamicJsonDocument doc(2048);
+    ArenaJsonDocument doc(request);
     DeserializationError error = deserializeJson(doc, data, len);
 
     if (error) {
@@ -806,27 +982,14 @@ void setupWebServer() {
     extern String pendingThemeJson;
     pendingThemeSave = true;
     pendingThemeJson = pendingThemeData;
-  });
-
+  }));
 
 
-  // Temperature settings endpoints
-  server.on("/api/settings/temperature", HTTP_GET, [](AsyncWebServerRequest *request) {
-    DynamicJsonDocument doc(256);
-    
-    // Add current temperature settings to the response
-    doc["temperatureIncrement"] = temperatureIncrement;
-    doc["tempResolution"] = String(tempResolution, 1); // Format to 1 decimal place
-    
-    String jsonResponse;
-    serializeJson(doc, jsonResponse);
-    request->send(200, "application/json", jsonResponse);
-  });
 
-  server.on("/api/settings/temperature", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL, 
-    [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+  apiRouter.on("/api/settings/temperature", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL, 
+    collectBody(REQUEST_BODY_MAX, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
     // Parse the JSON data from the received chunk
-    DynamicJsonDocument doc(256);
+    ArenaJsonDocument doc(request);
     DeserializationError error = deserializeJson(doc, data, len);
 
     if (error) {
@@ -870,69 +1033,55 @@ void setupWebServer() {
     } else {
         request->send(200, "application/json", "{\"success\":true,\"message\":\"No changes detected\"}");
     }
-  });
-
-  // Serve static files
-  server.serveStatic("/js/", SPIFFS, "/js/").setCacheControl("max-age=31536000");
-  server.serveStatic("/css/", SPIFFS, "/css/").setCacheControl("max-age=31536000");
-  server.serveStatic("/favicon.ico", SPIFFS, "/favicon.ico").setCacheControl("max-age=31536000");
-  server.serveStatic("/", SPIFFS, "/").setDefaultFile("index.html").setCacheControl("no-cache, no-store, must-revalidate");
-  
-  server.on("/settings", HTTP_GET, [](AsyncWebServerRequest *request) {
-    request->send(SPIFFS, "/settings.html", "text/html");
-  });
-  
-  server.on("/programs", HTTP_GET, [](AsyncWebServerRequest *request) {
-    request->send(SPIFFS, "/programs.html", "text/html");
-  });
-  
-  server.on("/filemanager", HTTP_GET, [](AsyncWebServerRequest *request) {
-    request->send(SPIFFS, "/filemanager.html", "text/html");
-  });
-
-  server.on("/filemanager", HTTP_GET, [](AsyncWebServerRequest *request) {
-    request->send(SPIFFS, "/filemanager.html", "text/html");
-  });
+  }));
 
-  server.on("/api/list", HTTP_GET, [](AsyncWebServerRequest *request) {
+  apiRouter.on("/api/list", HTTP_GET, [](AsyncWebServerRequest *request) {
     String path = request->hasParam("path") ? request->getParam("path")->value() : "/";
     
     if (!path.startsWith("/")) { path = "/" + path; }
     if (path != "/" && path.endsWith("/")) { path.remove(path.length() - 1); }
+    String prefix = (path == "/") ? path : path + "/";
 
     File root = SPIFFS.open("/");
     if (!root) {
       return request->send(500, "text/plain", "SPIFFS error");
     }
 
-    DynamicJsonDocument uniqueChildren(2048);
-    JsonObject children = uniqueChildren.to<JsonObject>();
+    // SPIFFS is flat: folders only exist as path prefixes. One pass over
+    // the entries takes each file's size and date from the handle already
+    // open; a folder totals the files below it and keeps the newest date.
+    ArenaJsonDocument doc(request);
+    JsonArray files = doc.to<JsonArray>();
 
     File file = root.openNextFile();
     while (file) {
         String itemPath = String(file.path());
         
-        if (itemPath.startsWith(path)) {
-            String relativePath;
-            if (path == "/") {
-                if (itemPath.length() > 1) { relativePath = itemPath.substring(1); } 
-                else { relativePath = ""; }
-            } else {
-                if (itemPath.length() > path.length() && itemPath.charAt(path.length()) == '/') {
-                    relativePath = itemPath.substring(path.length() + 1);
-                } else {
-                    relativePath = "";
+        if (itemPath.length() > prefix.length() && itemPath.startsWith(prefix)) {
+            int slash = itemPath.indexOf('/', prefix.length());
+            bool isFolder = slash >= 0;
+            String childName = itemPath.substring(prefix.length(), isFolder ? slash : itemPath.length());
+
+            if (childName.length() > 0 && !childName.startsWith(".")) {
+                JsonObject entry;
+                for (JsonObject existing : files) {
+                    if (childName == existing["name"].as<const char*>()) {
+                        entry = existing;
+                        break;
+                    }
+                }
+                if (entry.isNull()) {
+                    entry = files.createNestedObject();
+                    entry["name"] = childName;
+                    entry["type"] = isFolder ? "folder" : "file";
+                    entry["size"] = 0;
+                    entry["date"] = 0;
                 }
-            }
-
-            if (relativePath.length() > 0) {
-                int firstSlash = relativePath.indexOf('/');
-                String childName = (firstSlash == -1) ? relativePath : relativePath.substring(0, firstSlash);
 
-                if (childName.length() > 0 && !childName.startsWith(".")) {
-                    if(!children.containsKey(childName)){
-                      children[childName] = true;
-                    }
+                time_t written = file.getLastWrite();
+                entry["size"] = entry["size"].as<size_t>() + file.size();
+                if (written > entry["date"].as<time_t>()) {
+                    entry["date"] = written;
                 }
             }
         }
@@ -941,43 +1090,22 @@ void setupWebServer() {
     }
     root.close();
 
-    DynamicJsonDocument doc(4096);
-    JsonArray files = doc.to<JsonArray>();
-    for (JsonPair kv : children) {
-        String childName = kv.key().c_str();
-        String fullChildPath = (path == "/") ? "/" + childName : path + "/" + childName;
-        
-        File entry = SPIFFS.open(fullChildPath);
-        if (entry) {
-            JsonObject f = files.createNestedObject();
-            f["name"] = childName;
-            f["type"] = entry.isDirectory() ? "folder" : "file";
-            f["size"] = entry.size();
-            f["date"] = entry.getLastWrite();
-            entry.close();
-        }
-    }
-
-    String response;
-    serializeJson(doc, response);
-    request->send(200, "application/json", response);
+    sendJson(request, 200, doc);
   });
 
-  server.on("/api/file", HTTP_GET, [](AsyncWebServerRequest *request) {
+  apiRouter.on("/api/file", HTTP_GET, [](AsyncWebServerRequest *request) {
     if (!request->hasParam("path")) return request->send(400, "text/plain", "Missing path");
     String p = request->getParam("path")->value();
-    if (!SPIFFS.exists(p)) return request->send(404, "text/plain", "File not found");
-    request->send(SPIFFS, p, "text/plain");
+    sendFileWithRanges(request, p, "text/plain");
   });
 
-  server.on("/api/download", HTTP_GET, [](AsyncWebServerRequest *request) {
+  apiRouter.on("/api/download", HTTP_GET, [](AsyncWebServerRequest *request) {
     if (!request->hasParam("path")) return request->send(400, "text/plain", "Missing path");
     String p = request->getParam("path")->value();
-    if (!SPIFFS.exists(p)) return request->send(404, "text/plain", "File not found");
-    request->send(SPIFFS, p, "application/octet-stream", true);
+    sendFileWithRanges(request, p, "application/octet-stream", p.substring(p.lastIndexOf('/') + 1).c_str());
   });
 
-  server.on("/api/delete", HTTP_POST, [](AsyncWebServerRequest *request) {
+  apiRouter.on("/api/delete", HTTP_POST, [](AsyncWebServerRequest *request) {
     if (!request->hasParam("path", true)) {
       return request->send(400, "application/json", "{\"success\":false, \"error\":\"Missing path parameter\"}");
     }
@@ -992,6 +1120,8 @@ void setupWebServer() {
     }
 
     bool success = deleteRecursive(path);
+    invalidateStaticAsset(path);
+    bumpAllApiGenerations();  // The file may have been the theme or a program
 
     if (success) {
       request->send(200, "application/json", "{\"success\":true, \"message\":\"Deleted successfully\"}");
@@ -1000,130 +1130,194 @@ void setupWebServer() {
     }
   });
 
-  server.on("/api/create", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL, 
-    [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+  apiRouter.on("/api/create", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL, 
+    collectBody(REQUEST_BODY_MAX, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
     if (index == 0) {
-      DynamicJsonDocument doc(256);
+      ArenaJsonDocument doc(request);
       if (deserializeJson(doc, data, len)) return request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
       String p = doc["path"];
       if (p.isEmpty()) return request->send(400, "application/json", "{\"error\":\"Missing path\"}");
       if (SPIFFS.mkdir(p)) request->send(200, "application/json", "{\"success\":true}");
       else request->send(500, "application/json", "{\"error\":\"Failed to create directory\"}");
     }
-  });
+  }));
 
-  server.on("/api/edit", HTTP_POST, [](AsyncWebServerRequest *request) {
+  apiRouter.on("/api/edit", HTTP_POST, [](AsyncWebServerRequest *request) {
     request->send(200, "application/json", "{\"success\":true}");
   }, [](AsyncWebServerRequest *request, const String& filename, size_t index, uint8_t *data, size_t len, bool final) {
     String p;
     if (request->hasParam("path")) p = request->getParam("path")->value();
     else return;
-    if (!index) request->_tempFile = SPIFFS.open(p, "w");
+    if (!index) {
+      invalidateStaticAsset(p);
+      request->_tempFile = SPIFFS.open(p, "w");
+    }
     if (len) request->_tempFile.write(data, len);
-    if (final) request->_tempFile.close();
+    if (final) {
+      request->_tempFile.close();
+      bumpAllApiGenerations();
+    }
   });
 
-  server.on("/api/upload", HTTP_POST, [](AsyncWebServerRequest *request) {
+  apiRouter.on("/api/upload", HTTP_POST, [](AsyncWebServerRequest *request) {
     request->send(200, "application/json", "{\"success\":true, \"message\":\"Upload complete\"}");
   }, [](AsyncWebServerRequest *request, const String& filename, size_t index, uint8_t *data, size_t len, bool final) {
     String p = "/";
     if (request->hasParam("path", true)) p = request->getParam("path", true)->value();
     if (!p.endsWith("/")) p += "/";
     String fp = p + filename;
-    if (!index) request->_tempFile = SPIFFS.open(fp, "w");
+    if (!index) {
+      invalidateStaticAsset(fp);
+      request->_tempFile = SPIFFS.open(fp, "w");
+    }
     if (len) request->_tempFile.write(data, len);
-    if (final) request->_tempFile.close();
+    if (final) {
+      request->_tempFile.close();
+      bumpAllApiGenerations();
+    }
   });
 
-  server.serveStatic("/", SPIFFS, "/");
-
   // Configure CORS for all API endpoints at the beginning
   DefaultHeaders::Instance().addHeader("Access-Control-Allow-Origin", "*");
-  DefaultHeaders::Instance().addHeader("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
+  DefaultHeaders::Instance().addHeader("Access-Control-Allow-Methods", "GET, POST, PATCH, OPTIONS");
   DefaultHeaders::Instance().addHeader("Access-Control-Allow-Headers", "Content-Type");
 
   // Handle preflight requests - must be before any other route handlers
   server.on("*", HTTP_OPTIONS, [](AsyncWebServerRequest *request) {
     AsyncWebServerResponse *response = request->beginResponse(204);
-    response->addHeader("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
+    response->addHeader("Access-Control-Allow-Methods", "GET, POST, PATCH, OPTIONS");
     response->addHeader("Access-Control-Allow-Headers", "Content-Type");
     response->addHeader("Access-Control-Max-Age", "86400");
     request->send(response);
   });
 
-  // Serve static files from SPIFFS - must be before the catch-all route
-  server.serveStatic("/", SPIFFS, "/");
-
-  // Enhanced not found handler with better error reporting - must be the last route
+  // Not found handler - /api/ and GET requests never get here, other
+  // methods on page URLs get index.html for SPA routing
   server.onNotFound([](AsyncWebServerRequest *request) {
-    if (request->url().startsWith("/api/")) {
-      // For API requests, return JSON error
-      DynamicJsonDocument doc(256);
-      doc["error"] = "Not Found";
-      doc["path"] = request->url();
-      doc["method"] = request->methodToString();
-      
-      String json;
-      serializeJson(doc, json);
-      request->send(404, "application/json", json);
-    } else {
-      // For non-API requests, serve index.html for SPA routing
-      request->send(SPIFFS, "/index.html", "text/html");
+    if (!sendStaticAsset(request, "/index.html")) {
+      request->send(404, "text/plain", "Not Found");
     }
   });
   
-  // Add debug endpoint to list all registered routes
-  server.on("/api/debug/routes", HTTP_GET, [](AsyncWebServerRequest *request) {
-    DynamicJsonDocument doc(1024);
-    doc["status"] = "success";
-    doc["message"] = "Route debugging endpoint";
-    doc["endpoints"] = "[/api/status, /api/controls/status, /api/programs, /api/loadProgram, etc.]";
-    
-    String json;
-    serializeJson(doc, json);
-    request->send(200, "application/json", json);
+  // Binary dump of the control trace ring (trace_ring.h)
+  apiRouter.on("/api/trace", HTTP_GET, handleTraceRequest);
+
+  // Debug endpoint listing the API dispatch table
+  apiRouter.on("/api/debug/routes", HTTP_GET, handleApiRoutesRequest);
+
+  // Heap fragmentation and JSON arena usage, for verifying long-run heap health
+  apiRouter.on("/api/debug/heap", HTTP_GET, handleApiHeapRequest);
+
+  // Scoped-timer figures for loop() and TFT stages (profiler.h) next to the
+  // router's per-handler timing. ?reset=1 zeroes the timers after reading;
+  // sites are read while loop() updates them, so figures are approximate.
+  apiRouter.on("/api/debug/profile", HTTP_GET, [](AsyncWebServerRequest *request) {
+    ArenaJsonDocument doc(request);
+#ifdef PROFILE_ENABLED
+    doc["enabled"] = true;
+#else
+    doc["enabled"] = false;
+#endif
+    doc["cpuMHz"] = ESP.getCpuFreqMHz();
+
+    JsonArray sites = doc.createNestedArray("sites");
+    for (const ProfileSite* site : getProfileSitesBySlowest()) {
+      JsonObject entry = sites.createNestedObject();
+      entry["name"] = site->name;
+      entry["count"] = site->count;
+      entry["avgUs"] = site->count > 0 ? profileCyclesToMicros(site->totalCycles / site->count) : 0;
+      entry["p50Us"] = profilePercentileMicros(*site, 50);
+      entry["p99Us"] = profilePercentileMicros(*site, 99);
+      entry["maxUs"] = profileCyclesToMicros(site->maxCycles);
+      entry["totalMs"] = profileCyclesToMicros(site->totalCycles) / 1000.0;
+    }
+
+    JsonArray handlers = doc.createNestedArray("handlers");
+    for (int i = 0; i < apiRouter.getRouteCount(); i++) {
+      const ApiRoute& route = apiRouter.getRoute(i);
+      uint32_t calls = ApiRouter::getCallCount(route);
+      if (calls == 0) continue;
+      JsonObject entry = handlers.createNestedObject();
+      entry["name"] = String(ApiRouter::methodName(route.method)) + " " + route.path;
+      entry["count"] = calls;
+      entry["avgUs"] = (uint32_t)(route.handlerMicros / calls);
+      entry["p99Us"] = ApiRouter::latencyPercentile(route, 99);
+      entry["maxUs"] = route.maxHandlerMicros;
+    }
+
+    AsyncWebServerResponse *response = beginJsonResponse(request, 200, doc);
+    response->addHeader("Cache-Control", "no-store");
+    request->send(response);
+
+    if (request->hasParam("reset")) {
+      resetProfile();
+    }
+  });
+
+  // Control accuracy, CPU per control tick and memory low-water marks
+  // (furnace_sim.h); ?reset=1 starts a new measurement after reading
+  apiRouter.on("/api/debug/control", HTTP_GET, handleControlBenchmarkRequest);
+
+  // Control benchmark suite (control_benchmark.h): POST starts it while the
+  // system is disabled, GET returns progress and then the report
+  apiRouter.on("/api/debug/benchmark", HTTP_GET, [](AsyncWebServerRequest *request) {
+    ArenaJsonDocument doc(request);
+    writeControlBenchmarkReport(doc);
+    AsyncWebServerResponse *response = beginJsonResponse(request, 200, doc);
+    response->addHeader("Cache-Control", "no-store");
+    request->send(response);
   });
 
+  apiRouter.on("/api/debug/benchmark", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL, collectBody(REQUEST_BODY_MAX, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+    ArenaJsonDocument doc(request);
+    if (deserializeJson(doc, data, len)) {
+      request->send(400, "application/json", "{\"success\":false,\"error\":\"Invalid JSON\"}");
+      return;
+    }
+
+    String error;
+    int status = stageControlBenchmark(doc, error);
+    ArenaJsonDocument responseDoc(request);
+    responseDoc["success"] = status == 200;
+    if (status != 200) responseDoc["error"] = error;
+    sendJson(request, status, responseDoc);
+  }));
+
   // Toggle system power
-  server.on("/api/toggleSystem", HTTP_POST, [](AsyncWebServerRequest *request) {
+  apiRouter.on("/api/toggleSystem", HTTP_POST, [](AsyncWebServerRequest *request) {
     systemEnabled = !systemEnabled;
 
     // Handle system state change
     if (!systemEnabled) {
       // When turning off, ensure furnace is off
-      furnaceStatus = false;
-      digitalWrite(RELAY_PIN, LOW);
+      stopHeating();
     } else {
       // When turning on, let the main loop handle furnace control
       // The controlFurnace() function will handle the relay state
     }
 
     // Return the new state
-    DynamicJsonDocument doc(128);
+    ArenaJsonDocument doc(request);
     doc["success"] = true;
     doc["systemEnabled"] = systemEnabled;
     doc["enabled"] = systemEnabled;  // Include both for compatibility
-    String json;
-    serializeJson(doc, json);
-    
-    request->send(200, "application/json", json);
+    sendJson(request, 200, doc);
   });
 
   // Endpoint to update temperature resolution (points per hour)
-  server.on(
+  apiRouter.on(
     "/api/updateResolution",
     HTTP_POST,
     [](AsyncWebServerRequest *request) {
       // onRequest handler (required, but not used for body POST)
     },
     NULL,
-    [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-      DynamicJsonDocument doc(256);
+    collectBody(REQUEST_BODY_MAX, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+      ArenaJsonDocument doc(request);
       deserializeJson(doc, data, len);
       int newResolution = doc["resolution"].as<int>();
       if (newResolution == 1 || newResolution == 2 || newResolution == 4 || newResolution == 6 || newResolution == 12) {
         tempResolution = newResolution;
-        maxTempPoints = 24 * tempResolution;
         initializeTemperatureArrays(); // Ensure arrays are reallocated and populated
         // If you have profile names logic, reset as in V24 if needed.
         // Example: for (int i = 0; i < MAX_PROGRAMS; i++) programNames[i] = (i == 0 ? "Default" : "");
@@ -1135,12 +1329,15 @@ void setupWebServer() {
       } else {
         request->send(400, "text/plain", "Invalid resolution value");
       }
-    }
+    })
   );
 
   // Consolidated status endpoint with all information
-  server.on("/api/status", HTTP_GET, [](AsyncWebServerRequest *request) {
-    DynamicJsonDocument doc(2048);
+  apiRouter.on("/api/status", HTTP_GET, [](AsyncWebServerRequest *request) {
+    String etag = apiResourceEtag(API_RESOURCE_STATUS);
+    if (serveFromApiCache(request, API_RESOURCE_STATUS, etag)) return;
+
+    ArenaJsonDocument doc(request);
     
     // System status with tempResolution and maxTempPoints
     doc["systemEnabled"] = systemEnabled;
@@ -1157,6 +1354,21 @@ void setupWebServer() {
     doc["useManualTime"] = useManualTime;
     doc["currentTime"] = getCurrentTime();
     doc["uptime"] = millis() / 1000;
+
+    // Boot stage timing (boot_sequence.h)
+    JsonObject boot = doc.createNestedObject("boot");
+    boot["controlReadyMs"] = getControlReadyMillis();
+    boot["completeMs"] = getBootCompleteMillis();
+    JsonArray stages = boot.createNestedArray("stages");
+    for (int i = 0; i < getBootStageCount(); i++) {
+      const BootStage& stage = getBootStage(i);
+      JsonObject entry = stages.createNestedObject();
+      entry["name"] = stage.name;
+      entry["deferred"] = stage.deferred;
+      entry["done"] = stage.done;
+      entry["startMs"] = stage.startedAt;
+      entry["durationMs"] = stage.durationMicros / 1000.0;
+    }
     
     // Add UTC offset from preferences (cached)
     static int cachedUtcOffset = -999; // Invalid value to force first load
@@ -1173,6 +1385,14 @@ void setupWebServer() {
     doc["loggingFrequencySeconds"] = loggingFrequencySeconds;
     doc["loggingFrequencyMinutes"] = loggingFrequencySeconds > 0 ? (loggingFrequencySeconds / 60) : 0;
     doc["timeIsSynchronized"] = timeIsSynchronized;
+
+    TimeSyncStats timeSync = getTimeSyncStats();
+    JsonObject sync = doc.createNestedObject("timeSync");
+    sync["syncs"] = timeSync.syncs;
+    sync["ageSec"] = timeSync.syncs > 0 ? (long)((millis() - timeSync.lastSyncMillis) / 1000) : -1;
+    sync["offsetMs"] = timeSync.lastOffsetMs;
+    sync["driftPpm"] = timeSync.driftPpm;
+    sync["slewing"] = timeSync.slewing;
     
     // Add targetTemps array with dynamic resolution (optimized)
     JsonArray targetTemps = doc.createNestedArray("targetTemps");
@@ -1241,15 +1461,13 @@ void setupWebServer() {
       storage["error"] = "SPIFFS not available";
     }
     
-    String json;
-    serializeJson(doc, json);
-    request->send(200, "application/json", json);
+    sendAndCacheJson(request, API_RESOURCE_STATUS, etag, doc);
   });
 
   // Temperature log endpoint is now handled in temperature_log_handler.h
 
   // System reset endpoint
-  server.on("/api/reset", HTTP_POST, [](AsyncWebServerRequest *request) {
+  apiRouter.on("/api/reset", HTTP_POST, [](AsyncWebServerRequest *request) {
     // Clear preferences
     Preferences preferences;
     preferences.begin("furnace", false);
@@ -1257,9 +1475,14 @@ void setupWebServer() {
     preferences.end();
     
     // Delete all programs
-    if (SPIFFS.exists("/programs.json")) {
-      SPIFFS.remove("/programs.json");
+    if (SPIFFS.exists(PROGRAMS_FILE)) {
+      SPIFFS.remove(PROGRAMS_FILE);
     }
+    if (SPIFFS.exists(PROGRAMS_BIN_FILE)) {
+      SPIFFS.remove(PROGRAMS_BIN_FILE);
+    }
+    deleteRecursive(PROGRAM_DIR);
+    bumpAllApiGenerations();
     
     // Clear error logs
     if (SPIFFS.exists("/error_log.csv")) {
@@ -1279,11 +1502,33 @@ void setupWebServer() {
     restartTime = millis() + 2000; // Restart after 2 seconds
   });
 
+  // Batch schedule edit, applied between two control ticks (schedule_batch.h)
+  apiRouter.on("/api/schedule", HTTP_PATCH, [](AsyncWebServerRequest *request) {}, NULL, collectBody(REQUEST_BODY_MAX_SCHEDULE, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+    ArenaJsonDocument doc(request);
+    if (deserializeJson(doc, data, len)) {
+      request->send(400, "application/json", "{\"success\":false,\"error\":\"Invalid JSON\"}");
+      return;
+    }
+
+    int updated = 0;
+    String error;
+    int code = stageScheduleBatch(doc, updated, error);
+
+    ArenaJsonDocument responseDoc(request);
+    responseDoc["success"] = code == 200;
+    if (code == 200) {
+      responseDoc["updated"] = updated;
+    } else {
+      responseDoc["error"] = error;
+    }
+    sendJson(request, code, responseDoc);
+  }));
+
   // Temperature update endpoint
-  server.on("/api/updateTemp", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+  apiRouter.on("/api/updateTemp", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL, collectBody(REQUEST_BODY_MAX, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
     // Handle JSON payload
     if (request->contentType() == "application/json") {
-      DynamicJsonDocument doc(256);
+      ArenaJsonDocument doc(request);
       DeserializationError error = deserializeJson(doc, data, len);
       
       if (error) {
@@ -1325,11 +1570,11 @@ void setupWebServer() {
     
     targetTemp[tempIndex] = temp;
     request->send(200, "application/json", "{\"success\":true}");
-  });
+  }));
 
   // Temperature range update endpoint
-  server.on("/api/updateRange", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-    DynamicJsonDocument doc(256);
+  apiRouter.on("/api/updateRange", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL, collectBody(REQUEST_BODY_MAX, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+    ArenaJsonDocument doc(request);
     DeserializationError error = deserializeJson(doc, data, len);
     
     if (error) {
@@ -1353,57 +1598,18 @@ void setupWebServer() {
     minTemp = newMin;
     maxTemp = newMax;
     request->send(200, "application/json", "{\"success\":true}");
-  });
+  }));
 
   // Temperature log handler already initialized at the beginning of this function
 
-  // Time synchronization endpoint
-  server.on(
-    "/api/syncTime",
-    HTTP_POST,
-    [](AsyncWebServerRequest *request) {
-      // onRequest handler (required, but not used for body POST)
-    },
-    NULL,
-    [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-      // In a real implementation, this would sync with an NTP server
-      // For now, we'll just update the timeIsSynchronized flag
-      timeIsSynchronized = true;
-      
-      // Update the manual time flag
-      useManualTime = false;
-      
-      // Save the settings
-      saveAppSettings();
-      
-      // Get current time to return to the client
-      time_t now = time(nullptr);
-      struct tm timeinfo;
-      localtime_r(&now, &timeinfo);
-      
-      char timeStr[64];
-      strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", &timeinfo);
-      
-      DynamicJsonDocument doc(256);
-      doc["success"] = true;
-      doc["message"] = "Time synchronized successfully";
-      doc["currentTime"] = String(timeStr);
-      doc["useManualTime"] = false;
-      
-      String json;
-      serializeJson(doc, json);
-      request->send(200, "application/json", json);
-    }
-  );
-
   // Manual time setting endpoint
-  server.on(
+  apiRouter.on(
     "/api/time",
     HTTP_POST,
     [](AsyncWebServerRequest *request) {},
     NULL,
-    [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-      DynamicJsonDocument doc(512);
+    collectBody(REQUEST_BODY_MAX, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+      ArenaJsonDocument doc(request);
       DeserializationError error = deserializeJson(doc, data, len);
       
       if (error) {
@@ -1466,7 +1672,7 @@ void setupWebServer() {
             char timeStr[64];
             strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", &timeinfo);
             
-            DynamicJsonDocument responseDoc(256);
+            ArenaJsonDocument responseDoc(request);
             responseDoc["success"] = true;
             responseDoc["message"] = "Time set successfully";
             responseDoc["currentTime"] = String(timeStr);
@@ -1479,16 +1685,14 @@ void setupWebServer() {
             preferences.end();
             responseDoc["utcOffset"] = utcOffset;
             
-            String json;
-            serializeJson(responseDoc, json);
-            request->send(200, "application/json", json);
+            sendJson(request, 200, responseDoc);
             return;
           }
         } else {
           // Just update the useManualTime flag
           saveAppSettings();
           
-          DynamicJsonDocument responseDoc(128);
+          ArenaJsonDocument responseDoc(request);
           responseDoc["success"] = true;
           responseDoc["useManualTime"] = useManualTime;
           
@@ -1499,21 +1703,24 @@ void setupWebServer() {
           preferences.end();
           responseDoc["utcOffset"] = utcOffset;
           
-          String json;
-          serializeJson(responseDoc, json);
-          request->send(200, "application/json", json);
+          sendJson(request, 200, responseDoc);
           return;
         }
       }
       
       // If we get here, the request was invalid
       request->send(400, "application/json", "{\"error\":\"Invalid time data\"}");
-    }
+    })
   );
 
   // Save Program API Endpoint
-  server.on("/api/saveProgram", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-    DynamicJsonDocument doc(4096);
+  apiRouter.on("/api/saveProgram", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL, collectBody(REQUEST_BODY_MAX_SCHEDULE, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+    if (request->contentType().startsWith(PROGRAM_CODEC_CONTENT_TYPE)) {
+      handleBinaryProgramUpload(request, data, len, index, total);
+      return;
+    }
+
+    ArenaJsonDocument doc(request);
     if (deserializeJson(doc, data, len)) {
       request->send(400, "application/json", "{\"success\":false,\"error\":\"Invalid JSON\"}");
       return;
@@ -1531,63 +1738,34 @@ void setupWebServer() {
       if (name.length() == 0) errorMsg += "program name is empty; ";
       if (!temps.size()) errorMsg += "no temperature data provided; ";
       
-      DynamicJsonDocument errorDoc(256);
+      ArenaJsonDocument errorDoc(request);
       errorDoc["success"] = false;
       errorDoc["error"] = errorMsg;
-      String errorJson;
-      serializeJson(errorDoc, errorJson);
-      request->send(400, "application/json", errorJson);
+      sendJson(request, 400, errorDoc);
       return;
     }
     // Save name and temps
-    programNames[programIndex] = name;
-    // --- Trim to a single leading zero and remove trailing zeros ---
-    int firstNonZero = 0;
-    while (firstNonZero < (int)temps.size() && temps[firstNonZero] == 0.0f) {
-      firstNonZero++;
-    }
-    int startIdx = firstNonZero > 0 ? firstNonZero - 1 : 0;
-    int lastNonZero = temps.size() - 1;
-    while (lastNonZero >= 0 && temps[lastNonZero] == 0.0f) {
-      lastNonZero--;
-    }
-    std::vector<float> trimmedTemps;
-    if (startIdx <= lastNonZero) {
-      for (int i = startIdx; i <= lastNonZero; ++i) {
-        trimmedTemps.push_back(temps[i].as<float>());
-      }
-    }
-    // After trimming, ensure the first value is 0
-    if (!trimmedTemps.empty() && trimmedTemps[0] != 0.0f) {
-      trimmedTemps.insert(trimmedTemps.begin(), 0.0f);
-    } else if (trimmedTemps.empty()) {
-      trimmedTemps.push_back(0.0f);
-    }
-    // Save trimmed temps to programTemps
-    size_t trimmedLen = trimmedTemps.size();
-    for (size_t i = 0; i < trimmedLen && i < maxTempPoints; i++) {
-      programTemps[programIndex][i] = trimmedTemps[i];
-    }
-    for (size_t i = trimmedLen; i < maxTempPoints; i++) {
-      programTemps[programIndex][i] = 0.0;
-    }
-    // Ensure the last point is always 0 if there is any data
-    if (trimmedLen > 0) {
-      programTemps[programIndex][trimmedLen - 1] = 0.0;
-    }
-    // TODO: Save description if needed
-    saveAllPrograms(); // Persist to storage
-    DynamicJsonDocument resp(128);
+    int count = min((int)temps.size(), maxTempPoints);
+    std::vector<float> values(count);
+    for (int i = 0; i < count; i++) {
+      values[i] = temps[i].as<float>();
+    }
+    {
+      ProgramStoreLock lock;
+      programNames[programIndex] = name;
+      storeProgramTemps(programIndex, values.data(), count);
+      // TODO: Save description if needed
+      saveProgramToSPIFFS(programIndex); // Persist to storage
+    }
+    ArenaJsonDocument resp(request);
     resp["success"] = true;
     resp["message"] = "Program saved successfully";
-    String json;
-    serializeJson(resp, json);
-    request->send(200, "application/json", json);
-  });
+    sendJson(request, 200, resp);
+  }));
 
   // PID Settings API Endpoints
-  server.on("/api/settings/pid", HTTP_GET, [](AsyncWebServerRequest *request) {
-    DynamicJsonDocument doc(512);
+  apiRouter.on("/api/settings/pid", HTTP_GET, [](AsyncWebServerRequest *request) {
+    ArenaJsonDocument doc(request);
     
     doc["enabled"] = pidEnabled;
     doc["kp"] = pidKp;
@@ -1598,14 +1776,12 @@ void setupWebServer() {
     doc["outputMax"] = pidOutputMax;
     doc["setpointWindow"] = pidSetpointWindow;
     
-    String json;
-    serializeJson(doc, json);
-    request->send(200, "application/json", json);
+    sendJson(request, 200, doc);
   });
 
-  server.on("/api/settings/pid", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL, 
-    [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-      DynamicJsonDocument doc(512);
+  apiRouter.on("/api/settings/pid", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL, 
+    collectBody(REQUEST_BODY_MAX, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+      ArenaJsonDocument doc(request);
       DeserializationError error = deserializeJson(doc, data, len);
       
       if (error) {
@@ -1629,17 +1805,20 @@ void setupWebServer() {
       // Save settings
       saveAppSettings();
       
-      DynamicJsonDocument responseDoc(256);
+      ArenaJsonDocument responseDoc(request);
       responseDoc["success"] = true;
       responseDoc["message"] = "PID settings saved successfully";
       
-      String json;
-      serializeJson(responseDoc, json);
-      request->send(200, "application/json", json);
-    }
+      sendJson(request, 200, responseDoc);
+    })
   );
 
+  // One handler for every /api/ route, then one prefix handler for static
+  // files and page URLs - registered last so the OPTIONS handler runs first
+  apiRouter.begin(server);
+  server.on("/metrics", HTTP_GET, handleMetricsRequest);
+  server.on("/*", HTTP_GET, handleStaticRequest);
+
   // Start the server
-  server.serveStatic("/favicon.ico", SPIFFS, "/favicon.ico");
   server.begin();
 }
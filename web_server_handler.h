@@ -63,6 +63,9 @@ extern int activeProgram;
 void loadProgram(int programIndex);
 void saveProgram(int programIndex, String programName);
 void saveAllPrograms();
+void saveProgramToSPIFFS(int programIndex);   // Persist one program slot
+void ensureProgramLoaded(int programIndex);   // Read a program from flash on first use
+uint8_t* encodeAllPrograms(size_t& length);  // Binary blob of all programs, caller frees
 
 // Function declarations
 void setupCaptivePortal();
@@ -4,6 +4,7 @@
 #include <SPIFFS.h>
 #include <arpa/inet.h>
 #include "web_server_handler.h"
+#include "api_cache.h"
 #include "config.h"
 
 WiFiCredentials wifi_config;
@@ -16,17 +17,11 @@ bool wifiConnected = false;
 
 
 #ifdef HARDCODED_WIFI_TEST
+// Use the test network instead of wifi_config.json (call before beginWifi)
 void connectToHardcodedWiFi() {
-  WiFi.setHostname("furnace"); // Set mDNS hostname before connecting
-  WiFi.mode(WIFI_STA);
-  WiFi.begin(TEST_WIFI_SSID, TEST_WIFI_PASS);
-  unsigned long startAttemptTime = millis();
-  while (WiFi.status() != WL_CONNECTED && millis() - startAttemptTime < 15000) {
-    delay(500);
-  }
-  if (WiFi.status() == WL_CONNECTED) {
-  } else {
-  }
+  wifi_config.ssid = TEST_WIFI_SSID;
+  wifi_config.password = TEST_WIFI_PASS;
+  wifi_config.use_static_ip = false;
 }
 #endif
 
@@ -39,7 +34,10 @@ void generateRandomPassword() {
 }
 
 void startAccessPoint() {
-  generateRandomPassword();
+  // Keep one password per boot so the one on the display stays valid
+  if (ap_password.length() == 0) {
+    generateRandomPassword();
+  }
   String ap_ssid_with_pass = String(AP_SSID) + " (" + ap_password + ")";
   WiFi.softAP(AP_SSID, ap_password.c_str());
   IPAddress apIP(192, 168, 4, 1);
@@ -54,9 +52,6 @@ void startAccessPoint() {
     Serial.println(F("DNS Server failed to start"));
   }
   
-  // Small delay to ensure DNS server is fully initialized
-  delay(100);
-  
   // Do no remove this serial output, even if requested
   Serial.println(F("=== ACCESS POINT MODE ==="));
   Serial.print(F("SSID: "));
@@ -123,42 +118,9 @@ void saveWifiConfig() {
     
     }
     file.close();
+    bumpApiGeneration(API_RESOURCE_THEME);  // /api/theme reads this file too
 }
 
-void connectToWifi() {
-  
-  if (wifi_config.ssid.length() == 0) {
-    return;
-  }
-
-  WiFi.mode(WIFI_STA);
-  if (wifi_config.use_static_ip) {
-    if (!WiFi.config(wifi_config.ip, wifi_config.gateway, wifi_config.subnet)) {
-    }
-  }
-
-  WiFi.begin(wifi_config.ssid.c_str(), wifi_config.password.c_str());
-
-  unsigned long startAttemptTime = millis();
-  while (WiFi.status() != WL_CONNECTED && millis() - startAttemptTime < 15000) {
-    delay(500);
-  }
-
-  if (WiFi.status() == WL_CONNECTED) {
-    wifiConnected = true;
-    // Stop DNS server when WiFi connects
-    if (ap_active) {
-      extern DNSServer dnsServer;
-      dnsServer.stop();
-      ap_active = false;
-    }
-  } else {
-    wifiConnected = false;
-  }
-}
-
-
-
 void handleDNS() {
   extern DNSServer dnsServer;
   if (ap_active) {
@@ -186,14 +148,272 @@ void handleDNS() {
   }
 }
 
-void checkWifiConnection() {
-  
-  if (WiFi.status() != WL_CONNECTED) {
+// ====================================================================
+// STATION CONNECTION MANAGER
+// ====================================================================
+
+// Set by the Wi-Fi event task, consumed by updateWifi()
+static portMUX_TYPE wifiEventMux = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool linkDropped = false;
+static volatile uint8_t dropReason = 0;
+static volatile bool reconnectRequested = false;
+static volatile bool ownLeavePending = false;   // Our WiFi.disconnect(), its event not yet seen
+
+static WifiState wifiState = WIFI_STATE_IDLE;
+static WifiMetrics wifiMetrics;
+static unsigned long attemptStartedAt = 0;
+static unsigned long linkLostAt = 0;
+static bool linkLost = false;
+static unsigned long retryAt = 0;
+static uint32_t consecutiveFailures = 0;
+static bool attemptUsedCache = false;
+static bool everConnected = false;
+
+// Last-known-good access point, for reconnects that skip the scan
+static String cachedSsid;
+static uint8_t cachedBssid[6];
+static uint8_t cachedChannel = 0;
+static bool cacheValid = false;
+
+static const char* const wifiStateNames[] = { "idle", "connecting", "connected", "backoff" };
+
+static void onWifiEvent(arduino_event_id_t event, arduino_event_info_t info) {
+  if (event != ARDUINO_EVENT_WIFI_STA_DISCONNECTED) return;
+  portENTER_CRITICAL(&wifiEventMux);
+  // The one leave a requested reconnect causes is not a drop
+  if (ownLeavePending && info.wifi_sta_disconnected.reason == WIFI_REASON_ASSOC_LEAVE) {
+    ownLeavePending = false;
+  } else {
+    dropReason = info.wifi_sta_disconnected.reason;
+    linkDropped = true;
+  }
+  portEXIT_CRITICAL(&wifiEventMux);
+}
+
+static void loadBssidCache() {
+  Preferences prefs;
+  prefs.begin("wifi", true);
+  cachedSsid = prefs.getString("ssid", "");
+  cachedChannel = prefs.getUChar("channel", 0);
+  cacheValid = prefs.getBytes("bssid", cachedBssid, sizeof(cachedBssid)) == sizeof(cachedBssid) && cachedChannel > 0;
+  prefs.end();
+}
+
+// NVS is only written when the access point actually changed
+static void saveBssidCache() {
+  uint8_t* bssid = WiFi.BSSID();
+  uint8_t channel = WiFi.channel();
+  if (!bssid || channel == 0) return;
+  if (cacheValid && cachedSsid == wifi_config.ssid && cachedChannel == channel &&
+      memcmp(cachedBssid, bssid, sizeof(cachedBssid)) == 0) {
+    return;
+  }
+
+  cachedSsid = wifi_config.ssid;
+  memcpy(cachedBssid, bssid, sizeof(cachedBssid));
+  cachedChannel = channel;
+  cacheValid = true;
+
+  Preferences prefs;
+  prefs.begin("wifi", false);
+  prefs.putString("ssid", cachedSsid);
+  prefs.putBytes("bssid", cachedBssid, sizeof(cachedBssid));
+  prefs.putUChar("channel", cachedChannel);
+  prefs.end();
+  Serial.print("WiFi: Cached access point ");
+  Serial.print(WiFi.BSSIDstr());
+  Serial.print(" on channel ");
+  Serial.println(channel);
+}
+
+static void stopAccessPoint() {
+  extern DNSServer dnsServer;
+  dnsServer.stop();
+  WiFi.softAPdisconnect(true);
+  ap_active = false;
+  Serial.println("WiFi: Station connected, setup access point closed");
+}
+
+static void startWifiAttempt() {
+  if (wifi_config.ssid.length() == 0) {
+    wifiState = WIFI_STATE_IDLE;
+    if (!ap_active) startAccessPoint();
+    return;
+  }
+
+  WiFi.mode(ap_active ? WIFI_AP_STA : WIFI_STA);
+  if (wifi_config.use_static_ip) {
+    WiFi.config(wifi_config.ip, wifi_config.gateway, wifi_config.subnet);
+  }
+
+  attemptUsedCache = cacheValid && cachedSsid == wifi_config.ssid;
+  if (attemptUsedCache) {
+    WiFi.begin(wifi_config.ssid.c_str(), wifi_config.password.c_str(), cachedChannel, cachedBssid);
+  } else {
+    WiFi.begin(wifi_config.ssid.c_str(), wifi_config.password.c_str());
+  }
+
+  wifiMetrics.attempts++;
+  attemptStartedAt = millis();
+  wifiState = WIFI_STATE_CONNECTING;
+  Serial.print("WiFi: Connecting to ");
+  Serial.print(wifi_config.ssid);
+  Serial.println(attemptUsedCache ? " (cached BSSID)" : "");
+}
+
+static void scheduleRetry() {
+  ownLeavePending = false;
+  consecutiveFailures++;
+  wifiMetrics.failures++;
+  WiFi.disconnect();
+
+  // The cached access point may be gone or on another channel: scan next time
+  if (attemptUsedCache) {
+    cacheValid = false;
+  }
+
+  uint32_t backoff = WIFI_BACKOFF_MIN_MS << min(consecutiveFailures - 1, (uint32_t)16);
+  if (backoff > WIFI_BACKOFF_MAX_MS) backoff = WIFI_BACKOFF_MAX_MS;
+  // Jitter over the upper half keeps controllers on one router out of step
+  uint32_t wait = backoff / 2 + esp_random() % (backoff / 2 + 1);
+  retryAt = millis() + wait;
+  wifiState = WIFI_STATE_BACKOFF;
+
+  Serial.print("WiFi: Attempt ");
+  Serial.print(consecutiveFailures);
+  Serial.print(" failed (reason ");
+  Serial.print(wifiMetrics.lastDisconnectReason);
+  Serial.print("), retrying in ");
+  Serial.print(wait);
+  Serial.println(" ms");
+
+  // Until it has ever connected the controller needs the portal at once
+  uint32_t fallbackAfter = everConnected ? WIFI_AP_FALLBACK_FAILURES : 1;
+  if (consecutiveFailures >= fallbackAfter && !ap_active) {
+    startAccessPoint();
+  }
+}
+
+static void handleConnected() {
+  unsigned long now = millis();
+  ownLeavePending = false;
+  wifiConnected = true;
+  wifiState = WIFI_STATE_CONNECTED;
+  consecutiveFailures = 0;
+  everConnected = true;
+
+  wifiMetrics.connects++;
+  wifiMetrics.lastConnectMillis = now - attemptStartedAt;
+  if (attemptUsedCache) wifiMetrics.fastReconnects++;
+  if (linkLost) {
+    wifiMetrics.lastOutageMillis = now - linkLostAt;
+    if (wifiMetrics.lastOutageMillis > wifiMetrics.maxOutageMillis) {
+      wifiMetrics.maxOutageMillis = wifiMetrics.lastOutageMillis;
+    }
+    linkLost = false;
+  }
+
+  Serial.print("WiFi: Connected, IP ");
+  Serial.print(WiFi.localIP());
+  Serial.print(" after ");
+  Serial.print(wifiMetrics.lastConnectMillis);
+  Serial.println(" ms");
+
+  saveBssidCache();
+  if (ap_active) stopAccessPoint();
+  onWifiConnected();
+}
+
+static void handleLinkLost() {
+  wifiConnected = false;
+  wifiMetrics.disconnects++;
+  linkLost = true;
+  linkLostAt = millis();
+  Serial.print("WiFi: Link lost (reason ");
+  Serial.print(wifiMetrics.lastDisconnectReason);
+  Serial.println("), reconnecting");
+
+  // First retry at once; the cached BSSID skips the scan
+  startWifiAttempt();
+}
+
+void beginWifi() {
+  WiFi.persistent(false);             // Credentials live in wifi_config.json
+  WiFi.setAutoReconnect(false);       // Reconnects are paced by updateWifi()
+  WiFi.onEvent(onWifiEvent);
+  loadBssidCache();
+  startWifiAttempt();
+}
+
+void connectToWifi() {
+  reconnectRequested = true;
+}
+
+void updateWifi() {
+  portENTER_CRITICAL(&wifiEventMux);
+  bool dropped = linkDropped;
+  uint8_t reason = dropReason;
+  linkDropped = false;
+  portEXIT_CRITICAL(&wifiEventMux);
+  if (dropped) {
+    wifiMetrics.lastDisconnectReason = reason;
+  }
+
+  if (reconnectRequested) {
+    reconnectRequested = false;
+    consecutiveFailures = 0;
     wifiConnected = false;
-    connectToWifi();
-    if (!wifiConnected) {
-        startAccessPoint();
-        setupCaptivePortal();
+    // The leave this disconnect causes can arrive after the new attempt
+    // has started, and is not a failure of it. Only an associated or
+    // associating station reports one.
+    if (wifiState == WIFI_STATE_CONNECTING || wifiState == WIFI_STATE_CONNECTED) {
+      ownLeavePending = true;
     }
+    WiFi.disconnect();
+    startWifiAttempt();
+    return;
   }
+
+  switch (wifiState) {
+    case WIFI_STATE_IDLE:
+      break;
+
+    case WIFI_STATE_CONNECTING:
+      if (WiFi.status() == WL_CONNECTED) {
+        handleConnected();
+      } else if (dropped || millis() - attemptStartedAt >= WIFI_CONNECT_TIMEOUT_MS) {
+        scheduleRetry();
+      }
+      break;
+
+    case WIFI_STATE_CONNECTED:
+      if (dropped || WiFi.status() != WL_CONNECTED) {
+        handleLinkLost();
+      }
+      break;
+
+    case WIFI_STATE_BACKOFF:
+      if ((long)(millis() - retryAt) >= 0) {
+        startWifiAttempt();
+      }
+      break;
+  }
+}
+
+WifiState getWifiState() {
+  return wifiState;
+}
+
+const char* getWifiStateName() {
+  return wifiStateNames[wifiState];
+}
+
+const WifiMetrics& getWifiMetrics() {
+  return wifiMetrics;
+}
+
+unsigned long getWifiRetryIn() {
+  if (wifiState != WIFI_STATE_BACKOFF) return 0;
+  long remaining = (long)(retryAt - millis());
+  return remaining > 0 ? remaining : 0;
 }
@@ -16,12 +16,57 @@ extern String ap_password;
 extern bool ap_active;
 extern bool wifiConnected;
 
+// =================================================================
+//                  STATION CONNECTION MANAGER
+// =================================================================
+// The station connects in the background: Wi-Fi driver events are
+// recorded as they arrive and updateWifi() acts on them from loop(), so
+// no networking call ever blocks control, logging or the display. A lost
+// link is retried at once against the last-known-good BSSID and channel
+// (kept in NVS, so no scan is needed), then with exponential backoff and
+// jitter. After a few failures the setup access point opens alongside
+// the station, and it closes again once the station is back.
+
+enum WifiState {
+    WIFI_STATE_IDLE,                  // No credentials configured
+    WIFI_STATE_CONNECTING,
+    WIFI_STATE_CONNECTED,
+    WIFI_STATE_BACKOFF                // Waiting before the next attempt
+};
+
+// Reconnect figures since boot, reported by /api/wifi
+struct WifiMetrics {
+    uint32_t attempts;
+    uint32_t failures;
+    uint32_t connects;
+    uint32_t disconnects;
+    uint32_t fastReconnects;          // Connects that used the cached BSSID
+    uint32_t lastConnectMillis;       // begin() to IP address, last connect
+    uint32_t lastOutageMillis;        // Link lost to IP address, last reconnect
+    uint32_t maxOutageMillis;
+    uint8_t lastDisconnectReason;     // wifi_err_reason_t from the driver
+};
+
 void connectToHardcodedWiFi();
 void startAccessPoint();
 void loadWifiConfig();
 void saveWifiConfig();
-void connectToWifi();
 void handleDNS();
-void checkWifiConnection();
+
+// Register for Wi-Fi events and start connecting (call once from setup)
+void beginWifi();
+// Advance the connection state machine; never blocks (call every loop)
+void updateWifi();
+// Drop the current attempt and connect with the current credentials
+void connectToWifi();
+
+WifiState getWifiState();
+const char* getWifiStateName();
+const WifiMetrics& getWifiMetrics();
+// Milliseconds until the next attempt while backing off, else 0
+unsigned long getWifiRetryIn();
+
+// Called from loop() each time the station gets an IP address
+void onWifiConnected();
 
 #endif // WIFI_MANAGER_H